@@ -0,0 +1,521 @@
+// Agent-Zero Approximate Nearest Neighbour Index
+// /src/agent-zero/ann-index.c
+//
+// Hierarchical navigable small world graph (Malkov & Yashunin) over f32
+// rows. Every vector lives on layer 0 and on each layer up to a random
+// level drawn with P(level >= l) = m^-l; a query descends greedily from
+// the top layer's entry point and runs a best-first beam of width ef on
+// layer 0, so it visits O(log n) neighbourhoods instead of every row.
+// Neighbour lists are chosen with the diversity heuristic, which keeps the
+// graph navigable on clustered data. Distances are the SIMD dot / l2_sq
+// kernels; queries share the index read-only and each keeps its own
+// visited stamps, so batches run on the thread pool.
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cognitive-internal.h"
+
+#define ANN_DEFAULT_M 16
+#define ANN_DEFAULT_EF_CONSTRUCTION 200
+#define ANN_DEFAULT_EF 64
+#define ANN_MAX_M 128
+#define ANN_MAX_LEVEL 31
+
+typedef struct {
+    float dist;
+    uint32_t id;
+} ann_candidate_t;
+
+// Binary max-heap on (dist, id); candidates are pushed with -dist so the
+// same heap pops the nearest first. Capacity is reserved up front.
+typedef struct {
+    ann_candidate_t* items;
+    size_t size;
+} ann_heap_t;
+
+// Per-search state, sized by scratch_reserve so a search never allocates:
+// visited stamps (one epoch per layer search), the candidate heap (at most
+// every node), the ef-bounded result heap and a normalised query copy
+typedef struct {
+    uint32_t* stamp;
+    ann_candidate_t* candidate_items;
+    ann_candidate_t* result_items;
+    ann_candidate_t* sorted;
+    size_t node_capacity;
+    size_t beam_capacity;
+    uint32_t epoch;
+    ann_heap_t candidates;
+    ann_heap_t results;
+    float* query;
+} ann_scratch_t;
+
+struct ann_index {
+    size_t dim;
+    ann_metric_t metric;
+    size_t m;                 // links per node on upper layers
+    size_t m0;                // links per node on layer 0 (2 m)
+    size_t ef_construction;
+    double level_scale;       // 1 / ln(m)
+    uint64_t rng;
+    size_t count;
+    size_t capacity;
+    float* vectors;           // count x dim, unit length for ANN_COSINE
+    uint32_t* links0;         // capacity x (1 + m0): count, then ids
+    uint32_t** upper;         // levels[i] x (1 + m) per node, NULL at level 0
+    uint8_t* levels;
+    uint32_t entry;
+    int max_level;            // -1 while empty
+    ann_scratch_t scratch;    // used by inserts
+};
+
+static int candidate_less(ann_candidate_t a, ann_candidate_t b) {
+    return a.dist < b.dist || (a.dist == b.dist && a.id < b.id);
+}
+
+static int compare_candidates(const void* a, const void* b) {
+    ann_candidate_t x = *(const ann_candidate_t*)a;
+    ann_candidate_t y = *(const ann_candidate_t*)b;
+    return candidate_less(x, y) ? -1 : candidate_less(y, x);
+}
+
+static void heap_push(ann_heap_t* h, ann_candidate_t c) {
+    size_t i = h->size++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!candidate_less(h->items[parent], c)) break;
+        h->items[i] = h->items[parent];
+        i = parent;
+    }
+    h->items[i] = c;
+}
+
+static ann_candidate_t heap_pop(ann_heap_t* h) {
+    ann_candidate_t top = h->items[0];
+    ann_candidate_t last = h->items[--h->size];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && candidate_less(h->items[child], h->items[child + 1])) child++;
+        if (!candidate_less(last, h->items[child])) break;
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    if (h->size) h->items[i] = last;
+    return top;
+}
+
+static void scratch_free(ann_scratch_t* s) {
+    free(s->stamp);
+    free(s->candidate_items);
+    free(s->result_items);
+    free(s->sorted);
+    free(s->query);
+}
+
+// Room for searches over n nodes with beams up to ef; returns 0 or -1
+static int scratch_reserve(ann_scratch_t* s, size_t n, size_t ef, size_t dim) {
+    if (!s->query) {
+        s->query = malloc(dim * sizeof(float));
+        if (!s->query) return -1;
+    }
+    if (n > s->node_capacity) {
+        size_t capacity = s->node_capacity ? s->node_capacity : 256;
+        while (capacity < n) capacity *= 2;
+        uint32_t* stamp = realloc(s->stamp, capacity * sizeof(uint32_t));
+        if (stamp) s->stamp = stamp;
+        ann_candidate_t* items = realloc(s->candidate_items, capacity * sizeof(ann_candidate_t));
+        if (items) s->candidate_items = items;
+        if (!stamp || !items) return -1;
+        memset(stamp + s->node_capacity, 0, (capacity - s->node_capacity) * sizeof(uint32_t));
+        s->node_capacity = capacity;
+    }
+    if (ef + 1 > s->beam_capacity) {
+        ann_candidate_t* items = realloc(s->result_items, (ef + 1) * sizeof(ann_candidate_t));
+        if (items) s->result_items = items;
+        ann_candidate_t* sorted = realloc(s->sorted, (ef + 1) * sizeof(ann_candidate_t));
+        if (sorted) s->sorted = sorted;
+        if (!items || !sorted) return -1;
+        s->beam_capacity = ef + 1;
+    }
+    s->candidates.items = s->candidate_items;
+    s->results.items = s->result_items;
+    return 0;
+}
+
+static void scratch_next_epoch(ann_scratch_t* s) {
+    if (++s->epoch == 0) {
+        memset(s->stamp, 0, s->node_capacity * sizeof(uint32_t));
+        s->epoch = 1;
+    }
+}
+
+static const float* vector_at(const ann_index_t* index, uint32_t id) {
+    return index->vectors + (size_t)id * index->dim;
+}
+
+static float distance(const ann_index_t* index, const float* q, uint32_t id) {
+    const simd_kernels_t* simd = simd_kernels();
+    if (index->metric == ANN_COSINE) {
+        return 1.0f - simd->dot(q, vector_at(index, id), (int64_t)index->dim);
+    }
+    return simd->l2_sq(q, vector_at(index, id), (int64_t)index->dim);
+}
+
+// Neighbour list of id on layer: element 0 is the count
+static uint32_t* links_at(const ann_index_t* index, uint32_t id, int layer) {
+    if (layer == 0) return index->links0 + (size_t)id * (1 + index->m0);
+    return index->upper[id] + (size_t)(layer - 1) * (1 + index->m);
+}
+
+// Unit length copy for ANN_COSINE; zero vectors stay zero
+static void prepare_vector(const ann_index_t* index, float* dst, const float* src) {
+    memcpy(dst, src, index->dim * sizeof(float));
+    if (index->metric == ANN_COSINE) {
+        float norm = sqrtf(simd_kernels()->dot(src, src, (int64_t)index->dim));
+        if (norm > 0.0f) simd_kernels()->scale(dst, dst, 1.0f / norm, (int64_t)index->dim);
+    }
+}
+
+// Greedy walk to the closest node on one layer
+static ann_candidate_t greedy_closest(const ann_index_t* index, const float* q,
+                                      ann_candidate_t current, int layer) {
+    int moved = 1;
+    while (moved) {
+        moved = 0;
+        const uint32_t* links = links_at(index, current.id, layer);
+        for (uint32_t k = 1; k <= links[0]; k++) {
+            ann_candidate_t next = { distance(index, q, links[k]), links[k] };
+            if (candidate_less(next, current)) {
+                current = next;
+                moved = 1;
+            }
+        }
+    }
+    return current;
+}
+
+// Beam search of width ef on one layer from the entries in s->results;
+// on return s->results holds the ef closest nodes found
+static void search_layer(const ann_index_t* index, ann_scratch_t* s, const float* q,
+                         size_t ef, int layer) {
+    scratch_next_epoch(s);
+    s->candidates.size = 0;
+    for (size_t i = 0; i < s->results.size; i++) {
+        ann_candidate_t c = s->results.items[i];
+        s->stamp[c.id] = s->epoch;
+        heap_push(&s->candidates, (ann_candidate_t){ -c.dist, c.id });
+    }
+    while (s->results.size > ef) heap_pop(&s->results);
+
+    while (s->candidates.size) {
+        ann_candidate_t c = heap_pop(&s->candidates);
+        c.dist = -c.dist;
+        if (s->results.size >= ef && c.dist > s->results.items[0].dist) break;
+        const uint32_t* links = links_at(index, c.id, layer);
+        for (uint32_t k = 1; k <= links[0]; k++) {
+            uint32_t id = links[k];
+            if (s->stamp[id] == s->epoch) continue;
+            s->stamp[id] = s->epoch;
+            ann_candidate_t next = { distance(index, q, id), id };
+            if (s->results.size < ef || candidate_less(next, s->results.items[0])) {
+                heap_push(&s->candidates, (ann_candidate_t){ -next.dist, id });
+                heap_push(&s->results, next);
+                if (s->results.size > ef) heap_pop(&s->results);
+            }
+        }
+    }
+}
+
+// s->results in ascending order into s->sorted; returns the count
+static size_t sort_results(ann_scratch_t* s) {
+    size_t n = s->results.size;
+    memcpy(s->sorted, s->results.items, n * sizeof(ann_candidate_t));
+    qsort(s->sorted, n, sizeof(ann_candidate_t), compare_candidates);
+    return n;
+}
+
+// Diversity heuristic over candidates sorted by distance to the base node:
+// keep c unless an already kept neighbour is closer to c than the base is.
+// Writes up to max ids into out and returns how many.
+static size_t select_neighbours(const ann_index_t* index, const ann_candidate_t* sorted,
+                                size_t n, size_t max, uint32_t* out) {
+    size_t kept = 0;
+    for (size_t i = 0; i < n && kept < max; i++) {
+        const float* c = vector_at(index, sorted[i].id);
+        int diverse = 1;
+        for (size_t k = 0; k < kept && diverse; k++) {
+            diverse = distance(index, c, out[k]) >= sorted[i].dist;
+        }
+        if (diverse) out[kept++] = sorted[i].id;
+    }
+    return kept;
+}
+
+// Add id to neighbour's list on layer, re-selecting the list when full
+static void link_back(ann_index_t* index, uint32_t neighbour, uint32_t id, int layer) {
+    uint32_t* links = links_at(index, neighbour, layer);
+    size_t cap = layer == 0 ? index->m0 : index->m;
+    if (links[0] < cap) {
+        links[1 + links[0]++] = id;
+        return;
+    }
+    ann_candidate_t candidates[2 * ANN_MAX_M + 1];
+    const float* base = vector_at(index, neighbour);
+    for (size_t k = 0; k < cap; k++) {
+        candidates[k] = (ann_candidate_t){ distance(index, base, links[1 + k]), links[1 + k] };
+    }
+    candidates[cap] = (ann_candidate_t){ distance(index, base, id), id };
+    qsort(candidates, cap + 1, sizeof(ann_candidate_t), compare_candidates);
+    links[0] = (uint32_t)select_neighbours(index, candidates, cap + 1, cap, links + 1);
+}
+
+static int random_level(ann_index_t* index) {
+    // xorshift64*, uniform in (0, 1]
+    index->rng ^= index->rng >> 12;
+    index->rng ^= index->rng << 25;
+    index->rng ^= index->rng >> 27;
+    uint64_t bits = (index->rng * 0x2545F4914F6CDD1DULL) >> 11;
+    double u = ((double)bits + 1.0) / 9007199254740992.0;
+    double level = -log(u) * index->level_scale;
+    return level < ANN_MAX_LEVEL ? (int)level : ANN_MAX_LEVEL;
+}
+
+ann_index_t* create_ann_index(size_t dim, ann_metric_t metric, size_t m,
+                              size_t ef_construction, uint64_t seed) {
+    if (dim == 0 || (metric != ANN_L2 && metric != ANN_COSINE) || m == 1) return NULL;
+    if (m == 0) m = ANN_DEFAULT_M;
+    if (m > ANN_MAX_M) return NULL;
+
+    ann_index_t* index = calloc(1, sizeof(ann_index_t));
+    if (!index) return NULL;
+    index->dim = dim;
+    index->metric = metric;
+    index->m = m;
+    index->m0 = 2 * m;
+    index->ef_construction = ef_construction ? ef_construction : ANN_DEFAULT_EF_CONSTRUCTION;
+    if (index->ef_construction < m) index->ef_construction = m;
+    index->level_scale = 1.0 / log((double)m);
+    index->rng = seed ? seed : 0x9E3779B97F4A7C15ULL;
+    index->max_level = -1;
+    return index;
+}
+
+void destroy_ann_index(ann_index_t* index) {
+    if (index) {
+        for (size_t i = 0; i < index->count; i++) {
+            free(index->upper[i]);
+        }
+        free(index->upper);
+        free(index->levels);
+        free(index->links0);
+        free(index->vectors);
+        scratch_free(&index->scratch);
+        free(index);
+    }
+}
+
+size_t ann_index_size(const ann_index_t* index) {
+    return index ? index->count : 0;
+}
+
+size_t ann_index_dim(const ann_index_t* index) {
+    return index ? index->dim : 0;
+}
+
+static int reserve_nodes(ann_index_t* index, size_t n) {
+    if (n <= index->capacity) return 0;
+    size_t capacity = index->capacity ? index->capacity : 64;
+    while (capacity < n) capacity *= 2;
+    float* vectors = realloc(index->vectors, capacity * index->dim * sizeof(float));
+    if (vectors) index->vectors = vectors;
+    uint32_t* links0 = realloc(index->links0, capacity * (1 + index->m0) * sizeof(uint32_t));
+    if (links0) index->links0 = links0;
+    uint32_t** upper = realloc(index->upper, capacity * sizeof(uint32_t*));
+    if (upper) index->upper = upper;
+    uint8_t* levels = realloc(index->levels, capacity);
+    if (levels) index->levels = levels;
+    if (!vectors || !links0 || !upper || !levels) return -1;
+    index->capacity = capacity;
+    return 0;
+}
+
+int64_t ann_index_add(ann_index_t* index, const float* vector) {
+    if (!index || !vector || index->count >= UINT32_MAX) return -1;
+    ann_scratch_t* s = &index->scratch;
+    if (reserve_nodes(index, index->count + 1) != 0 ||
+        scratch_reserve(s, index->count + 1, index->ef_construction, index->dim) != 0) {
+        return -1;
+    }
+
+    uint32_t id = (uint32_t)index->count;
+    int level = random_level(index);
+    uint32_t* upper = NULL;
+    if (level > 0) {
+        upper = calloc((size_t)level * (1 + index->m), sizeof(uint32_t));
+        if (!upper) return -1;
+    }
+
+    STATS_SPAN_BEGIN(span);
+    float* v = index->vectors + (size_t)id * index->dim;
+    prepare_vector(index, v, vector);
+    index->links0[(size_t)id * (1 + index->m0)] = 0;
+    index->upper[id] = upper;
+    index->levels[id] = (uint8_t)level;
+    index->count++;
+
+    if (index->max_level < 0) {
+        index->entry = id;
+        index->max_level = level;
+        STATS_SPAN_END(span, AGENT_ZERO_OP_ANN_INSERT, index->dim * sizeof(float));
+        return id;
+    }
+
+    ann_candidate_t ep = { distance(index, v, index->entry), index->entry };
+    for (int layer = index->max_level; layer > level; layer--) {
+        ep = greedy_closest(index, v, ep, layer);
+    }
+    s->results.size = 0;
+    heap_push(&s->results, ep);
+
+    uint32_t selected[ANN_MAX_M];
+    for (int layer = level < index->max_level ? level : index->max_level; layer >= 0; layer--) {
+        search_layer(index, s, v, index->ef_construction, layer);
+        size_t n = sort_results(s);
+        size_t kept = select_neighbours(index, s->sorted, n, index->m, selected);
+        uint32_t* links = links_at(index, id, layer);
+        links[0] = (uint32_t)kept;
+        memcpy(links + 1, selected, kept * sizeof(uint32_t));
+        for (size_t k = 0; k < kept; k++) {
+            link_back(index, selected[k], id, layer);
+        }
+        // The whole beam seeds the next layer down; results are kept as is
+    }
+
+    if (level > index->max_level) {
+        index->entry = id;
+        index->max_level = level;
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ANN_INSERT, index->dim * sizeof(float));
+    return id;
+}
+
+int64_t ann_index_add_rows(ann_index_t* index, const struct ggml_tensor* rows) {
+    if (!index || !rows || !rows->data || (size_t)rows->ne[1] != index->dim) return -1;
+    const ggml_type_traits_t* traits = ggml_get_type_traits(rows->type);
+    if (!traits || !traits->to_f32) return -1;
+
+    int64_t n = ggml_nrows(rows);
+    if (reserve_nodes(index, index->count + (size_t)n) != 0) return -1;
+    float* row = malloc(index->dim * sizeof(float));
+    if (!row) return -1;
+    int64_t first = (int64_t)index->count;
+    for (int64_t r = 0; r < n; r++) {
+        traits->to_f32(ggml_get_row(rows, r), row, (int64_t)index->dim);
+        if (ann_index_add(index, row) < 0) {
+            free(row);
+            return -1;
+        }
+    }
+    free(row);
+    return first;
+}
+
+static size_t search_beam(size_t k, size_t ef) {
+    ef = ef ? ef : ANN_DEFAULT_EF;
+    return ef > k ? ef : k;
+}
+
+// Top-k of one prepared query into ids / distances, padded to k; s has
+// room for search_beam(k, ef)
+static size_t search_prepared(const ann_index_t* index, ann_scratch_t* s, const float* q,
+                              size_t k, size_t ef, uint32_t* ids, float* distances) {
+    size_t found = 0;
+    if (index->max_level >= 0 && k > 0) {
+        ann_candidate_t ep = { distance(index, q, index->entry), index->entry };
+        for (int layer = index->max_level; layer > 0; layer--) {
+            ep = greedy_closest(index, q, ep, layer);
+        }
+        s->results.size = 0;
+        heap_push(&s->results, ep);
+        search_layer(index, s, q, search_beam(k, ef), 0);
+        found = sort_results(s);
+        if (found > k) found = k;
+    }
+    for (size_t i = 0; i < k; i++) {
+        ids[i] = i < found ? s->sorted[i].id : UINT32_MAX;
+        if (distances) distances[i] = i < found ? s->sorted[i].dist : INFINITY;
+    }
+    return found;
+}
+
+size_t ann_index_search(const ann_index_t* index, const float* query, size_t k, size_t ef,
+                        uint32_t* ids, float* distances) {
+    if (!index || !query || !ids) return 0;
+    ann_scratch_t s = { 0 };
+    size_t found = 0;
+    STATS_SPAN_BEGIN(span);
+    if (scratch_reserve(&s, index->count, search_beam(k, ef), index->dim) == 0) {
+        prepare_vector(index, s.query, query);
+        found = search_prepared(index, &s, s.query, k, ef, ids, distances);
+    } else {
+        for (size_t i = 0; i < k; i++) {
+            ids[i] = UINT32_MAX;
+            if (distances) distances[i] = INFINITY;
+        }
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ANN_SEARCH, index->dim * sizeof(float));
+    scratch_free(&s);
+    return found;
+}
+
+typedef struct {
+    const ann_index_t* index;
+    const struct ggml_tensor* queries;
+    const ggml_type_traits_t* traits;
+    size_t k;
+    size_t ef;
+    uint32_t* ids;
+    float* distances;
+    _Atomic int failed;
+} ann_batch_t;
+
+// One scratch per chunk, reused across its queries
+static void search_batch_range(int64_t begin, int64_t end, void* arg) {
+    ann_batch_t* job = arg;
+    const ann_index_t* index = job->index;
+    ann_scratch_t s = { 0 };
+    float* row = malloc(index->dim * sizeof(float));
+    if (!row || scratch_reserve(&s, index->count, search_beam(job->k, job->ef), index->dim) != 0) {
+        atomic_store_explicit(&job->failed, 1, memory_order_relaxed);
+        begin = end;
+    }
+    for (int64_t q = begin; q < end; q++) {
+        job->traits->to_f32(ggml_get_row(job->queries, q), row, (int64_t)index->dim);
+        prepare_vector(index, s.query, row);
+        search_prepared(index, &s, s.query, job->k, job->ef, job->ids + (size_t)q * job->k,
+                        job->distances ? job->distances + (size_t)q * job->k : NULL);
+    }
+    free(row);
+    scratch_free(&s);
+}
+
+int ann_index_search_batch(const ann_index_t* index, const struct ggml_tensor* queries,
+                           size_t k, size_t ef, uint32_t* ids, float* distances) {
+    if (!index || !queries || !queries->data || !ids || (size_t)queries->ne[1] != index->dim) {
+        return -1;
+    }
+    const ggml_type_traits_t* traits = ggml_get_type_traits(queries->type);
+    if (!traits || !traits->to_f32) return -1;
+
+    int64_t n = ggml_nrows(queries);
+    ann_batch_t job = { index, queries, traits, k, ef, ids, distances, 0 };
+    STATS_SPAN_BEGIN(span);
+    // A query costs about ef * m distance evaluations
+    int64_t cost = (int64_t)(search_beam(k, ef) * index->m * index->dim);
+    parallel_for(n, parallel_grain(cost), search_batch_range, &job);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ANN_SEARCH, (size_t)n * index->dim * sizeof(float));
+    return atomic_load(&job.failed) ? -1 : 0;
+}
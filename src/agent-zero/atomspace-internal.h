@@ -0,0 +1,124 @@
+// Agent-Zero mock AtomSpace internals
+// /src/agent-zero/atomspace-internal.h
+//
+// Shared by the AtomSpace implementation and the tensor bridge. Not
+// installed; callers outside the library use the opaque AtomSpace from
+// opencog-ggml-bridge.h.
+
+#ifndef ATOMSPACE_INTERNAL_H
+#define ATOMSPACE_INTERNAL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "cognitive-internal.h"
+#include "opencog-ggml-bridge.h"
+
+#define ATOMSPACE_NO_NAME UINT32_MAX
+#define ATOMSPACE_UNBOUND UINT32_MAX
+
+// Growable list of atom or name ids
+typedef struct {
+    uint32_t* items;
+    size_t count;
+    size_t capacity;
+} atom_id_list_t;
+
+// Reader snapshot of the activation and liveness columns, one allocation
+// with the arrays behind the header. Entries below count never change
+// while the view is published: appends write past count and then raise it,
+// and any other change goes to a fresh copy that replaces the view.
+typedef struct {
+    _Atomic size_t count;
+    _Atomic size_t live_count;
+    size_t capacity;
+    float* activation;
+    uint8_t* live;
+    epoch_node_t retired;
+} atomspace_view_t;
+
+// Atoms are stored column-wise (structure of arrays), indexed by handle, so
+// scans over one attribute touch only that attribute's memory. Retired
+// atoms keep their handle (and read as 0 in activation) so a later revival
+// restores the same identity; they are absent from every index.
+//
+// Writers (add, clear, apply) serialize on write_lock. Readers of the
+// activation and liveness columns take the published view inside an epoch
+// section and never block; the index and name lookups still need the
+// writer excluded.
+struct AtomSpace {
+    int* type;
+    int* id;
+    double* mean;
+    double* confidence;
+    float* activation;         // (float)mean, the f32 tensor view of the means
+    uint32_t* name_id;         // ATOMSPACE_NO_NAME for unnamed atoms
+    uint8_t* live;             // 0 once retired; the handle stays reserved
+    size_t count;              // handles in use, live or retired
+    size_t capacity;
+    size_t live_count;
+
+    // activation and live alias the writer's view, which apply_activations
+    // keeps private until it is done
+    atomspace_view_t* view;
+    _Atomic(atomspace_view_t*) published;
+    epoch_list_t garbage;
+    atomspace_view_t* spare;   // a reclaimed view kept for the next copy
+    pthread_mutex_t write_lock;
+
+    // Per-type index: type_keys[t] owns the handles in type_atoms[t]
+    int* type_keys;
+    atom_id_list_t* type_atoms;
+    size_t type_count;
+    size_t type_capacity;
+
+    // Interned names (kept across atomspace_clear) with the handles that
+    // currently carry each name
+    char* name_pool;           // NUL-terminated names, back to back
+    size_t name_pool_used;
+    size_t name_pool_capacity;
+    size_t* name_offsets;      // name id -> offset in name_pool
+    atom_id_list_t* name_atoms;
+    size_t name_count;
+    size_t name_capacity;
+    uint32_t* name_slots;      // open addressing: name id + 1, 0 when empty
+    size_t name_slot_count;    // power of two
+
+    // Trigram -> name ids, for substring queries over the interned names
+    uint32_t* trigram_keys;    // trigram + 1, 0 when empty
+    atom_id_list_t* trigram_names;
+    size_t trigram_count;
+    size_t trigram_slot_count; // power of two
+
+    // Tensor element -> handle of the atom the delta decoder manages for it
+    uint32_t* binding;         // ATOMSPACE_UNBOUND until resolved
+    size_t binding_count;
+};
+
+// Lock-free read section: the returned view stays valid until the
+// matching atomspace_view_release()
+static inline const atomspace_view_t* atomspace_view_acquire(const AtomSpace* as) {
+    epoch_enter();
+    return atomic_load(&((AtomSpace*)as)->published);
+}
+
+static inline void atomspace_view_release(void) {
+    epoch_exit();
+}
+
+static inline size_t atomspace_view_count(const atomspace_view_t* view) {
+    return atomic_load_explicit(&((atomspace_view_t*)view)->count, memory_order_acquire);
+}
+
+static inline const char* atomspace_name_at(const AtomSpace* as, uint32_t name_id) {
+    return as->name_pool + as->name_offsets[name_id];
+}
+
+// Name of an atom, or NULL when it has none
+static inline const char* atomspace_atom_name(const AtomSpace* as, size_t atom) {
+    uint32_t name_id = as->name_id[atom];
+    return name_id == ATOMSPACE_NO_NAME ? NULL : atomspace_name_at(as, name_id);
+}
+
+#endif // ATOMSPACE_INTERNAL_H
@@ -0,0 +1,797 @@
+// Agent-Zero mock AtomSpace
+// /src/agent-zero/atomspace.c
+//
+// Growable column-wise atom table with three indexes kept up to date on
+// insert:
+// - type -> handles, so type queries cost the result size
+// - interned name hash -> handles; each distinct name is stored once
+// - trigram -> name ids over the interned names; a substring query
+//   intersects to the rarest trigram of the pattern and verifies only
+//   those candidate names
+// Names stay interned across atomspace_clear(), so decode loops that
+// recreate the same names do not re-hash or re-index them.
+//
+// Writers serialize on one lock. The activation and liveness columns are
+// also published as an immutable view, so encoders read them without
+// locking while agents add atoms: appends extend the view in place, and a
+// clear, a column growth or an activation batch builds a replacement that
+// is swapped in whole; the old view is freed once its readers are gone.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "cognitive-internal.h"
+#include "atomspace-internal.h"
+
+#define ATOMSPACE_INITIAL_CAPACITY 1024
+#define ATOMSPACE_INITIAL_SLOTS 256
+
+static int id_list_push(atom_id_list_t* list, uint32_t id) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 4;
+        uint32_t* grown = realloc(list->items, capacity * sizeof(uint32_t));
+        if (!grown) return -1;
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = id;
+    return 0;
+}
+
+// Grow two parallel arrays to hold at least needed entries
+static int grow_parallel(void** a, size_t a_size, void** b, size_t b_size,
+                         size_t* capacity, size_t needed) {
+    if (needed <= *capacity) return 0;
+    size_t new_capacity = *capacity ? *capacity * 2 : 8;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* grown_a = realloc(*a, new_capacity * a_size);
+    if (!grown_a) return -1;
+    *a = grown_a;
+    void* grown_b = realloc(*b, new_capacity * b_size);
+    if (!grown_b) return -1;
+    *b = grown_b;
+    // New list headers start empty
+    memset((char*)*b + *capacity * b_size, 0, (new_capacity - *capacity) * b_size);
+    *capacity = new_capacity;
+    return 0;
+}
+
+static uint64_t hash_name(const char* name) {
+    // FNV-1a
+    uint64_t h = 1469598103934665603ull;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t hash_trigram(uint32_t key) {
+    uint64_t h = key * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+
+static uint32_t trigram_at(const char* s) {
+    const unsigned char* p = (const unsigned char*)s;
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+// Type index
+
+static atom_id_list_t* type_list(const AtomSpace* as, int type) {
+    for (size_t t = 0; t < as->type_count; t++) {
+        if (as->type_keys[t] == type) return &as->type_atoms[t];
+    }
+    return NULL;
+}
+
+static atom_id_list_t* type_list_insert(AtomSpace* as, int type) {
+    atom_id_list_t* list = type_list(as, type);
+    if (list) return list;
+    if (grow_parallel((void**)&as->type_keys, sizeof(int),
+                      (void**)&as->type_atoms, sizeof(atom_id_list_t),
+                      &as->type_capacity, as->type_count + 1) != 0) {
+        return NULL;
+    }
+    as->type_keys[as->type_count] = type;
+    return &as->type_atoms[as->type_count++];
+}
+
+// Name table
+
+static int64_t find_name(const AtomSpace* as, const char* name) {
+    if (!as->name_slot_count) return -1;
+    size_t mask = as->name_slot_count - 1;
+    for (size_t slot = hash_name(name) & mask;; slot = (slot + 1) & mask) {
+        uint32_t entry = as->name_slots[slot];
+        if (!entry) return -1;
+        if (strcmp(atomspace_name_at(as, entry - 1), name) == 0) return entry - 1;
+    }
+}
+
+static int rehash_names(AtomSpace* as, size_t slot_count) {
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) return -1;
+    size_t mask = slot_count - 1;
+    for (size_t id = 0; id < as->name_count; id++) {
+        size_t slot = hash_name(atomspace_name_at(as, (uint32_t)id)) & mask;
+        while (slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = (uint32_t)id + 1;
+    }
+    free(as->name_slots);
+    as->name_slots = slots;
+    as->name_slot_count = slot_count;
+    return 0;
+}
+
+static atom_id_list_t* trigram_list_insert(AtomSpace* as, uint32_t trigram) {
+    if (2 * (as->trigram_count + 1) > as->trigram_slot_count) {
+        size_t slot_count = as->trigram_slot_count ? as->trigram_slot_count * 2 : ATOMSPACE_INITIAL_SLOTS;
+        uint32_t* keys = calloc(slot_count, sizeof(uint32_t));
+        atom_id_list_t* lists = calloc(slot_count, sizeof(atom_id_list_t));
+        if (!keys || !lists) {
+            free(keys);
+            free(lists);
+            return NULL;
+        }
+        for (size_t s = 0; s < as->trigram_slot_count; s++) {
+            if (!as->trigram_keys[s]) continue;
+            size_t slot = hash_trigram(as->trigram_keys[s] - 1) & (slot_count - 1);
+            while (keys[slot]) {
+                slot = (slot + 1) & (slot_count - 1);
+            }
+            keys[slot] = as->trigram_keys[s];
+            lists[slot] = as->trigram_names[s];
+        }
+        free(as->trigram_keys);
+        free(as->trigram_names);
+        as->trigram_keys = keys;
+        as->trigram_names = lists;
+        as->trigram_slot_count = slot_count;
+    }
+
+    size_t mask = as->trigram_slot_count - 1;
+    size_t slot = hash_trigram(trigram) & mask;
+    while (as->trigram_keys[slot] && as->trigram_keys[slot] != trigram + 1) {
+        slot = (slot + 1) & mask;
+    }
+    if (!as->trigram_keys[slot]) {
+        as->trigram_keys[slot] = trigram + 1;
+        as->trigram_count++;
+    }
+    return &as->trigram_names[slot];
+}
+
+static const atom_id_list_t* trigram_list(const AtomSpace* as, uint32_t trigram) {
+    if (!as->trigram_slot_count) return NULL;
+    size_t mask = as->trigram_slot_count - 1;
+    for (size_t slot = hash_trigram(trigram) & mask;; slot = (slot + 1) & mask) {
+        if (!as->trigram_keys[slot]) return NULL;
+        if (as->trigram_keys[slot] == trigram + 1) return &as->trigram_names[slot];
+    }
+}
+
+static int64_t intern_name(AtomSpace* as, const char* name) {
+    int64_t existing = find_name(as, name);
+    if (existing >= 0) return existing;
+    if (as->name_count >= UINT32_MAX - 1) return -1;
+
+    if (2 * (as->name_count + 1) > as->name_slot_count &&
+        rehash_names(as, as->name_slot_count ? as->name_slot_count * 2 : ATOMSPACE_INITIAL_SLOTS) != 0) {
+        return -1;
+    }
+    if (grow_parallel((void**)&as->name_offsets, sizeof(size_t),
+                      (void**)&as->name_atoms, sizeof(atom_id_list_t),
+                      &as->name_capacity, as->name_count + 1) != 0) {
+        return -1;
+    }
+
+    size_t len = strlen(name);
+    if (as->name_pool_used + len + 1 > as->name_pool_capacity) {
+        size_t capacity = as->name_pool_capacity ? as->name_pool_capacity * 2 : 4096;
+        while (capacity < as->name_pool_used + len + 1) {
+            capacity *= 2;
+        }
+        char* grown = realloc(as->name_pool, capacity);
+        if (!grown) return -1;
+        as->name_pool = grown;
+        as->name_pool_capacity = capacity;
+    }
+    size_t offset = as->name_pool_used;
+    const char* copy = as->name_pool + offset;
+    memcpy(as->name_pool + offset, name, len + 1);
+    uint32_t id = (uint32_t)as->name_count;
+
+    // Name ids are assigned in increasing order, so a trigram seen twice in
+    // one name is caught by comparing with the list tail
+    for (size_t i = 0; i + 3 <= len; i++) {
+        atom_id_list_t* list = trigram_list_insert(as, trigram_at(copy + i));
+        if (!list) return -1;
+        if ((!list->count || list->items[list->count - 1] != id) && id_list_push(list, id) != 0) {
+            return -1;
+        }
+    }
+
+    as->name_pool_used += len + 1;
+    as->name_offsets[id] = offset;
+    as->name_count++;
+    size_t mask = as->name_slot_count - 1;
+    size_t slot = hash_name(copy) & mask;
+    while (as->name_slots[slot]) {
+        slot = (slot + 1) & mask;
+    }
+    as->name_slots[slot] = id + 1;
+    return id;
+}
+
+// Reader views
+
+// View with room for capacity entries, holding the first count of src.
+// Activation batches replace the view every call, so one reclaimed view of
+// the current capacity is reused rather than allocated and faulted in again.
+static atomspace_view_t* view_create(AtomSpace* as, size_t capacity,
+                                     const atomspace_view_t* src, size_t count) {
+    atomspace_view_t* view = as->spare;
+    if (view && view->capacity == capacity) {
+        as->spare = NULL;
+    } else {
+        view = malloc(sizeof(atomspace_view_t) + capacity * (sizeof(float) + sizeof(uint8_t)));
+        if (!view) return NULL;
+    }
+    view->capacity = capacity;
+    view->activation = (float*)(view + 1);
+    view->live = (uint8_t*)(view->activation + capacity);
+    if (count) {
+        memcpy(view->activation, src->activation, count * sizeof(float));
+        memcpy(view->live, src->live, count);
+    }
+    atomic_init(&view->count, count);
+    atomic_init(&view->live_count, 0);
+    return view;
+}
+
+// Retired views no reader can see any more; runs on the writer
+static void view_reclaim(void* ptr, void* user) {
+    AtomSpace* as = user;
+    atomspace_view_t* view = ptr;
+    if (!as->spare && view->capacity == as->capacity) {
+        as->spare = view;
+    } else {
+        free(view);
+    }
+}
+
+// Hand the writer a new view. The old one is retired after the next
+// publish if readers have it, or freed now if they never did.
+static void view_adopt(AtomSpace* as, atomspace_view_t* view) {
+    atomspace_view_t* old = as->view;
+    if (old && old == atomic_load_explicit(&as->published, memory_order_relaxed)) {
+        epoch_stage(&as->garbage, &old->retired, old);
+    } else {
+        free(old);
+    }
+    as->view = view;
+    as->activation = view->activation;
+    as->live = view->live;
+}
+
+// Show readers the writer's view with the current counts
+static void view_publish(AtomSpace* as) {
+    atomic_store_explicit(&as->view->live_count, as->live_count, memory_order_relaxed);
+    atomic_store_explicit(&as->view->count, as->count, memory_order_release);
+    if (atomic_load_explicit(&as->published, memory_order_relaxed) != as->view) {
+        atomic_store(&as->published, as->view);
+    }
+    if (as->garbage.staged || as->garbage.retired) epoch_retire(&as->garbage);
+}
+
+// AtomSpace
+
+// Resize every atom column to capacity entries
+static int resize_columns(AtomSpace* as, size_t capacity) {
+    // The lock-free columns move to a new view instead of being reallocated
+    atomspace_view_t* view = view_create(as, capacity, as->view, as->count);
+    if (!view) return -1;
+    void** columns[] = {
+        (void**)&as->type, (void**)&as->id, (void**)&as->mean,
+        (void**)&as->confidence, (void**)&as->name_id,
+    };
+    const size_t sizes[] = {
+        sizeof(int), sizeof(int), sizeof(double),
+        sizeof(double), sizeof(uint32_t),
+    };
+    for (size_t c = 0; c < sizeof(sizes) / sizeof(sizes[0]); c++) {
+        void* grown = realloc(*columns[c], capacity * sizes[c]);
+        if (!grown) {
+            free(view);
+            return -1;
+        }
+        *columns[c] = grown;
+    }
+    view_adopt(as, view);
+    as->capacity = capacity;
+    return 0;
+}
+
+AtomSpace* create_atomspace(void) {
+    AtomSpace* as = calloc(1, sizeof(AtomSpace));
+    if (!as) return NULL;
+    pthread_mutex_init(&as->write_lock, NULL);
+    as->garbage.reclaim = view_reclaim;
+    as->garbage.reclaim_user = as;
+    if (resize_columns(as, ATOMSPACE_INITIAL_CAPACITY) != 0) {
+        destroy_atomspace(as);
+        return NULL;
+    }
+    view_publish(as);
+    return as;
+}
+
+void atomspace_clear(AtomSpace* as) {
+    if (!as) return;
+    pthread_mutex_lock(&as->write_lock);
+    // Readers may still be walking the old entries, so new atoms go to a
+    // fresh view; failing that, the old one is reused once they are gone
+    atomspace_view_t* view = view_create(as, as->capacity, NULL, 0);
+    if (view) view_adopt(as, view);
+    as->count = 0;
+    as->live_count = 0;
+    as->binding_count = 0;
+    for (size_t t = 0; t < as->type_count; t++) {
+        as->type_atoms[t].count = 0;
+    }
+    for (size_t n = 0; n < as->name_count; n++) {
+        as->name_atoms[n].count = 0;
+    }
+    view_publish(as);
+    if (!view) epoch_synchronize();
+    pthread_mutex_unlock(&as->write_lock);
+}
+
+void destroy_atomspace(AtomSpace* as) {
+    if (as) {
+        epoch_drain(&as->garbage);
+        free(as->view);
+        free(as->spare);
+        pthread_mutex_destroy(&as->write_lock);
+        free(as->type);
+        free(as->id);
+        free(as->mean);
+        free(as->confidence);
+        free(as->name_id);
+        free(as->binding);
+        for (size_t t = 0; t < as->type_count; t++) {
+            free(as->type_atoms[t].items);
+        }
+        free(as->type_keys);
+        free(as->type_atoms);
+        for (size_t n = 0; n < as->name_count; n++) {
+            free(as->name_atoms[n].items);
+        }
+        free(as->name_pool);
+        free(as->name_offsets);
+        free(as->name_atoms);
+        free(as->name_slots);
+        for (size_t s = 0; s < as->trigram_slot_count; s++) {
+            free(as->trigram_names[s].items);
+        }
+        free(as->trigram_keys);
+        free(as->trigram_names);
+        free(as);
+    }
+}
+
+// Append without publishing; the caller holds write_lock
+static int64_t add_atom_locked(AtomSpace* as, int type, const char* name,
+                               double mean, double confidence) {
+    if (as->count >= UINT32_MAX) return -1;
+
+    if (as->count == as->capacity && resize_columns(as, as->capacity * 2) != 0) {
+        return -1;
+    }
+
+    uint32_t handle = (uint32_t)as->count;
+    uint32_t name_id = ATOMSPACE_NO_NAME;
+    if (name) {
+        int64_t id = intern_name(as, name);
+        if (id < 0 || id_list_push(&as->name_atoms[id], handle) != 0) return -1;
+        name_id = (uint32_t)id;
+    }
+
+    atom_id_list_t* by_type = type_list_insert(as, type);
+    if (!by_type || id_list_push(by_type, handle) != 0) {
+        if (name) as->name_atoms[name_id].count--;
+        return -1;
+    }
+
+    as->type[handle] = type;
+    as->id[handle] = rand() % 10000;
+    as->mean[handle] = mean;
+    as->confidence[handle] = confidence;
+    as->activation[handle] = (float)mean;
+    as->name_id[handle] = name_id;
+    as->live[handle] = 1;
+    as->count++;
+    as->live_count++;
+    return handle;
+}
+
+int64_t atomspace_add_atom(AtomSpace* as, int type, const char* name,
+                           double mean, double confidence) {
+    if (!as) return -1;
+    pthread_mutex_lock(&as->write_lock);
+    int64_t handle = add_atom_locked(as, type, name, mean, confidence);
+    if (handle >= 0) view_publish(as);
+    pthread_mutex_unlock(&as->write_lock);
+    return handle;
+}
+
+void atomspace_read_begin(const AtomSpace* as) {
+    (void)as;
+    epoch_enter();
+}
+
+void atomspace_read_end(const AtomSpace* as) {
+    (void)as;
+    epoch_exit();
+}
+
+size_t atomspace_size(const AtomSpace* as) {
+    if (!as) return 0;
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t live = atomic_load_explicit(&((atomspace_view_t*)view)->live_count, memory_order_relaxed);
+    atomspace_view_release();
+    return live;
+}
+
+size_t atomspace_atoms_by_type(const AtomSpace* as, int type, const uint32_t** atoms) {
+    const atom_id_list_t* list = as ? type_list(as, type) : NULL;
+    *atoms = list ? list->items : NULL;
+    return list ? list->count : 0;
+}
+
+size_t atomspace_atoms_by_name(const AtomSpace* as, const char* name, const uint32_t** atoms) {
+    int64_t id = (as && name) ? find_name(as, name) : -1;
+    *atoms = id >= 0 ? as->name_atoms[id].items : NULL;
+    return id >= 0 ? as->name_atoms[id].count : 0;
+}
+
+static size_t visit_name(const AtomSpace* as, uint32_t name_id,
+                         atomspace_visit_fn visit, void* user) {
+    const atom_id_list_t* list = &as->name_atoms[name_id];
+    for (size_t i = 0; i < list->count; i++) {
+        visit(list->items[i], user);
+    }
+    return list->count;
+}
+
+static size_t match_name_locked(const AtomSpace* as, const char* substring,
+                                atomspace_visit_fn visit, void* user) {
+    size_t len = strlen(substring);
+    size_t visited = 0;
+    if (len < 3) {
+        // Too short for the trigram index; scan distinct names only
+        for (size_t n = 0; n < as->name_count; n++) {
+            if (strstr(atomspace_name_at(as, (uint32_t)n), substring)) {
+                visited += visit_name(as, (uint32_t)n, visit, user);
+            }
+        }
+        return visited;
+    }
+
+    // Every matching name contains all of the pattern's trigrams; the
+    // rarest one bounds the candidates
+    const atom_id_list_t* rarest = NULL;
+    for (size_t i = 0; i + 3 <= len; i++) {
+        const atom_id_list_t* list = trigram_list(as, trigram_at(substring + i));
+        if (!list) return 0;
+        if (!rarest || list->count < rarest->count) rarest = list;
+    }
+    for (size_t c = 0; c < rarest->count; c++) {
+        uint32_t n = rarest->items[c];
+        // Ids left behind by a failed intern point past the table
+        if (n < as->name_count && strstr(atomspace_name_at(as, n), substring)) {
+            visited += visit_name(as, n, visit, user);
+        }
+    }
+    return visited;
+}
+
+size_t atomspace_match_name(const AtomSpace* as, const char* substring,
+                            atomspace_visit_fn visit, void* user) {
+    if (!as || !substring || !visit) return 0;
+    pthread_mutex_t* lock = &((AtomSpace*)as)->write_lock;
+    pthread_mutex_lock(lock);
+    size_t visited = match_name_locked(as, substring, visit, user);
+    pthread_mutex_unlock(lock);
+    return visited;
+}
+
+void atomspace_cursor_init(atomspace_cursor_t* cursor, const AtomSpace* as, int type) {
+    cursor->as = as;
+    cursor->type = type;
+    cursor->position = 0;
+}
+
+size_t atomspace_cursor_next(atomspace_cursor_t* cursor, uint32_t* handles,
+                             float* activations, size_t max) {
+    const AtomSpace* as = cursor->as;
+    if (!as) return 0;
+
+    // Untyped walks read the published view alone; typed walks need the
+    // index, so they hold off writers and re-resolve it each call (added
+    // atoms may have moved it, but they only ever append). A typed walk
+    // never enters a read section: clear may wait for those while holding
+    // the lock.
+    pthread_mutex_t* lock = &((AtomSpace*)as)->write_lock;
+    const atomspace_view_t* view = NULL;
+    const uint32_t* items = NULL;
+    size_t available;
+    if (cursor->type >= 0) {
+        pthread_mutex_lock(lock);
+        const atom_id_list_t* list = type_list(as, cursor->type);
+        items = list ? list->items : NULL;
+        available = list ? list->count : 0;
+    } else {
+        view = atomspace_view_acquire(as);
+        available = atomspace_view_count(view);
+    }
+
+    size_t n = cursor->position < available ? available - cursor->position : 0;
+    if (n > max) n = max;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t handle = view ? (uint32_t)(cursor->position + i) : items[cursor->position + i];
+        if (handles) handles[i] = handle;
+        if (activations) activations[i] = view ? view->activation[handle] : as->activation[handle];
+    }
+    cursor->position += n;
+    if (view) {
+        atomspace_view_release();
+    } else {
+        pthread_mutex_unlock(lock);
+    }
+    return n;
+}
+
+const float* atomspace_activations(const AtomSpace* as) {
+    if (!as) return NULL;
+    const float* activation = atomspace_view_acquire(as)->activation;
+    atomspace_view_release();
+    return activation;
+}
+
+struct ggml_tensor* atomspace_activation_tensor(struct ggml_context* ctx, AtomSpace* as) {
+    if (!as) return NULL;
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t count = atomspace_view_count(view);
+    struct ggml_tensor* tensor = NULL;
+    if (count > 0 && count <= INT32_MAX) {
+        int ne = (int)count;
+        tensor = ggml_tensor_wrap(ctx, GGML_TYPE_F32, 1, &ne, view->activation);
+    }
+    atomspace_view_release();
+    return tensor;
+}
+
+// Delta decoding
+
+atomspace_delta_t* create_atomspace_delta(void) {
+    return calloc(1, sizeof(atomspace_delta_t));
+}
+
+void destroy_atomspace_delta(atomspace_delta_t* delta) {
+    if (delta) {
+        free(delta->updated);
+        free(delta->created);
+        free(delta->retired);
+        free(delta->revived);
+        free(delta->scratch);
+        free(delta);
+    }
+}
+
+static int delta_push(uint32_t** items, size_t* count, size_t* capacity, uint32_t id) {
+    atom_id_list_t list = { *items, *count, *capacity };
+    int status = id_list_push(&list, id);
+    *items = list.items;
+    *count = list.count;
+    *capacity = list.capacity;
+    return status;
+}
+
+static int compare_handles(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Drop the ascending ids[0..n) from an ascending list
+static void id_list_remove_sorted(atom_id_list_t* list, const uint32_t* ids, size_t n) {
+    size_t out = 0, k = 0;
+    for (size_t i = 0; i < list->count; i++) {
+        while (k < n && ids[k] < list->items[i]) k++;
+        if (k < n && ids[k] == list->items[i]) continue;
+        list->items[out++] = list->items[i];
+    }
+    list->count = out;
+}
+
+// Merge the ascending ids[0..n) into an ascending list, back to front
+static int id_list_insert_sorted(atom_id_list_t* list, const uint32_t* ids, size_t n) {
+    if (list->count + n > list->capacity) {
+        size_t capacity = list->capacity ? list->capacity : 4;
+        while (capacity < list->count + n) {
+            capacity *= 2;
+        }
+        uint32_t* grown = realloc(list->items, capacity * sizeof(uint32_t));
+        if (!grown) return -1;
+        list->items = grown;
+        list->capacity = capacity;
+    }
+    size_t i = list->count, k = n, out = list->count + n;
+    while (k > 0) {
+        if (i > 0 && list->items[i - 1] > ids[k - 1]) {
+            list->items[--out] = list->items[--i];
+        } else {
+            list->items[--out] = ids[--k];
+        }
+    }
+    list->count += n;
+    return 0;
+}
+
+// Apply a batch of liveness changes to one type's index; handles are
+// ascending, so each type list is rewritten in a single merge pass
+static int reindex_type(AtomSpace* as, size_t t, const uint32_t* handles, size_t n,
+                        uint32_t* scratch, int insert) {
+    size_t m = 0;
+    for (size_t k = 0; k < n; k++) {
+        if (as->type[handles[k]] == as->type_keys[t]) scratch[m++] = handles[k];
+    }
+    if (!m) return 0;
+    if (insert) return id_list_insert_sorted(&as->type_atoms[t], scratch, m);
+    id_list_remove_sorted(&as->type_atoms[t], scratch, m);
+    return 0;
+}
+
+static int reindex_liveness(AtomSpace* as, atomspace_delta_t* delta,
+                            const uint32_t* handles, size_t n, int insert) {
+    if (!n) return 0;
+    for (size_t k = 0; k < n; k++) {
+        uint32_t name_id = as->name_id[handles[k]];
+        if (name_id == ATOMSPACE_NO_NAME) continue;
+        if (insert) {
+            if (id_list_insert_sorted(&as->name_atoms[name_id], &handles[k], 1) != 0) return -1;
+        } else {
+            id_list_remove_sorted(&as->name_atoms[name_id], &handles[k], 1);
+        }
+    }
+    for (size_t t = 0; t < as->type_count; t++) {
+        if (reindex_type(as, t, handles, n, delta->scratch, insert) != 0) return -1;
+    }
+    return 0;
+}
+
+static int bind_elements(AtomSpace* as, size_t n) {
+    if (n <= as->binding_count) return 0;
+    uint32_t* grown = realloc(as->binding, n * sizeof(uint32_t));
+    if (!grown) return -1;
+    as->binding = grown;
+    for (size_t i = as->binding_count; i < n; i++) {
+        as->binding[i] = ATOMSPACE_UNBOUND;
+    }
+    as->binding_count = n;
+    return 0;
+}
+
+static int apply_activations_locked(AtomSpace* as, const float* values, size_t n,
+                                    float scale, float threshold, atomspace_delta_t* delta) {
+    STATS_SPAN_BEGIN(span);
+    delta->updated_count = 0;
+    delta->created_count = 0;
+    delta->retired_count = 0;
+    delta->revived_count = 0;
+    if (bind_elements(as, n) != 0) return -1;
+
+    for (size_t i = 0; i < n; i++) {
+        float value = values[i] * scale;
+        int significant = value > threshold;
+        uint32_t handle = as->binding[i];
+
+        if (handle == ATOMSPACE_UNBOUND) {
+            if (!significant) continue;
+            // Adopt an atom a full decode already created for this element
+            char name[64];
+            snprintf(name, sizeof(name), "concept_%zu", i);
+            const uint32_t* named;
+            if (atomspace_atoms_by_name(as, name, &named) > 0) {
+                handle = named[0];
+                as->binding[i] = handle;
+            } else {
+                int64_t created = add_atom_locked(as, ATOM_TYPE_CONCEPT, name, value, 0.8);
+                if (created < 0) return -1;
+                as->binding[i] = (uint32_t)created;
+                if (delta_push(&delta->created, &delta->created_count,
+                               &delta->created_capacity, (uint32_t)created) != 0) {
+                    return -1;
+                }
+                continue;
+            }
+        }
+
+        if (!as->live[handle]) {
+            if (!significant) continue;
+            as->live[handle] = 1;
+            as->live_count++;
+            as->mean[handle] = value;
+            as->activation[handle] = value;
+            if (delta_push(&delta->created, &delta->created_count,
+                           &delta->created_capacity, handle) != 0 ||
+                delta_push(&delta->revived, &delta->revived_count,
+                           &delta->revived_capacity, handle) != 0) {
+                return -1;
+            }
+        } else if (!significant) {
+            as->live[handle] = 0;
+            as->live_count--;
+            as->activation[handle] = 0.0f;
+            if (delta_push(&delta->retired, &delta->retired_count,
+                           &delta->retired_capacity, handle) != 0) {
+                return -1;
+            }
+        } else if (as->activation[handle] != value) {
+            as->mean[handle] = value;
+            as->activation[handle] = value;
+            if (delta_push(&delta->updated, &delta->updated_count,
+                           &delta->updated_capacity, handle) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    // Fresh atoms were indexed on insert; retirements and revivals are
+    // folded into the indexes in one pass per list
+    size_t changes = delta->retired_count > delta->revived_count ?
+                     delta->retired_count : delta->revived_count;
+    if (changes > delta->scratch_capacity) {
+        uint32_t* grown = realloc(delta->scratch, changes * sizeof(uint32_t));
+        if (!grown) return -1;
+        delta->scratch = grown;
+        delta->scratch_capacity = changes;
+    }
+    if (delta->retired_count) {
+        qsort(delta->retired, delta->retired_count, sizeof(uint32_t), compare_handles);
+    }
+    if (delta->revived_count) {
+        // Revived handles sit among the fresh ones in element order
+        qsort(delta->revived, delta->revived_count, sizeof(uint32_t), compare_handles);
+        qsort(delta->created, delta->created_count, sizeof(uint32_t), compare_handles);
+    }
+    if (reindex_liveness(as, delta, delta->retired, delta->retired_count, 0) != 0 ||
+        reindex_liveness(as, delta, delta->revived, delta->revived_count, 1) != 0) {
+        return -1;
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_DECODE, n * sizeof(float));
+    return 0;
+}
+
+int atomspace_apply_activations(AtomSpace* as, const float* values, size_t n,
+                                float scale, float threshold, atomspace_delta_t* delta) {
+    if (!as || (!values && n) || !delta) return -1;
+    pthread_mutex_lock(&as->write_lock);
+    // Updates and retirements rewrite published entries, so the batch goes
+    // to a private copy that replaces the view when it is done
+    atomspace_view_t* view = view_create(as, as->capacity, as->view, as->count);
+    int status = -1;
+    if (view) {
+        view_adopt(as, view);
+        status = apply_activations_locked(as, values, n, scale, threshold, delta);
+        view_publish(as);
+    }
+    pthread_mutex_unlock(&as->write_lock);
+    return status;
+}
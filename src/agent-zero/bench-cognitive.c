@@ -0,0 +1,906 @@
+// Agent-Zero Microbenchmarks
+// /src/agent-zero/bench-cognitive.c
+//
+// Google-Benchmark-style timing of the public tensor ops and the bridge:
+// every benchmark runs a loop that is grown until it takes --min-time,
+// after one untimed warm-up iteration, for each size and thread count.
+// Reports time per call, ns per element, GB/s over the bytes the op
+// touches, and heap allocations per call (counted by wrapping malloc at
+// link time where the linker supports it). --json writes the results in
+// Google Benchmark's JSON layout, which CogUtil::PerformanceRegression
+// imports for the regression gate.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "cognitive.h"
+#include "opencog-ggml-bridge.h"
+
+#define BENCH_MAX_SIZES 4
+#define BENCH_MAX_THREADS 16
+#define BENCH_MAX_ITERATIONS 1000000000LL
+
+// ---------------------------------------------------------------------------
+// Allocation counting
+
+static atomic_llong alloc_count;
+static atomic_llong alloc_bytes;
+
+#ifdef BENCH_COUNT_ALLOCS
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real_aligned_alloc(size_t align, size_t size);
+
+static void count_alloc(size_t size) {
+    atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&alloc_bytes, (long long)size, memory_order_relaxed);
+}
+
+void* __wrap_malloc(size_t size) {
+    count_alloc(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    count_alloc(n * size);
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    count_alloc(size);
+    return __real_realloc(ptr, size);
+}
+
+void* __wrap_aligned_alloc(size_t align, size_t size) {
+    count_alloc(size);
+    return __real_aligned_alloc(align, size);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Harness
+
+typedef struct {
+    int64_t size;           // benchmark argument
+    int threads;
+    int64_t elements;       // per iteration, set by the benchmark
+    int64_t bytes;          // bytes read + written per iteration
+    const char* error;      // set when setup fails; the run is skipped
+
+    // Loop state
+    int64_t target;
+    int64_t done;
+    int warmup;
+    double start_wall, start_cpu;
+    long long start_allocs, start_alloc_bytes;
+
+    // Results of the final batch
+    int64_t iterations;
+    double wall;
+    double cpu;
+    long long allocs;
+    long long alloced;
+} bench_state_t;
+
+typedef void (*bench_fn)(bench_state_t* state);
+
+typedef struct {
+    const char* name;
+    bench_fn fn;
+    int64_t sizes[BENCH_MAX_SIZES];   // 0 terminated
+    int threaded;                     // runs once per thread count
+} bench_def_t;
+
+static double min_time = 0.2;
+
+static double clock_seconds(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void batch_start(bench_state_t* s) {
+    s->done = 0;
+    s->start_allocs = atomic_load(&alloc_count);
+    s->start_alloc_bytes = atomic_load(&alloc_bytes);
+    s->start_cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+    s->start_wall = clock_seconds(CLOCK_MONOTONIC);
+}
+
+// Loop condition: while (bench_running(s)) { op; }. The first batch is
+// one warm-up iteration; later batches grow until one lasts min_time.
+static int bench_running(bench_state_t* s) {
+    if (s->target == 0) {
+        s->target = 1;
+        s->warmup = 1;
+        batch_start(s);
+    }
+    if (s->done < s->target) {
+        s->done++;
+        return 1;
+    }
+
+    double wall = clock_seconds(CLOCK_MONOTONIC) - s->start_wall;
+    if (!s->warmup && (wall >= min_time || s->target >= BENCH_MAX_ITERATIONS)) {
+        s->iterations = s->target;
+        s->wall = wall;
+        s->cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - s->start_cpu;
+        s->allocs = atomic_load(&alloc_count) - s->start_allocs;
+        s->alloced = atomic_load(&alloc_bytes) - s->start_alloc_bytes;
+        return 0;
+    }
+
+    // Aim 40% past min_time, growing at least 2x and at most 100x
+    double factor = wall > 0.0 ? min_time * 1.4 / wall : 100.0;
+    if (factor < 2.0) factor = 2.0;
+    if (factor > 100.0) factor = 100.0;
+    s->target = s->warmup ? 1 : (int64_t)((double)s->target * factor);
+    if (s->target > BENCH_MAX_ITERATIONS) s->target = BENCH_MAX_ITERATIONS;
+    s->warmup = 0;
+    batch_start(s);
+    s->done = 1;
+    return 1;
+}
+
+static void consume(const void* p) {
+    __asm__ volatile("" : : "r"(p) : "memory");
+}
+
+static uint32_t rng_state = 12345;
+
+static float random_unit(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)(rng_state >> 8) / 16777216.0f;
+}
+
+static void fill_random(struct ggml_tensor* t) {
+    float* data = ggml_get_data_f32(t);
+    for (int64_t i = 0; i < ggml_nelements(t); i++) {
+        data[i] = random_unit();
+    }
+}
+
+// size elements as rows of 1024 (or one row for small sizes)
+static struct ggml_tensor* new_field(int64_t size) {
+    int cols = size >= 1024 ? 1024 : (int)size;
+    struct ggml_tensor* t = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, (int)(size / cols), cols);
+    if (t) fill_random(t);
+    return t;
+}
+
+static AtomSpace* new_atomspace(int64_t atoms) {
+    AtomSpace* as = create_atomspace();
+    for (int64_t i = 0; as && i < atoms; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, random_unit(), 0.9);
+    }
+    return as;
+}
+
+// ---------------------------------------------------------------------------
+// Elementwise ops
+
+static void bench_attention_matrix(bench_state_t* s) {
+    struct ggml_tensor* input = new_field(s->size);
+    if (!input) { s->error = "allocation failed"; return; }
+    s->elements = s->size;
+    s->bytes = s->size * 2 * (int64_t)sizeof(float);
+    while (bench_running(s)) {
+        struct ggml_tensor* out = cognitive_attention_matrix(NULL, input, 0.8f);
+        consume(out);
+        ggml_free_tensor(out);
+    }
+    ggml_free_tensor(input);
+}
+
+static void bench_attention_matrix_into(bench_state_t* s) {
+    struct ggml_tensor* input = new_field(s->size);
+    struct ggml_tensor* out = new_field(s->size);
+    if (!input || !out) {
+        s->error = "allocation failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * 2 * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            cognitive_attention_matrix_into(out, input, 0.8f);
+            consume(ggml_get_data_f32(out));
+        }
+    }
+    ggml_free_tensor(input);
+    ggml_free_tensor(out);
+}
+
+static void bench_meta_transform(bench_state_t* s) {
+    struct ggml_tensor* input = new_field(s->size);
+    if (!input) { s->error = "allocation failed"; return; }
+    s->elements = s->size;
+    s->bytes = s->size * 2 * (int64_t)sizeof(float);
+    while (bench_running(s)) {
+        struct ggml_tensor* out = meta_cognitive_transform(NULL, input, 2);
+        consume(out);
+        ggml_free_tensor(out);
+    }
+    ggml_free_tensor(input);
+}
+
+static void bench_hypergraph_encoding(bench_state_t* s) {
+    struct ggml_tensor* nodes = new_field(s->size);
+    struct ggml_tensor* links = new_field(s->size);
+    if (!nodes || !links) {
+        s->error = "allocation failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * 3 * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            struct ggml_tensor* out = hypergraph_encoding(NULL, nodes, links);
+            consume(out);
+            ggml_free_tensor(out);
+        }
+    }
+    ggml_free_tensor(nodes);
+    ggml_free_tensor(links);
+}
+
+static void bench_attention_matrix_f16(bench_state_t* s) {
+    struct ggml_tensor* field = new_field(s->size);
+    struct ggml_tensor* input = field ? ggml_cast(NULL, field, GGML_TYPE_F16) : NULL;
+    if (!input) {
+        s->error = "allocation failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * 2 * (int64_t)sizeof(uint16_t);
+        while (bench_running(s)) {
+            struct ggml_tensor* out = cognitive_attention_matrix(NULL, input, 0.8f);
+            consume(out);
+            ggml_free_tensor(out);
+        }
+    }
+    ggml_free_tensor(field);
+    ggml_free_tensor(input);
+}
+
+// attention -> meta transform -> encoding with its input, one fused pass
+static void bench_graph_chain(bench_state_t* s) {
+    struct ggml_tensor* input = new_field(s->size);
+    struct ggml_tensor* output = new_field(s->size);
+    cognitive_graph_t* graph = create_cognitive_graph();
+    int in = graph ? cognitive_graph_input(graph, input) : -1;
+    int attended = cognitive_graph_attention(graph, in, 0.8f);
+    int meta = cognitive_graph_meta_transform(graph, attended, 2);
+    int encoded = cognitive_graph_hypergraph_encoding(graph, meta, in);
+    if (!input || !output || encoded < 0 || cognitive_graph_set_output(graph, encoded, output) != 0) {
+        s->error = "setup failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * 2 * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            cognitive_graph_compute(graph);
+            consume(ggml_get_data_f32(output));
+        }
+    }
+    destroy_cognitive_graph(graph);
+    ggml_free_tensor(input);
+    ggml_free_tensor(output);
+}
+
+static void bench_cast(bench_state_t* s, int type) {
+    struct ggml_tensor* field = new_field(s->size);
+    if (!field) { s->error = "allocation failed"; return; }
+    s->elements = s->size;
+    s->bytes = s->size * (int64_t)sizeof(float) + (int64_t)ggml_row_size(type, s->size);
+    while (bench_running(s)) {
+        struct ggml_tensor* out = ggml_cast(NULL, field, type);
+        consume(out);
+        ggml_free_tensor(out);
+    }
+    ggml_free_tensor(field);
+}
+
+static void bench_cast_f16(bench_state_t* s) {
+    bench_cast(s, GGML_TYPE_F16);
+}
+
+static void bench_cast_q8_0(bench_state_t* s) {
+    bench_cast(s, GGML_TYPE_Q8_0);
+}
+
+// ---------------------------------------------------------------------------
+// Pattern matching: 8 patterns of size x size against a 256 x 256 plane
+
+static void bench_pattern_match(bench_state_t* s, cognitive_match_backend_t backend) {
+    const int side = 256, n_patterns = 8;
+    struct ggml_tensor* data = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, side, side);
+    struct ggml_tensor* patterns = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, (int)s->size, (int)s->size,
+                                                      n_patterns);
+    if (!data || !patterns) {
+        s->error = "allocation failed";
+    } else {
+        fill_random(data);
+        fill_random(patterns);
+        s->elements = (int64_t)side * side * n_patterns;
+        s->bytes = (int64_t)side * side * (1 + n_patterns) * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            struct ggml_tensor* out = cognitive_pattern_match_batch(NULL, patterns, data, backend);
+            consume(out);
+            ggml_free_tensor(out);
+        }
+    }
+    ggml_free_tensor(data);
+    ggml_free_tensor(patterns);
+}
+
+static void bench_pattern_match_direct(bench_state_t* s) {
+    bench_pattern_match(s, COGNITIVE_MATCH_DIRECT);
+}
+
+static void bench_pattern_match_gemm(bench_state_t* s) {
+    bench_pattern_match(s, COGNITIVE_MATCH_GEMM);
+}
+
+static void bench_pattern_match_fft(bench_state_t* s) {
+    bench_pattern_match(s, COGNITIVE_MATCH_FFT);
+}
+
+// AUTO picks the unrolled per-shape kernels for these sizes
+static void bench_pattern_match_auto(bench_state_t* s) {
+    bench_pattern_match(s, COGNITIVE_MATCH_AUTO);
+}
+
+// ---------------------------------------------------------------------------
+// Bridge
+
+static void bench_atomspace_to_tensor(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    struct ggml_tensor* tensor = new_field(s->size);
+    if (!as || !tensor) {
+        s->error = "allocation failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * 2 * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            atomspace_to_tensor(as, tensor);
+            consume(ggml_get_data_f32(tensor));
+        }
+    }
+    ggml_free_tensor(tensor);
+    destroy_atomspace(as);
+}
+
+static void bench_encode_batch(bench_state_t* s) {
+    enum { N_KERNELS = 8 };
+    AtomSpace* as = new_atomspace(s->size);
+    cognitive_kernel_t* kernels[N_KERNELS];
+    struct ggml_tensor* outputs[N_KERNELS];
+    int shape[] = { (int)(s->size >= 1024 ? s->size / 1024 : 1), (int)(s->size >= 1024 ? 1024 : s->size) };
+    int ok = as != NULL;
+    for (int k = 0; k < N_KERNELS; k++) {
+        kernels[k] = create_cognitive_kernel(NULL, shape, 2, 0.1f * (float)(k + 1));
+        outputs[k] = kernels[k] ? kernels[k]->tensor_field : NULL;
+        ok = ok && kernels[k];
+    }
+    if (!ok) {
+        s->error = "allocation failed";
+    } else {
+        s->elements = s->size * N_KERNELS;
+        s->bytes = s->size * (1 + N_KERNELS) * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            encode_cognitive_state_batch(as, kernels, N_KERNELS, outputs);
+            consume(ggml_get_data_f32(outputs[0]));
+        }
+    }
+    for (int k = 0; k < N_KERNELS; k++) {
+        destroy_cognitive_kernel(kernels[k]);
+    }
+    destroy_atomspace(as);
+}
+
+// Alternates between two tensors differing in every other element, so
+// each call updates, creates and retires atoms
+static void bench_decode_delta(bench_state_t* s) {
+    AtomSpace* as = create_atomspace();
+    atomspace_delta_t* delta = create_atomspace_delta();
+    struct ggml_tensor* a = new_field(s->size);
+    struct ggml_tensor* b = new_field(s->size);
+    int shape[] = { 1, 1 };
+    cognitive_kernel_t* kernel = create_cognitive_kernel(NULL, shape, 2, 1.0f);
+    if (!as || !delta || !a || !b || !kernel) {
+        s->error = "allocation failed";
+    } else {
+        float* bd = ggml_get_data_f32(b);
+        for (int64_t i = 0; i < s->size; i += 2) {
+            bd[i] = 0.0f;
+        }
+        s->elements = s->size;
+        s->bytes = s->size * (int64_t)(sizeof(float) + sizeof(double) * 2);
+        int64_t call = 0;
+        while (bench_running(s)) {
+            decode_cognitive_state_delta(call++ & 1 ? b : a, kernel, as, delta);
+        }
+    }
+    destroy_cognitive_kernel(kernel);
+    ggml_free_tensor(a);
+    ggml_free_tensor(b);
+    destroy_atomspace_delta(delta);
+    destroy_atomspace(as);
+}
+
+static void bench_attention_tensor(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    if (!as) { s->error = "allocation failed"; return; }
+    s->elements = s->size * s->size;
+    s->bytes = s->elements * (int64_t)sizeof(float);
+    while (bench_running(s)) {
+        struct ggml_tensor* out = create_attention_tensor(NULL, as, 0.8f);
+        consume(out);
+        ggml_free_tensor(out);
+    }
+    destroy_atomspace(as);
+}
+
+// Attention fields are dense but only the diagonal clears 0.5
+static void bench_decode_attention_field(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    struct ggml_tensor* field = as ? create_attention_tensor(NULL, as, 0.8f) : NULL;
+    hypergraph_t* hg = create_hypergraph((size_t)s->size, (size_t)s->size);
+    if (!field || !hg) {
+        s->error = "setup failed";
+    } else {
+        s->elements = s->size * s->size;
+        s->bytes = s->elements * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            decode_tensor_to_hypergraph(field, hg);
+            consume(hg->node_weights);
+        }
+    }
+    destroy_hypergraph(hg);
+    ggml_free_tensor(field);
+    destroy_atomspace(as);
+}
+
+static void bench_attention_matvec(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    float* x = malloc((size_t)s->size * sizeof(float));
+    float* y = malloc((size_t)s->size * sizeof(float));
+    if (!as || !x || !y) {
+        s->error = "allocation failed";
+    } else {
+        for (int64_t i = 0; i < s->size; i++) {
+            x[i] = random_unit();
+        }
+        s->elements = s->size;
+        s->bytes = s->size * 3 * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            attention_matvec(as, 0.8f, x, y);
+            consume(y);
+        }
+    }
+    free(x);
+    free(y);
+    destroy_atomspace(as);
+}
+
+// About eight similarity edges per atom
+static void bench_similarity_hypergraph(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    if (!as) { s->error = "allocation failed"; return; }
+    float threshold = 4.0f / (float)s->size;
+    s->elements = s->size;
+    s->bytes = s->size * (int64_t)sizeof(float);
+    while (bench_running(s)) {
+        hypergraph_t* hg = create_hypergraph_from_atomspace(as, threshold, s->threads);
+        consume(hg);
+        destroy_hypergraph(hg);
+    }
+    destroy_atomspace(as);
+}
+
+static void bench_hypergraph_to_sparse(bench_state_t* s) {
+    AtomSpace* as = new_atomspace(s->size);
+    hypergraph_t* hg = as ? create_hypergraph_from_atomspace(as, 4.0f / (float)s->size, 1) : NULL;
+    if (!hg) {
+        s->error = "setup failed";
+    } else {
+        s->elements = (int64_t)hg->edge_offsets[hg->link_count];
+        s->bytes = s->elements * (int64_t)(sizeof(uint32_t) + sizeof(float));
+        while (bench_running(s)) {
+            sparse_tensor_t* sp = encode_hypergraph_to_sparse(hg);
+            consume(sp);
+            destroy_sparse_tensor(sp);
+        }
+    }
+    destroy_hypergraph(hg);
+    destroy_atomspace(as);
+}
+
+// Diffusion over the similarity hypergraph; the update bench moves 1% of
+// the atoms per step
+static void bench_diffusion(bench_state_t* s, int incremental) {
+    AtomSpace* as = new_atomspace(s->size);
+    hypergraph_t* hg = as ? create_hypergraph_from_atomspace(as, 4.0f / (float)s->size, 1) : NULL;
+    attention_diffusion_t* d = hg ? create_attention_diffusion(hg, 0.2f, 0.5f) : NULL;
+    float* sti = malloc((size_t)s->size * sizeof(float));
+    float* result = malloc((size_t)s->size * sizeof(float));
+    size_t n_changed = (size_t)(s->size / 100) + 1;
+    uint32_t* changed = malloc(n_changed * sizeof(uint32_t));
+    if (!d || !sti || !result || !changed) {
+        s->error = "setup failed";
+    } else {
+        for (int64_t i = 0; i < s->size; i++) {
+            sti[i] = (float)(i % 13) / 6.0f;
+        }
+        for (size_t c = 0; c < n_changed; c++) {
+            changed[c] = (uint32_t)((c * 7919) % (size_t)s->size);
+        }
+        attention_diffusion_compute(d, sti, result);
+        s->elements = incremental ? (int64_t)n_changed : s->size;
+        s->bytes = s->elements * (int64_t)(3 * sizeof(float));
+        float delta = 1.0f;
+        while (bench_running(s)) {
+            if (incremental) {
+                for (size_t c = 0; c < n_changed; c++) {
+                    sti[changed[c]] += delta;
+                }
+                delta = -delta;
+                attention_diffusion_update(d, sti, changed, n_changed, result);
+            } else {
+                attention_diffusion_compute(d, sti, result);
+            }
+            consume(result);
+        }
+    }
+    free(changed);
+    free(result);
+    free(sti);
+    destroy_attention_diffusion(d);
+    destroy_hypergraph(hg);
+    destroy_atomspace(as);
+}
+
+static void bench_diffusion_compute(bench_state_t* s) {
+    bench_diffusion(s, 0);
+}
+
+static void bench_diffusion_update(bench_state_t* s) {
+    bench_diffusion(s, 1);
+}
+
+// 64 top-10 queries per iteration against an index of size clustered rows
+#define ANN_BENCH_DIM 32
+#define ANN_BENCH_QUERIES 64
+
+static void bench_ann_search(bench_state_t* s) {
+    ann_index_t* index = create_ann_index(ANN_BENCH_DIM, ANN_L2, 16, 100, 1);
+    struct ggml_tensor* queries = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, ANN_BENCH_QUERIES, ANN_BENCH_DIM);
+    uint32_t* ids = malloc(ANN_BENCH_QUERIES * 10 * sizeof(uint32_t));
+    float row[ANN_BENCH_DIM];
+    uint64_t x = 88172645463325252ULL;
+    for (int64_t i = 0; index && i < s->size; i++) {
+        for (int d = 0; d < ANN_BENCH_DIM; d++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            row[d] = (float)((i % 64) * (d + 1) % 17) + (float)(x % 1000) / 500.0f;
+        }
+        if (ann_index_add(index, row) < 0) break;
+    }
+    if (!index || ann_index_size(index) != (size_t)s->size || !queries || !ids) {
+        s->error = "setup failed";
+    } else {
+        float* q = ggml_get_data_f32(queries);
+        for (int i = 0; i < ANN_BENCH_QUERIES * ANN_BENCH_DIM; i++) {
+            q[i] = (float)(i % 17) + 0.5f;
+        }
+        s->elements = ANN_BENCH_QUERIES;
+        s->bytes = ANN_BENCH_QUERIES * ANN_BENCH_DIM * (int64_t)sizeof(float);
+        while (bench_running(s)) {
+            ann_index_search_batch(index, queries, 10, 64, ids, NULL);
+            consume(ids);
+        }
+    }
+    free(ids);
+    ggml_free_tensor(queries);
+    destroy_ann_index(index);
+}
+
+// One frame per iteration of encode -> attention -> decode, back to back
+// on this thread or through the three-stage pipeline
+static void bench_frames(bench_state_t* s, int pipelined) {
+    AtomSpace* as = new_atomspace(s->size);
+    AtomSpace* sink = create_atomspace();
+    atomspace_delta_t* delta = create_atomspace_delta();
+    int shape[] = { (int)(s->size / 256), 256 };
+    cognitive_kernel_t* kernel = create_cognitive_kernel(NULL, shape, 2, 0.8f);
+    struct ggml_tensor* encoded = new_field(s->size);
+    struct ggml_tensor* computed = new_field(s->size);
+    cognitive_pipeline_config_t config = { kernel, NULL, NULL, sink, delta, NULL, NULL, 0 };
+    cognitive_pipeline_t* p = pipelined && kernel ? create_cognitive_pipeline(&config) : NULL;
+    if (!as || !sink || !delta || !kernel || !encoded || !computed || (pipelined && !p)) {
+        s->error = "setup failed";
+    } else {
+        s->elements = s->size;
+        s->bytes = s->size * (int64_t)(3 * sizeof(float));
+        while (bench_running(s)) {
+            if (pipelined) {
+                cognitive_pipeline_submit(p, as);
+            } else {
+                encode_cognitive_state(as, kernel, encoded);
+                cognitive_attention_matrix_into(computed, encoded, 0.8f);
+                decode_cognitive_state_delta(computed, kernel, sink, delta);
+            }
+        }
+        cognitive_pipeline_drain(p);
+    }
+    destroy_cognitive_pipeline(p);
+    ggml_free_tensor(computed);
+    ggml_free_tensor(encoded);
+    destroy_cognitive_kernel(kernel);
+    destroy_atomspace_delta(delta);
+    destroy_atomspace(sink);
+    destroy_atomspace(as);
+}
+
+static void bench_frames_serial(bench_state_t* s) {
+    bench_frames(s, 0);
+}
+
+static void bench_frames_pipelined(bench_state_t* s) {
+    bench_frames(s, 1);
+}
+
+// Lossless delta of a field 1% of whose cells move between messages
+static void bench_tensor_delta(bench_state_t* s) {
+    struct ggml_tensor* current = new_field(s->size);
+    struct ggml_tensor* base = new_field(s->size);
+    size_t bound = current ? tensor_delta_bound(current) : 0;
+    uint8_t* msg = bound ? malloc(bound) : NULL;
+    if (!base || !msg) {
+        s->error = "setup failed";
+    } else {
+        float* c = ggml_get_data_f32(current);
+        int64_t n_changed = s->size / 100 + 1;
+        tensor_delta_options_t key = { 0.0f, 1, 0 };
+        tensor_delta_encode(current, base, &key, msg, bound);
+        s->elements = s->size;
+        s->bytes = s->size * (int64_t)(2 * sizeof(float));
+        float delta = 0.125f;
+        while (bench_running(s)) {
+            for (int64_t k = 0; k < n_changed; k++) {
+                c[(k * 7919) % s->size] += delta;
+            }
+            delta = -delta;
+            tensor_delta_encode(current, base, NULL, msg, bound);
+            consume(msg);
+        }
+    }
+    free(msg);
+    ggml_free_tensor(base);
+    ggml_free_tensor(current);
+}
+
+#define ELEMENTWISE_SIZES { 1 << 12, 1 << 18, 1 << 22 }
+#define ATOM_SIZES { 1 << 10, 1 << 14, 1 << 18 }
+
+static const bench_def_t benchmarks[] = {
+    { "cognitive_attention_matrix",      bench_attention_matrix,      ELEMENTWISE_SIZES, 1 },
+    { "cognitive_attention_matrix_into", bench_attention_matrix_into, ELEMENTWISE_SIZES, 1 },
+    { "cognitive_attention_matrix_f16",  bench_attention_matrix_f16,  ELEMENTWISE_SIZES, 1 },
+    { "meta_cognitive_transform",        bench_meta_transform,        ELEMENTWISE_SIZES, 1 },
+    { "hypergraph_encoding",             bench_hypergraph_encoding,   ELEMENTWISE_SIZES, 1 },
+    { "cognitive_graph_chain",           bench_graph_chain,           ELEMENTWISE_SIZES, 1 },
+    { "ggml_cast_f16",                   bench_cast_f16,              ELEMENTWISE_SIZES, 0 },
+    { "ggml_cast_q8_0",                  bench_cast_q8_0,             ELEMENTWISE_SIZES, 0 },
+    { "pattern_match_direct",            bench_pattern_match_direct,  { 3, 5 },          1 },
+    { "pattern_match_gemm",              bench_pattern_match_gemm,    { 9, 17 },         1 },
+    { "pattern_match_fft",               bench_pattern_match_fft,     { 33, 65 },        1 },
+    { "pattern_match_specialized",       bench_pattern_match_auto,    { 3, 5, 7 },       1 },
+    { "atomspace_to_tensor",             bench_atomspace_to_tensor,   ATOM_SIZES,        0 },
+    { "encode_cognitive_state_batch",    bench_encode_batch,          ATOM_SIZES,        0 },
+    { "decode_cognitive_state_delta",    bench_decode_delta,          ATOM_SIZES,        0 },
+    { "create_attention_tensor",         bench_attention_tensor,      { 256, 1024, 2048 }, 1 },
+    { "decode_tensor_to_hypergraph",     bench_decode_attention_field, { 256, 1024, 2048 }, 1 },
+    { "attention_matvec",                bench_attention_matvec,      ATOM_SIZES,        0 },
+    { "create_hypergraph_from_atomspace", bench_similarity_hypergraph, ATOM_SIZES,       1 },
+    { "encode_hypergraph_to_sparse",     bench_hypergraph_to_sparse,  ATOM_SIZES,        0 },
+    { "attention_diffusion_compute",     bench_diffusion_compute,     ATOM_SIZES,        1 },
+    { "attention_diffusion_update",      bench_diffusion_update,      ATOM_SIZES,        1 },
+    { "encode_compute_decode_serial",    bench_frames_serial,         ATOM_SIZES,        0 },
+    { "cognitive_pipeline",              bench_frames_pipelined,      ATOM_SIZES,        0 },
+    { "tensor_delta_encode",             bench_tensor_delta,          ELEMENTWISE_SIZES, 0 },
+    { "ann_index_search_batch",          bench_ann_search,            { 1 << 10, 1 << 14, 1 << 16 }, 1 },
+};
+
+// ---------------------------------------------------------------------------
+// Reporting
+
+typedef struct {
+    char name[128];
+    bench_state_t state;
+} bench_result_t;
+
+static double ns_per_iteration(const bench_state_t* s, double seconds) {
+    return seconds * 1e9 / (double)s->iterations;
+}
+
+static void print_header(FILE* out) {
+    fprintf(out, "%-52s %14s %14s %11s %10s %9s %9s\n",
+           "Benchmark", "Time (ns)", "CPU (ns)", "Iterations", "ns/elem", "GB/s", "allocs");
+    for (int i = 0; i < 125; i++) fputc('-', out);
+    fputc('\n', out);
+}
+
+static void print_result(FILE* out, const bench_result_t* r) {
+    const bench_state_t* s = &r->state;
+    if (s->error) {
+        fprintf(out, "%-52s ERROR: %s\n", r->name, s->error);
+        return;
+    }
+    double ns = ns_per_iteration(s, s->wall);
+    fprintf(out, "%-52s %14.1f %14.1f %11lld %10.3f %9.2f ", r->name, ns, ns_per_iteration(s, s->cpu),
+           (long long)s->iterations, ns / (double)s->elements, (double)s->bytes / ns);
+#ifdef BENCH_COUNT_ALLOCS
+    fprintf(out, "%9.2f\n", (double)s->allocs / (double)s->iterations);
+#else
+    fprintf(out, "%9s\n", "n/a");
+#endif
+}
+
+static void write_json(FILE* out, const bench_result_t* results, size_t count) {
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(out, "{\n  \"context\": {\n");
+    fprintf(out, "    \"date\": \"%s\",\n", date);
+    fprintf(out, "    \"library\": \"agent-zero-cognitive\",\n");
+    fprintf(out, "    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(out, "    \"simd_backend\": \"%s\",\n", agent_zero_simd_backend());
+    fprintf(out, "    \"min_time\": %g,\n", min_time);
+#ifdef BENCH_COUNT_ALLOCS
+    fprintf(out, "    \"allocations_counted\": true\n");
+#else
+    fprintf(out, "    \"allocations_counted\": false\n");
+#endif
+    fprintf(out, "  },\n  \"benchmarks\": [");
+
+    const char* sep = "\n";
+    for (size_t i = 0; i < count; i++) {
+        const bench_state_t* s = &results[i].state;
+        if (s->error) continue;
+        double ns = ns_per_iteration(s, s->wall);
+        fprintf(out, "%s    {\n", sep);
+        fprintf(out, "      \"name\": \"%s\",\n", results[i].name);
+        fprintf(out, "      \"run_type\": \"iteration\",\n");
+        fprintf(out, "      \"iterations\": %lld,\n", (long long)s->iterations);
+        fprintf(out, "      \"real_time\": %.3f,\n", ns);
+        fprintf(out, "      \"cpu_time\": %.3f,\n", ns_per_iteration(s, s->cpu));
+        fprintf(out, "      \"time_unit\": \"ns\",\n");
+        fprintf(out, "      \"threads\": %d,\n", s->threads);
+        fprintf(out, "      \"size\": %lld,\n", (long long)s->size);
+        fprintf(out, "      \"ns_per_element\": %.6f,\n", ns / (double)s->elements);
+        fprintf(out, "      \"bytes_per_second\": %.1f,\n", (double)s->bytes / ns * 1e9);
+        fprintf(out, "      \"items_per_second\": %.1f,\n", (double)s->elements / ns * 1e9);
+        fprintf(out, "      \"allocs_per_iter\": %.3f,\n", (double)s->allocs / (double)s->iterations);
+        fprintf(out, "      \"alloc_bytes_per_iter\": %.1f\n", (double)s->alloced / (double)s->iterations);
+        fprintf(out, "    }");
+        sep = ",\n";
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+// ---------------------------------------------------------------------------
+// Driver
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [--filter SUBSTRING] [--threads N,N,...] [--min-time SECONDS]\n"
+            "          [--quick] [--json FILE|-] [--list]\n"
+            "  --threads   thread counts for threaded ops (default 1 and one per CPU)\n"
+            "  --quick     smallest size of every benchmark only\n"
+            "  --json      write Google Benchmark JSON to FILE (- for stdout)\n",
+            argv0);
+}
+
+static int parse_threads(const char* list, int* threads) {
+    int count = 0;
+    const char* p = list;
+    while (*p && count < BENCH_MAX_THREADS) {
+        char* end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) return -1;
+        threads[count++] = (int)n;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') return -1;
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    const char* json_path = NULL;
+    int quick = 0, list = 0;
+    int threads[BENCH_MAX_THREADS];
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int n_threads = 1;
+    threads[0] = 1;
+    if (cpus > 1) threads[n_threads++] = (int)cpus;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--quick") == 0) {
+            quick = 1;
+        } else if (strcmp(arg, "--list") == 0) {
+            list = 1;
+        } else if (strcmp(arg, "--filter") == 0 && value) {
+            filter = value;
+            i++;
+        } else if (strcmp(arg, "--json") == 0 && value) {
+            json_path = value;
+            i++;
+        } else if (strcmp(arg, "--min-time") == 0 && value && atof(value) > 0.0) {
+            min_time = atof(value);
+            i++;
+        } else if (strcmp(arg, "--threads") == 0 && value && (n_threads = parse_threads(value, threads)) > 0) {
+            i++;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    const size_t n_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    size_t capacity = n_benchmarks * BENCH_MAX_SIZES * (size_t)n_threads;
+    bench_result_t* results = calloc(capacity, sizeof(bench_result_t));
+    if (!results) return 1;
+
+    // Tables go to stderr when the JSON goes to stdout
+    FILE* table = json_path && strcmp(json_path, "-") == 0 ? stderr : stdout;
+    if (!list) {
+        fprintf(table, "agent-zero benchmarks: simd=%s cpus=%ld min_time=%gs\n\n",
+                agent_zero_simd_backend(), cpus, min_time);
+        fflush(table);
+    }
+    if (!list) print_header(table);
+
+    size_t count = 0;
+    int failures = 0;
+    for (size_t b = 0; b < n_benchmarks; b++) {
+        const bench_def_t* def = &benchmarks[b];
+        if (filter && !strstr(def->name, filter)) continue;
+        for (int z = 0; z < BENCH_MAX_SIZES && def->sizes[z]; z++) {
+            if (quick && z > 0) break;
+            for (int t = 0; t < (def->threaded ? n_threads : 1); t++) {
+                bench_result_t* r = &results[count++];
+                r->state.size = def->sizes[z];
+                r->state.threads = def->threaded ? threads[t] : 1;
+                snprintf(r->name, sizeof(r->name), "%s/%lld/threads:%d",
+                         def->name, (long long)r->state.size, r->state.threads);
+                if (list) {
+                    fprintf(table, "%s\n", r->name);
+                    continue;
+                }
+                agent_zero_set_num_threads(r->state.threads);
+                def->fn(&r->state);
+                if (r->state.error) failures++;
+                print_result(table, r);
+                fflush(table);
+            }
+        }
+    }
+
+    if (json_path && !list) {
+        FILE* out = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", json_path);
+            failures++;
+        } else {
+            write_json(out, results, count);
+            if (out != stdout) fclose(out);
+        }
+    }
+    free(results);
+    return failures ? 1 : 0;
+}
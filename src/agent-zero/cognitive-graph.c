@@ -0,0 +1,261 @@
+// Agent-Zero Deferred Cognitive Graph
+// /src/agent-zero/cognitive-graph.c
+//
+// Ops on a cognitive_graph_t only record nodes. cognitive_graph_compute()
+// walks the data once in MODULATION_BLOCK-sized tiles and evaluates every
+// node needed by an output on that tile before moving on, so a chain of
+// elementwise ops costs one pass over its inputs and outputs; intermediate
+// results live in per-thread tile buffers and are never materialized.
+//
+// Tiles start at the same plane offsets the eager ops use, so for contiguous
+// operands the outputs are bit-identical to calling the ops one by one.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "cognitive-internal.h"
+
+#define GRAPH_MIN_CAPACITY 8
+#define GRAPH_TILE MODULATION_BLOCK
+
+typedef enum {
+    GRAPH_OP_INPUT,
+    GRAPH_OP_ATTENTION,
+    GRAPH_OP_META_TRANSFORM,
+    GRAPH_OP_HYPERGRAPH_ENCODING,
+} graph_op_t;
+
+typedef struct {
+    graph_op_t op;
+    int src[2];
+    float gain;                        // attention weight / meta factor / tanh scale
+    float freq;
+    const struct ggml_tensor* tensor;  // GRAPH_OP_INPUT
+    struct ggml_tensor* output;        // materialized here when set
+} graph_node_t;
+
+struct cognitive_graph {
+    graph_node_t* nodes;
+    int count;
+    int capacity;
+    int ne[GGML_MAX_DIMS];  // shape shared by every node
+};
+
+cognitive_graph_t* create_cognitive_graph(void) {
+    return calloc(1, sizeof(cognitive_graph_t));
+}
+
+void destroy_cognitive_graph(cognitive_graph_t* graph) {
+    if (graph) {
+        free(graph->nodes);
+        free(graph);
+    }
+}
+
+void cognitive_graph_reset(cognitive_graph_t* graph) {
+    if (graph) graph->count = 0;
+}
+
+static int valid_node(const cognitive_graph_t* graph, int node) {
+    return graph && node >= 0 && node < graph->count;
+}
+
+static int push_node(cognitive_graph_t* graph, graph_node_t node) {
+    if (graph->count == graph->capacity) {
+        int capacity = graph->capacity ? graph->capacity * 2 : GRAPH_MIN_CAPACITY;
+        graph_node_t* nodes = realloc(graph->nodes, (size_t)capacity * sizeof(graph_node_t));
+        if (!nodes) return -1;
+        graph->nodes = nodes;
+        graph->capacity = capacity;
+    }
+    graph->nodes[graph->count] = node;
+    return graph->count++;
+}
+
+int cognitive_graph_input(cognitive_graph_t* graph, const struct ggml_tensor* tensor) {
+    if (!graph || !tensor || !tensor->data || tensor->type != GGML_TYPE_F32) return -1;
+    if (graph->count == 0) {
+        memcpy(graph->ne, tensor->ne, sizeof(graph->ne));
+    } else if (memcmp(graph->ne, tensor->ne, sizeof(graph->ne)) != 0) {
+        return -1;
+    }
+
+    graph_node_t node = { GRAPH_OP_INPUT, { -1, -1 }, 0.0f, 0.0f, tensor, NULL };
+    return push_node(graph, node);
+}
+
+int cognitive_graph_attention(cognitive_graph_t* graph, int src, float attention_weight) {
+    if (!valid_node(graph, src)) return -1;
+    graph_node_t node = { GRAPH_OP_ATTENTION, { src, -1 }, attention_weight, 0.1f, NULL, NULL };
+    return push_node(graph, node);
+}
+
+int cognitive_graph_meta_transform(cognitive_graph_t* graph, int src, int meta_level) {
+    if (!valid_node(graph, src)) return -1;
+    graph_node_t node = { GRAPH_OP_META_TRANSFORM, { src, -1 },
+                          1.0f + (meta_level * 0.2f), meta_level * 0.01f, NULL, NULL };
+    return push_node(graph, node);
+}
+
+int cognitive_graph_hypergraph_encoding(cognitive_graph_t* graph, int nodes, int links) {
+    if (!valid_node(graph, nodes) || !valid_node(graph, links)) return -1;
+    graph_node_t node = { GRAPH_OP_HYPERGRAPH_ENCODING, { nodes, links }, 0.5f, 0.0f, NULL, NULL };
+    return push_node(graph, node);
+}
+
+int cognitive_graph_set_output(cognitive_graph_t* graph, int node, struct ggml_tensor* output) {
+    if (!valid_node(graph, node)) return -1;
+    if (output && (!output->data || output->type != GGML_TYPE_F32 ||
+                   memcmp(graph->ne, output->ne, sizeof(graph->ne)) != 0)) {
+        return -1;
+    }
+    graph->nodes[node].output = output;
+    return 0;
+}
+
+struct ggml_tensor* cognitive_graph_new_output(
+    struct ggml_context* ctx, cognitive_graph_t* graph, int node) {
+    if (!valid_node(graph, node)) return NULL;
+    struct ggml_tensor* output = ggml_new_tensor(ctx, GGML_TYPE_F32, GGML_MAX_DIMS, graph->ne);
+    if (!output) return NULL;
+    graph->nodes[node].output = output;
+    return output;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation
+
+typedef struct {
+    const cognitive_graph_t* graph;
+    const int* plan;        // needed nodes, ascending (sources first)
+    int plan_count;
+    int contiguous;         // one span per plane, otherwise one per row
+    int64_t plane;          // elements per ne[0] x ne[1] plane
+    int64_t span_len;
+    int64_t tiles_per_span;
+    atomic_int failed;
+} graph_job_t;
+
+static void* span_ptr(const graph_job_t* job, const struct ggml_tensor* t, int64_t span, int64_t offset) {
+    if (job->contiguous) return (float*)t->data + span * job->span_len + offset;
+    return (float*)ggml_get_row(t, span) + offset;
+}
+
+// Evaluate every planned node on one tile. Inputs are read in place, the
+// other nodes write to their output or to their tile buffer.
+static void eval_tile(const graph_job_t* job, float** values, float* scratch,
+                      int64_t span, int64_t offset, int64_t len) {
+    const graph_node_t* nodes = job->graph->nodes;
+    const simd_kernels_t* k = simd_kernels();
+    int64_t base = span * job->span_len % job->plane + offset;
+
+    for (int p = 0; p < job->plan_count; p++) {
+        int id = job->plan[p];
+        const graph_node_t* node = &nodes[id];
+        if (node->op == GRAPH_OP_INPUT) {
+            values[id] = span_ptr(job, node->tensor, span, offset);
+            if (node->output && node->output->data != node->tensor->data) {
+                memcpy(span_ptr(job, node->output, span, offset), values[id],
+                       (size_t)len * sizeof(float));
+            }
+            continue;
+        }
+
+        float* dst = node->output ? span_ptr(job, node->output, span, offset)
+                                  : scratch + (size_t)p * GRAPH_TILE;
+        const float* a = values[node->src[0]];
+        switch (node->op) {
+        case GRAPH_OP_ATTENTION:
+        case GRAPH_OP_META_TRANSFORM:
+            // Both are index-modulated scalings of their source
+            modulate_span(dst, a, node->gain, 0.1f, node->freq, base, len);
+            break;
+        case GRAPH_OP_HYPERGRAPH_ENCODING:
+            k->add_tanh(dst, a, values[node->src[1]], node->gain, len);
+            break;
+        default:
+            break;
+        }
+        values[id] = dst;
+    }
+}
+
+static void eval_tiles(int64_t begin, int64_t end, void* arg) {
+    graph_job_t* job = arg;
+    int count = job->graph->count;
+    float** values = malloc((size_t)count * sizeof(float*));
+    float* scratch = malloc((size_t)job->plan_count * GRAPH_TILE * sizeof(float));
+    if (!values || !scratch) {
+        atomic_store(&job->failed, 1);
+        free(values);
+        free(scratch);
+        return;
+    }
+
+    for (int64_t t = begin; t < end; t++) {
+        int64_t span = t / job->tiles_per_span;
+        int64_t offset = (t % job->tiles_per_span) * GRAPH_TILE;
+        int64_t len = job->span_len - offset < GRAPH_TILE ? job->span_len - offset : GRAPH_TILE;
+        eval_tile(job, values, scratch, span, offset, len);
+    }
+    free(values);
+    free(scratch);
+}
+
+int cognitive_graph_compute(cognitive_graph_t* graph) {
+    if (!graph) return -1;
+
+    // Plan: the nodes some output depends on, in creation order
+    int count = graph->count;
+    char* needed = calloc((size_t)count + 1, 1);
+    int* plan = malloc(((size_t)count + 1) * sizeof(int));
+    if (!needed || !plan) {
+        free(needed);
+        free(plan);
+        return -1;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        const graph_node_t* node = &graph->nodes[i];
+        if (node->output) needed[i] = 1;
+        if (!needed[i]) continue;
+        for (int s = 0; s < 2; s++) {
+            if (node->src[s] >= 0) needed[node->src[s]] = 1;
+        }
+    }
+
+    int plan_count = 0;
+    int contiguous = 1;
+    for (int i = 0; i < count; i++) {
+        if (!needed[i]) continue;
+        plan[plan_count++] = i;
+        const graph_node_t* node = &graph->nodes[i];
+        if (node->tensor && !ggml_is_contiguous(node->tensor)) contiguous = 0;
+        if (node->output && !ggml_is_contiguous(node->output)) contiguous = 0;
+    }
+    free(needed);
+
+    if (plan_count == 0) {
+        free(plan);
+        return 0;
+    }
+
+    graph_job_t job;
+    job.graph = graph;
+    job.plan = plan;
+    job.plan_count = plan_count;
+    job.contiguous = contiguous;
+    int64_t elements = (int64_t)graph->ne[0] * graph->ne[1] * graph->ne[2] * graph->ne[3];
+    job.plane = (int64_t)graph->ne[0] * graph->ne[1];
+    job.span_len = contiguous ? job.plane : graph->ne[1];
+    int64_t spans = job.span_len ? elements / job.span_len : 0;
+    job.tiles_per_span = (job.span_len + GRAPH_TILE - 1) / GRAPH_TILE;
+    atomic_init(&job.failed, 0);
+
+    // Traffic is counted as one f32 plane per planned node
+    STATS_SPAN_BEGIN(span);
+    parallel_for(spans * job.tiles_per_span, parallel_grain((int64_t)GRAPH_TILE * plan_count),
+                 eval_tiles, &job);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_GRAPH_COMPUTE, (uint64_t)elements * sizeof(float) * plan_count);
+    free(plan);
+    return atomic_load(&job.failed) ? -1 : 0;
+}
@@ -0,0 +1,322 @@
+// Agent-Zero internal tensor and context definitions
+// /src/agent-zero/cognitive-internal.h
+//
+// Shared by every translation unit of the library so that tensors created
+// in one file can be consumed by another with the same layout. Not installed.
+
+#ifndef COGNITIVE_INTERNAL_H
+#define COGNITIVE_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "cognitive.h"
+
+// Alignment of tensor data (cache line, wide enough for AVX-512)
+#define GGML_MEM_ALIGN 64
+// Alignment of tensor headers inside a context arena
+#define GGML_HEADER_ALIGN 32
+
+// Tensor allocation origins (struct ggml_tensor::flags)
+#define GGML_TENSOR_FLAG_CTX  0x1  // header and data owned by a context arena
+#define GGML_TENSOR_FLAG_POOL 0x2  // header and data share one pool block
+#define GGML_TENSOR_FLAG_VIEW 0x4  // data borrowed from view_src
+#define GGML_TENSOR_FLAG_PLACED 0x8  // header and data share one placement block
+#define GGML_TENSOR_POOL_SHIFT 8   // pool size class stored above the flag bits
+
+// Layout: ne[0] rows of ne[1] elements, stacked ne[2] x ne[3] times. ne[1]
+// is the innermost dimension (nb[1] == element size); nb[d] is the byte
+// stride between consecutive indices of dimension d, so a view may use
+// row/plane strides larger than the dense ones.
+struct ggml_tensor {
+    int ne[GGML_MAX_DIMS];       // dimensions
+    void* data;                  // tensor data (GGML_MEM_ALIGN aligned unless a view)
+    size_t nb[GGML_MAX_DIMS];    // strides in bytes
+    int type;                    // data type
+    int flags;                   // GGML_TENSOR_FLAG_*
+    struct ggml_tensor* view_src;  // owning tensor for views, NULL otherwise
+    size_t view_offs;              // byte offset of data within view_src
+    ggml_tensor_release_fn release;  // caller-owned data, run by ggml_free_tensor
+    void* release_user;
+};
+
+struct ggml_context {
+    void* mem_buffer;  // arena backing store
+    size_t mem_size;   // arena budget in bytes
+    size_t mem_used;   // bump offset
+    int owns_buffer;   // mem_buffer allocated by ggml_context_create
+    int placed;        // ... by placement_alloc
+};
+
+// Bump-allocate size bytes from the context arena. Returns NULL when ctx has
+// no arena or the budget is exhausted.
+void* ggml_context_alloc(struct ggml_context* ctx, size_t size, size_t align);
+
+// Size-classed block pool (tensor-pool.c). tensor_pool_alloc returns NULL
+// with *size_class == -1 when size exceeds the largest class.
+void* tensor_pool_alloc(size_t size, int* size_class);
+void tensor_pool_free(void* ptr, int size_class);
+size_t tensor_pool_block_size(int size_class);
+// Bytes of pool blocks currently handed out, and their high-water mark
+void tensor_pool_usage(size_t* in_use, size_t* peak);
+
+// NUMA placement (placement.c). placement_alloc returns a zero-filled,
+// GGML_MEM_ALIGN aligned block placed by the current policy (arena blocks
+// are interleaved under PARTITIONED), or NULL when size is below
+// PLACEMENT_MIN_BYTES, the policy is plain first touch, or mapping fails.
+// Under PARTITIONED a tensor block (arena == 0) may be a reused one holding
+// old data; the caller zeroes it with placement_touch.
+#define PLACEMENT_MIN_BYTES ((size_t)1 << 20)
+void* placement_alloc(size_t size, int arena);
+void placement_free(void* ptr);
+int placement_partitioned(void);
+// Zero rows x row_bytes through parallel_for, one chunk per participant, so
+// every row is first touched by the thread the even split gives it
+void placement_touch(void* data, size_t rows, size_t row_bytes);
+// Pin pool worker self (of threads) to its node under PARTITIONED, or
+// restore the process affinity otherwise; *bound is the current node, -1
+// unpinned. A no-op when nothing changed.
+void placement_bind_worker(int self, int threads, int* bound);
+
+// Pattern shapes with a compile-time specialized correlation row: out[j] =
+// sum P[pi][pj] * data[pi * stride + j + pj] over the prows x pcols taps,
+// reading 0 past column n (data must hold prows rows). The taps are fully
+// unrolled and four output vectors share each tap broadcast.
+typedef void (*simd_correlate_fn)(float* out, const float* data, int64_t stride,
+                                  const float* pattern, int64_t n);
+
+typedef struct {
+    int prows;
+    int pcols;
+    simd_correlate_fn row;
+} simd_correlate_shape_t;
+
+#define SIMD_CORRELATE_SHAPE_COUNT 3   // 3x3, 5x5, 7x7
+#define SIMD_CORRELATE_MAX_SIDE 7
+
+// Elementwise f32 kernels over n contiguous elements (simd-kernels.c).
+// In-place use (dst == a or dst == b) is allowed.
+typedef struct {
+    const char* name;
+    void (*mul)(float* dst, const float* a, const float* b, int64_t n);
+    void (*add)(float* dst, const float* a, const float* b, int64_t n);
+    // dst = a * b + c
+    void (*fmadd)(float* dst, const float* a, const float* b, const float* c, int64_t n);
+    // dst = a * s
+    void (*scale)(float* dst, const float* a, float s, int64_t n);
+    // dst = tanh(a * s)
+    void (*tanh)(float* dst, const float* a, float s, int64_t n);
+    // dst = tanh((a + b) * s)
+    void (*add_tanh)(float* dst, const float* a, const float* b, float s, int64_t n);
+    // dst = a * gain * (1 + depth * sin((base + i) * freq)); a == NULL reads as 1
+    void (*sin_mod)(float* dst, const float* a, float gain, float depth,
+                    float freq, int64_t base, int64_t n);
+    // dst = a * (c0 + c1 * t1 + c2 * t2); a == NULL reads as 1
+    void (*mul_lincomb2)(float* dst, const float* a, const float* t1, const float* t2,
+                         float c0, float c1, float c2, int64_t n);
+    // dst += x * s
+    void (*axpy)(float* dst, const float* x, float s, int64_t n);
+    // C[m x n] += A[m x k] * B[k x n] (row-major, leading dimensions in elements)
+    void (*sgemm)(float* c, int64_t ldc, const float* a, int64_t lda,
+                  const float* b, int64_t ldb, int64_t m, int64_t k, int64_t n);
+    // dst = (c - |a - s|) * scale
+    void (*similarity)(float* dst, const float* a, float s, float c, float scale, int64_t n);
+    // dst = sin(a)
+    void (*sin)(float* dst, const float* a, int64_t n);
+    // Store base + i for every a[i] > threshold, ascending; returns how many
+    int64_t (*compress_gt)(uint32_t* idx, const float* a, float threshold,
+                           uint32_t base, int64_t n);
+    // sum += (a > 0 ? a : 0) and count += (a > 0) elementwise; row[0] and
+    // row[1] receive the same two totals over the whole span
+    void (*positive_stats)(float* sum, float* count, float* row, const float* a, int64_t n);
+    // sum of w[k] * x[idx[k]] (a CSR row times a dense vector)
+    float (*gather_dot)(const float* w, const uint32_t* idx, const float* x, int64_t n);
+    // sum of a[k] * b[k], and of (a[k] - b[k])^2
+    float (*dot)(const float* a, const float* b, int64_t n);
+    float (*l2_sq)(const float* a, const float* b, int64_t n);
+    // SIMD_CORRELATE_SHAPE_COUNT entries
+    const simd_correlate_shape_t* correlate_shapes;
+} simd_kernels_t;
+
+// Kernel table for the best instruction set supported by this CPU
+const simd_kernels_t* simd_kernels(void);
+
+// Thread pool (thread-pool.c). parallel_for runs fn over [0, n) in chunks
+// of grain indices spread across the pool; every index is covered exactly
+// once and chunk boundaries do not depend on the thread count. Runs inline
+// when called from inside another parallel_for.
+typedef void (*parallel_range_fn)(int64_t begin, int64_t end, void* params);
+void parallel_for(int64_t n, int64_t grain, parallel_range_fn fn, void* params);
+
+// Units per chunk for work costing unit_cost elements each, from the
+// configured grain size (at least 1)
+int64_t parallel_grain(int64_t unit_cost);
+
+// Epoch-based reclamation (epoch.c). Lock-free readers bracket their loads
+// of published pointers with epoch_enter/epoch_exit (nestable, never
+// blocking writers). A writer stages each block it is about to unpublish,
+// then calls epoch_retire once the replacement is published; retired blocks
+// are reclaimed when no reader that could still see them remains: passed
+// to the list's reclaim hook (which may recycle them), or to free(). The
+// node lives inside the block, so staging cannot fail. A list belongs to
+// one writer at a time.
+typedef struct epoch_node {
+    void* ptr;                 // the block
+    uint64_t epoch;
+    struct epoch_node* next;
+} epoch_node_t;
+
+typedef struct {
+    epoch_node_t* staged;      // still reachable by new readers
+    epoch_node_t* retired;     // waiting on readers already inside
+    void (*reclaim)(void* ptr, void* user);  // NULL: free()
+    void* reclaim_user;
+} epoch_list_t;
+
+void epoch_enter(void);
+void epoch_exit(void);
+void epoch_stage(epoch_list_t* list, epoch_node_t* node, void* ptr);
+void epoch_retire(epoch_list_t* list);
+// Wait until every read section open at the call has ended; not from
+// inside a read section
+void epoch_synchronize(void);
+// Free everything now, bypassing the hook; only when no reader can reach
+// the blocks any more
+void epoch_drain(epoch_list_t* list);
+
+// Index modulation (cognitive-tensors.c):
+// dst = a * gain * (1 + depth * sin((base + i) * freq)); a == NULL reads as 1.
+// Callers pass base relative to the start of the element's plane. Spans
+// are evaluated in MODULATION_BLOCK pieces from base, so splitting a
+// span at multiples of MODULATION_BLOCK gives bit-identical results.
+#define MODULATION_BLOCK 1024
+void modulate_span(float* dst, const float* a, float gain, float depth,
+                   float freq, int64_t base, int64_t n);
+
+// Scale encode_cognitive_state applies to activations: attention
+// weighting and meta-level processing
+static inline float kernel_encode_factor(const cognitive_kernel_t* kernel) {
+    return kernel->attention_weight * (1.0f + kernel->meta_level * 0.1f);
+}
+
+// Conversion between a storage type and f32 (tensor-types.c); NULL
+// function pointers for unknown types. n is a multiple of blck_size.
+typedef struct {
+    const char* name;
+    int blck_size;     // elements per block
+    size_t type_size;  // bytes per block
+    void (*to_f32)(const void* x, float* y, int64_t n);
+    void (*from_f32)(const float* x, void* y, int64_t n);
+} ggml_type_traits_t;
+
+const ggml_type_traits_t* ggml_get_type_traits(int type);  // NULL if unknown
+
+// Address of element i (a multiple of the block size) of a row
+static inline void* ggml_row_element(const struct ggml_tensor* t, void* row, int64_t i) {
+    const ggml_type_traits_t* traits = ggml_get_type_traits(t->type);
+    return (char*)row + i / traits->blck_size * traits->type_size;
+}
+
+// Fill in a dense header (shape, strides) over caller-provided data, e.g.
+// for stack temporaries; does not allocate
+void ggml_tensor_init(struct ggml_tensor* tensor, int type, int n_dims, const int* ne, void* data);
+
+// Dense tensor header over memory the caller keeps alive (flagged as a view
+// with no view_src); freeing the tensor leaves the data untouched
+struct ggml_tensor* ggml_tensor_wrap(struct ggml_context* ctx, int type, int n_dims,
+                                     const int* ne, void* data);
+
+// Rows are indexed in logical order r = (i3 * ne[2] + i2) * ne[0] + i0
+int64_t ggml_nrows(const struct ggml_tensor* tensor);
+
+static inline void* ggml_get_row(const struct ggml_tensor* t, int64_t r) {
+    int64_t i0 = r % t->ne[0];
+    int64_t i2 = (r / t->ne[0]) % t->ne[2];
+    int64_t i3 = r / ((int64_t)t->ne[0] * t->ne[2]);
+    return (char*)t->data + i0 * t->nb[0] + i2 * t->nb[2] + i3 * t->nb[3];
+}
+
+static inline int ggml_same_shape(const struct ggml_tensor* a, const struct ggml_tensor* b) {
+    return a->ne[0] == b->ne[0] && a->ne[1] == b->ne[1] &&
+           a->ne[2] == b->ne[2] && a->ne[3] == b->ne[3];
+}
+
+// Dense data size of a tensor in bytes
+static inline size_t ggml_nbytes(const struct ggml_tensor* t) {
+    return ggml_row_size(t->type, t->ne[1]) * (size_t)ggml_nrows(t);
+}
+
+// Instrumentation (stats.c, profile.c). Counter events are one relaxed
+// atomic add; spans read the monotonic clock twice and call the trace hook
+// if one is installed, and while profiling also read the hardware counters
+// and write a trace event. Building with AGENT_ZERO_NO_STATS compiles every
+// macro away, arguments included.
+enum {
+    STAT_TENSOR_ALLOCS,
+    STAT_TENSOR_BYTES,
+    STAT_ARENA_ALLOCS,
+    STAT_POOL_HITS,
+    STAT_POOL_MISSES,
+    STAT_MALLOC_FALLBACKS,
+    STAT_PLACED_ALLOCS,
+    STAT_COUNTER_COUNT,
+};
+
+#ifndef AGENT_ZERO_NO_STATS
+extern _Atomic uint64_t stats_counters[STAT_COUNTER_COUNT];
+
+static inline void stats_add(int counter, uint64_t amount) {
+    atomic_fetch_add_explicit(&stats_counters[counter], amount, memory_order_relaxed);
+}
+
+// Allocation event sources
+enum {
+    PROFILE_ALLOC_ARENA,     // tensor bump-allocated from a context
+    PROFILE_ALLOC_POOL,
+    PROFILE_ALLOC_PLACED,
+    PROFILE_ALLOC_HEAP,
+    PROFILE_ALLOC_CONTEXT,   // a context's arena buffer
+};
+
+typedef struct {
+    uint64_t start_ns;
+    int profiled;
+    // Calling thread's state at the start, when profiled
+    uint64_t counters[AGENT_ZERO_COUNTER_COUNT];
+    uint64_t allocs;
+    uint64_t alloc_bytes;
+} stats_span_t;
+
+extern _Atomic int profile_active;
+
+uint64_t stats_clock_ns(void);
+void stats_span_end(int op, const stats_span_t* span, uint64_t bytes);
+void profile_span_begin(stats_span_t* span);
+void profile_read_counters(uint64_t* counters);
+void profile_span_end(int op, const stats_span_t* span, const uint64_t* counters,
+                      uint64_t end_ns, uint64_t bytes);
+void profile_alloc(int source, const void* ptr, uint64_t bytes);
+void profile_free(int source, const void* ptr);
+
+static inline void stats_span_begin(stats_span_t* span) {
+    span->profiled = atomic_load_explicit(&profile_active, memory_order_relaxed);
+    span->start_ns = stats_clock_ns();
+    if (span->profiled) profile_span_begin(span);
+}
+
+#define STATS_ADD(counter, amount) stats_add((counter), (amount))
+#define STATS_SPAN_BEGIN(name) stats_span_t name; stats_span_begin(&name)
+#define STATS_SPAN_END(name, op, bytes) stats_span_end((op), &(name), (uint64_t)(bytes))
+#define STATS_ALLOC_EVENT(source, ptr, bytes) \
+    (atomic_load_explicit(&profile_active, memory_order_relaxed) ? profile_alloc((source), (ptr), (bytes)) : (void)0)
+#define STATS_FREE_EVENT(source, ptr) \
+    (atomic_load_explicit(&profile_active, memory_order_relaxed) ? profile_free((source), (ptr)) : (void)0)
+#else
+#define STATS_ADD(counter, amount) ((void)0)
+#define STATS_SPAN_BEGIN(name) ((void)0)
+#define STATS_SPAN_END(name, op, bytes) ((void)0)
+#define STATS_ALLOC_EVENT(source, ptr, bytes) ((void)0)
+#define STATS_FREE_EVENT(source, ptr) ((void)0)
+#endif
+
+#endif // COGNITIVE_INTERNAL_H
@@ -5,150 +5,271 @@
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
-#include "cognitive.h"
-
-// Complete GGML structures for standalone implementation
-// In a real implementation, this would include actual GGML headers
-
-struct ggml_tensor {
-    int ne[4];       // dimensions
-    void* data;      // tensor data
-    size_t nb[4];    // strides
-    int type;        // data type
-};
-
-struct ggml_context {
-    void* mem_buffer;
-    size_t mem_size;
-    size_t mem_used;
-};
-
-// GGML function implementations
-static struct ggml_tensor* ggml_new_tensor_2d(struct ggml_context* ctx, int type, int ne0, int ne1) {
-    struct ggml_tensor* tensor = malloc(sizeof(struct ggml_tensor));
-    if (!tensor) return NULL;
-    
-    tensor->ne[0] = ne0;
-    tensor->ne[1] = ne1;
-    tensor->ne[2] = 1;
-    tensor->ne[3] = 1;
-    tensor->type = type;
-    tensor->data = calloc(ne0 * ne1, sizeof(float));
-    
-    if (!tensor->data) {
-        free(tensor);
-        return NULL;
+#include <stdatomic.h>
+#include <pthread.h>
+#include "cognitive-internal.h"
+
+// Index modulation tables
+// Both the ECAN attention weighting and the meta transform scale element i
+// of each ne[0] x ne[1] plane by 1 + depth * sin(i * freq). With the
+// angle-addition identity
+//   sin((s + k) f) = sin(s f) cos(k f) + cos(s f) sin(k f)
+// one table of sin/cos(k f) for k < MODULATION_BLOCK serves every span
+// start s and therefore every tensor shape: a span costs one libm sin/cos
+// pair per block plus two FMAs per element. Tables are cached per
+// frequency, never freed, and published lock-free to readers.
+#define MODULATION_CACHE_SLOTS 8
+
+typedef struct {
+    float freq;
+    float cos_table[MODULATION_BLOCK];
+    float sin_table[MODULATION_BLOCK];
+} modulation_table_t;
+
+static _Atomic(modulation_table_t*) modulation_cache[MODULATION_CACHE_SLOTS];
+static pthread_mutex_t modulation_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const modulation_table_t* find_modulation_table(float freq) {
+    for (int i = 0; i < MODULATION_CACHE_SLOTS; i++) {
+        modulation_table_t* t = atomic_load_explicit(&modulation_cache[i], memory_order_acquire);
+        if (!t) break;
+        if (t->freq == freq) return t;
     }
-    
-    return tensor;
+    return NULL;
 }
 
-static struct ggml_tensor* ggml_mul(struct ggml_context* ctx, struct ggml_tensor* a, struct ggml_tensor* b) {
-    if (!a || !b || !a->data || !b->data) return NULL;
-    
-    struct ggml_tensor* result = ggml_new_tensor_2d(ctx, 0, a->ne[0], a->ne[1]);
-    if (!result) return NULL;
-    
-    float* a_data = (float*)a->data;
-    float* b_data = (float*)b->data;
-    float* result_data = (float*)result->data;
-    
-    int size = a->ne[0] * a->ne[1];
-    for (int i = 0; i < size; i++) {
-        result_data[i] = a_data[i] * b_data[i];
+// Returns NULL when the cache is full; callers then evaluate sin directly
+static const modulation_table_t* get_modulation_table(float freq) {
+    const modulation_table_t* found = find_modulation_table(freq);
+    if (found) return found;
+
+    pthread_mutex_lock(&modulation_lock);
+    found = find_modulation_table(freq);
+    for (int i = 0; !found && i < MODULATION_CACHE_SLOTS; i++) {
+        if (atomic_load_explicit(&modulation_cache[i], memory_order_relaxed)) continue;
+
+        modulation_table_t* t = malloc(sizeof(modulation_table_t));
+        if (!t) break;
+        t->freq = freq;
+        for (int k = 0; k < MODULATION_BLOCK; k++) {
+            double angle = (double)k * (double)freq;
+            t->cos_table[k] = (float)cos(angle);
+            t->sin_table[k] = (float)sin(angle);
+        }
+        atomic_store_explicit(&modulation_cache[i], t, memory_order_release);
+        found = t;
     }
-    return result;
+    pthread_mutex_unlock(&modulation_lock);
+    return found;
+}
+
+void modulate_span(float* dst, const float* a, float gain, float depth,
+                   float freq, int64_t base, int64_t n) {
+    const simd_kernels_t* k = simd_kernels();
+    const modulation_table_t* t = get_modulation_table(freq);
+    if (!t) {
+        k->sin_mod(dst, a, gain, depth, freq, base, n);
+        return;
+    }
+
+    float amplitude = gain * depth;
+    for (int64_t s = 0; s < n; s += MODULATION_BLOCK) {
+        int64_t len = n - s < MODULATION_BLOCK ? n - s : MODULATION_BLOCK;
+        double angle = (double)(base + s) * (double)freq;
+        k->mul_lincomb2(dst + s, a ? a + s : NULL, t->cos_table, t->sin_table,
+                        gain, amplitude * (float)sin(angle), amplitude * (float)cos(angle), len);
+    }
+}
+
+// Elementwise row kernel: n elements of one plane starting at index base
+// within that plane
+typedef void (*row_kernel_fn)(float* dst, const float* a, const float* b,
+                              int64_t n, int64_t base, const void* params);
+
+typedef struct {
+    struct ggml_tensor* dst;
+    const struct ggml_tensor* a;
+    const struct ggml_tensor* b;
+    row_kernel_fn fn;
+    const void* params;
+    int64_t plane;           // elements per ne[0] x ne[1] plane
+    // Tiled operands only
+    int contiguous;          // one span per plane, otherwise one per row
+    int64_t span_len;
+    int64_t tiles_per_span;
+} row_job_t;
+
+// Flat element range of contiguous single-plane operands
+static void run_span_range(int64_t begin, int64_t end, void* arg) {
+    const row_job_t* job = arg;
+    job->fn((float*)job->dst->data + begin, (const float*)job->a->data + begin,
+            job->b ? (const float*)job->b->data + begin : NULL, end - begin, begin, job->params);
+}
+
+// Logical row range of strided operands
+static void run_row_range(int64_t begin, int64_t end, void* arg) {
+    const row_job_t* job = arg;
+    int64_t row_len = job->dst->ne[1];
+    for (int64_t r = begin; r < end; r++) {
+        job->fn((float*)ggml_get_row(job->dst, r), (const float*)ggml_get_row(job->a, r),
+                job->b ? (const float*)ggml_get_row(job->b, r) : NULL, row_len,
+                (r % job->dst->ne[0]) * row_len, job->params);
+    }
+}
+
+static void* span_element(const struct ggml_tensor* t, const row_job_t* job, int64_t span, int64_t i) {
+    if (job->contiguous) return ggml_row_element(t, t->data, span * job->span_len + i);
+    return ggml_row_element(t, ggml_get_row(t, span), i);
 }
 
-static struct ggml_tensor* ggml_add(struct ggml_context* ctx, struct ggml_tensor* a, struct ggml_tensor* b) {
-    if (!a || !b || !a->data || !b->data) return NULL;
+// f32 view of n elements of t at src: src itself, or src converted into tile
+static const float* load_tile(const struct ggml_tensor* t, const void* src, float* tile, int64_t n) {
+    if (t->type == GGML_TYPE_F32) return src;
+    ggml_get_type_traits(t->type)->to_f32(src, tile, n);
+    return tile;
+}
+
+// Typed or multi-plane operands: MODULATION_BLOCK tiles of each span, typed
+// ones converted through f32 buffers, so the kernels see the same spans and
+// bases as on f32 data
+static void run_tile_range(int64_t begin, int64_t end, void* arg) {
+    const row_job_t* job = arg;
+    float tile_a[MODULATION_BLOCK];
+    float tile_b[MODULATION_BLOCK];
+    float tile_dst[MODULATION_BLOCK];
+    int dst_f32 = job->dst->type == GGML_TYPE_F32;
+
+    for (int64_t t = begin; t < end; t++) {
+        int64_t span = t / job->tiles_per_span;
+        int64_t offset = (t % job->tiles_per_span) * MODULATION_BLOCK;
+        int64_t len = job->span_len - offset < MODULATION_BLOCK ? job->span_len - offset : MODULATION_BLOCK;
+
+        const float* a = load_tile(job->a, span_element(job->a, job, span, offset),
+                                   tile_a, len);
+        const float* b = job->b ? load_tile(job->b, span_element(job->b, job, span, offset),
+                                            tile_b, len)
+                                : NULL;
+        void* dst = span_element(job->dst, job, span, offset);
+        float* out = dst_f32 ? dst : tile_dst;
+        job->fn(out, a, b, len, span * job->span_len % job->plane + offset, job->params);
+        if (!dst_f32) {
+            ggml_get_type_traits(job->dst->type)->from_f32(out, dst, len);
+        }
+    }
+}
+
+// Run fn over matching rows of same-shaped tensors (b may be NULL), split
+// across the thread pool. Planes along ne[2] and ne[3] are independent:
+// each starts the kernels' index at 0, so a batched op equals the op on
+// every plane alone. Contiguous planes are cut into spans aligned to
+// MODULATION_BLOCK from their start, so modulated kernels see the same
+// table blocks as a single serial span and results do not depend on the
+// split.
+static void for_each_row(struct ggml_tensor* dst, const struct ggml_tensor* a,
+                         const struct ggml_tensor* b, row_kernel_fn fn, const void* params) {
+    row_job_t job = { dst, a, b, fn, params, (int64_t)dst->ne[0] * dst->ne[1], 0, 0, 0 };
+    int contiguous = ggml_is_contiguous(dst) && ggml_is_contiguous(a) && (!b || ggml_is_contiguous(b));
+    int64_t elements = ggml_nelements(dst);
+
+    if (dst->type != GGML_TYPE_F32 || a->type != GGML_TYPE_F32 || (b && b->type != GGML_TYPE_F32) ||
+        (contiguous && elements > job.plane)) {
+        job.contiguous = contiguous;
+        job.span_len = contiguous ? job.plane : dst->ne[1];
+        job.tiles_per_span = (job.span_len + MODULATION_BLOCK - 1) / MODULATION_BLOCK;
+        int64_t spans = job.span_len ? elements / job.span_len : 0;
+        parallel_for(spans * job.tiles_per_span, parallel_grain(MODULATION_BLOCK), run_tile_range, &job);
+        return;
+    }
+
+    if (contiguous) {
+        int64_t grain = parallel_grain(1);
+        grain = (grain + MODULATION_BLOCK - 1) / MODULATION_BLOCK * MODULATION_BLOCK;
+        parallel_for(elements, grain, run_span_range, &job);
+        return;
+    }
+
+    parallel_for(ggml_nrows(dst), parallel_grain(dst->ne[1]), run_row_range, &job);
+}
+
+static void add_tanh_row(float* dst, const float* a, const float* b, int64_t n, int64_t base, const void* params) {
+    (void)base;
+    // Apply non-linear transformation for hypergraph encoding
+    simd_kernels()->add_tanh(dst, a, b, *(const float*)params, n);
+}
+
+static struct ggml_tensor* ggml_binary_op(struct ggml_context* ctx, struct ggml_tensor* a,
+                                          struct ggml_tensor* b, row_kernel_fn fn, const void* params) {
+    if (!a || !b || !a->data || !b->data || !ggml_same_shape(a, b)) return NULL;
     
-    struct ggml_tensor* result = ggml_new_tensor_2d(ctx, 0, a->ne[0], a->ne[1]);
+    struct ggml_tensor* result = ggml_new_tensor(ctx, a->type, GGML_MAX_DIMS, a->ne);
     if (!result) return NULL;
     
-    float* a_data = (float*)a->data;
-    float* b_data = (float*)b->data;
-    float* result_data = (float*)result->data;
-    
-    int size = a->ne[0] * a->ne[1];
-    for (int i = 0; i < size; i++) {
-        result_data[i] = a_data[i] + b_data[i];
-    }
+    for_each_row(result, a, b, fn, params);
     return result;
 }
 
-static void ggml_free_tensor(struct ggml_tensor* tensor) {
-    if (tensor) {
-        if (tensor->data) {
-            free(tensor->data);
-        }
-        free(tensor);
-    }
+static void attention_row(float* dst, const float* a, const float* b, int64_t n, int64_t base, const void* params) {
+    (void)b;
+    // Apply ECAN attention weighting fused with the multiply
+    modulate_span(dst, a, *(const float*)params, 0.1f, 0.1f, base, n);
+}
+
+typedef struct {
+    float meta_factor;
+    float frequency;
+} meta_params_t;
+
+static void meta_transform_row(float* dst, const float* a, const float* b, int64_t n, int64_t base, const void* params) {
+    (void)b;
+    const meta_params_t* p = params;
+    // Apply recursive transformation
+    modulate_span(dst, a, p->meta_factor, 0.1f, p->frequency, base, n);
 }
 
 // Custom cognitive tensor operations
-struct ggml_tensor* cognitive_attention_matrix(
-    struct ggml_context* ctx,
-    struct ggml_tensor* input,
+int cognitive_attention_matrix_into(
+    struct ggml_tensor* out,
+    const struct ggml_tensor* input,
     float attention_weight) {
     
-    struct ggml_tensor* attention = ggml_new_tensor_2d(
-        ctx, 0, input->ne[0], input->ne[1]);
-    
-    // Apply ECAN attention weighting
-    float* attention_data = (float*)attention->data;
-    for (int i = 0; i < input->ne[0] * input->ne[1]; i++) {
-        attention_data[i] = attention_weight * (1.0f + 0.1f * sinf(i * 0.1f));
+    if (!out || !input || !out->data || !input->data || !ggml_same_shape(out, input)) {
+        return -1;
     }
     
-    return ggml_mul(ctx, input, attention);
+    // Weighting and multiply in one pass; nothing is materialized
+    STATS_SPAN_BEGIN(span);
+    for_each_row(out, input, NULL, attention_row, &attention_weight);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION, ggml_nbytes(input) + ggml_nbytes(out));
+    return 0;
 }
 
-struct ggml_tensor* hypergraph_encoding(
+struct ggml_tensor* cognitive_attention_matrix(
     struct ggml_context* ctx,
-    struct ggml_tensor* nodes,
-    struct ggml_tensor* links) {
+    struct ggml_tensor* input,
+    float attention_weight) {
     
-    // Encode hypergraph structure as tensor operations
-    struct ggml_tensor* encoding = ggml_add(ctx, nodes, links);
+    if (!input || !input->data) return NULL;
     
-    // Apply hypergraph-specific transformations
-    float* data = (float*)encoding->data;
-    for (int i = 0; i < encoding->ne[0] * encoding->ne[1]; i++) {
-        // Apply non-linear transformation for hypergraph encoding
-        data[i] = tanhf(data[i] * 0.5f);
-    }
+    struct ggml_tensor* result = ggml_new_tensor(
+        ctx, input->type, GGML_MAX_DIMS, input->ne);
+    if (!result) return NULL;
     
-    return encoding;
+    cognitive_attention_matrix_into(result, input, attention_weight);
+    return result;
 }
 
-struct ggml_tensor* cognitive_pattern_match(
+struct ggml_tensor* hypergraph_encoding(
     struct ggml_context* ctx,
-    struct ggml_tensor* pattern,
-    struct ggml_tensor* data) {
-    
-    struct ggml_tensor* match_result = ggml_new_tensor_2d(
-        ctx, 0, data->ne[0], data->ne[1]);
-    
-    float* pattern_data = (float*)pattern->data;
-    float* input_data = (float*)data->data;
-    float* result_data = (float*)match_result->data;
-    
-    // Implement pattern matching using correlation
-    for (int i = 0; i < data->ne[0]; i++) {
-        for (int j = 0; j < data->ne[1]; j++) {
-            float correlation = 0.0f;
-            for (int pi = 0; pi < pattern->ne[0] && (i + pi) < data->ne[0]; pi++) {
-                for (int pj = 0; pj < pattern->ne[1] && (j + pj) < data->ne[1]; pj++) {
-                    correlation += pattern_data[pi * pattern->ne[1] + pj] * 
-                                 input_data[(i + pi) * data->ne[1] + (j + pj)];
-                }
-            }
-            result_data[i * data->ne[1] + j] = correlation;
-        }
-    }
+    struct ggml_tensor* nodes,
+    struct ggml_tensor* links) {
     
-    return match_result;
+    // Encode hypergraph structure as tensor operations; the sum and the
+    // hypergraph-specific tanh are fused into one pass
+    float scale = 0.5f;
+    STATS_SPAN_BEGIN(span);
+    struct ggml_tensor* result = ggml_binary_op(ctx, nodes, links, add_tanh_row, &scale);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_HYPERGRAPH_ENCODING, result ? 3 * ggml_nbytes(result) : 0);
+    return result;
 }
 
 struct ggml_tensor* meta_cognitive_transform(
@@ -156,19 +277,17 @@ struct ggml_tensor* meta_cognitive_transform(
     struct ggml_tensor* input,
     int meta_level) {
     
-    struct ggml_tensor* transformed = ggml_new_tensor_2d(
-        ctx, 0, input->ne[0], input->ne[1]);
+    if (!input || !input->data) return NULL;
     
-    float* input_data = (float*)input->data;
-    float* output_data = (float*)transformed->data;
+    struct ggml_tensor* transformed = ggml_new_tensor(
+        ctx, input->type, GGML_MAX_DIMS, input->ne);
+    if (!transformed) return NULL;
     
     // Apply meta-cognitive transformation based on level
-    float meta_factor = 1.0f + (meta_level * 0.2f);
-    for (int i = 0; i < input->ne[0] * input->ne[1]; i++) {
-        // Apply recursive transformation
-        output_data[i] = input_data[i] * meta_factor * 
-                        (1.0f + 0.1f * sinf(i * meta_level * 0.01f));
-    }
+    meta_params_t params = { 1.0f + (meta_level * 0.2f), meta_level * 0.01f };
+    STATS_SPAN_BEGIN(span);
+    for_each_row(transformed, input, NULL, meta_transform_row, &params);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_META_TRANSFORM, ggml_nbytes(input) + ggml_nbytes(transformed));
     
     return transformed;
 }
@@ -180,14 +299,30 @@ cognitive_kernel_t* create_cognitive_kernel(
     size_t shape_dims,
     float attention_weight) {
     
+    return create_cognitive_kernel_typed(ctx, shape, shape_dims, attention_weight, GGML_TYPE_F32);
+}
+
+cognitive_kernel_t* create_cognitive_kernel_typed(
+    struct ggml_context* ctx,
+    const int* shape,
+    size_t shape_dims,
+    float attention_weight,
+    int type) {
+    
     cognitive_kernel_t* kernel = malloc(sizeof(cognitive_kernel_t));
     if (!kernel) return NULL;
     
-    // Create tensor field based on shape
+    // Create tensor field based on shape; extra dimensions batch the field
     if (shape_dims >= 2) {
-        kernel->tensor_field = ggml_new_tensor_2d(ctx, 0, shape[0], shape[1]);
+        int dims = shape_dims > GGML_MAX_DIMS ? GGML_MAX_DIMS : (int)shape_dims;
+        kernel->tensor_field = ggml_new_tensor(ctx, type, dims, shape);
     } else {
-        kernel->tensor_field = ggml_new_tensor_2d(ctx, 0, shape[0], 1);
+        kernel->tensor_field = ggml_new_tensor_2d(ctx, type, shape[0], 1);
+    }
+    
+    if (!kernel->tensor_field) {
+        free(kernel);
+        return NULL;
     }
     
     kernel->attention_weight = attention_weight;
@@ -199,12 +334,7 @@ cognitive_kernel_t* create_cognitive_kernel(
 
 void destroy_cognitive_kernel(cognitive_kernel_t* kernel) {
     if (kernel) {
-        if (kernel->tensor_field && kernel->tensor_field->data) {
-            free(kernel->tensor_field->data);
-        }
-        if (kernel->tensor_field) {
-            free(kernel->tensor_field);
-        }
+        ggml_free_tensor(kernel->tensor_field);
         free(kernel);
     }
 }
@@ -217,82 +347,3 @@ int update_kernel_attention(cognitive_kernel_t* kernel, float new_weight) {
     kernel->attention_weight = new_weight;
     return 0; // Success
 }
-
-// Hypergraph operations
-hypergraph_t* create_hypergraph(size_t node_count, size_t link_count) {
-    hypergraph_t* hg = malloc(sizeof(hypergraph_t));
-    if (!hg) return NULL;
-    
-    hg->node_count = node_count;
-    hg->link_count = link_count;
-    
-    hg->node_weights = calloc(node_count, sizeof(float));
-    hg->link_weights = calloc(link_count, sizeof(float));
-    hg->adjacency_matrix = calloc(node_count * node_count, sizeof(int));
-    
-    if (!hg->node_weights || !hg->link_weights || !hg->adjacency_matrix) {
-        destroy_hypergraph(hg);
-        return NULL;
-    }
-    
-    return hg;
-}
-
-void destroy_hypergraph(hypergraph_t* hg) {
-    if (hg) {
-        free(hg->node_weights);
-        free(hg->link_weights);
-        free(hg->adjacency_matrix);
-        free(hg);
-    }
-}
-
-struct ggml_tensor* encode_hypergraph_to_tensor(
-    struct ggml_context* ctx,
-    const hypergraph_t* hg) {
-    
-    if (!hg) return NULL;
-    
-    struct ggml_tensor* tensor = ggml_new_tensor_2d(
-        ctx, 0, (int)hg->node_count, (int)hg->node_count);
-    
-    float* tensor_data = (float*)tensor->data;
-    
-    // Encode adjacency matrix with weights
-    for (size_t i = 0; i < hg->node_count; i++) {
-        for (size_t j = 0; j < hg->node_count; j++) {
-            int adj_value = hg->adjacency_matrix[i * hg->node_count + j];
-            float weight_factor = (hg->node_weights[i] + hg->node_weights[j]) * 0.5f;
-            tensor_data[i * hg->node_count + j] = adj_value * weight_factor;
-        }
-    }
-    
-    return tensor;
-}
-
-int decode_tensor_to_hypergraph(
-    const struct ggml_tensor* tensor,
-    hypergraph_t* hg) {
-    
-    if (!tensor || !hg || !tensor->data) return -1;
-    
-    float* tensor_data = (float*)tensor->data;
-    size_t min_size = (hg->node_count < (size_t)tensor->ne[0]) ? 
-                      hg->node_count : (size_t)tensor->ne[0];
-    
-    // Decode tensor back to adjacency matrix
-    for (size_t i = 0; i < min_size; i++) {
-        for (size_t j = 0; j < min_size; j++) {
-            float value = tensor_data[i * tensor->ne[1] + j];
-            hg->adjacency_matrix[i * hg->node_count + j] = (value > 0.5f) ? 1 : 0;
-            
-            // Update node weights based on connections
-            if (value > 0.0f) {
-                hg->node_weights[i] = (hg->node_weights[i] + value) * 0.5f;
-                hg->node_weights[j] = (hg->node_weights[j] + value) * 0.5f;
-            }
-        }
-    }
-    
-    return 0; // Success
-}
\ No newline at end of file
@@ -12,12 +12,253 @@ extern "C" {
 struct ggml_context;
 struct ggml_tensor;
 
+#define GGML_MAX_DIMS 4
+
+// Element types; values follow upstream ggml. Q8_0 stores blocks of 32
+// values as one fp16 scale plus 32 int8, so rows (ne[1]) of a Q8_0 tensor
+// must be a multiple of 32 elements.
+enum ggml_type {
+    GGML_TYPE_F32 = 0,
+    GGML_TYPE_F16 = 1,
+    GGML_TYPE_Q8_0 = 8,
+    GGML_TYPE_BF16 = 30,
+};
+
+#define QK8_0 32
+
+// Context management
+// A context owns a fixed-budget arena that tensor headers and data are
+// bump-allocated from. Resetting or freeing the context releases every
+// tensor created in it at once. Functions taking a NULL context allocate
+// tensors on the heap instead; release those with ggml_free_tensor().
+struct ggml_context* ggml_context_create(size_t mem_size);
+void ggml_context_reset(struct ggml_context* ctx);
+void ggml_context_free(struct ggml_context* ctx);
+size_t ggml_context_used(const struct ggml_context* ctx);
+
+// Worst-case arena bytes consumed per tensor on top of its data
+size_t ggml_tensor_overhead(void);
+
+// Frees a heap tensor; no-op for tensors owned by a context
+void ggml_free_tensor(struct ggml_tensor* tensor);
+
+// Tensor creation
+// Tensors hold ne[0] rows of ne[1] elements (ne[1] is contiguous), stacked
+// along ne[2] and ne[3]. Data is zero-initialized.
+struct ggml_tensor* ggml_new_tensor(struct ggml_context* ctx, int type, int n_dims, const int* ne);
+struct ggml_tensor* ggml_new_tensor_1d(struct ggml_context* ctx, int type, int ne0);
+struct ggml_tensor* ggml_new_tensor_2d(struct ggml_context* ctx, int type, int ne0, int ne1);
+struct ggml_tensor* ggml_new_tensor_3d(struct ggml_context* ctx, int type, int ne0, int ne1, int ne2);
+struct ggml_tensor* ggml_new_tensor_4d(struct ggml_context* ctx, int type, int ne0, int ne1, int ne2, int ne3);
+
+// Views share the parent's buffer; the parent must outlive them. nb0 is
+// the byte stride between rows, nb2/nb3 between planes, offset is in bytes
+// from the start of the parent's data. Returns NULL if the view would reach
+// outside the parent.
+struct ggml_tensor* ggml_view_2d(
+    struct ggml_context* ctx, struct ggml_tensor* parent,
+    int ne0, int ne1, size_t nb0, size_t offset);
+struct ggml_tensor* ggml_view_3d(
+    struct ggml_context* ctx, struct ggml_tensor* parent,
+    int ne0, int ne1, int ne2, size_t nb0, size_t nb2, size_t offset);
+struct ggml_tensor* ggml_view_4d(
+    struct ggml_context* ctx, struct ggml_tensor* parent,
+    int ne0, int ne1, int ne2, int ne3,
+    size_t nb0, size_t nb2, size_t nb3, size_t offset);
+
+// Tensor inspection
+int64_t ggml_nelements(const struct ggml_tensor* tensor);
+int ggml_is_contiguous(const struct ggml_tensor* tensor);
+int ggml_get_ne(const struct ggml_tensor* tensor, int dim);
+size_t ggml_get_nb(const struct ggml_tensor* tensor, int dim);
+float* ggml_get_data_f32(const struct ggml_tensor* tensor);  // NULL unless F32
+
+// Zero-copy buffers
+// A tensor header over caller-owned memory; nothing is copied. nb holds
+// the byte strides of the n_dims dimensions (NULL for dense): nb[1] must
+// be the element size and rows and planes may not overlap. If release is
+// set, ggml_free_tensor calls release(data, user) once the header is
+// gone, so it requires a NULL ctx. On failure NULL is returned and the
+// caller keeps the buffer.
+typedef void (*ggml_tensor_release_fn)(void* data, void* user);
+
+struct ggml_tensor* ggml_new_tensor_from_buffer(
+    struct ggml_context* ctx, int type, int n_dims, const int* ne, const size_t* nb,
+    void* data, ggml_tensor_release_fn release, void* user);
+
+// Data and element count of a contiguous F32 tensor, to borrow as a flat
+// array (a Crystal Slice(Float32)); NULL for other types and strided
+// views. Valid until the tensor or its owner is freed.
+float* ggml_borrow_f32(const struct ggml_tensor* tensor, int64_t* n);
+
+// Element types
+// Type sizes are per block (one element for the float types); ggml_row_size
+// is the byte size of n elements. Unknown types have size 0.
+const char* ggml_type_name(int type);
+int ggml_blck_size(int type);
+size_t ggml_type_size(int type);
+size_t ggml_row_size(int type, int64_t n);
+
+// Row conversions between f32 and the storage types; Q8_0 rows hold a
+// multiple of QK8_0 values
+void ggml_fp32_to_fp16_row(const float* x, uint16_t* y, int64_t n);
+void ggml_fp16_to_fp32_row(const uint16_t* x, float* y, int64_t n);
+void ggml_fp32_to_bf16_row(const float* x, uint16_t* y, int64_t n);
+void ggml_bf16_to_fp32_row(const uint16_t* x, float* y, int64_t n);
+void quantize_row_q8_0(const float* x, void* y, int64_t n);
+void dequantize_row_q8_0(const void* x, float* y, int64_t n);
+
+// Copy of tensor converted to type (dense), or NULL if the shape does not
+// fit the type's blocks
+struct ggml_tensor* ggml_cast(struct ggml_context* ctx, const struct ggml_tensor* tensor, int type);
+
+// SIMD dispatch
+// Elementwise ops run on the widest instruction set the CPU supports
+// (avx512, avx2, sse2, neon or scalar), chosen at first use or forced
+// with the AGENT_ZERO_SIMD environment variable.
+const char* agent_zero_simd_backend(void);
+int agent_zero_set_simd_backend(const char* name);  // 0 on success, -1 if unavailable
+
+// Threading
+// Tensor ops split large tensors across a work-stealing thread pool; the
+// results are identical for every thread count. n_threads == 0 uses one
+// thread per CPU (or AGENT_ZERO_NUM_THREADS), 1 runs everything on the
+// caller. The grain size is the number of elements per task.
+int agent_zero_set_num_threads(int n_threads);  // 0 on success, -1 if n_threads < 0
+int agent_zero_get_num_threads(void);
+void agent_zero_set_grain_size(int64_t elements);  // <= 0 restores the default
+int64_t agent_zero_get_grain_size(void);
+
+// Memory placement
+// Heap tensors of 1 MiB and up and context arenas are placed by policy:
+// FIRST_TOUCH (default) leaves pages on the node of the thread that first
+// writes them, INTERLEAVE spreads them over the NUMA nodes, PARTITIONED pins
+// the pool threads to nodes and first-touches each new tensor's rows from
+// the thread that later processes them. OR in AGENT_ZERO_PLACEMENT_HUGE_PAGES
+// for huge-page backing. The initial policy can be forced with the
+// AGENT_ZERO_PLACEMENT environment variable ("interleave", "partitioned",
+// "first-touch", each optionally "+huge"); changes apply to tensors and
+// contexts created afterwards.
+typedef enum {
+    AGENT_ZERO_PLACEMENT_FIRST_TOUCH = 0,
+    AGENT_ZERO_PLACEMENT_INTERLEAVE,
+    AGENT_ZERO_PLACEMENT_PARTITIONED
+} agent_zero_placement_t;
+#define AGENT_ZERO_PLACEMENT_HUGE_PAGES 0x100
+
+int agent_zero_set_placement(int placement);  // 0 on success, -1 if unknown
+int agent_zero_get_placement(void);
+int agent_zero_numa_nodes(void);  // online nodes, 1 without NUMA
+
+// Instrumentation
+// Per-op call counts, time and bytes touched (read + written), plus tensor
+// allocation counters. Each event costs one relaxed atomic add; a library
+// built with AGENT_ZERO_NO_STATS records nothing and reports zeros except
+// for the pool gauges. Counters are process-wide and cumulative.
+typedef enum {
+    AGENT_ZERO_OP_ATTENTION = 0,          // cognitive_attention_matrix(_into)
+    AGENT_ZERO_OP_META_TRANSFORM,
+    AGENT_ZERO_OP_HYPERGRAPH_ENCODING,
+    AGENT_ZERO_OP_PATTERN_MATCH,
+    AGENT_ZERO_OP_GRAPH_COMPUTE,
+    AGENT_ZERO_OP_CAST,
+    AGENT_ZERO_OP_ENCODE,                 // atomspace_to_tensor, encode_cognitive_state*
+    AGENT_ZERO_OP_DECODE,                 // tensor_to_atomspace, delta decodes
+    AGENT_ZERO_OP_ATTENTION_TENSOR,       // dense and packed attention matrices
+    AGENT_ZERO_OP_ATTENTION_MATVEC,
+    AGENT_ZERO_OP_SIMILARITY_HYPERGRAPH,  // create_hypergraph_from_atomspace
+    AGENT_ZERO_OP_HYPERGRAPH_TO_SPARSE,
+    AGENT_ZERO_OP_ATTENTION_DIFFUSION,    // attention_diffusion_compute/update
+    AGENT_ZERO_OP_ANN_INSERT,             // ann_index_add(_rows), per vector
+    AGENT_ZERO_OP_ANN_SEARCH,
+    AGENT_ZERO_OP_DELTA_ENCODE,           // tensor_delta_encode/decode
+    AGENT_ZERO_OP_DELTA_DECODE,
+    AGENT_ZERO_OP_COUNT
+} agent_zero_op_t;
+
+typedef struct {
+    uint64_t op_calls[AGENT_ZERO_OP_COUNT];
+    uint64_t op_nanoseconds[AGENT_ZERO_OP_COUNT];
+    uint64_t op_bytes[AGENT_ZERO_OP_COUNT];
+    uint64_t tensor_allocs;        // tensors created with their own data
+    uint64_t tensor_bytes;         // data bytes of those tensors
+    uint64_t arena_allocs;         // ... taken from a context arena
+    uint64_t pool_hits;            // ... served by a cached pool block
+    uint64_t pool_misses;          // ... that had to carve a new pool slab
+    uint64_t malloc_fallbacks;     // ... too large for the pool (heap)
+    uint64_t placed_allocs;        // ... placed by the placement policy
+    uint64_t pool_bytes_in_use;    // gauge: pool blocks currently handed out
+    uint64_t pool_peak_bytes;      // gauge: high-water mark of the above
+} agent_zero_stats_t;
+
+int agent_zero_stats_enabled(void);  // 0 when built with AGENT_ZERO_NO_STATS
+void agent_zero_get_stats(agent_zero_stats_t* stats);
+void agent_zero_reset_stats(void);   // counters only; gauges are kept
+const char* agent_zero_op_name(int op);
+
+// Trace hook, called on the calling thread after every instrumented op
+// with its span (CLOCK_MONOTONIC nanoseconds). NULL removes the hook.
+// Install it while no ops are running.
+typedef struct {
+    int op;
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint64_t bytes;
+} agent_zero_trace_span_t;
+
+typedef void (*agent_zero_trace_fn)(const agent_zero_trace_span_t* span, void* user);
+void agent_zero_set_trace_hook(agent_zero_trace_fn hook, void* user);
+
+// Profiling
+// Opt-in and deterministic: while active, every instrumented op above is
+// written to a Chrome trace file (Trace Event Format, "X" events stamped in
+// CLOCK_MONOTONIC microseconds) with its bytes, the tensor allocations made
+// inside it and, where perf_event_open is permitted, the calling thread's
+// hardware counters over the op. Tensor and context allocations and frees
+// become instant events. AGENT_ZERO_PROFILE=FILE in the environment
+// profiles the whole process with every flag. Costs two counter reads and
+// one locked write per op while active, one relaxed load when not.
+#define AGENT_ZERO_PROFILE_COUNTERS 0x1   // hardware counters per op
+#define AGENT_ZERO_PROFILE_ALLOCS   0x2   // allocation and free events
+#define AGENT_ZERO_PROFILE_ALL      0x3
+
+typedef enum {
+    AGENT_ZERO_COUNTER_CYCLES = 0,
+    AGENT_ZERO_COUNTER_INSTRUCTIONS,
+    AGENT_ZERO_COUNTER_LLC_MISSES,
+    AGENT_ZERO_COUNTER_BRANCH_MISSES,
+    AGENT_ZERO_COUNTER_COUNT
+} agent_zero_counter_t;
+
+// 0, or -1 if already profiling, the file cannot be created or the library
+// was built with AGENT_ZERO_NO_STATS
+int agent_zero_profile_start(const char* path, unsigned flags);
+// Completes and closes the file; returns the events written, -1 if idle
+int64_t agent_zero_profile_stop(void);
+int agent_zero_profile_active(void);
+// Counters (1 << agent_zero_counter_t) the calling thread can read
+int agent_zero_profile_counters(void);
+
 // Cognitive tensor operations
+// Planes along ne[2] and ne[3] are processed independently, as if each
+// were its own tensor.
 struct ggml_tensor* cognitive_attention_matrix(
     struct ggml_context* ctx,
     struct ggml_tensor* input,
     float attention_weight);
 
+// Elementwise ops accept any storage type and return a tensor of their
+// first operand's type; computation is f32 either way.
+//
+// Allocation-free variant: out = input weighted by the ECAN attention
+// pattern. out must have input's shape and may be input itself (in place).
+// Returns 0 on success, -1 on invalid arguments.
+int cognitive_attention_matrix_into(
+    struct ggml_tensor* out,
+    const struct ggml_tensor* input,
+    float attention_weight);
+
 struct ggml_tensor* hypergraph_encoding(
     struct ggml_context* ctx,
     struct ggml_tensor* nodes,
@@ -28,11 +269,55 @@ struct ggml_tensor* cognitive_pattern_match(
     struct ggml_tensor* pattern,
     struct ggml_tensor* data);
 
+// Pattern matching backends; AUTO picks by pattern size (direct for a few
+// taps, im2col + SGEMM for medium patterns, FFT for large ones)
+typedef enum {
+    COGNITIVE_MATCH_AUTO = 0,
+    COGNITIVE_MATCH_DIRECT,
+    COGNITIVE_MATCH_GEMM,
+    COGNITIVE_MATCH_FFT,
+} cognitive_match_backend_t;
+
+// Correlate a batch of ne[2] patterns (ne[0] x ne[1] each) against one 2D
+// data plane. Returns a data-shaped 3D tensor with one plane per pattern,
+// or NULL on invalid arguments.
+struct ggml_tensor* cognitive_pattern_match_batch(
+    struct ggml_context* ctx,
+    const struct ggml_tensor* patterns,
+    const struct ggml_tensor* data,
+    cognitive_match_backend_t backend);
+
 struct ggml_tensor* meta_cognitive_transform(
     struct ggml_context* ctx,
     struct ggml_tensor* input,
     int meta_level);
 
+// Deferred execution
+// Graph ops record nodes instead of computing. cognitive_graph_compute()
+// fuses every node an output depends on into one tiled pass over the
+// data; nodes without an output are never materialized. All nodes share
+// the shape of the first input. Node ids are returned, or -1 on invalid
+// arguments / allocation failure. Outputs must not overlap the inputs.
+typedef struct cognitive_graph cognitive_graph_t;
+
+cognitive_graph_t* create_cognitive_graph(void);
+void destroy_cognitive_graph(cognitive_graph_t* graph);
+void cognitive_graph_reset(cognitive_graph_t* graph);  // drop all nodes
+
+int cognitive_graph_input(cognitive_graph_t* graph, const struct ggml_tensor* tensor);
+int cognitive_graph_attention(cognitive_graph_t* graph, int src, float attention_weight);
+int cognitive_graph_meta_transform(cognitive_graph_t* graph, int src, int meta_level);
+int cognitive_graph_hypergraph_encoding(cognitive_graph_t* graph, int nodes, int links);
+
+// Materialize node into output (NULL unsets it), or into a new tensor
+int cognitive_graph_set_output(cognitive_graph_t* graph, int node, struct ggml_tensor* output);
+struct ggml_tensor* cognitive_graph_new_output(
+    struct ggml_context* ctx, cognitive_graph_t* graph, int node);
+
+// Evaluate all outputs; the graph can be recomputed after inputs change.
+// Matches the eager ops bit for bit when every operand is contiguous.
+int cognitive_graph_compute(cognitive_graph_t* graph);
+
 // Cognitive kernel structure
 typedef struct {
     struct ggml_tensor* tensor_field;
@@ -48,30 +333,258 @@ cognitive_kernel_t* create_cognitive_kernel(
     size_t shape_dims,
     float attention_weight);
 
+// Kernel whose tensor field is stored as type (e.g. GGML_TYPE_F16)
+cognitive_kernel_t* create_cognitive_kernel_typed(
+    struct ggml_context* ctx,
+    const int* shape,
+    size_t shape_dims,
+    float attention_weight,
+    int type);
+
 void destroy_cognitive_kernel(cognitive_kernel_t* kernel);
 
 int update_kernel_attention(cognitive_kernel_t* kernel, float new_weight);
 
 // Hypergraph encoding functions
+// Sparse hypergraph: each hyperedge is a set of node ids. Storage is
+// O(nodes + total edge arity), independent of node_count squared.
 typedef struct {
     size_t node_count;
-    size_t link_count;
-    float* node_weights;
-    float* link_weights;
-    int* adjacency_matrix;
+    size_t link_count;        // hyperedges added so far
+    float* node_weights;      // node_count entries
+    float* link_weights;      // one per hyperedge
+    // Edge -> node incidence (CSR): members of edge e are
+    // edge_nodes[edge_offsets[e] .. edge_offsets[e + 1])
+    size_t* edge_offsets;     // link_count + 1 entries
+    uint32_t* edge_nodes;
+    // Node -> edge incidence (CSR), valid while finalized is set: edges
+    // containing node v are node_edges[node_offsets[v] .. node_offsets[v + 1])
+    size_t* node_offsets;     // node_count + 1 entries
+    uint32_t* node_edges;
+    int finalized;
+    size_t link_capacity;
+    size_t incidence_capacity;
 } hypergraph_t;
 
+// link_count is a capacity hint; the hypergraph starts with no edges.
 hypergraph_t* create_hypergraph(size_t node_count, size_t link_count);
 void destroy_hypergraph(hypergraph_t* hg);
 
+// Append a hyperedge over arity distinct nodes. Returns the edge index, or
+// -1 on invalid node ids or allocation failure. Invalidates the node -> edge
+// index until the next hypergraph_finalize().
+int64_t hypergraph_add_edge(hypergraph_t* hg, const uint32_t* nodes, size_t arity, float weight);
+
+// Remove every hyperedge, keeping node weights and capacity
+void hypergraph_clear_edges(hypergraph_t* hg);
+
+// Build the node -> edge incidence index. Returns 0 on success, -1 on
+// allocation failure.
+int hypergraph_finalize(hypergraph_t* hg);
+
+// Compressed sparse row matrix of f32 values; column indices are sorted
+// and unique within each row
+typedef struct {
+    size_t rows;
+    size_t cols;
+    size_t nnz;
+    size_t* row_ptr;      // rows + 1 entries
+    uint32_t* col_idx;    // nnz entries
+    float* values;        // nnz entries
+} sparse_tensor_t;
+
+sparse_tensor_t* create_sparse_tensor(size_t rows, size_t cols, size_t nnz);
+void destroy_sparse_tensor(sparse_tensor_t* sp);
+
+// node_count x node_count weighted adjacency of the clique expansion: every
+// pair of nodes sharing a hyperedge gets (w_i + w_j) / 2, and single-node
+// edges mark the diagonal. The dense variant materializes the same matrix.
+sparse_tensor_t* encode_hypergraph_to_sparse(const hypergraph_t* hg);
+
 struct ggml_tensor* encode_hypergraph_to_tensor(
     struct ggml_context* ctx,
     const hypergraph_t* hg);
 
+// Replace hg's edges with one 2-node edge per adjacency entry above 0.5
+// (one per symmetric pair) and fold entry values into the node weights:
+// each positive entry (i, j) counts towards nodes i and j, and a node's
+// weight becomes the mean of its old weight and those entries, whatever
+// the traversal order. Returns 0 on success, -1 on invalid arguments or
+// allocation failure.
+int decode_sparse_to_hypergraph(
+    const sparse_tensor_t* sp,
+    hypergraph_t* hg);
+
 int decode_tensor_to_hypergraph(
     const struct ggml_tensor* tensor,
     hypergraph_t* hg);
 
+// Dense decode with the edge threshold as a parameter. The field is read
+// once: a SIMD compare-and-compress keeps the entries above threshold and
+// the node-weight reduction runs in the same row pass, spread over the
+// thread pool with results independent of the thread count. With entries,
+// *entries receives those kept entries as CSR (caller frees).
+int decode_tensor_to_hypergraph_threshold(
+    const struct ggml_tensor* tensor,
+    hypergraph_t* hg,
+    float threshold,
+    sparse_tensor_t** entries);
+
+// Entries of a 2D field above threshold as CSR, one row per tensor row
+sparse_tensor_t* tensor_to_sparse_threshold(const struct ggml_tensor* tensor, float threshold);
+
+// Attention diffusion
+// ECAN importance spreading over a hypergraph as a CSR matrix-vector
+// product. Each step, an atom whose STI exceeds focus_threshold and which
+// shares an edge with another atom gives spread_fraction of its STI to
+// its neighbours, split in proportion to the edge weight / (arity - 1)
+// they share. Total STI is conserved. The transfer matrix is built once:
+// rebuild the diffusion after editing the hypergraph's edges.
+typedef struct attention_diffusion attention_diffusion_t;
+
+// NULL on invalid arguments (spread_fraction outside [0, 1], a negative or
+// non-finite edge weight) or allocation failure. Atoms whose edges all
+// weigh 0 keep their STI.
+attention_diffusion_t* create_attention_diffusion(
+    const hypergraph_t* hg,
+    float spread_fraction,
+    float focus_threshold);
+void destroy_attention_diffusion(attention_diffusion_t* d);
+
+// Number of atoms, the length of the sti and result vectors
+size_t attention_diffusion_size(const attention_diffusion_t* d);
+
+// Move the focus threshold, e.g. as the attentional focus changes; the
+// next update after a change runs a full step. Returns 0, or -1 for NULL.
+int attention_diffusion_set_threshold(attention_diffusion_t* d, float focus_threshold);
+
+// One spreading step over every atom; result may alias sti. Returns 0, or
+// -1 on invalid arguments.
+int attention_diffusion_compute(attention_diffusion_t* d, const float* sti, float* result);
+
+// The same step after only the atoms in changed moved since the previous
+// compute or update: result must still hold that step's output, and only
+// the rows of the changed atoms and their neighbours are recomputed, giving
+// bit-identical values to a full compute. result must not alias sti; before
+// the first compute this runs one. Returns the number of rows recomputed,
+// or -1 on invalid arguments or node ids.
+int64_t attention_diffusion_update(attention_diffusion_t* d, const float* sti,
+                                   const uint32_t* changed, size_t n_changed, float* result);
+
+// Approximate nearest neighbour index
+// HNSW graph over fixed-length f32 rows (tensor rows, e.g. the node rows
+// of encode_hypergraph_to_tensor or a kernel's output), answering top-k
+// queries in about O(log n) distance evaluations. Row ids are assigned in
+// insertion order from 0. Searches may run concurrently with each other,
+// but not with inserts.
+typedef enum {
+    ANN_L2 = 0,       // squared Euclidean distance
+    ANN_COSINE = 1,   // 1 - cosine similarity
+} ann_metric_t;
+
+typedef struct ann_index ann_index_t;
+
+// m is the number of links per node (0 = 16, at most 128), ef_construction
+// the insert beam width (0 = 200); larger values trade build time for
+// recall. seed fixes the level draws, making builds reproducible.
+ann_index_t* create_ann_index(size_t dim, ann_metric_t metric, size_t m,
+                              size_t ef_construction, uint64_t seed);
+void destroy_ann_index(ann_index_t* index);
+
+size_t ann_index_size(const ann_index_t* index);
+size_t ann_index_dim(const ann_index_t* index);
+
+// Insert one dim-length vector; returns its id, or -1 on failure
+int64_t ann_index_add(ann_index_t* index, const float* vector);
+
+// Insert every row of a tensor with ne[1] == dim (any storage type or
+// strides); returns the first new id, or -1
+int64_t ann_index_add_rows(ann_index_t* index, const struct ggml_tensor* rows);
+
+// The k nearest rows to query, nearest first, into ids (and distances if
+// not NULL); slots past the result count get UINT32_MAX / INFINITY. ef is
+// the search beam (0 = 64, raised to k). Returns the number found.
+size_t ann_index_search(const ann_index_t* index, const float* query, size_t k, size_t ef,
+                        uint32_t* ids, float* distances);
+
+// One search per row of queries (ne[1] == dim), spread over the thread
+// pool; row q's results go to ids[q * k ...] and distances[q * k ...].
+// Returns 0, or -1 on invalid arguments or allocation failure.
+int ann_index_search_batch(const ann_index_t* index, const struct ggml_tensor* queries,
+                           size_t k, size_t ef, uint32_t* ids, float* distances);
+
+// Binary snapshots
+// A versioned little-endian file holding a hypergraph (optional) and the
+// tensor fields of n_kernels kernels, every section 64-byte aligned.
+// Opening maps the file copy-on-write: kernels and tensors returned from a
+// snapshot point into the mapping and must be released before it is
+// closed; writes to them never reach the file.
+#define COGNITIVE_SNAPSHOT_VERSION 1
+
+typedef struct cognitive_snapshot cognitive_snapshot_t;
+
+// Returns 0 on success, -1 on invalid arguments or I/O failure. The file
+// is written beside path and renamed into place.
+int cognitive_snapshot_save(const char* path, const hypergraph_t* hg,
+                            cognitive_kernel_t* const* kernels, size_t n_kernels);
+
+// Validates the header, section bounds and CSR indices; NULL if the file
+// is missing, truncated, corrupt or from another version
+cognitive_snapshot_t* cognitive_snapshot_open(const char* path);
+void cognitive_snapshot_close(cognitive_snapshot_t* snap);
+
+// Zero-copy view of the stored hypergraph, or NULL if none was saved.
+// It is read-only: never add edges to it or destroy it.
+const hypergraph_t* cognitive_snapshot_hypergraph(const cognitive_snapshot_t* snap);
+
+// Heap copy of the stored hypergraph, owned by the caller
+hypergraph_t* cognitive_snapshot_load_hypergraph(const cognitive_snapshot_t* snap);
+
+size_t cognitive_snapshot_kernel_count(const cognitive_snapshot_t* snap);
+
+// Tensor field of the index-th saved kernel, wrapping the mapped data
+struct ggml_tensor* cognitive_snapshot_tensor(
+    struct ggml_context* ctx, const cognitive_snapshot_t* snap, size_t index);
+
+// Kernel around cognitive_snapshot_tensor(); free with destroy_cognitive_kernel()
+cognitive_kernel_t* cognitive_snapshot_kernel(
+    struct ggml_context* ctx, const cognitive_snapshot_t* snap, size_t index);
+
+// Tensor deltas
+// A compact message carrying a tensor as its change from a base version
+// both peers hold: unchanged blocks of 64 storage words cost a few bits and
+// changed ones their XOR with the base, byte by byte. step > 0 (F32 only)
+// quantizes instead: words move by whole steps and changes below step / 2
+// wait for a later message. The encoder advances base to exactly what the
+// decoder will compute, so peers stay bit-identical. Tensors must be
+// contiguous; messages are little-endian.
+#define TENSOR_DELTA_VERSION 1
+
+typedef struct {
+    float step;        // quantization step, 0 for lossless
+    int keyframe;      // encode against zeros, applying to any tensor of the shape
+    int zstd_level;    // > 0: zstd-frame the body if built with zstd and it shrinks
+} tensor_delta_options_t;
+
+// Bytes tensor_delta_encode may write for t, 0 if t cannot be encoded
+size_t tensor_delta_bound(const struct ggml_tensor* t);
+
+// Encodes current as a delta over base (same type and shape) into out,
+// which must hold tensor_delta_bound(current) bytes, and moves base to
+// the decoded result. opts may be NULL (lossless, no keyframe). Returns the
+// message size, or -1 on invalid arguments.
+int64_t tensor_delta_encode(const struct ggml_tensor* current, struct ggml_tensor* base,
+                            const tensor_delta_options_t* opts, void* out, size_t out_size);
+
+// Applies a message in place; target must hold the message's base (any
+// contents for a keyframe). Unframed messages are read straight from data.
+// Returns 0, or -1 with target untouched if the message is truncated,
+// corrupt, for another shape or base, or zstd-framed without zstd support.
+int tensor_delta_decode(struct ggml_tensor* target, const void* data, size_t size);
+
+// 1 if this build can write and read zstd-framed messages
+int tensor_delta_zstd_available(void);
+
 #ifdef __cplusplus
 }
 #endif
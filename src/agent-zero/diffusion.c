@@ -0,0 +1,277 @@
+// Agent-Zero Attention Diffusion
+// /src/agent-zero/diffusion.c
+//
+// ECAN importance spreading as a sparse matrix-vector product. The clique
+// expansion of the hypergraph is symmetric, so row i of the CSR transfer
+// matrix lists exactly the neighbours j that spread into i, carrying the
+// share P_ij of j's outflow; each row is one SIMD gather-dot and rows are
+// independent, so the product splits across the thread pool without
+// atomics and gives the same result at any thread count.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cognitive-internal.h"
+
+struct attention_diffusion {
+    sparse_tensor_t* transfer;  // P_ij in row i, column j
+    float spread_fraction;
+    float focus_threshold;
+    int primed;                 // outflow holds the last evaluated sti
+    float* outflow;             // per-atom amount spread, cached
+    uint8_t* can_spread;        // atoms with at least one neighbour
+    uint32_t* frontier;
+    uint32_t* stamp;            // frontier dedupe, one epoch per update
+    uint32_t epoch;
+};
+
+typedef struct {
+    uint32_t col;
+    float weight;
+} transfer_entry_t;
+
+static int compare_transfer_entries(const void* a, const void* b) {
+    uint32_t x = ((const transfer_entry_t*)a)->col;
+    uint32_t y = ((const transfer_entry_t*)b)->col;
+    return (x > y) - (x < y);
+}
+
+// Symmetric adjacency a_ij = sum over shared edges of weight / (arity - 1),
+// each row then scaled so column j's entries sum to 1 (a_ij / deg_j). A
+// column whose edges all weigh 0 has nothing to scale and spreads nothing.
+static sparse_tensor_t* build_transfer(const hypergraph_t* hg, uint8_t* can_spread) {
+    size_t n = hg->node_count;
+    size_t* counts = calloc(n + 1, sizeof(size_t));
+    if (!counts) return NULL;
+    size_t pairs = 0;
+    for (size_t e = 0; e < hg->link_count; e++) {
+        size_t arity = hg->edge_offsets[e + 1] - hg->edge_offsets[e];
+        if (arity < 2) continue;
+        for (size_t a = hg->edge_offsets[e]; a < hg->edge_offsets[e + 1]; a++) {
+            counts[hg->edge_nodes[a]] += arity - 1;
+        }
+        pairs += arity * (arity - 1);
+    }
+
+    transfer_entry_t* entries = malloc((pairs ? pairs : 1) * sizeof(transfer_entry_t));
+    size_t* cursor = malloc((n + 1) * sizeof(size_t));
+    double* degree = calloc(n + 1, sizeof(double));
+    sparse_tensor_t* sp = NULL;
+    if (entries && cursor && degree) {
+        size_t offset = 0;
+        for (size_t i = 0; i < n; i++) {
+            cursor[i] = offset;
+            offset += counts[i];
+        }
+        for (size_t e = 0; e < hg->link_count; e++) {
+            size_t begin = hg->edge_offsets[e];
+            size_t end = hg->edge_offsets[e + 1];
+            if (end - begin < 2) continue;
+            float share = hg->link_weights[e] / (float)(end - begin - 1);
+            for (size_t a = begin; a < end; a++) {
+                for (size_t b = begin; b < end; b++) {
+                    if (a == b) continue;
+                    transfer_entry_t* entry = &entries[cursor[hg->edge_nodes[a]]++];
+                    entry->col = hg->edge_nodes[b];
+                    entry->weight = share;
+                }
+            }
+        }
+
+        // Merge duplicate neighbours, then count the merged rows
+        size_t nnz = 0;
+        size_t row_begin = 0;
+        for (size_t i = 0; i < n; i++) {
+            transfer_entry_t* row = entries + row_begin;
+            qsort(row, counts[i], sizeof(transfer_entry_t), compare_transfer_entries);
+            size_t merged = 0;
+            for (size_t k = 0; k < counts[i]; k++) {
+                if (merged && row[merged - 1].col == row[k].col) {
+                    row[merged - 1].weight += row[k].weight;
+                } else {
+                    row[merged++] = row[k];
+                }
+                degree[i] += row[k].weight;
+            }
+            row_begin += counts[i];
+            cursor[i] = merged;
+            nnz += merged;
+        }
+
+        sp = create_sparse_tensor(n, n, nnz);
+        if (sp) {
+            row_begin = 0;
+            size_t out = 0;
+            for (size_t i = 0; i < n; i++) {
+                sp->row_ptr[i] = out;
+                for (size_t k = 0; k < cursor[i]; k++) {
+                    const transfer_entry_t* entry = &entries[row_begin + k];
+                    sp->col_idx[out] = entry->col;
+                    double deg = degree[entry->col];
+                    sp->values[out] = deg > 0.0 ? (float)(entry->weight / deg) : 0.0f;
+                    out++;
+                }
+                row_begin += counts[i];
+                can_spread[i] = degree[i] > 0.0;
+            }
+            sp->row_ptr[n] = out;
+        }
+    }
+
+    free(counts);
+    free(entries);
+    free(cursor);
+    free(degree);
+    return sp;
+}
+
+attention_diffusion_t* create_attention_diffusion(
+    const hypergraph_t* hg,
+    float spread_fraction,
+    float focus_threshold) {
+
+    if (!hg || hg->node_count > UINT32_MAX || !(spread_fraction >= 0.0f && spread_fraction <= 1.0f)) {
+        return NULL;
+    }
+    for (size_t e = 0; e < hg->link_count; e++) {
+        if (!(hg->link_weights[e] >= 0.0f) || isinf(hg->link_weights[e])) return NULL;
+    }
+
+    attention_diffusion_t* d = calloc(1, sizeof(attention_diffusion_t));
+    if (!d) return NULL;
+    size_t n = hg->node_count;
+    d->spread_fraction = spread_fraction;
+    d->focus_threshold = focus_threshold;
+    d->outflow = calloc(n + 1, sizeof(float));
+    d->can_spread = calloc(n + 1, 1);
+    d->frontier = malloc((n + 1) * sizeof(uint32_t));
+    d->stamp = calloc(n + 1, sizeof(uint32_t));
+    if (d->outflow && d->can_spread && d->frontier && d->stamp) {
+        d->transfer = build_transfer(hg, d->can_spread);
+    }
+    if (!d->transfer) {
+        destroy_attention_diffusion(d);
+        return NULL;
+    }
+    return d;
+}
+
+void destroy_attention_diffusion(attention_diffusion_t* d) {
+    if (d) {
+        destroy_sparse_tensor(d->transfer);
+        free(d->outflow);
+        free(d->can_spread);
+        free(d->frontier);
+        free(d->stamp);
+        free(d);
+    }
+}
+
+size_t attention_diffusion_size(const attention_diffusion_t* d) {
+    return d ? d->transfer->rows : 0;
+}
+
+int attention_diffusion_set_threshold(attention_diffusion_t* d, float focus_threshold) {
+    if (!d) return -1;
+    if (focus_threshold != d->focus_threshold) {
+        // Cached outflow used the old threshold
+        d->focus_threshold = focus_threshold;
+        d->primed = 0;
+    }
+    return 0;
+}
+
+static float atom_outflow(const attention_diffusion_t* d, size_t i, float sti) {
+    return d->can_spread[i] && sti > d->focus_threshold ? sti * d->spread_fraction : 0.0f;
+}
+
+typedef struct {
+    const attention_diffusion_t* d;
+    const float* sti;
+    float* result;
+    const uint32_t* rows;   // NULL: rows are the range itself
+} diffusion_job_t;
+
+static void diffuse_rows(int64_t begin, int64_t end, void* arg) {
+    const diffusion_job_t* job = arg;
+    const sparse_tensor_t* p = job->d->transfer;
+    const simd_kernels_t* simd = simd_kernels();
+    for (int64_t r = begin; r < end; r++) {
+        size_t i = job->rows ? job->rows[r] : (size_t)r;
+        size_t k = p->row_ptr[i];
+        float inflow = simd->gather_dot(p->values + k, p->col_idx + k, job->d->outflow,
+                                        (int64_t)(p->row_ptr[i + 1] - k));
+        job->result[i] = job->sti[i] - job->d->outflow[i] + inflow;
+    }
+}
+
+static void compute_outflow(int64_t begin, int64_t end, void* arg) {
+    const diffusion_job_t* job = arg;
+    attention_diffusion_t* d = (attention_diffusion_t*)job->d;
+    for (int64_t i = begin; i < end; i++) {
+        d->outflow[i] = atom_outflow(d, (size_t)i, job->sti[i]);
+    }
+}
+
+static int64_t row_grain(const attention_diffusion_t* d) {
+    size_t rows = d->transfer->rows;
+    return parallel_grain(rows ? 1 + (int64_t)(d->transfer->nnz / rows) : 1);
+}
+
+int attention_diffusion_compute(attention_diffusion_t* d, const float* sti, float* result) {
+    if (!d || !sti || !result) return -1;
+    size_t n = d->transfer->rows;
+    diffusion_job_t job = { d, sti, result, NULL };
+
+    STATS_SPAN_BEGIN(span);
+    // The outflow is complete before any row reads it, so result may be sti
+    parallel_for((int64_t)n, parallel_grain(1), compute_outflow, &job);
+    parallel_for((int64_t)n, row_grain(d), diffuse_rows, &job);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_DIFFUSION,
+                   d->transfer->nnz * (sizeof(uint32_t) + 2 * sizeof(float)) + 3 * n * sizeof(float));
+    d->primed = 1;
+    return 0;
+}
+
+int64_t attention_diffusion_update(attention_diffusion_t* d, const float* sti,
+                                   const uint32_t* changed, size_t n_changed, float* result) {
+    if (!d || !sti || !result || result == sti || (!changed && n_changed)) return -1;
+    if (!d->primed) {
+        return attention_diffusion_compute(d, sti, result) == 0 ? (int64_t)d->transfer->rows : -1;
+    }
+    size_t n = d->transfer->rows;
+    const sparse_tensor_t* p = d->transfer;
+    for (size_t c = 0; c < n_changed; c++) {
+        if (changed[c] >= n) return -1;
+    }
+
+    if (++d->epoch == 0) {
+        // Stamps wrapped; start the epochs over
+        memset(d->stamp, 0, n * sizeof(uint32_t));
+        d->epoch = 1;
+    }
+
+    // Frontier: the changed atoms and every neighbour they spread into
+    STATS_SPAN_BEGIN(span);
+    size_t count = 0;
+    for (size_t c = 0; c < n_changed; c++) {
+        uint32_t j = changed[c];
+        d->outflow[j] = atom_outflow(d, j, sti[j]);
+        if (d->stamp[j] != d->epoch) {
+            d->stamp[j] = d->epoch;
+            d->frontier[count++] = j;
+        }
+        for (size_t k = p->row_ptr[j]; k < p->row_ptr[j + 1]; k++) {
+            uint32_t i = p->col_idx[k];
+            if (d->stamp[i] != d->epoch) {
+                d->stamp[i] = d->epoch;
+                d->frontier[count++] = i;
+            }
+        }
+    }
+
+    diffusion_job_t job = { d, sti, result, d->frontier };
+    parallel_for((int64_t)count, row_grain(d), diffuse_rows, &job);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_DIFFUSION, count * 3 * sizeof(float));
+    return (int64_t)count;
+}
@@ -0,0 +1,158 @@
+// Agent-Zero Epoch-Based Reclamation
+// /src/agent-zero/epoch.c
+//
+// Readers announce the global epoch they entered at in a per-thread record;
+// a writer that unpublishes a block stamps it with the epoch it bumped the
+// global counter from. The block is freed once every reader still inside a
+// section announced a later epoch, since those readers entered after the
+// block stopped being reachable. Records are claimed on a thread's first
+// read section and released for reuse when the thread exits.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include "cognitive-internal.h"
+
+typedef struct epoch_record {
+    _Atomic uint64_t epoch;        // announced epoch, 0 when quiescent
+    atomic_int claimed;
+    struct epoch_record* next;
+} epoch_record_t;
+
+static _Atomic uint64_t global_epoch = 1;
+static _Atomic(epoch_record_t*) records;
+
+// Thread-exit release of the record
+static pthread_key_t record_key;
+static pthread_once_t record_once = PTHREAD_ONCE_INIT;
+static int record_key_ok;
+
+// Threads that cannot get a record fall back to one shared record, held
+// under a lock for the whole section
+static epoch_record_t fallback_record;
+static pthread_mutex_t fallback_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static _Thread_local epoch_record_t* local_record;
+static _Thread_local unsigned local_depth;
+static _Thread_local int local_fallback;
+
+static void release_record(void* record) {
+    atomic_store(&((epoch_record_t*)record)->claimed, 0);
+    if (local_record == record) local_record = NULL;
+}
+
+static void make_record_key(void) {
+    record_key_ok = pthread_key_create(&record_key, release_record) == 0;
+}
+
+static epoch_record_t* claim_record(void) {
+    pthread_once(&record_once, make_record_key);
+    if (!record_key_ok) return NULL;
+    for (epoch_record_t* r = atomic_load(&records); r; r = r->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&r->claimed, &expected, 1)) return r;
+    }
+    epoch_record_t* r = calloc(1, sizeof(epoch_record_t));
+    if (!r) return NULL;
+    atomic_store(&r->claimed, 1);
+    r->next = atomic_load(&records);
+    while (!atomic_compare_exchange_weak(&records, &r->next, r)) {
+    }
+    return r;
+}
+
+void epoch_enter(void) {
+    if (local_depth++) return;
+    if (!local_record) {
+        local_record = claim_record();
+        if (local_record && pthread_setspecific(record_key, local_record) != 0) {
+            release_record(local_record);
+            local_record = NULL;
+        }
+    }
+    epoch_record_t* r = local_record;
+    local_fallback = r == NULL;
+    if (local_fallback) {
+        pthread_mutex_lock(&fallback_lock);
+        r = &fallback_record;
+    }
+    // Sequentially consistent: a writer that misses this store published
+    // its replacement before the reader's next load
+    atomic_store(&r->epoch, atomic_load(&global_epoch));
+}
+
+void epoch_exit(void) {
+    if (--local_depth) return;
+    if (local_fallback) {
+        atomic_store(&fallback_record.epoch, 0);
+        pthread_mutex_unlock(&fallback_lock);
+    } else {
+        atomic_store(&local_record->epoch, 0);
+    }
+}
+
+// Oldest epoch a reader may still be using
+static uint64_t oldest_reader(void) {
+    uint64_t oldest = atomic_load(&fallback_record.epoch);
+    if (!oldest) oldest = UINT64_MAX;
+    for (epoch_record_t* r = atomic_load(&records); r; r = r->next) {
+        uint64_t e = atomic_load(&r->epoch);
+        if (e && e < oldest) oldest = e;
+    }
+    return oldest;
+}
+
+void epoch_stage(epoch_list_t* list, epoch_node_t* node, void* ptr) {
+    node->ptr = ptr;
+    node->next = list->staged;
+    list->staged = node;
+}
+
+void epoch_retire(epoch_list_t* list) {
+    if (list->staged) {
+        uint64_t stamp = atomic_fetch_add(&global_epoch, 1);
+        while (list->staged) {
+            epoch_node_t* node = list->staged;
+            list->staged = node->next;
+            node->epoch = stamp;
+            node->next = list->retired;
+            list->retired = node;
+        }
+    }
+    if (!list->retired) return;
+
+    uint64_t oldest = oldest_reader();
+    for (epoch_node_t** link = &list->retired; *link;) {
+        epoch_node_t* node = *link;
+        if (node->epoch < oldest) {
+            *link = node->next;
+            if (list->reclaim) {
+                list->reclaim(node->ptr, list->reclaim_user);
+            } else {
+                free(node->ptr);
+            }
+        } else {
+            link = &node->next;
+        }
+    }
+}
+
+void epoch_synchronize(void) {
+    uint64_t stamp = atomic_fetch_add(&global_epoch, 1);
+    while (oldest_reader() <= stamp) {
+        sched_yield();
+    }
+}
+
+void epoch_drain(epoch_list_t* list) {
+    epoch_node_t* lists[] = { list->staged, list->retired };
+    for (size_t l = 0; l < 2; l++) {
+        while (lists[l]) {
+            epoch_node_t* node = lists[l];
+            lists[l] = node->next;
+            free(node->ptr);
+        }
+    }
+    list->staged = NULL;
+    list->retired = NULL;
+}
@@ -0,0 +1,401 @@
+// Agent-Zero Tensor Context Arena
+// /src/agent-zero/ggml-context.c
+//
+// A context owns one fixed-size buffer. Tensor headers and data are
+// bump-allocated from it, and ggml_context_reset() drops every tensor
+// created since the last reset in O(1). Without an arena (NULL context or
+// zero budget) tensors come from the heap, normally via the size-classed
+// pool in tensor-pool.c, and are freed individually. Large arenas and heap
+// tensors follow the NUMA placement policy (placement.c).
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cognitive-internal.h"
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+struct ggml_context* ggml_context_create(size_t mem_size) {
+    struct ggml_context* ctx = malloc(sizeof(struct ggml_context));
+    if (!ctx) return NULL;
+
+    ctx->mem_buffer = NULL;
+    ctx->mem_size = 0;
+    ctx->mem_used = 0;
+    ctx->owns_buffer = 0;
+    ctx->placed = 0;
+
+    if (mem_size > 0) {
+        mem_size = align_up(mem_size, GGML_MEM_ALIGN);
+        ctx->mem_buffer = placement_alloc(mem_size, 1);
+        ctx->placed = ctx->mem_buffer != NULL;
+        if (!ctx->mem_buffer) {
+            ctx->mem_buffer = aligned_alloc(GGML_MEM_ALIGN, mem_size);
+        }
+        if (!ctx->mem_buffer) {
+            free(ctx);
+            return NULL;
+        }
+        ctx->mem_size = mem_size;
+        ctx->owns_buffer = 1;
+        STATS_ALLOC_EVENT(PROFILE_ALLOC_CONTEXT, ctx->mem_buffer, mem_size);
+    }
+
+    return ctx;
+}
+
+void ggml_context_reset(struct ggml_context* ctx) {
+    if (ctx) {
+        ctx->mem_used = 0;
+    }
+}
+
+void ggml_context_free(struct ggml_context* ctx) {
+    if (ctx) {
+        if (ctx->owns_buffer) STATS_FREE_EVENT(PROFILE_ALLOC_CONTEXT, ctx->mem_buffer);
+        if (ctx->placed) {
+            placement_free(ctx->mem_buffer);
+        } else if (ctx->owns_buffer) {
+            free(ctx->mem_buffer);
+        }
+        free(ctx);
+    }
+}
+
+size_t ggml_context_used(const struct ggml_context* ctx) {
+    return ctx ? ctx->mem_used : 0;
+}
+
+size_t ggml_tensor_overhead(void) {
+    return align_up(sizeof(struct ggml_tensor), GGML_HEADER_ALIGN) + GGML_MEM_ALIGN;
+}
+
+void* ggml_context_alloc(struct ggml_context* ctx, size_t size, size_t align) {
+    if (!ctx || !ctx->mem_buffer) return NULL;
+
+    // Align the absolute address so callers' alignment holds regardless of
+    // how the backing buffer itself was aligned
+    uintptr_t base = (uintptr_t)ctx->mem_buffer;
+    size_t offset = align_up(base + ctx->mem_used, align) - base;
+    if (offset > ctx->mem_size || size > ctx->mem_size - offset) {
+        return NULL;  // Budget exhausted
+    }
+
+    ctx->mem_used = offset + size;
+    return (char*)ctx->mem_buffer + offset;
+}
+
+void ggml_tensor_init(struct ggml_tensor* tensor, int type, int n_dims, const int* ne, void* data) {
+    tensor->type = type;
+    tensor->data = data;
+    tensor->flags = 0;
+    tensor->view_src = NULL;
+    tensor->view_offs = 0;
+    tensor->release = NULL;
+    tensor->release_user = NULL;
+    for (int d = 0; d < GGML_MAX_DIMS; d++) {
+        tensor->ne[d] = d < n_dims ? ne[d] : 1;
+    }
+
+    // ne[1] is the innermost dimension, then ne[0], ne[2], ne[3]; for
+    // block types nb[1] is the stride between blocks
+    tensor->nb[1] = ggml_type_size(type);
+    tensor->nb[0] = ggml_row_size(type, tensor->ne[1]);
+    tensor->nb[2] = tensor->nb[0] * (size_t)tensor->ne[0];
+    tensor->nb[3] = tensor->nb[2] * (size_t)tensor->ne[2];
+}
+
+// Allocate a header, plus data_size bytes of data when data_size > 0
+static struct ggml_tensor* new_tensor_header(struct ggml_context* ctx, size_t data_size, int with_data) {
+    struct ggml_tensor* tensor;
+
+    if (ctx && ctx->mem_buffer) {
+        // Arena path: header and data share the context lifetime
+        size_t mark = ctx->mem_used;
+        tensor = ggml_context_alloc(ctx, sizeof(struct ggml_tensor), GGML_HEADER_ALIGN);
+        void* data = (tensor && with_data) ? ggml_context_alloc(ctx, data_size, GGML_MEM_ALIGN) : NULL;
+        if (!tensor || (with_data && !data)) {
+            ctx->mem_used = mark;
+            return NULL;
+        }
+        tensor->data = data;
+        tensor->flags = GGML_TENSOR_FLAG_CTX;
+        STATS_ADD(STAT_ARENA_ALLOCS, 1);
+        if (with_data) {
+            STATS_ADD(STAT_TENSOR_ALLOCS, 1);
+            STATS_ADD(STAT_TENSOR_BYTES, data_size);
+        }
+        STATS_ALLOC_EVENT(PROFILE_ALLOC_ARENA, tensor, with_data ? data_size : 0);
+        return tensor;
+    }
+
+    // Heap path: one block holds the header followed by the data, taken
+    // from the size-classed pool when it fits, or placed when it is large
+    size_t header_size = align_up(sizeof(struct ggml_tensor), GGML_MEM_ALIGN);
+    size_t total_size = with_data ? header_size + data_size : sizeof(struct ggml_tensor);
+    int size_class = -1;
+    int flags = 0;
+    char* block = NULL;
+    if (with_data && data_size >= PLACEMENT_MIN_BYTES) {
+        block = placement_alloc(total_size, 0);
+        if (block) {
+            flags = GGML_TENSOR_FLAG_PLACED;
+            STATS_ADD(STAT_PLACED_ALLOCS, 1);
+        }
+    }
+    if (!block) {
+        block = tensor_pool_alloc(total_size, &size_class);
+        flags = size_class >= 0 ? GGML_TENSOR_FLAG_POOL | (size_class << GGML_TENSOR_POOL_SHIFT) : 0;
+    }
+    if (!block) {
+        block = aligned_alloc(GGML_MEM_ALIGN, align_up(total_size, GGML_MEM_ALIGN));
+        flags = 0;
+        if (block) STATS_ADD(STAT_MALLOC_FALLBACKS, 1);
+    }
+    if (!block) return NULL;
+    if (with_data) {
+        STATS_ADD(STAT_TENSOR_ALLOCS, 1);
+        STATS_ADD(STAT_TENSOR_BYTES, data_size);
+    }
+    STATS_ALLOC_EVENT((flags & GGML_TENSOR_FLAG_POOL) ? PROFILE_ALLOC_POOL
+                      : (flags & GGML_TENSOR_FLAG_PLACED) ? PROFILE_ALLOC_PLACED : PROFILE_ALLOC_HEAP,
+                      block, with_data ? data_size : 0);
+
+    tensor = (struct ggml_tensor*)block;
+    tensor->data = with_data ? block + header_size : NULL;
+    tensor->flags = flags;
+    return tensor;
+}
+
+// Shape usable with type: known type, rows made of whole blocks
+static int valid_shape(int type, int n_dims, const int* ne) {
+    if (!ne || n_dims < 1 || n_dims > GGML_MAX_DIMS || !ggml_get_type_traits(type)) return 0;
+    for (int d = 0; d < n_dims; d++) {
+        if (ne[d] < 0) return 0;
+    }
+    int row_len = n_dims > 1 ? ne[1] : 1;
+    return row_len % ggml_blck_size(type) == 0;
+}
+
+struct ggml_tensor* ggml_new_tensor(struct ggml_context* ctx, int type, int n_dims, const int* ne) {
+    if (!valid_shape(type, n_dims, ne)) return NULL;
+
+    size_t rows = 1;
+    for (int d = 0; d < n_dims; d++) {
+        if (d != 1) rows *= (size_t)ne[d];
+    }
+    size_t data_size = rows * ggml_row_size(type, n_dims > 1 ? ne[1] : 1);
+
+    struct ggml_tensor* tensor = new_tensor_header(ctx, data_size, 1);
+    if (!tensor) return NULL;
+
+    int flags = tensor->flags;
+    ggml_tensor_init(tensor, type, n_dims, ne, tensor->data);
+    tensor->flags = flags;
+    // Placed blocks arrive zeroed; under PARTITIONED the rows are touched
+    // now, by the threads that will work on them
+    if (!(flags & GGML_TENSOR_FLAG_PLACED)) {
+        memset(tensor->data, 0, data_size);
+    } else if (placement_partitioned()) {
+        placement_touch(tensor->data, rows, data_size / rows);
+    }
+
+    return tensor;
+}
+
+struct ggml_tensor* ggml_new_tensor_1d(struct ggml_context* ctx, int type, int ne0) {
+    int ne[1] = {ne0};
+    return ggml_new_tensor(ctx, type, 1, ne);
+}
+
+struct ggml_tensor* ggml_new_tensor_2d(struct ggml_context* ctx, int type, int ne0, int ne1) {
+    int ne[2] = {ne0, ne1};
+    return ggml_new_tensor(ctx, type, 2, ne);
+}
+
+struct ggml_tensor* ggml_new_tensor_3d(struct ggml_context* ctx, int type, int ne0, int ne1, int ne2) {
+    int ne[3] = {ne0, ne1, ne2};
+    return ggml_new_tensor(ctx, type, 3, ne);
+}
+
+struct ggml_tensor* ggml_new_tensor_4d(struct ggml_context* ctx, int type, int ne0, int ne1, int ne2, int ne3) {
+    int ne[4] = {ne0, ne1, ne2, ne3};
+    return ggml_new_tensor(ctx, type, 4, ne);
+}
+
+// Byte span [0, extent) addressed by a tensor's shape and strides
+struct ggml_tensor* ggml_tensor_wrap(struct ggml_context* ctx, int type, int n_dims,
+                                     const int* ne, void* data) {
+    if (!data || !valid_shape(type, n_dims, ne)) return NULL;
+
+    struct ggml_tensor* tensor = new_tensor_header(ctx, 0, 0);
+    if (!tensor) return NULL;
+
+    int flags = tensor->flags;
+    ggml_tensor_init(tensor, type, n_dims, ne, data);
+    tensor->flags = flags | GGML_TENSOR_FLAG_VIEW;
+    return tensor;
+}
+
+struct ggml_tensor* ggml_new_tensor_from_buffer(
+    struct ggml_context* ctx, int type, int n_dims, const int* ne, const size_t* nb,
+    void* data, ggml_tensor_release_fn release, void* user) {
+
+    if (!data || (release && ctx) || !valid_shape(type, n_dims, ne)) return NULL;
+    // Elements must be addressable as their scalar type
+    size_t align = type == GGML_TYPE_F32 ? sizeof(float) : sizeof(uint16_t);
+    if ((uintptr_t)data % align != 0) return NULL;
+
+    struct ggml_tensor layout;
+    ggml_tensor_init(&layout, type, n_dims, ne, data);
+    if (nb) {
+        for (int d = 0; d < n_dims; d++) {
+            layout.nb[d] = nb[d];
+        }
+        // Dimensions past n_dims have size 1 and dense strides
+        if (n_dims < 3) layout.nb[2] = layout.nb[0] * (size_t)layout.ne[0];
+        if (n_dims < 4) layout.nb[3] = layout.nb[2] * (size_t)layout.ne[2];
+        if (n_dims < 2) layout.nb[1] = ggml_type_size(type);
+        if (layout.nb[1] != ggml_type_size(type) ||
+            layout.nb[0] < ggml_row_size(type, layout.ne[1]) ||
+            layout.nb[2] < layout.nb[0] * (size_t)layout.ne[0] ||
+            layout.nb[3] < layout.nb[2] * (size_t)layout.ne[2]) {
+            return NULL;
+        }
+    }
+
+    struct ggml_tensor* tensor = new_tensor_header(ctx, 0, 0);
+    if (!tensor) return NULL;
+
+    int flags = tensor->flags;
+    *tensor = layout;
+    tensor->flags = flags | GGML_TENSOR_FLAG_VIEW;
+    tensor->release = release;
+    tensor->release_user = user;
+    return tensor;
+}
+
+float* ggml_borrow_f32(const struct ggml_tensor* tensor, int64_t* n) {
+    if (!tensor || tensor->type != GGML_TYPE_F32 || !tensor->data || !ggml_is_contiguous(tensor)) {
+        if (n) *n = 0;
+        return NULL;
+    }
+    if (n) *n = ggml_nelements(tensor);
+    return (float*)tensor->data;
+}
+
+static size_t tensor_extent(const struct ggml_tensor* t) {
+    if (ggml_nelements(t) == 0) return 0;
+    size_t extent = ggml_row_size(t->type, t->ne[1]);
+    for (int d = 0; d < GGML_MAX_DIMS; d++) {
+        if (d != 1) extent += (size_t)(t->ne[d] - 1) * t->nb[d];
+    }
+    return extent;
+}
+
+struct ggml_tensor* ggml_view_4d(
+    struct ggml_context* ctx,
+    struct ggml_tensor* parent,
+    int ne0, int ne1, int ne2, int ne3,
+    size_t nb0, size_t nb2, size_t nb3,
+    size_t offset) {
+
+    int ne[4] = {ne0, ne1, ne2, ne3};
+    if (!parent || !parent->data || !valid_shape(parent->type, 4, ne)) return NULL;
+
+    struct ggml_tensor view;
+    ggml_tensor_init(&view, parent->type, 4, ne, NULL);
+    view.nb[0] = nb0;
+    view.nb[2] = nb2;
+    view.nb[3] = nb3;
+
+    // Views may only address memory inside the parent's span
+    size_t extent = tensor_extent(&view);
+    size_t parent_extent = tensor_extent(parent);
+    if (offset > parent_extent || extent > parent_extent - offset) return NULL;
+
+    struct ggml_tensor* tensor = new_tensor_header(ctx, 0, 0);
+    if (!tensor) return NULL;
+
+    int flags = tensor->flags;
+    *tensor = view;
+    tensor->flags = flags | GGML_TENSOR_FLAG_VIEW;
+    tensor->data = (char*)parent->data + offset;
+    tensor->view_src = parent->view_src ? parent->view_src : parent;
+    tensor->view_offs = parent->view_offs + offset;
+
+    return tensor;
+}
+
+struct ggml_tensor* ggml_view_2d(
+    struct ggml_context* ctx,
+    struct ggml_tensor* parent,
+    int ne0, int ne1,
+    size_t nb0,
+    size_t offset) {
+
+    size_t nb2 = nb0 * (size_t)ne0;
+    return ggml_view_4d(ctx, parent, ne0, ne1, 1, 1, nb0, nb2, nb2, offset);
+}
+
+struct ggml_tensor* ggml_view_3d(
+    struct ggml_context* ctx,
+    struct ggml_tensor* parent,
+    int ne0, int ne1, int ne2,
+    size_t nb0, size_t nb2,
+    size_t offset) {
+
+    return ggml_view_4d(ctx, parent, ne0, ne1, ne2, 1, nb0, nb2, nb2 * (size_t)ne2, offset);
+}
+
+int64_t ggml_nelements(const struct ggml_tensor* tensor) {
+    if (!tensor) return 0;
+    return (int64_t)tensor->ne[0] * tensor->ne[1] * tensor->ne[2] * tensor->ne[3];
+}
+
+int64_t ggml_nrows(const struct ggml_tensor* tensor) {
+    if (!tensor) return 0;
+    return (int64_t)tensor->ne[0] * tensor->ne[2] * tensor->ne[3];
+}
+
+int ggml_is_contiguous(const struct ggml_tensor* tensor) {
+    if (!tensor) return 0;
+    return tensor->nb[1] == ggml_type_size(tensor->type) &&
+           tensor->nb[0] == ggml_row_size(tensor->type, tensor->ne[1]) &&
+           tensor->nb[2] == tensor->nb[0] * (size_t)tensor->ne[0] &&
+           tensor->nb[3] == tensor->nb[2] * (size_t)tensor->ne[2];
+}
+
+int ggml_get_ne(const struct ggml_tensor* tensor, int dim) {
+    return (tensor && dim >= 0 && dim < GGML_MAX_DIMS) ? tensor->ne[dim] : 0;
+}
+
+size_t ggml_get_nb(const struct ggml_tensor* tensor, int dim) {
+    return (tensor && dim >= 0 && dim < GGML_MAX_DIMS) ? tensor->nb[dim] : 0;
+}
+
+float* ggml_get_data_f32(const struct ggml_tensor* tensor) {
+    return tensor && tensor->type == GGML_TYPE_F32 ? (float*)tensor->data : NULL;
+}
+
+void ggml_free_tensor(struct ggml_tensor* tensor) {
+    if (!tensor || (tensor->flags & GGML_TENSOR_FLAG_CTX)) {
+        return;  // Arena tensors are released by ggml_context_reset/free
+    }
+    ggml_tensor_release_fn release = tensor->release;
+    void* data = tensor->data;
+    void* user = tensor->release_user;
+    STATS_FREE_EVENT((tensor->flags & GGML_TENSOR_FLAG_POOL) ? PROFILE_ALLOC_POOL
+                     : (tensor->flags & GGML_TENSOR_FLAG_PLACED) ? PROFILE_ALLOC_PLACED : PROFILE_ALLOC_HEAP,
+                     tensor);
+    if (tensor->flags & GGML_TENSOR_FLAG_POOL) {
+        tensor_pool_free(tensor, tensor->flags >> GGML_TENSOR_POOL_SHIFT);
+    } else if (tensor->flags & GGML_TENSOR_FLAG_PLACED) {
+        placement_free(tensor);
+    } else {
+        free(tensor);
+    }
+    if (release) release(data, user);
+}
@@ -0,0 +1,598 @@
+// Agent-Zero Sparse Hypergraph
+// /src/agent-zero/hypergraph.c
+//
+// Hyperedges are appended in edge -> node CSR form (offsets + member ids),
+// which is also the COO-style build order: adding an edge is an append,
+// and hypergraph_finalize() derives the node -> edge index with one
+// counting sort. Nothing is proportional to node_count squared except the
+// dense tensor encoding, which is kept for existing callers.
+
+#include <stdlib.h>
+#include <string.h>
+#include "cognitive-internal.h"
+
+#define HYPERGRAPH_MIN_CAPACITY 16
+
+static int grow_array(void** array, size_t* capacity, size_t needed, size_t elem_size) {
+    if (needed <= *capacity) return 0;
+    size_t new_capacity = *capacity ? *capacity : HYPERGRAPH_MIN_CAPACITY;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    void* grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) return -1;
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+// Grow the per-edge arrays together; edge_offsets has one extra entry
+static int grow_edges(hypergraph_t* hg, size_t needed) {
+    if (needed <= hg->link_capacity) return 0;
+    size_t new_capacity = hg->link_capacity * 2;
+    if (new_capacity < needed) new_capacity = needed;
+
+    float* weights = realloc(hg->link_weights, new_capacity * sizeof(float));
+    if (!weights) return -1;
+    hg->link_weights = weights;
+    size_t* offsets = realloc(hg->edge_offsets, (new_capacity + 1) * sizeof(size_t));
+    if (!offsets) return -1;
+    hg->edge_offsets = offsets;
+    hg->link_capacity = new_capacity;
+    return 0;
+}
+
+static void invalidate_node_index(hypergraph_t* hg) {
+    free(hg->node_offsets);
+    free(hg->node_edges);
+    hg->node_offsets = NULL;
+    hg->node_edges = NULL;
+    hg->finalized = 0;
+}
+
+hypergraph_t* create_hypergraph(size_t node_count, size_t link_count) {
+    if (node_count > UINT32_MAX) return NULL;
+
+    hypergraph_t* hg = calloc(1, sizeof(hypergraph_t));
+    if (!hg) return NULL;
+
+    hg->node_count = node_count;
+    hg->link_capacity = link_count ? link_count : HYPERGRAPH_MIN_CAPACITY;
+    hg->incidence_capacity = 2 * hg->link_capacity;
+
+    hg->node_weights = calloc(node_count ? node_count : 1, sizeof(float));
+    hg->link_weights = malloc(hg->link_capacity * sizeof(float));
+    hg->edge_offsets = malloc((hg->link_capacity + 1) * sizeof(size_t));
+    hg->edge_nodes = malloc(hg->incidence_capacity * sizeof(uint32_t));
+
+    if (!hg->node_weights || !hg->link_weights || !hg->edge_offsets || !hg->edge_nodes) {
+        destroy_hypergraph(hg);
+        return NULL;
+    }
+    hg->edge_offsets[0] = 0;
+
+    return hg;
+}
+
+void destroy_hypergraph(hypergraph_t* hg) {
+    if (hg) {
+        free(hg->node_weights);
+        free(hg->link_weights);
+        free(hg->edge_offsets);
+        free(hg->edge_nodes);
+        free(hg->node_offsets);
+        free(hg->node_edges);
+        free(hg);
+    }
+}
+
+int64_t hypergraph_add_edge(hypergraph_t* hg, const uint32_t* nodes, size_t arity, float weight) {
+    if (!hg || !nodes || arity == 0 || hg->link_count >= UINT32_MAX) return -1;
+    for (size_t i = 0; i < arity; i++) {
+        if (nodes[i] >= hg->node_count) return -1;
+    }
+
+    size_t edge = hg->link_count;
+    size_t used = hg->edge_offsets[edge];
+
+    if (grow_edges(hg, edge + 1) != 0 ||
+        grow_array((void**)&hg->edge_nodes, &hg->incidence_capacity, used + arity, sizeof(uint32_t)) != 0) {
+        return -1;
+    }
+
+    memcpy(hg->edge_nodes + used, nodes, arity * sizeof(uint32_t));
+    hg->link_weights[edge] = weight;
+    hg->edge_offsets[edge + 1] = used + arity;
+    hg->link_count = edge + 1;
+
+    if (hg->finalized) {
+        invalidate_node_index(hg);
+    }
+    return (int64_t)edge;
+}
+
+void hypergraph_clear_edges(hypergraph_t* hg) {
+    if (!hg) return;
+    hg->link_count = 0;
+    hg->edge_offsets[0] = 0;
+    invalidate_node_index(hg);
+}
+
+int hypergraph_finalize(hypergraph_t* hg) {
+    if (!hg) return -1;
+    if (hg->finalized) return 0;
+
+    size_t incidences = hg->edge_offsets[hg->link_count];
+    size_t* offsets = calloc(hg->node_count + 1, sizeof(size_t));
+    uint32_t* edges = malloc((incidences ? incidences : 1) * sizeof(uint32_t));
+    if (!offsets || !edges) {
+        free(offsets);
+        free(edges);
+        return -1;
+    }
+
+    // Counting sort of (node, edge) incidences by node; edges stay ascending
+    for (size_t k = 0; k < incidences; k++) {
+        offsets[hg->edge_nodes[k] + 1]++;
+    }
+    for (size_t v = 0; v < hg->node_count; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    size_t* cursor = malloc((hg->node_count ? hg->node_count : 1) * sizeof(size_t));
+    if (!cursor) {
+        free(offsets);
+        free(edges);
+        return -1;
+    }
+    memcpy(cursor, offsets, hg->node_count * sizeof(size_t));
+    for (size_t e = 0; e < hg->link_count; e++) {
+        for (size_t k = hg->edge_offsets[e]; k < hg->edge_offsets[e + 1]; k++) {
+            edges[cursor[hg->edge_nodes[k]]++] = (uint32_t)e;
+        }
+    }
+    free(cursor);
+
+    invalidate_node_index(hg);
+    hg->node_offsets = offsets;
+    hg->node_edges = edges;
+    hg->finalized = 1;
+    return 0;
+}
+
+// Sparse tensors
+
+sparse_tensor_t* create_sparse_tensor(size_t rows, size_t cols, size_t nnz) {
+    sparse_tensor_t* sp = malloc(sizeof(sparse_tensor_t));
+    if (!sp) return NULL;
+
+    sp->rows = rows;
+    sp->cols = cols;
+    sp->nnz = nnz;
+    sp->row_ptr = calloc(rows + 1, sizeof(size_t));
+    sp->col_idx = malloc((nnz ? nnz : 1) * sizeof(uint32_t));
+    sp->values = malloc((nnz ? nnz : 1) * sizeof(float));
+
+    if (!sp->row_ptr || !sp->col_idx || !sp->values) {
+        destroy_sparse_tensor(sp);
+        return NULL;
+    }
+    return sp;
+}
+
+void destroy_sparse_tensor(sparse_tensor_t* sp) {
+    if (sp) {
+        free(sp->row_ptr);
+        free(sp->col_idx);
+        free(sp->values);
+        free(sp);
+    }
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Runs body with (i, j) bound to every ordered adjacency pair of edge e:
+// all distinct member pairs, or (v, v) for a single-node edge
+#define FOR_EACH_EDGE_PAIR(hg, e, i, j, body)                                 \
+    do {                                                                      \
+        size_t begin_ = (hg)->edge_offsets[e];                                \
+        size_t end_ = (hg)->edge_offsets[(e) + 1];                            \
+        if (end_ - begin_ == 1) {                                             \
+            uint32_t i = (hg)->edge_nodes[begin_], j = i;                     \
+            body;                                                             \
+        } else {                                                              \
+            for (size_t a_ = begin_; a_ < end_; a_++) {                       \
+                for (size_t b_ = begin_; b_ < end_; b_++) {                   \
+                    uint32_t i = (hg)->edge_nodes[a_];                        \
+                    uint32_t j = (hg)->edge_nodes[b_];                        \
+                    if (i != j) { body; }                                     \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+    } while (0)
+
+sparse_tensor_t* encode_hypergraph_to_sparse(const hypergraph_t* hg) {
+    if (!hg) return NULL;
+    STATS_SPAN_BEGIN(span);
+
+    // Upper bound on entries before duplicate pairs are merged
+    size_t bound = 0;
+    for (size_t e = 0; e < hg->link_count; e++) {
+        size_t arity = hg->edge_offsets[e + 1] - hg->edge_offsets[e];
+        bound += arity == 1 ? 1 : arity * (arity - 1);
+    }
+
+    sparse_tensor_t* sp = create_sparse_tensor(hg->node_count, hg->node_count, bound);
+    if (!sp) return NULL;
+
+    // Scatter COO pairs into per-row slots (row_ptr doubles as the cursor)
+    for (size_t e = 0; e < hg->link_count; e++) {
+        FOR_EACH_EDGE_PAIR(hg, e, i, j, { (void)j; sp->row_ptr[i + 1]++; });
+    }
+    for (size_t r = 0; r < sp->rows; r++) {
+        sp->row_ptr[r + 1] += sp->row_ptr[r];
+    }
+    for (size_t e = 0; e < hg->link_count; e++) {
+        FOR_EACH_EDGE_PAIR(hg, e, i, j, { sp->col_idx[sp->row_ptr[i]++] = j; });
+    }
+    for (size_t r = sp->rows; r > 0; r--) {
+        sp->row_ptr[r] = sp->row_ptr[r - 1];
+    }
+    sp->row_ptr[0] = 0;
+
+    // Sort and merge each row in place, compacting towards the front
+    size_t out = 0;
+    for (size_t r = 0; r < sp->rows; r++) {
+        size_t begin = sp->row_ptr[r];
+        size_t end = sp->row_ptr[r + 1];
+        qsort(sp->col_idx + begin, end - begin, sizeof(uint32_t), compare_u32);
+
+        sp->row_ptr[r] = out;
+        for (size_t k = begin; k < end; k++) {
+            uint32_t c = sp->col_idx[k];
+            if (k > begin && c == sp->col_idx[k - 1]) continue;
+            sp->col_idx[out] = c;
+            sp->values[out] = (hg->node_weights[r] + hg->node_weights[c]) * 0.5f;
+            out++;
+        }
+    }
+    sp->row_ptr[sp->rows] = out;
+    sp->nnz = out;
+
+    STATS_SPAN_END(span, AGENT_ZERO_OP_HYPERGRAPH_TO_SPARSE,
+                   out * (sizeof(uint32_t) + sizeof(float)) + (sp->rows + 1) * sizeof(size_t));
+    return sp;
+}
+
+struct ggml_tensor* encode_hypergraph_to_tensor(
+    struct ggml_context* ctx,
+    const hypergraph_t* hg) {
+
+    if (!hg || hg->node_count > INT32_MAX) return NULL;
+
+    struct ggml_tensor* tensor = ggml_new_tensor_2d(
+        ctx, GGML_TYPE_F32, (int)hg->node_count, (int)hg->node_count);
+    if (!tensor) return NULL;
+
+    // The tensor starts zeroed; only incident pairs are written
+    float* tensor_data = (float*)tensor->data;
+    for (size_t e = 0; e < hg->link_count; e++) {
+        FOR_EACH_EDGE_PAIR(hg, e, i, j, {
+            float weight_factor = (hg->node_weights[i] + hg->node_weights[j]) * 0.5f;
+            tensor_data[(size_t)i * hg->node_count + j] = weight_factor;
+        });
+    }
+
+    return tensor;
+}
+
+// Threshold decode
+// Entries above the threshold become hyperedges, one per symmetric pair:
+// (i, j) is kept unless j < i and (j, i) was already above it. Node
+// weights are a separate, order-independent reduction: every positive
+// entry (i, j) contributes to nodes i and j, and
+//   w_i = (w_i + sum of contributions) / (1 + number of contributions)
+
+static float sparse_lookup(const sparse_tensor_t* sp, size_t row, uint32_t col) {
+    size_t lo = sp->row_ptr[row];
+    size_t hi = sp->row_ptr[row + 1];
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (sp->col_idx[mid] < col) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return (lo < sp->row_ptr[row + 1] && sp->col_idx[lo] == col) ? sp->values[lo] : 0.0f;
+}
+
+// Append the edges of the leading min_size square of sp, in entry order
+static int decode_edges(hypergraph_t* hg, const sparse_tensor_t* sp, size_t min_size, float threshold) {
+    for (size_t i = 0; i < min_size; i++) {
+        for (size_t k = sp->row_ptr[i]; k < sp->row_ptr[i + 1]; k++) {
+            uint32_t j = sp->col_idx[k];
+            if (j >= min_size) break;
+            if (!(sp->values[k] > threshold)) continue;
+            if (j < i && sparse_lookup(sp, j, (uint32_t)i) > threshold) continue;
+            uint32_t pair[2] = { j < i ? j : (uint32_t)i, j < i ? (uint32_t)i : j };
+            if (hypergraph_add_edge(hg, pair, j == i ? 1 : 2, sp->values[k]) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+static void apply_node_stats(hypergraph_t* hg, const double* sum, const double* count, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        hg->node_weights[i] = (float)((hg->node_weights[i] + sum[i]) / (1.0 + count[i]));
+    }
+}
+
+// Dense field scan. Rows are cut into at most FIELD_SCAN_BLOCKS fixed
+// blocks (independent of the thread count); each block compresses its
+// rows into a private entry list and accumulates per-column positive
+// sums, so the data is read once and every result is deterministic.
+#define FIELD_SCAN_BLOCKS 64
+#define FIELD_SCAN_MIN_ROWS 16
+
+typedef struct {
+    uint32_t* cols;
+    float* values;
+    size_t count;
+    size_t capacity;
+} scan_block_t;
+
+typedef struct {
+    const struct ggml_tensor* tensor;
+    size_t rows;
+    size_t cols;
+    size_t rows_per_block;
+    float threshold;
+    scan_block_t* blocks;
+    size_t* row_nnz;
+    // Node reduction of a square field (NULL to skip)
+    float* col_sum;        // one cols-wide slab per block
+    float* col_count;
+    double* node_sum;
+    double* node_count;
+    size_t n_blocks;
+    atomic_int failed;
+} field_scan_t;
+
+static int reserve_block(scan_block_t* block, size_t needed) {
+    if (needed <= block->capacity) return 0;
+    size_t capacity = block->capacity ? block->capacity : HYPERGRAPH_MIN_CAPACITY;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    uint32_t* cols = realloc(block->cols, capacity * sizeof(uint32_t));
+    if (!cols) return -1;
+    block->cols = cols;
+    float* values = realloc(block->values, capacity * sizeof(float));
+    if (!values) return -1;
+    block->values = values;
+    block->capacity = capacity;
+    return 0;
+}
+
+static void scan_field_blocks(int64_t begin, int64_t end, void* arg) {
+    field_scan_t* scan = arg;
+    const simd_kernels_t* simd = simd_kernels();
+    for (int64_t b = begin; b < end; b++) {
+        scan_block_t* block = &scan->blocks[b];
+        size_t first = (size_t)b * scan->rows_per_block;
+        size_t last = first + scan->rows_per_block < scan->rows ? first + scan->rows_per_block : scan->rows;
+        for (size_t r = first; r < last; r++) {
+            const float* row = (const float*)ggml_get_row(scan->tensor, (int64_t)r);
+            if (reserve_block(block, block->count + scan->cols) != 0) {
+                atomic_store(&scan->failed, 1);
+                return;
+            }
+            uint32_t* cols = block->cols + block->count;
+            float* values = block->values + block->count;
+            size_t n = (size_t)simd->compress_gt(cols, row, scan->threshold, 0, (int64_t)scan->cols);
+            for (size_t k = 0; k < n; k++) {
+                values[k] = row[cols[k]];
+            }
+            scan->row_nnz[r] = n;
+            block->count += n;
+
+            if (scan->col_sum) {
+                float totals[2];
+                simd->positive_stats(scan->col_sum + (size_t)b * scan->cols,
+                                     scan->col_count + (size_t)b * scan->cols,
+                                     totals, row, (int64_t)scan->cols);
+                scan->node_sum[r] = totals[0];
+                scan->node_count[r] = totals[1];
+            }
+        }
+    }
+}
+
+// Fold the per-block column partials into the node totals, in block order
+static void reduce_field_columns(int64_t begin, int64_t end, void* arg) {
+    field_scan_t* scan = arg;
+    for (int64_t j = begin; j < end; j++) {
+        double sum = 0.0, count = 0.0;
+        for (size_t b = 0; b < scan->n_blocks; b++) {
+            sum += scan->col_sum[b * scan->cols + (size_t)j];
+            count += scan->col_count[b * scan->cols + (size_t)j];
+        }
+        scan->node_sum[j] += sum;
+        scan->node_count[j] += count;
+    }
+}
+
+// Entries of the leading rows x cols of an f32 tensor above threshold, as
+// CSR. With node_sum/node_count (rows == cols), also the per-node positive
+// sums and counts over row i and column i.
+static sparse_tensor_t* scan_field(const struct ggml_tensor* tensor, size_t rows, size_t cols,
+                                   float threshold, double* node_sum, double* node_count) {
+    field_scan_t scan;
+    memset(&scan, 0, sizeof(scan));
+    scan.tensor = tensor;
+    scan.rows = rows;
+    scan.cols = cols;
+    scan.threshold = threshold;
+    scan.rows_per_block = (rows + FIELD_SCAN_BLOCKS - 1) / FIELD_SCAN_BLOCKS;
+    if (scan.rows_per_block < FIELD_SCAN_MIN_ROWS) scan.rows_per_block = FIELD_SCAN_MIN_ROWS;
+    scan.n_blocks = (rows + scan.rows_per_block - 1) / scan.rows_per_block;
+    atomic_init(&scan.failed, 0);
+
+    scan.blocks = calloc(scan.n_blocks ? scan.n_blocks : 1, sizeof(scan_block_t));
+    scan.row_nnz = malloc((rows ? rows : 1) * sizeof(size_t));
+    int status = (scan.blocks && scan.row_nnz) ? 0 : -1;
+    if (status == 0 && node_sum) {
+        scan.col_sum = calloc(scan.n_blocks * cols + 1, sizeof(float));
+        scan.col_count = calloc(scan.n_blocks * cols + 1, sizeof(float));
+        scan.node_sum = node_sum;
+        scan.node_count = node_count;
+        if (!scan.col_sum || !scan.col_count) status = -1;
+    }
+
+    sparse_tensor_t* sp = NULL;
+    if (status == 0) {
+        parallel_for((int64_t)scan.n_blocks, 1, scan_field_blocks, &scan);
+        if (atomic_load(&scan.failed)) status = -1;
+    }
+    if (status == 0 && node_sum) {
+        parallel_for((int64_t)cols, parallel_grain((int64_t)scan.n_blocks), reduce_field_columns, &scan);
+    }
+    if (status == 0) {
+        size_t nnz = 0;
+        for (size_t b = 0; b < scan.n_blocks; b++) {
+            nnz += scan.blocks[b].count;
+        }
+        sp = create_sparse_tensor(rows, cols, nnz);
+    }
+    if (sp) {
+        // Blocks hold consecutive rows, so their lists concatenate into CSR
+        for (size_t r = 0; r < rows; r++) {
+            sp->row_ptr[r + 1] = sp->row_ptr[r] + scan.row_nnz[r];
+        }
+        size_t offset = 0;
+        for (size_t b = 0; b < scan.n_blocks; b++) {
+            const scan_block_t* block = &scan.blocks[b];
+            if (block->count) {
+                memcpy(sp->col_idx + offset, block->cols, block->count * sizeof(uint32_t));
+                memcpy(sp->values + offset, block->values, block->count * sizeof(float));
+            }
+            offset += block->count;
+        }
+    }
+
+    if (scan.blocks) {
+        for (size_t b = 0; b < scan.n_blocks; b++) {
+            free(scan.blocks[b].cols);
+            free(scan.blocks[b].values);
+        }
+    }
+    free(scan.blocks);
+    free(scan.row_nnz);
+    free(scan.col_sum);
+    free(scan.col_count);
+    return sp;
+}
+
+int decode_sparse_to_hypergraph(
+    const sparse_tensor_t* sp,
+    hypergraph_t* hg) {
+
+    if (!sp || !hg) return -1;
+
+    size_t min_size = hg->node_count < sp->rows ? hg->node_count : sp->rows;
+    if (sp->cols < min_size) min_size = sp->cols;
+
+    double* node_sum = calloc(min_size + 1, sizeof(double));
+    double* node_count = calloc(min_size + 1, sizeof(double));
+    if (!node_sum || !node_count) {
+        free(node_sum);
+        free(node_count);
+        return -1;
+    }
+
+    hypergraph_clear_edges(hg);
+    int status = decode_edges(hg, sp, min_size, 0.5f);
+    if (status == 0) {
+        for (size_t i = 0; i < min_size; i++) {
+            for (size_t k = sp->row_ptr[i]; k < sp->row_ptr[i + 1]; k++) {
+                uint32_t j = sp->col_idx[k];
+                if (j >= min_size) break;
+                if (!(sp->values[k] > 0.0f)) continue;
+                node_sum[i] += sp->values[k];
+                node_sum[j] += sp->values[k];
+                node_count[i] += 1.0;
+                node_count[j] += 1.0;
+            }
+        }
+        apply_node_stats(hg, node_sum, node_count, min_size);
+    }
+
+    free(node_sum);
+    free(node_count);
+    return status;
+}
+
+sparse_tensor_t* tensor_to_sparse_threshold(const struct ggml_tensor* tensor, float threshold) {
+    if (!tensor || !tensor->data) return NULL;
+    if (tensor->type != GGML_TYPE_F32) {
+        struct ggml_tensor* converted = ggml_cast(NULL, tensor, GGML_TYPE_F32);
+        if (!converted) return NULL;
+        sparse_tensor_t* sp = tensor_to_sparse_threshold(converted, threshold);
+        ggml_free_tensor(converted);
+        return sp;
+    }
+    return scan_field(tensor, (size_t)ggml_nrows(tensor), (size_t)tensor->ne[1], threshold, NULL, NULL);
+}
+
+int decode_tensor_to_hypergraph_threshold(
+    const struct ggml_tensor* tensor,
+    hypergraph_t* hg,
+    float threshold,
+    sparse_tensor_t** entries) {
+
+    if (entries) *entries = NULL;
+    if (!tensor || !hg || !tensor->data) return -1;
+    if (tensor->type != GGML_TYPE_F32) {
+        struct ggml_tensor* converted = ggml_cast(NULL, tensor, GGML_TYPE_F32);
+        if (!converted) return -1;
+        int status = decode_tensor_to_hypergraph_threshold(converted, hg, threshold, entries);
+        ggml_free_tensor(converted);
+        return status;
+    }
+
+    size_t min_size = (hg->node_count < (size_t)tensor->ne[0]) ?
+                      hg->node_count : (size_t)tensor->ne[0];
+    if ((size_t)tensor->ne[1] < min_size) min_size = (size_t)tensor->ne[1];
+
+    double* node_sum = malloc((min_size + 1) * sizeof(double));
+    double* node_count = malloc((min_size + 1) * sizeof(double));
+    sparse_tensor_t* sp = (node_sum && node_count) ?
+        scan_field(tensor, min_size, min_size, threshold, node_sum, node_count) : NULL;
+
+    int status = -1;
+    if (sp) {
+        hypergraph_clear_edges(hg);
+        status = decode_edges(hg, sp, min_size, threshold);
+        if (status == 0) apply_node_stats(hg, node_sum, node_count, min_size);
+    }
+    free(node_sum);
+    free(node_count);
+
+    if (status == 0 && entries) {
+        *entries = sp;
+    } else {
+        destroy_sparse_tensor(sp);
+    }
+    return status;
+}
+
+int decode_tensor_to_hypergraph(
+    const struct ggml_tensor* tensor,
+    hypergraph_t* hg) {
+
+    return decode_tensor_to_hypergraph_threshold(tensor, hg, 0.5f, NULL);
+}
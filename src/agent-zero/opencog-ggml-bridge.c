@@ -2,8 +2,8 @@
 // /src/agent-zero/opencog-ggml-bridge.c
 //
 // Performance optimizations:
-// - Memory pool for tensor allocations
-// - SIMD operations for tensor math
+// - Memory pool for tensor allocations (tensor-pool.c)
+// - SIMD operations for tensor math (runtime dispatch, simd-kernels.c)
 // - Cache-friendly memory layouts
 // - Batch processing for AtomSpace conversions
 
@@ -11,294 +11,208 @@
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
-#include <immintrin.h>  // For SIMD operations
-#include "cognitive.h"
+#include <unistd.h>
+#include <pthread.h>
+#include "cognitive-internal.h"
+#include "atomspace-internal.h"
 
-// Memory pool for optimized tensor allocations
-#define TENSOR_POOL_SIZE 1024
-#define TENSOR_BLOCK_SIZE 16384  // 16KB blocks
+// f32 elements of a contiguous tensor: its own data, or a converted copy
+// the caller frees through *owned. NULL when the copy cannot be made.
+static const float* tensor_f32_values(const struct ggml_tensor* t, float** owned) {
+    *owned = NULL;
+    if (t->type == GGML_TYPE_F32) return (const float*)t->data;
 
-typedef struct {
-    void* blocks[TENSOR_POOL_SIZE];
-    int free_blocks[TENSOR_POOL_SIZE];
-    int allocated_blocks[TENSOR_POOL_SIZE];
-    int free_count;
-    int allocated_count;
-    size_t total_allocated;
-    size_t peak_usage;
-} TensorMemoryPool;
-
-static TensorMemoryPool tensor_pool = {0};
-
-// Initialize tensor memory pool
-static void init_tensor_pool() {
-    for (int i = 0; i < TENSOR_POOL_SIZE; i++) {
-        tensor_pool.blocks[i] = aligned_alloc(32, TENSOR_BLOCK_SIZE);  // 32-byte aligned for SIMD
-        tensor_pool.free_blocks[i] = i;
-    }
-    tensor_pool.free_count = TENSOR_POOL_SIZE;
-    tensor_pool.allocated_count = 0;
-    tensor_pool.total_allocated = 0;
-    tensor_pool.peak_usage = 0;
-}
-
-// Optimized GGML structures with cache-friendly layouts
-struct ggml_tensor {
-    int ne[4];       // dimensions
-    void* data;      // tensor data (32-byte aligned)
-    size_t nb[4];    // strides
-    int type;        // data type
-    int padding[3];  // Pad to cache line boundary
-};
-
-struct ggml_context {
-    void* mem_buffer;
-    size_t mem_size;
-    size_t mem_used;
-    TensorMemoryPool* pool;  // Reference to memory pool
-};
-
-// Optimized tensor allocation using memory pool
-static struct ggml_tensor* ggml_new_tensor_2d_optimized(struct ggml_context* ctx, int type, int ne0, int ne1) {
-    if (!tensor_pool.blocks[0]) {
-        init_tensor_pool();
-    }
-    
-    struct ggml_tensor* tensor = malloc(sizeof(struct ggml_tensor));
-    if (!tensor) return NULL;
-    
-    tensor->ne[0] = ne0;
-    tensor->ne[1] = ne1;
-    tensor->ne[2] = 1;
-    tensor->ne[3] = 1;
-    tensor->type = type;
-    
-    // Use memory pool for data allocation
-    size_t data_size = ne0 * ne1 * sizeof(float);
-    
-    if (data_size <= TENSOR_BLOCK_SIZE && tensor_pool.free_count > 0) {
-        // Allocate from pool
-        int block_idx = tensor_pool.free_blocks[--tensor_pool.free_count];
-        tensor_pool.allocated_blocks[tensor_pool.allocated_count++] = block_idx;
-        tensor->data = tensor_pool.blocks[block_idx];
-        tensor_pool.total_allocated += data_size;
-        if (tensor_pool.total_allocated > tensor_pool.peak_usage) {
-            tensor_pool.peak_usage = tensor_pool.total_allocated;
-        }
-    } else {
-        // Fallback to system allocation
-        tensor->data = aligned_alloc(32, data_size);
-    }
-    
-    if (!tensor->data) {
-        free(tensor);
-        return NULL;
-    }
-    
-    // Zero-initialize with SIMD optimization
-    memset(tensor->data, 0, data_size);
-    
-    return tensor;
+    size_t size = (size_t)ggml_nelements(t);
+    float* values = malloc((size ? size : 1) * sizeof(float));
+    if (!values) return NULL;
+    ggml_get_type_traits(t->type)->to_f32(t->data, values, (int64_t)size);
+    *owned = values;
+    return values;
 }
 
-// SIMD-optimized tensor multiplication
-static struct ggml_tensor* ggml_mul_simd(struct ggml_context* ctx, struct ggml_tensor* a, struct ggml_tensor* b) {
-    if (!a || !b || !a->data || !b->data) return NULL;
-    
-    struct ggml_tensor* result = ggml_new_tensor_2d_optimized(ctx, 0, a->ne[0], a->ne[1]);
-    if (!result) return NULL;
-    
-    float* a_data = (float*)a->data;
-    float* b_data = (float*)b->data;
-    float* result_data = (float*)result->data;
-    
-    int size = a->ne[0] * a->ne[1];
-    int simd_size = size - (size % 8);  // Process 8 floats at a time with AVX
-    
-    // SIMD processing
-    for (int i = 0; i < simd_size; i += 8) {
-        __m256 va = _mm256_load_ps(&a_data[i]);
-        __m256 vb = _mm256_load_ps(&b_data[i]);
-        __m256 vresult = _mm256_mul_ps(va, vb);
-        _mm256_store_ps(&result_data[i], vresult);
-    }
-    
-    // Handle remaining elements
-    for (int i = simd_size; i < size; i++) {
-        result_data[i] = a_data[i] * b_data[i];
-    }
-    
-    return result;
-}
+// Bridge functions
+#define ENCODE_BLOCK 4096
 
-// SIMD-optimized tensor addition
-static struct ggml_tensor* ggml_add_simd(struct ggml_context* ctx, struct ggml_tensor* a, struct ggml_tensor* b) {
-    if (!a || !b || !a->data || !b->data) return NULL;
-    
-    struct ggml_tensor* result = ggml_new_tensor_2d_optimized(ctx, 0, a->ne[0], a->ne[1]);
-    if (!result) return NULL;
-    
-    float* a_data = (float*)a->data;
-    float* b_data = (float*)b->data;
-    float* result_data = (float*)result->data;
-    
-    int size = a->ne[0] * a->ne[1];
-    int simd_size = size - (size % 8);
-    
-    // SIMD processing
-    for (int i = 0; i < simd_size; i += 8) {
-        __m256 va = _mm256_load_ps(&a_data[i]);
-        __m256 vb = _mm256_load_ps(&b_data[i]);
-        __m256 vresult = _mm256_add_ps(va, vb);
-        _mm256_store_ps(&result_data[i], vresult);
-    }
-    
-    // Handle remaining elements
-    for (int i = simd_size; i < size; i++) {
-        result_data[i] = a_data[i] + b_data[i];
-    }
-    
-    return result;
-}
+// Streaming encode: f32 tensors are written in place, typed ones through
+// the tile, flushed whenever it fills. Tiles start at multiples of
+// ATOMSPACE_STREAM_TILE, so every flush covers whole Q8_0 blocks.
+#define STREAM_DEFAULT_ACTIVATION 0.1f
 
-typedef struct {
-    int type;
-    double mean;
-    double confidence;
-} TruthValue;
+int atomspace_tensor_stream_init(atomspace_tensor_stream_t* stream,
+                                 struct ggml_tensor* tensor, float scale) {
+    if (!stream || !tensor || !tensor->data || !ggml_is_contiguous(tensor)) return -1;
+    stream->tensor = tensor;
+    stream->scale = scale;
+    stream->size = (size_t)ggml_nelements(tensor);
+    stream->written = 0;
+    stream->staged = 0;
+    return 0;
+}
 
-typedef struct {
-    int id;
-    int type;
-    TruthValue* truth_value;
-    char* name;
-} Atom;
+static void stream_flush(atomspace_tensor_stream_t* stream) {
+    if (stream->staged == 0) return;
+    struct ggml_tensor* t = stream->tensor;
+    size_t begin = stream->written - stream->staged;
+    ggml_get_type_traits(t->type)->from_f32(stream->tile,
+                                            (char*)t->data + ggml_row_size(t->type, (int64_t)begin),
+                                            (int64_t)stream->staged);
+    stream->staged = 0;
+}
 
-typedef struct {
-    Atom** atoms;
-    size_t count;
-    size_t capacity;
-} AtomSpace;
+size_t atomspace_tensor_stream_push(atomspace_tensor_stream_t* stream,
+                                    const float* activations, size_t n) {
+    size_t room = stream->size - stream->written;
+    if (n > room) n = room;
 
-typedef struct {
-    Atom** handles;
-    size_t count;
-} HandleSeq;
-
-// Mock OpenCog constants
-#define ATOM_TYPE_CONCEPT 1
-#define ATOM_TYPE_LINK 2
-#define ATOM_TYPE_INHERITANCE 3
-
-// Mock AtomSpace functions
-static AtomSpace* create_atomspace() {
-    AtomSpace* as = malloc(sizeof(AtomSpace));
-    as->atoms = malloc(sizeof(Atom*) * 1000);
-    as->count = 0;
-    as->capacity = 1000;
-    return as;
-}
-
-static void destroy_atomspace(AtomSpace* as) {
-    if (as) {
-        for (size_t i = 0; i < as->count; i++) {
-            if (as->atoms[i]) {
-                free(as->atoms[i]->truth_value);
-                free(as->atoms[i]->name);
-                free(as->atoms[i]);
-            }
-        }
-        free(as->atoms);
-        free(as);
+    const simd_kernels_t* simd = simd_kernels();
+    if (stream->tensor->type == GGML_TYPE_F32) {
+        float* data = (float*)stream->tensor->data + stream->written;
+        simd->scale(data, activations, stream->scale, (int64_t)n);
+        stream->written += n;
+        return n;
     }
-}
-
-static Atom* create_atom(int type, const char* name, double mean, double confidence) {
-    Atom* atom = malloc(sizeof(Atom));
-    atom->type = type;
-    atom->id = rand() % 10000;
-    atom->name = name ? strdup(name) : NULL;
-    
-    atom->truth_value = malloc(sizeof(TruthValue));
-    atom->truth_value->mean = mean;
-    atom->truth_value->confidence = confidence;
-    
-    return atom;
-}
 
-static void add_atom_to_space(AtomSpace* as, Atom* atom) {
-    if (as->count < as->capacity) {
-        as->atoms[as->count++] = atom;
+    for (size_t done = 0; done < n;) {
+        size_t take = ATOMSPACE_STREAM_TILE - stream->staged;
+        if (take > n - done) take = n - done;
+        simd->scale(stream->tile + stream->staged, activations + done, stream->scale, (int64_t)take);
+        stream->staged += take;
+        stream->written += take;
+        done += take;
+        if (stream->staged == ATOMSPACE_STREAM_TILE) stream_flush(stream);
     }
+    return n;
 }
 
-static HandleSeq get_atoms_by_type(AtomSpace* as, int type, int include_subtypes) {
-    HandleSeq seq;
-    seq.handles = malloc(sizeof(Atom*) * as->count);
-    seq.count = 0;
-    
-    for (size_t i = 0; i < as->count; i++) {
-        if (as->atoms[i]->type == type || include_subtypes) {
-            seq.handles[seq.count++] = as->atoms[i];
-        }
+void atomspace_tensor_stream_finish(atomspace_tensor_stream_t* stream) {
+    // Elements past the last pushed value take the default low activation
+    float pad[256];
+    const size_t pad_len = sizeof(pad) / sizeof(pad[0]);
+    for (size_t i = 0; i < pad_len; i++) {
+        pad[i] = STREAM_DEFAULT_ACTIVATION;
     }
-    
-    return seq;
+    while (stream->written < stream->size) {
+        atomspace_tensor_stream_push(stream, pad, pad_len);
+    }
+    stream_flush(stream);
 }
 
-// Bridge functions
 void atomspace_to_tensor(AtomSpace* as, struct ggml_tensor* tensor) {
-    // Convert AtomSpace hypergraph to tensor representation
-    HandleSeq atoms = get_atoms_by_type(as, ATOM_TYPE_CONCEPT, 1);
-    
-    float* data = (float*)tensor->data;
-    size_t tensor_size = tensor->ne[0] * tensor->ne[1];
-    
-    for (size_t i = 0; i < atoms.count && i < tensor_size; i++) {
-        if (atoms.handles[i] && atoms.handles[i]->truth_value) {
-            data[i] = (float)atoms.handles[i]->truth_value->mean;
-        } else {
-            data[i] = 0.0f;
-        }
-    }
-    
-    // Fill remaining tensor elements with default values
-    for (size_t i = atoms.count; i < tensor_size; i++) {
-        data[i] = 0.1f; // Default low activation
-    }
-    
-    free(atoms.handles);
+    // Convert AtomSpace hypergraph to tensor representation; every atom
+    // contributes regardless of type. The f32 activation column already
+    // holds the means in tensor order, so it streams straight in.
+    atomspace_tensor_stream_t stream;
+    if (!as || atomspace_tensor_stream_init(&stream, tensor, 1.0f) != 0) return;
+    STATS_SPAN_BEGIN(span);
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    atomspace_tensor_stream_push(&stream, view->activation, atomspace_view_count(view));
+    atomspace_view_release();
+    atomspace_tensor_stream_finish(&stream);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ENCODE, ggml_nbytes(tensor));
 }
 
 void tensor_to_atomspace(const struct ggml_tensor* tensor, AtomSpace* as) {
     // Convert tensor representation back to AtomSpace
-    float* data = (float*)tensor->data;
-    size_t tensor_size = tensor->ne[0] * tensor->ne[1];
+    float* owned;
+    const float* data = tensor_f32_values(tensor, &owned);
+    size_t tensor_size = (size_t)ggml_nelements(tensor);
     
     // Clear existing atoms (simplified)
-    for (size_t i = 0; i < as->count; i++) {
-        if (as->atoms[i]) {
-            free(as->atoms[i]->truth_value);
-            free(as->atoms[i]->name);
-            free(as->atoms[i]);
-        }
-    }
-    as->count = 0;
+    atomspace_clear(as);
+    if (!data) return;
     
     // Create atoms from tensor data
-    for (size_t i = 0; i < tensor_size && i < as->capacity; i++) {
+    STATS_SPAN_BEGIN(span);
+    for (size_t i = 0; i < tensor_size; i++) {
         if (data[i] > 0.01f) { // Only create atoms for significant values
             char name[64];
             snprintf(name, sizeof(name), "concept_%zu", i);
             
-            Atom* atom = create_atom(
-                ATOM_TYPE_CONCEPT, 
-                name, 
-                data[i], 
-                0.8 // Default confidence
-            );
-            
-            add_atom_to_space(as, atom);
+            // Default confidence
+            if (atomspace_add_atom(as, ATOM_TYPE_CONCEPT, name, data[i], 0.8) < 0) {
+                break;
+            }
+        }
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_DECODE, tensor_size * sizeof(float));
+    free(owned);
+}
+
+// Atoms ordered by activation, ties by handle
+typedef struct {
+    float mean;
+    uint32_t index;
+} similarity_key_t;
+
+static int compare_similarity_keys(const void* a, const void* b) {
+    const similarity_key_t* x = a;
+    const similarity_key_t* y = b;
+    if (x->mean != y->mean) return x->mean < y->mean ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Attention matrix
+// Off-diagonal entries are (1 - |act_i - act_j|) * weight / 2 and the
+// diagonal is weight, for the atom handles of one published view (a 64 x 64
+// weight * identity for an empty AtomSpace). The matrix is symmetric, so it
+// can be stored as its upper triangle, and products with it need never
+// form it.
+#define ATTENTION_TILE_COLS 4096  // activations kept in L1 across a row block
+
+static size_t attention_size(size_t atoms) {
+    return atoms ? atoms : 64;
+}
+
+// Columns [j0, j1) of row i into dst, which holds row i from column j0
+static void attention_row_span(const float* activation, float attention_weight,
+                               size_t i, size_t j0, size_t j1, float* dst) {
+    if (!activation) {
+        memset(dst, 0, (j1 - j0) * sizeof(float));
+    } else {
+        simd_kernels()->similarity(dst, activation + j0, activation[i],
+                                   1.0f, attention_weight * 0.5f, (int64_t)(j1 - j0));
+    }
+    if (i >= j0 && i < j1) {
+        dst[i - j0] = attention_weight;  // Self-attention
+    }
+}
+
+typedef struct {
+    const float* activation;  // NULL for an empty AtomSpace
+    float* data;
+    size_t n;
+    float attention_weight;
+    int packed;  // upper triangle, row i holding columns i..n-1
+    const struct ggml_tensor* typed;  // non-f32 dense target, data unused
+} attention_job_t;
+
+static size_t packed_row_offset(size_t n, size_t i) {
+    return i * (2 * n - i + 1) / 2;
+}
+
+// Rows [begin, end), one column tile at a time across the whole row block
+static void attention_rows(int64_t begin, int64_t end, void* arg) {
+    const attention_job_t* job = arg;
+    size_t n = job->n;
+    float staging[ATTENTION_TILE_COLS];
+    for (size_t j0 = 0; j0 < n; j0 += ATTENTION_TILE_COLS) {
+        size_t j1 = n - j0 < ATTENTION_TILE_COLS ? n : j0 + ATTENTION_TILE_COLS;
+        for (size_t i = (size_t)begin; i < (size_t)end; i++) {
+            if (job->typed) {
+                // Generated in f32, stored converted
+                const struct ggml_tensor* t = job->typed;
+                attention_row_span(job->activation, job->attention_weight, i, j0, j1, staging);
+                ggml_get_type_traits(t->type)->from_f32(
+                    staging, ggml_row_element(t, ggml_get_row(t, (int64_t)i), (int64_t)j0),
+                    (int64_t)(j1 - j0));
+            } else if (!job->packed) {
+                attention_row_span(job->activation, job->attention_weight, i, j0, j1,
+                                   job->data + i * n + j0);
+            } else if (j1 > i) {
+                size_t start = j0 > i ? j0 : i;
+                attention_row_span(job->activation, job->attention_weight, i, start, j1,
+                                   job->data + packed_row_offset(n, i) + (start - i));
+            }
         }
     }
 }
@@ -308,42 +222,225 @@ struct ggml_tensor* create_attention_tensor(
     AtomSpace* as,
     float attention_weight) {
     
+    return create_attention_tensor_typed(ctx, as, attention_weight, GGML_TYPE_F32);
+}
+
+struct ggml_tensor* create_attention_tensor_typed(
+    struct ggml_context* ctx,
+    AtomSpace* as,
+    float attention_weight,
+    int type) {
+    
     // Create tensor based on attention values in AtomSpace
-    size_t node_count = as->count;
-    if (node_count == 0) node_count = 64; // Default size
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t atoms = atomspace_view_count(view);
+    size_t node_count = attention_size(atoms);
     
     struct ggml_tensor* attention_tensor = ggml_new_tensor_2d(
-        ctx, 0, (int)node_count, (int)node_count);
-    
-    float* data = (float*)attention_tensor->data;
+        ctx, type, (int)node_count, (int)node_count);
+    if (attention_tensor) {
+        // Initialize attention matrix, row blocks spread over the thread pool
+        attention_job_t job = { atoms ? view->activation : NULL, (float*)attention_tensor->data,
+                                node_count, attention_weight, 0,
+                                type == GGML_TYPE_F32 ? NULL : attention_tensor };
+        STATS_SPAN_BEGIN(span);
+        parallel_for((int64_t)node_count, parallel_grain((int64_t)node_count), attention_rows, &job);
+        STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_TENSOR, ggml_nbytes(attention_tensor));
+    }
+    atomspace_view_release();
     
-    // Initialize attention matrix
-    for (size_t i = 0; i < node_count; i++) {
-        for (size_t j = 0; j < node_count; j++) {
-            if (i == j) {
-                // Self-attention
-                data[i * node_count + j] = attention_weight;
-            } else if (i < as->count && j < as->count) {
-                // Cross-attention based on atom relationships
-                Atom* atom_i = as->atoms[i];
-                Atom* atom_j = as->atoms[j];
-                
-                if (atom_i && atom_j && atom_i->truth_value && atom_j->truth_value) {
-                    float similarity = 1.0f - fabsf(
-                        (float)atom_i->truth_value->mean - 
-                        (float)atom_j->truth_value->mean
-                    );
-                    data[i * node_count + j] = similarity * attention_weight * 0.5f;
-                } else {
-                    data[i * node_count + j] = 0.1f * attention_weight;
-                }
-            } else {
-                data[i * node_count + j] = 0.0f;
+    return attention_tensor;
+}
+
+packed_attention_t* create_packed_attention(AtomSpace* as, float attention_weight) {
+    if (!as) return NULL;
+    packed_attention_t* packed = malloc(sizeof(packed_attention_t));
+    if (!packed) return NULL;
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t atoms = atomspace_view_count(view);
+    packed->n = attention_size(atoms);
+    packed->values = malloc(packed->n * (packed->n + 1) / 2 * sizeof(float));
+    if (!packed->values) {
+        atomspace_view_release();
+        free(packed);
+        return NULL;
+    }
+
+    // Rows shrink towards the bottom; small chunks let the pool rebalance
+    attention_job_t job = { atoms ? view->activation : NULL, packed->values, packed->n,
+                            attention_weight, 1, NULL };
+    STATS_SPAN_BEGIN(span);
+    parallel_for((int64_t)packed->n, parallel_grain((int64_t)packed->n / 2), attention_rows, &job);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_TENSOR,
+                   packed->n * (packed->n + 1) / 2 * sizeof(float));
+    atomspace_view_release();
+    return packed;
+}
+
+void destroy_packed_attention(packed_attention_t* packed) {
+    if (packed) {
+        free(packed->values);
+        free(packed);
+    }
+}
+
+float packed_attention_get(const packed_attention_t* packed, size_t i, size_t j) {
+    if (i > j) {
+        size_t t = i;
+        i = j;
+        j = t;
+    }
+    return packed->values[packed_row_offset(packed->n, i) + (j - i)];
+}
+
+size_t attention_tensor_size(const AtomSpace* as) {
+    if (!as) return 0;
+    size_t atoms = atomspace_view_count(atomspace_view_acquire(as));
+    atomspace_view_release();
+    return attention_size(atoms);
+}
+
+static int attention_matvec_view(const atomspace_view_t* view, float attention_weight,
+                                 const float* x, float* y) {
+    size_t n = attention_size(atomspace_view_count(view));
+    STATS_SPAN_BEGIN(span);
+    if (atomspace_view_count(view) == 0) {
+        for (size_t i = 0; i < n; i++) {
+            y[i] = attention_weight * x[i];
+        }
+        STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_MATVEC, 2 * n * sizeof(float));
+        return 0;
+    }
+
+    // With atoms sorted by activation a, the row sum splits at atom i:
+    //   sum_j |a_i - a_j| x_j = a_i (Xlo - Xhi) - (AXlo - AXhi)
+    // where lo/hi are the prefix/suffix sums of x_j and a_j x_j below and
+    // above it, so the product is O(N log N) instead of O(N^2).
+    similarity_key_t* keys = malloc(n * sizeof(similarity_key_t));
+    if (!keys) return -1;
+    for (size_t i = 0; i < n; i++) {
+        keys[i].mean = view->activation[i];
+        keys[i].index = (uint32_t)i;
+    }
+    qsort(keys, n, sizeof(similarity_key_t), compare_similarity_keys);
+
+    double total_x = 0.0, total_ax = 0.0;
+    for (size_t p = 0; p < n; p++) {
+        double xv = x[keys[p].index];
+        total_x += xv;
+        total_ax += keys[p].mean * xv;
+    }
+
+    double half = attention_weight * 0.5;
+    double lo_x = 0.0, lo_ax = 0.0;
+    for (size_t p = 0; p < n; p++) {
+        uint32_t i = keys[p].index;
+        double a = keys[p].mean;
+        double xv = x[i];
+        double hi_x = total_x - lo_x - xv;
+        double hi_ax = total_ax - lo_ax - a * xv;
+        double spread = a * (lo_x - hi_x) - (lo_ax - hi_ax);
+        double off_diagonal = (total_x - xv) - spread;
+        y[i] = (float)(attention_weight * xv + half * off_diagonal);
+        lo_x += xv;
+        lo_ax += a * xv;
+    }
+
+    free(keys);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ATTENTION_MATVEC, 2 * n * sizeof(float));
+    return 0;
+}
+
+int attention_matvec(AtomSpace* as, float attention_weight, const float* x, float* y) {
+    if (!as || !x || !y) return -1;
+    // x and y are sized by the atoms in the view at the call
+    int status = attention_matvec_view(atomspace_view_acquire(as), attention_weight, x, y);
+    atomspace_view_release();
+    return status;
+}
+
+// Kernel encode/decode scales
+static float encode_factor(const cognitive_kernel_t* kernel) {
+    return kernel_encode_factor(kernel);
+}
+
+static float decode_factor(const cognitive_kernel_t* kernel) {
+    float inverse_attention = 1.0f / (kernel->attention_weight + 1e-6f);
+    float inverse_meta = 1.0f / (1.0f + kernel->meta_level * 0.1f);
+    return inverse_attention * inverse_meta;
+}
+
+// Batched encode
+// Every kernel's output is the AtomSpace activation column (padded with
+// the default activation) times a per-kernel factor. Walking the outputs
+// block by block keeps each activation block in L1 while all N kernels
+// consume it, and reads the column directly instead of converting it to
+// a temporary tensor per kernel.
+
+typedef struct {
+    struct ggml_tensor* const* outputs;  // one tensor per kernel, or
+    struct ggml_tensor* stacked;         // one plane per kernel
+} encode_targets_t;
+
+static struct ggml_tensor* encode_target(const encode_targets_t* targets, size_t k,
+                                         size_t* size, size_t* first) {
+    if (targets->stacked) {
+        *size = (size_t)targets->stacked->ne[0] * targets->stacked->ne[1];
+        *first = k * *size;
+        return targets->stacked;
+    }
+    *size = (size_t)ggml_nelements(targets->outputs[k]);
+    *first = 0;
+    return targets->outputs[k];
+}
+
+static void encode_blocked(const AtomSpace* as, cognitive_kernel_t* const* kernels,
+                           size_t n_kernels, const encode_targets_t* targets) {
+    const simd_kernels_t* simd = simd_kernels();
+    float staging[ENCODE_BLOCK];
+    size_t longest = 0;
+    uint64_t bytes = 0;
+    for (size_t k = 0; k < n_kernels; k++) {
+        size_t size, first;
+        struct ggml_tensor* target = encode_target(targets, k, &size, &first);
+        if (size > longest) longest = size;
+        bytes += ggml_row_size(target->type, (int64_t)size);
+    }
+    (void)bytes;
+
+    STATS_SPAN_BEGIN(span);
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t atoms = atomspace_view_count(view);
+
+    for (size_t begin = 0; begin < longest; begin += ENCODE_BLOCK) {
+        for (size_t k = 0; k < n_kernels; k++) {
+            size_t size, first;
+            struct ggml_tensor* target = encode_target(targets, k, &size, &first);
+            if (begin >= size) continue;
+
+            // Typed targets are filled through the staging block
+            int typed = target->type != GGML_TYPE_F32;
+            float* out = typed ? staging : (float*)target->data + first + begin;
+
+            size_t end = begin + ENCODE_BLOCK < size ? begin + ENCODE_BLOCK : size;
+            size_t atoms_end = atoms < begin ? begin : atoms < end ? atoms : end;
+            float factor = encode_factor(kernels[k]);
+            simd->scale(out, view->activation + begin, factor, (int64_t)(atoms_end - begin));
+
+            // Elements past the last atom take the default low activation
+            float pad = 0.1f * factor;
+            for (size_t i = atoms_end; i < end; i++) {
+                out[i - begin] = pad;
+            }
+
+            if (typed) {
+                char* dst = (char*)target->data + ggml_row_size(target->type, (int64_t)(first + begin));
+                ggml_get_type_traits(target->type)->from_f32(staging, dst, (int64_t)(end - begin));
             }
         }
     }
-    
-    return attention_tensor;
+    atomspace_view_release();
+    STATS_SPAN_END(span, AGENT_ZERO_OP_ENCODE, bytes);
 }
 
 int encode_cognitive_state(
@@ -351,28 +448,39 @@ int encode_cognitive_state(
     cognitive_kernel_t* kernel,
     struct ggml_tensor* output_tensor) {
     
-    if (!as || !kernel || !output_tensor) return -1;
-    
-    // Create intermediate tensor from AtomSpace
-    struct ggml_tensor temp_tensor;
-    temp_tensor.ne[0] = output_tensor->ne[0];
-    temp_tensor.ne[1] = output_tensor->ne[1];
-    temp_tensor.data = calloc(temp_tensor.ne[0] * temp_tensor.ne[1], sizeof(float));
+    return encode_cognitive_state_batch(as, &kernel, 1, &output_tensor);
+}
+
+int encode_cognitive_state_batch(
+    AtomSpace* as,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    struct ggml_tensor* const* output_tensors) {
     
-    // Convert AtomSpace to tensor
-    atomspace_to_tensor(as, &temp_tensor);
+    if (!as || !kernels || !output_tensors) return -1;
+    for (size_t k = 0; k < n_kernels; k++) {
+        if (!kernels[k] || !output_tensors[k] || !ggml_is_contiguous(output_tensors[k])) return -1;
+    }
     
-    // Apply cognitive kernel transformation
-    float* temp_data = (float*)temp_tensor.data;
-    float* output_data = (float*)output_tensor->data;
+    encode_targets_t targets = { output_tensors, NULL };
+    encode_blocked(as, kernels, n_kernels, &targets);
+    return 0;
+}
+
+int encode_cognitive_state_stacked(
+    AtomSpace* as,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    struct ggml_tensor* output_tensor) {
     
-    for (int i = 0; i < output_tensor->ne[0] * output_tensor->ne[1]; i++) {
-        // Apply attention weighting and meta-level processing
-        output_data[i] = temp_data[i] * kernel->attention_weight * 
-                        (1.0f + kernel->meta_level * 0.1f);
+    if (!as || !kernels || !output_tensor || !ggml_is_contiguous(output_tensor)) return -1;
+    if ((size_t)output_tensor->ne[2] != n_kernels || output_tensor->ne[3] != 1) return -1;
+    for (size_t k = 0; k < n_kernels; k++) {
+        if (!kernels[k]) return -1;
     }
     
-    free(temp_tensor.data);
+    encode_targets_t targets = { NULL, output_tensor };
+    encode_blocked(as, kernels, n_kernels, &targets);
     return 0;
 }
 
@@ -381,22 +489,22 @@ int decode_cognitive_state(
     cognitive_kernel_t* kernel,
     AtomSpace* as) {
     
-    if (!input_tensor || !kernel || !as) return -1;
+    if (!input_tensor || !kernel || !as || !ggml_is_contiguous(input_tensor)) return -1;
     
     // Apply inverse kernel transformation
+    size_t size = (size_t)ggml_nelements(input_tensor);
     struct ggml_tensor decoded_tensor;
-    decoded_tensor.ne[0] = input_tensor->ne[0];
-    decoded_tensor.ne[1] = input_tensor->ne[1];
-    decoded_tensor.data = calloc(decoded_tensor.ne[0] * decoded_tensor.ne[1], sizeof(float));
+    ggml_tensor_init(&decoded_tensor, GGML_TYPE_F32, GGML_MAX_DIMS, input_tensor->ne,
+                     calloc(size, sizeof(float)));
     
-    float* input_data = (float*)input_tensor->data;
     float* decoded_data = (float*)decoded_tensor.data;
-    
-    float inverse_attention = 1.0f / (kernel->attention_weight + 1e-6f);
-    float inverse_meta = 1.0f / (1.0f + kernel->meta_level * 0.1f);
-    
-    for (int i = 0; i < input_tensor->ne[0] * input_tensor->ne[1]; i++) {
-        decoded_data[i] = input_data[i] * inverse_attention * inverse_meta;
+    if (!decoded_data) return -1;
+    if (input_tensor->type == GGML_TYPE_F32) {
+        simd_kernels()->scale(decoded_data, (const float*)input_tensor->data,
+                              decode_factor(kernel), (int64_t)size);
+    } else {
+        ggml_get_type_traits(input_tensor->type)->to_f32(input_tensor->data, decoded_data, (int64_t)size);
+        simd_kernels()->scale(decoded_data, decoded_data, decode_factor(kernel), (int64_t)size);
     }
     
     // Convert back to AtomSpace
@@ -406,89 +514,327 @@ int decode_cognitive_state(
     return 0;
 }
 
-// Hypergraph-specific bridge functions
-struct ggml_tensor* create_hypergraph_tensor_from_atomspace(
-    struct ggml_context* ctx,
-    AtomSpace* as) {
+int tensor_to_atomspace_delta(const struct ggml_tensor* tensor, AtomSpace* as,
+                              atomspace_delta_t* delta) {
+    if (!tensor || !ggml_is_contiguous(tensor)) return -1;
+    float* owned;
+    const float* values = tensor_f32_values(tensor, &owned);
+    if (!values) return -1;
+    int status = atomspace_apply_activations(as, values, (size_t)ggml_nelements(tensor),
+                                             1.0f, 0.01f, delta);
+    free(owned);
+    return status;
+}
+
+int decode_cognitive_state_delta(
+    const struct ggml_tensor* input_tensor,
+    cognitive_kernel_t* kernel,
+    AtomSpace* as,
+    atomspace_delta_t* delta) {
     
-    // Create hypergraph representation
-    hypergraph_t* hg = create_hypergraph(as->count, as->count * 2);
-    if (!hg) return NULL;
+    if (!input_tensor || !kernel || !as || !ggml_is_contiguous(input_tensor)) return -1;
     
-    // Populate hypergraph from AtomSpace
-    for (size_t i = 0; i < as->count; i++) {
-        if (as->atoms[i] && as->atoms[i]->truth_value) {
-            hg->node_weights[i] = (float)as->atoms[i]->truth_value->mean;
-            
-            // Create links based on atom relationships
-            for (size_t j = i + 1; j < as->count; j++) {
-                if (as->atoms[j] && as->atoms[j]->truth_value) {
-                    float weight_diff = fabsf(
-                        hg->node_weights[i] - 
-                        (float)as->atoms[j]->truth_value->mean
-                    );
-                    
-                    if (weight_diff < 0.3f) { // Similar atoms are connected
-                        hg->adjacency_matrix[i * hg->node_count + j] = 1;
-                        hg->adjacency_matrix[j * hg->node_count + i] = 1;
-                    }
+    float* owned;
+    const float* values = tensor_f32_values(input_tensor, &owned);
+    if (!values) return -1;
+    int status = atomspace_apply_activations(as, values, (size_t)ggml_nelements(input_tensor),
+                                             decode_factor(kernel), 0.01f, delta);
+    free(owned);
+    return status;
+}
+
+int decode_cognitive_state_batch(
+    const struct ggml_tensor* const* input_tensors,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    AtomSpace* const* spaces,
+    atomspace_delta_t* const* deltas) {
+    
+    if (!input_tensors || !kernels || !spaces || !deltas) return -1;
+    for (size_t k = 0; k < n_kernels; k++) {
+        if (!input_tensors[k] || !kernels[k] || !spaces[k] || !deltas[k] ||
+            !ggml_is_contiguous(input_tensors[k])) {
+            return -1;
+        }
+    }
+    
+    for (size_t k = 0; k < n_kernels; k++) {
+        if (decode_cognitive_state_delta(input_tensors[k], kernels[k], spaces[k], deltas[k]) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Hypergraph-specific bridge functions
+
+// Similarity join
+// |mean_i - mean_j| < threshold is a 1-D band join: after sorting atoms by
+// mean, the partners of each atom are the contiguous run that follows it
+// while the gap stays under the threshold. Float subtraction is monotone,
+// so the run ends at the first failing atom and the result equals the
+// all-pairs comparison on the same float means.
+#define SIMILARITY_PARALLEL_MIN_ATOMS 4096
+
+typedef struct {
+    const similarity_key_t* keys;
+    size_t count;
+    size_t begin, end;  // window starts handled by this worker
+    float threshold;
+    uint32_t* pairs;    // 2 entries per edge
+    size_t pair_count;
+    size_t pair_capacity;
+    int threaded;
+    int failed;
+} similarity_job_t;
+
+static void* similarity_join_range(void* arg) {
+    similarity_job_t* job = arg;
+    for (size_t a = job->begin; a < job->end; a++) {
+        for (size_t b = a + 1; b < job->count; b++) {
+            if (job->keys[b].mean - job->keys[a].mean >= job->threshold) break;
+
+            if (job->pair_count == job->pair_capacity) {
+                size_t capacity = job->pair_capacity ? job->pair_capacity * 2 : 1024;
+                uint32_t* grown = realloc(job->pairs, capacity * 2 * sizeof(uint32_t));
+                if (!grown) {
+                    job->failed = 1;
+                    return NULL;
                 }
+                job->pairs = grown;
+                job->pair_capacity = capacity;
             }
+            uint32_t i = job->keys[a].index;
+            uint32_t j = job->keys[b].index;
+            job->pairs[2 * job->pair_count] = i < j ? i : j;
+            job->pairs[2 * job->pair_count + 1] = i < j ? j : i;
+            job->pair_count++;
         }
     }
-    
+    return NULL;
+}
+
+// Explicit thread counts are honoured; the automatic choice stays serial
+// for inputs too small to amortize thread start-up
+static int similarity_thread_count(int n_threads, size_t atoms) {
+    if (n_threads <= 0) {
+        if (atoms < SIMILARITY_PARALLEL_MIN_ATOMS) return 1;
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        n_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if ((size_t)n_threads > atoms) n_threads = atoms ? (int)atoms : 1;
+    return n_threads;
+}
+
+hypergraph_t* create_hypergraph_from_atomspace(
+    AtomSpace* as,
+    float threshold,
+    int n_threads) {
+
+    if (!as) return NULL;
+
+    STATS_SPAN_BEGIN(span);
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t atoms = atomspace_view_count(view);
+    hypergraph_t* hg = create_hypergraph(atoms, atoms * 2);
+    similarity_key_t* keys = malloc((atoms ? atoms : 1) * sizeof(similarity_key_t));
+    if (!hg || !keys) {
+        atomspace_view_release();
+        destroy_hypergraph(hg);
+        free(keys);
+        return NULL;
+    }
+
+    // Retired atoms keep weight 0 and join nothing; past this copy the
+    // AtomSpace may change freely
+    size_t count = 0;
+    memcpy(hg->node_weights, view->activation, atoms * sizeof(float));
+    for (size_t i = 0; i < atoms; i++) {
+        if (view->live[i]) {
+            keys[count].mean = view->activation[i];
+            keys[count].index = (uint32_t)i;
+            count++;
+        }
+    }
+    atomspace_view_release();
+    qsort(keys, count, sizeof(similarity_key_t), compare_similarity_keys);
+
+    // Split window starts evenly; workers emit into private pair lists that
+    // are appended in worker order, so the edge order never depends on the
+    // thread count
+    int workers = similarity_thread_count(n_threads, count);
+    similarity_job_t* jobs = calloc((size_t)workers, sizeof(similarity_job_t));
+    pthread_t* threads = malloc((size_t)workers * sizeof(pthread_t));
+    int status = (jobs && threads) ? 0 : -1;
+
+    for (int w = 0; w < workers && status == 0; w++) {
+        jobs[w].keys = keys;
+        jobs[w].count = count;
+        jobs[w].begin = count * (size_t)w / (size_t)workers;
+        jobs[w].end = count * (size_t)(w + 1) / (size_t)workers;
+        jobs[w].threshold = threshold;
+    }
+    if (status == 0) {
+        // The calling thread takes the first range; a range whose thread
+        // cannot be started runs inline afterwards
+        for (int w = 1; w < workers; w++) {
+            jobs[w].threaded = pthread_create(&threads[w], NULL, similarity_join_range, &jobs[w]) == 0;
+        }
+        similarity_join_range(&jobs[0]);
+        for (int w = 1; w < workers; w++) {
+            if (jobs[w].threaded) {
+                pthread_join(threads[w], NULL);
+            } else {
+                similarity_join_range(&jobs[w]);
+            }
+        }
+    }
+
+    for (int w = 0; w < workers && status == 0; w++) {
+        if (jobs[w].failed) {
+            status = -1;
+            break;
+        }
+        for (size_t p = 0; p < jobs[w].pair_count; p++) {
+            if (hypergraph_add_edge(hg, &jobs[w].pairs[2 * p], 2, 1.0f) < 0) {
+                status = -1;
+                break;
+            }
+        }
+    }
+
+    if (jobs) {
+        for (int w = 0; w < workers; w++) {
+            free(jobs[w].pairs);
+        }
+    }
+    free(jobs);
+    free(threads);
+    free(keys);
+
+    if (status != 0) {
+        destroy_hypergraph(hg);
+        return NULL;
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_SIMILARITY_HYPERGRAPH,
+                   atoms * sizeof(float) + hg->link_count * 2 * sizeof(uint32_t));
+    return hg;
+}
+
+struct ggml_tensor* create_hypergraph_tensor_from_atomspace(
+    struct ggml_context* ctx,
+    AtomSpace* as) {
+
+    // Create hypergraph representation
+    hypergraph_t* hg = create_hypergraph_from_atomspace(as, ATOMSPACE_SIMILARITY_THRESHOLD, 0);
+    if (!hg) return NULL;
+
     // Convert hypergraph to tensor
     struct ggml_tensor* tensor = encode_hypergraph_to_tensor(ctx, hg);
-    
+
     destroy_hypergraph(hg);
     return tensor;
 }
 
+sparse_tensor_t* create_sparse_hypergraph_tensor_from_atomspace(
+    AtomSpace* as,
+    float threshold,
+    int n_threads) {
+
+    hypergraph_t* hg = create_hypergraph_from_atomspace(as, threshold, n_threads);
+    if (!hg) return NULL;
+
+    sparse_tensor_t* sp = encode_hypergraph_to_sparse(hg);
+
+    destroy_hypergraph(hg);
+    return sp;
+}
+
 // Cognitive pattern matching bridge
+typedef struct {
+    const AtomSpace* as;
+    float* data;
+    size_t size;
+} pattern_match_result_t;
+
+static void record_pattern_match(uint32_t atom, void* user) {
+    pattern_match_result_t* result = user;
+    if (atom < result->size) {
+        // atomspace_match_name holds writers off, so the columns are current
+        result->data[atom] = result->as->activation[atom];
+    }
+}
+
 int pattern_match_atomspace(
     AtomSpace* as,
     const char* pattern_name,
     struct ggml_tensor* result_tensor) {
     
-    if (!as || !pattern_name || !result_tensor) return -1;
+    if (!as || !pattern_name || !result_tensor || !ggml_is_contiguous(result_tensor)) return -1;
     
-    float* result_data = (float*)result_tensor->data;
-    size_t result_size = result_tensor->ne[0] * result_tensor->ne[1];
+    pattern_match_result_t result = {
+        as, (float*)result_tensor->data, (size_t)ggml_nelements(result_tensor)
+    };
     
     // Initialize result
-    memset(result_data, 0, result_size * sizeof(float));
+    memset(result.data, 0, result.size * sizeof(float));
+    
+    // Find pattern matches in AtomSpace through the name index
+    atomspace_match_name(as, pattern_name, record_pattern_match, &result);
     
-    // Find pattern matches in AtomSpace
-    for (size_t i = 0; i < as->count && i < result_size; i++) {
-        if (as->atoms[i] && as->atoms[i]->name) {
-            if (strstr(as->atoms[i]->name, pattern_name)) {
-                result_data[i] = (float)as->atoms[i]->truth_value->mean;
+    return 0;
+}
+
+size_t pattern_match_atomspace_similar(
+    const AtomSpace* as,
+    const ann_index_t* index,
+    const float* query,
+    size_t k,
+    size_t ef,
+    uint32_t* atoms,
+    float* distances) {
+    
+    if (!as || !index || !query || !atoms || k == 0) return 0;
+    
+    // Over-fetch until k live atoms are found or the index runs out
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t atom_count = atomspace_view_count(view);
+    size_t kept = 0;
+    for (size_t fetch = k; kept < k; fetch *= 2) {
+        uint32_t* ids = malloc(fetch * sizeof(uint32_t));
+        float* dist = malloc(fetch * sizeof(float));
+        size_t found = ids && dist ? ann_index_search(index, query, fetch, ef, ids, dist) : 0;
+        kept = 0;
+        for (size_t i = 0; i < found && kept < k; i++) {
+            if (ids[i] < atom_count && view->live[ids[i]]) {
+                atoms[kept] = ids[i];
+                if (distances) distances[kept] = dist[i];
+                kept++;
             }
         }
+        free(ids);
+        free(dist);
+        if (found < fetch || fetch >= ann_index_size(index)) break;
     }
-    
-    return 0;
+    atomspace_view_release();
+    return kept;
 }
 
 // Example usage functions for demonstration
-void demo_bridge_usage() {
+void demo_bridge_usage(void) {
     // This function demonstrates how to use the bridge
     
     // Create mock structures
     AtomSpace* as = create_atomspace();
     
     // Add some sample atoms
-    add_atom_to_space(as, create_atom(ATOM_TYPE_CONCEPT, "agent-zero", 0.9, 0.8));
-    add_atom_to_space(as, create_atom(ATOM_TYPE_CONCEPT, "cognitive-function", 0.7, 0.9));
-    add_atom_to_space(as, create_atom(ATOM_TYPE_CONCEPT, "intelligence", 0.8, 0.85));
+    atomspace_add_atom(as, ATOM_TYPE_CONCEPT, "agent-zero", 0.9, 0.8);
+    atomspace_add_atom(as, ATOM_TYPE_CONCEPT, "cognitive-function", 0.7, 0.9);
+    atomspace_add_atom(as, ATOM_TYPE_CONCEPT, "intelligence", 0.8, 0.85);
     
-    // Create GGML context
-    struct ggml_context* ctx = malloc(sizeof(struct ggml_context));
+    // Create GGML context; every intermediate below lives in its arena
+    struct ggml_context* ctx = ggml_context_create(4 * 1024 * 1024);
     if (ctx) {
-        ctx->mem_buffer = NULL;
-        ctx->mem_size = 0;
-        ctx->mem_used = 0;
-    
         // Create cognitive kernel
         int shape[] = {64, 64};
         cognitive_kernel_t* kernel = create_cognitive_kernel(ctx, shape, 2, 0.8f);
@@ -498,24 +844,16 @@ void demo_bridge_usage() {
             atomspace_to_tensor(as, kernel->tensor_field);
             
             // Create attention tensor
-            struct ggml_tensor* attention = create_attention_tensor(ctx, as, 0.8f);
+            create_attention_tensor(ctx, as, 0.8f);
             
             // Apply cognitive attention
-            struct ggml_tensor* result = cognitive_attention_matrix(ctx, kernel->tensor_field, 0.8f);
+            cognitive_attention_matrix(ctx, kernel->tensor_field, 0.8f);
             
-            // Clean up
+            // Clean up; the tensors above are dropped with the context
             destroy_cognitive_kernel(kernel);
-            if (attention && attention->data) {
-                free(attention->data);
-                free(attention);
-            }
-            if (result && result->data) {
-                free(result->data);
-                free(result);
-            }
         }
         
-        free(ctx);
+        ggml_context_free(ctx);
     }
     
     destroy_atomspace(as);
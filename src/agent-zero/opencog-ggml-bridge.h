@@ -0,0 +1,336 @@
+// Bridge between OpenCog AtomSpace and GGML tensors
+// /src/agent-zero/opencog-ggml-bridge.h
+
+#ifndef OPENCOG_GGML_BRIDGE_H
+#define OPENCOG_GGML_BRIDGE_H
+
+#include "cognitive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mock OpenCog constants
+#define ATOM_TYPE_CONCEPT 1
+#define ATOM_TYPE_LINK 2
+#define ATOM_TYPE_INHERITANCE 3
+
+// Atoms closer than this in truth-value mean are linked by default
+#define ATOMSPACE_SIMILARITY_THRESHOLD 0.3f
+
+typedef struct AtomSpace AtomSpace;
+
+AtomSpace* create_atomspace(void);
+void destroy_atomspace(AtomSpace* as);
+
+// Remove every atom; capacity and interned names are kept for reuse
+void atomspace_clear(AtomSpace* as);
+
+// Returns the new atom's handle (its index), or -1 on allocation failure
+int64_t atomspace_add_atom(AtomSpace* as, int type, const char* name,
+                           double mean, double confidence);
+size_t atomspace_size(const AtomSpace* as);
+
+// Concurrency: add, clear and atomspace_apply_activations serialize with
+// each other and may run on any thread. Reads of the activation column
+// (atomspace_to_tensor, the encoders, the attention builders, the untyped
+// cursor) never block and see a consistent prefix of the atoms, even while
+// a writer runs. Inside atomspace_read_begin/end, pointers from
+// atomspace_activations() stay valid whatever the writers do; sections
+// nest and are per thread. Do not write from inside a section, nor call
+// atomspace_match_name or walk a typed cursor there: they take the
+// writers' lock, which clear may hold while it waits for the section to
+// end.
+void atomspace_read_begin(const AtomSpace* as);
+void atomspace_read_end(const AtomSpace* as);
+
+// Indexed queries. The by-type and by-name lookups return the number of
+// matching handles and point *atoms at an ascending handle array owned by
+// the AtomSpace, valid until it is next modified; they must not overlap a
+// writer.
+size_t atomspace_atoms_by_type(const AtomSpace* as, int type, const uint32_t** atoms);
+size_t atomspace_atoms_by_name(const AtomSpace* as, const char* name, const uint32_t** atoms);
+
+// Call visit for every atom whose name contains substring; returns the
+// number of atoms visited. Cost follows the candidate names sharing the
+// pattern's rarest trigram, not the AtomSpace size. Writers wait while it
+// runs, so visit must not modify the AtomSpace.
+typedef void (*atomspace_visit_fn)(uint32_t atom, void* user);
+size_t atomspace_match_name(const AtomSpace* as, const char* substring,
+                            atomspace_visit_fn visit, void* user);
+
+// Truth-value means as a contiguous f32 column, one entry per atom handle.
+// The tensor variant wraps that column without copying. Both are read-only
+// and valid until the enclosing read section ends, or without one until
+// the AtomSpace next changes.
+const float* atomspace_activations(const AtomSpace* as);
+struct ggml_tensor* atomspace_activation_tensor(struct ggml_context* ctx, AtomSpace* as);
+
+void atomspace_to_tensor(AtomSpace* as, struct ggml_tensor* tensor);
+void tensor_to_atomspace(const struct ggml_tensor* tensor, AtomSpace* as);
+
+// Chunked walk over atom handles without building a handle array. A
+// negative type visits every handle in order, retired ones included (their
+// activation reads 0), matching the element order of atomspace_to_tensor;
+// otherwise the live atoms of that type. The cursor tolerates atoms being
+// added between calls.
+typedef struct {
+    const AtomSpace* as;
+    int type;
+    size_t position;
+} atomspace_cursor_t;
+
+void atomspace_cursor_init(atomspace_cursor_t* cursor, const AtomSpace* as, int type);
+
+// Store up to max handles and/or their activations (either may be NULL);
+// returns how many, 0 once the walk is done
+size_t atomspace_cursor_next(atomspace_cursor_t* cursor, uint32_t* handles,
+                             float* activations, size_t max);
+
+// Streaming encode
+// Fills a contiguous tensor from activations pushed in chunks of any size,
+// so the source (an AtomSpace cursor, a storage backend, a file) never has
+// to be resident: element i receives scale * the i-th pushed value, and
+// finish pads the rest with scale * 0.1, exactly as atomspace_to_tensor
+// (scale 1) and encode_cognitive_state do. Typed tensors are converted
+// through the embedded tile, so memory beyond the tensor itself stays
+// bounded; the tensor may be a file-backed mapping.
+#define ATOMSPACE_STREAM_TILE 4096
+
+typedef struct {
+    struct ggml_tensor* tensor;
+    float scale;
+    size_t size;         // tensor elements
+    size_t written;      // elements filled so far
+    size_t staged;       // values waiting in tile (typed tensors)
+    float tile[ATOMSPACE_STREAM_TILE];
+} atomspace_tensor_stream_t;
+
+// Returns 0, or -1 for a NULL, dataless or non-contiguous tensor
+int atomspace_tensor_stream_init(atomspace_tensor_stream_t* stream,
+                                 struct ggml_tensor* tensor, float scale);
+
+// Returns the number of values consumed; values past the tensor's end are
+// dropped
+size_t atomspace_tensor_stream_push(atomspace_tensor_stream_t* stream,
+                                    const float* activations, size_t n);
+
+// Pad the remaining elements and flush; the stream is done afterwards
+void atomspace_tensor_stream_finish(atomspace_tensor_stream_t* stream);
+
+// Atom handles changed by one delta decode; created and retired are
+// ascending, updated follows element order. Reuse one delta across calls;
+// its arrays only grow.
+typedef struct {
+    uint32_t* updated;      // truth value changed in place
+    size_t updated_count;
+    uint32_t* created;      // crossed above the threshold (new or revived)
+    size_t created_count;
+    uint32_t* retired;      // fell to or below the threshold
+    size_t retired_count;
+    // Internal
+    size_t updated_capacity, created_capacity, retired_capacity;
+    uint32_t* revived;
+    size_t revived_count, revived_capacity;
+    uint32_t* scratch;
+    size_t scratch_capacity;
+} atomspace_delta_t;
+
+atomspace_delta_t* create_atomspace_delta(void);
+void destroy_atomspace_delta(atomspace_delta_t* delta);
+
+// Delta decode of values[i] * scale into the concept atoms bound to each
+// element: atoms above threshold are updated in place, created (or
+// revived with their old handle) when they cross it, and retired when
+// they fall below it. Elements are bound to atoms on first use, adopting
+// an existing "concept_<i>" atom when there is one. Atoms the decoder does
+// not manage are left alone. Returns 0, or -1 on allocation failure.
+int atomspace_apply_activations(AtomSpace* as, const float* values, size_t n,
+                                float scale, float threshold, atomspace_delta_t* delta);
+
+// Incremental tensor_to_atomspace with the same 0.01 activation threshold
+int tensor_to_atomspace_delta(const struct ggml_tensor* tensor, AtomSpace* as,
+                              atomspace_delta_t* delta);
+
+// Attention between atom handles: weight on the diagonal and
+// (1 - |mean_i - mean_j|) * weight / 2 elsewhere, over attention_tensor_size()
+// rows (64 for an empty AtomSpace)
+size_t attention_tensor_size(const AtomSpace* as);
+
+struct ggml_tensor* create_attention_tensor(
+    struct ggml_context* ctx,
+    AtomSpace* as,
+    float attention_weight);
+
+// The same matrix stored as type (F16, BF16, or Q8_0 when the size is a
+// multiple of QK8_0); NULL if the type does not fit
+struct ggml_tensor* create_attention_tensor_typed(
+    struct ggml_context* ctx,
+    AtomSpace* as,
+    float attention_weight,
+    int type);
+
+// The symmetric matrix as its packed upper triangle: row i holds columns
+// i..n-1, n * (n + 1) / 2 values in all
+typedef struct {
+    size_t n;
+    float* values;
+} packed_attention_t;
+
+packed_attention_t* create_packed_attention(AtomSpace* as, float attention_weight);
+void destroy_packed_attention(packed_attention_t* packed);
+float packed_attention_get(const packed_attention_t* packed, size_t i, size_t j);
+
+// y = A x for the attention matrix A without forming it, in O(N log N);
+// x and y hold attention_tensor_size(as) values. Returns 0 or -1.
+int attention_matvec(AtomSpace* as, float attention_weight, const float* x, float* y);
+
+int encode_cognitive_state(
+    AtomSpace* as,
+    cognitive_kernel_t* kernel,
+    struct ggml_tensor* output_tensor);
+
+// Encode the AtomSpace once for many kernels: output_tensors[k] receives
+// what encode_cognitive_state(as, kernels[k], output_tensors[k]) would
+// write, in one cache-blocked pass with no temporaries. The stacked form
+// writes kernel k to plane k of a 3D tensor with ne[2] == n_kernels.
+// Returns -1 on invalid arguments without writing anything.
+int encode_cognitive_state_batch(
+    AtomSpace* as,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    struct ggml_tensor* const* output_tensors);
+
+int encode_cognitive_state_stacked(
+    AtomSpace* as,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    struct ggml_tensor* output_tensor);
+
+int decode_cognitive_state(
+    const struct ggml_tensor* input_tensor,
+    cognitive_kernel_t* kernel,
+    AtomSpace* as);
+
+// decode_cognitive_state through the delta decoder: the inverse kernel
+// scale is fused into the update, so no temporary tensor is allocated
+int decode_cognitive_state_delta(
+    const struct ggml_tensor* input_tensor,
+    cognitive_kernel_t* kernel,
+    AtomSpace* as,
+    atomspace_delta_t* delta);
+
+// Delta-decode input_tensors[k] with kernels[k] into spaces[k], reporting
+// into deltas[k]. Arguments are validated before any space is touched.
+int decode_cognitive_state_batch(
+    const struct ggml_tensor* const* input_tensors,
+    cognitive_kernel_t* const* kernels,
+    size_t n_kernels,
+    AtomSpace* const* spaces,
+    atomspace_delta_t* const* deltas);
+
+// Pipelined encode -> compute -> decode
+// cognitive_pipeline_submit() copies the AtomSpace's activations and
+// returns at once, so the caller may keep modifying that AtomSpace; encode,
+// compute and decode then run on one thread each, depth frames in flight.
+// A frame's results are those of encode_cognitive_state, the compute
+// function and decode_cognitive_state_delta run back to back on its
+// snapshot, and frames complete in submission order.
+
+// Compute stage: read input (the encoded frame, the kernel field's type
+// and shape) and write output (f32, same shape). Returns 0 or -1.
+typedef int (*cognitive_pipeline_compute_fn)(
+    const struct ggml_tensor* input, struct ggml_tensor* output, void* user);
+
+// Called on the decode thread, in frame order, once a frame is complete.
+// status is 0 or -1 (encode, compute or decode failed; a failed frame is
+// not decoded). output is valid during the call only; delta is the sink's
+// delta, or NULL without a sink. Must not wait on the pipeline.
+typedef void (*cognitive_pipeline_done_fn)(
+    uint64_t frame, int status, const struct ggml_tensor* output,
+    const atomspace_delta_t* delta, void* user);
+
+typedef struct {
+    cognitive_kernel_t* kernel;               // encode / decode scaling and frame shape
+    cognitive_pipeline_compute_fn compute;    // NULL: cognitive_attention_matrix_into
+    void* compute_user;                       //   with the kernel's weight
+    AtomSpace* sink;                          // decode target, or NULL to skip decoding;
+                                              //   the decode thread owns it while frames
+                                              //   are in flight
+    atomspace_delta_t* delta;                 // sink delta; NULL: the pipeline's own
+    cognitive_pipeline_done_fn done;          // may be NULL
+    void* done_user;
+    size_t depth;                             // frames in flight, 0 = 3, at least 2
+} cognitive_pipeline_config_t;
+
+typedef struct cognitive_pipeline cognitive_pipeline_t;
+
+// Starts the stage threads; NULL on invalid configuration or failure
+cognitive_pipeline_t* create_cognitive_pipeline(const cognitive_pipeline_config_t* config);
+
+// Completes every submitted frame, then stops the threads
+void destroy_cognitive_pipeline(cognitive_pipeline_t* p);
+
+// Snapshot as and queue it as the next frame, blocking while depth frames
+// are in flight. Submit from one thread at a time. Returns the frame
+// number (0, 1, ...), or -1 on invalid arguments or allocation failure.
+int64_t cognitive_pipeline_submit(cognitive_pipeline_t* p, const AtomSpace* as);
+
+// 1 once frame is complete (its callback has returned), 0 while in
+// flight, -1 if it was never submitted
+int cognitive_pipeline_poll(cognitive_pipeline_t* p, uint64_t frame);
+
+// Block until frame is complete; returns 0, or -1 if it was never submitted
+int cognitive_pipeline_wait(cognitive_pipeline_t* p, uint64_t frame);
+
+// Block until every submitted frame is complete
+void cognitive_pipeline_drain(cognitive_pipeline_t* p);
+
+// Frames completed with a nonzero status
+uint64_t cognitive_pipeline_failures(cognitive_pipeline_t* p);
+
+// Similarity hypergraph: one 2-node edge for every pair of atoms whose
+// truth-value means differ by less than threshold, node weights set to the
+// means. Built with a sort + sliding-window join in O(N log N + E); the
+// edge order is the same for every n_threads (<= 0 picks one per CPU).
+hypergraph_t* create_hypergraph_from_atomspace(
+    AtomSpace* as,
+    float threshold,
+    int n_threads);
+
+// Dense and sparse encodings of the default similarity hypergraph
+struct ggml_tensor* create_hypergraph_tensor_from_atomspace(
+    struct ggml_context* ctx,
+    AtomSpace* as);
+
+sparse_tensor_t* create_sparse_hypergraph_tensor_from_atomspace(
+    AtomSpace* as,
+    float threshold,
+    int n_threads);
+
+int pattern_match_atomspace(
+    AtomSpace* as,
+    const char* pattern_name,
+    struct ggml_tensor* result_tensor);
+
+// Similarity retrieval: the k live atoms whose indexed rows are nearest to
+// query, nearest first, for an index whose row id i is atom handle i (built
+// with ann_index_add_rows from encode_hypergraph_to_tensor of the
+// AtomSpace's hypergraph, or from kernel outputs in handle order). Ids of
+// retired or unknown atoms are skipped. Returns how many were stored.
+size_t pattern_match_atomspace_similar(
+    const AtomSpace* as,
+    const ann_index_t* index,
+    const float* query,
+    size_t k,
+    size_t ef,
+    uint32_t* atoms,
+    float* distances);
+
+void demo_bridge_usage(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPENCOG_GGML_BRIDGE_H
@@ -0,0 +1,563 @@
+// Agent-Zero Cognitive Pattern Matching Engine
+// /src/agent-zero/pattern-match.c
+//
+// Cross-correlates K patterns against one data plane:
+//   out[k][i][j] = sum P[k][pi][pj] * D[i + pi][j + pj]
+// with data read as zero past its bottom/right edges. Three backends
+// compute the same result:
+// - direct: one SIMD axpy per pattern tap; best for a handful of taps.
+//           3x3, 5x5 and 7x7 patterns take a fully unrolled kernel
+//           instantiated per shape (simd-kernels-impl.h) instead
+// - gemm:   im2col over row blocks + register-blocked SGEMM, so every
+//           column load is shared by four patterns
+// - fft:    2D radix-2 FFT correlation; cost is independent of the
+//           pattern area, and the data spectrum is computed once for
+//           the whole batch (two real patterns share each complex FFT)
+// Each backend splits into independent output blocks (pattern rows, im2col
+// row blocks, pattern pairs) run on the thread pool; every block is computed
+// the same way whichever thread runs it, so results match the serial path.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cognitive-internal.h"
+
+// Backend selection thresholds (pattern taps, clipped to the data)
+#define MATCH_DIRECT_MAX_TAPS 16
+#define MATCH_GEMM_MAX_TAPS 256
+
+// im2col block budget and SGEMM cache blocking
+#define MATCH_IM2COL_BYTES (1024 * 1024)
+#define MATCH_GEMM_KC 128
+#define MATCH_GEMM_NC 1024
+
+typedef struct {
+    const float* data;      // dense rows x cols
+    int rows, cols;
+    const float* patterns;  // dense count x prows x pcols
+    int prows, pcols;
+    int count;
+    float* out;             // dense count x rows x cols, zeroed
+} match_problem_t;
+
+// ---------------------------------------------------------------------------
+// Direct
+
+// Compile-time specialized row kernel for the pattern shape, or NULL.
+// Only unclipped patterns qualify: the kernel reads all prows x pcols taps.
+static simd_correlate_fn specialized_row(const match_problem_t* m, const simd_kernels_t* k) {
+    if (m->prows > m->rows || m->pcols > m->cols) return NULL;
+    for (int s = 0; s < SIMD_CORRELATE_SHAPE_COUNT; s++) {
+        if (k->correlate_shapes[s].prows == m->prows && k->correlate_shapes[s].pcols == m->pcols) {
+            return k->correlate_shapes[s].row;
+        }
+    }
+    return NULL;
+}
+
+// Output row i of pattern p
+static void direct_row(const match_problem_t* m, const simd_kernels_t* k, int p, int i) {
+    int prows = m->prows < m->rows ? m->prows : m->rows;
+    int pcols = m->pcols < m->cols ? m->pcols : m->cols;
+    const float* pattern = m->patterns + (size_t)p * m->prows * m->pcols;
+    float* out_row = m->out + ((size_t)p * m->rows + i) * m->cols;
+    simd_correlate_fn row = specialized_row(m, k);
+    // The bottom prows - 1 rows clip and take the generic taps
+    if (row && i + m->prows <= m->rows) {
+        row(out_row, m->data + (size_t)i * m->cols, m->cols, pattern, m->cols);
+        return;
+    }
+    for (int pi = 0; pi < prows && i + pi < m->rows; pi++) {
+        const float* data_row = m->data + (size_t)(i + pi) * m->cols;
+        for (int pj = 0; pj < pcols; pj++) {
+            k->axpy(out_row, data_row + pj, pattern[pi * m->pcols + pj], m->cols - pj);
+        }
+    }
+}
+
+// Units are (pattern, row) pairs in pattern-major order
+static void direct_range(int64_t begin, int64_t end, void* arg) {
+    const match_problem_t* m = arg;
+    const simd_kernels_t* k = simd_kernels();
+    for (int64_t u = begin; u < end; u++) {
+        direct_row(m, k, (int)(u / m->rows), (int)(u % m->rows));
+    }
+}
+
+static void match_direct(const match_problem_t* m) {
+    int64_t taps = (int64_t)m->prows * m->pcols;
+    parallel_for((int64_t)m->count * m->rows, parallel_grain(taps * m->cols), direct_range, (void*)m);
+}
+
+// ---------------------------------------------------------------------------
+// im2col + SGEMM
+
+typedef struct {
+    const match_problem_t* m;
+    int64_t taps;
+    int64_t block_rows;   // output rows per im2col block
+} gemm_job_t;
+
+// Output rows [i0, i0 + rows) of every pattern through a columns buffer of
+// taps x (block_rows * cols)
+static void gemm_block(const gemm_job_t* job, float* columns, int64_t i0, int64_t rows) {
+    const match_problem_t* m = job->m;
+    const simd_kernels_t* k = simd_kernels();
+    int64_t taps = job->taps;
+    int64_t width = job->block_rows * m->cols;
+    int64_t n = rows * m->cols;
+    size_t plane = (size_t)m->rows * m->cols;
+
+    // columns[tap][r * cols + j] = D[i0 + r + pi][j + pj], zero past the edge
+    for (int pi = 0; pi < m->prows; pi++) {
+        for (int pj = 0; pj < m->pcols; pj++) {
+            float* col = columns + (int64_t)(pi * m->pcols + pj) * width;
+            for (int64_t r = 0; r < rows; r++) {
+                float* dst = col + r * m->cols;
+                int64_t src_row = i0 + r + pi;
+                int64_t valid = src_row < m->rows ? m->cols - pj : 0;
+                if (valid < 0) valid = 0;
+                if (valid > 0) {
+                    memcpy(dst, m->data + src_row * m->cols + pj, (size_t)valid * sizeof(float));
+                }
+                memset(dst + valid, 0, (size_t)(m->cols - valid) * sizeof(float));
+            }
+        }
+    }
+
+    // out[p][block] += patterns[p][taps] * columns[taps][block]
+    float* c = m->out + (size_t)i0 * m->cols;
+    for (int64_t nb = 0; nb < n; nb += MATCH_GEMM_NC) {
+        int64_t nlen = n - nb < MATCH_GEMM_NC ? n - nb : MATCH_GEMM_NC;
+        for (int64_t kb = 0; kb < taps; kb += MATCH_GEMM_KC) {
+            int64_t klen = taps - kb < MATCH_GEMM_KC ? taps - kb : MATCH_GEMM_KC;
+            k->sgemm(c + nb, (int64_t)plane,
+                     m->patterns + kb, taps,
+                     columns + kb * width + nb, width,
+                     m->count, klen, nlen);
+        }
+    }
+}
+
+// Units are im2col blocks; each chunk owns one columns buffer
+static void gemm_range(int64_t begin, int64_t end, void* arg) {
+    const gemm_job_t* job = arg;
+    const match_problem_t* m = job->m;
+    float* columns = malloc((size_t)(job->taps * job->block_rows * m->cols) * sizeof(float));
+
+    for (int64_t b = begin; b < end; b++) {
+        int64_t i0 = b * job->block_rows;
+        int64_t rows = m->rows - i0 < job->block_rows ? m->rows - i0 : job->block_rows;
+        if (columns) {
+            gemm_block(job, columns, i0, rows);
+            continue;
+        }
+        // No scratch for this chunk: the direct path needs none
+        for (int p = 0; p < m->count; p++) {
+            for (int64_t i = i0; i < i0 + rows; i++) {
+                direct_row(m, simd_kernels(), p, (int)i);
+            }
+        }
+    }
+    free(columns);
+}
+
+static void match_gemm(const match_problem_t* m) {
+    gemm_job_t job;
+    job.m = m;
+    job.taps = (int64_t)m->prows * m->pcols;
+
+    // Rows of output per im2col block, bounded by the column buffer budget
+    job.block_rows = MATCH_IM2COL_BYTES / ((int64_t)m->cols * job.taps * (int64_t)sizeof(float));
+    if (job.block_rows < 1) job.block_rows = 1;
+    if (job.block_rows > m->rows) job.block_rows = m->rows;
+
+    int64_t blocks = (m->rows + job.block_rows - 1) / job.block_rows;
+    int64_t block_cost = job.taps * job.block_rows * m->cols * m->count;
+    parallel_for(blocks, parallel_grain(block_cost), gemm_range, &job);
+}
+
+// ---------------------------------------------------------------------------
+// FFT
+
+typedef struct {
+    size_t n;
+    float* cos_table;  // n / 2 twiddles
+    float* sin_table;
+    size_t* bitrev;
+} fft_plan_t;
+
+static int fft_plan_init(fft_plan_t* plan, size_t n) {
+    plan->n = n;
+    plan->cos_table = malloc(n / 2 * sizeof(float) + sizeof(float));
+    plan->sin_table = malloc(n / 2 * sizeof(float) + sizeof(float));
+    plan->bitrev = malloc(n * sizeof(size_t));
+    if (!plan->cos_table || !plan->sin_table || !plan->bitrev) return -1;
+
+    for (size_t i = 0; i < n / 2; i++) {
+        double angle = -2.0 * M_PI * (double)i / (double)n;
+        plan->cos_table[i] = (float)cos(angle);
+        plan->sin_table[i] = (float)sin(angle);
+    }
+
+    int bits = 0;
+    while (((size_t)1 << bits) < n) bits++;
+    for (size_t i = 0; i < n; i++) {
+        size_t r = 0;
+        for (int b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+    return 0;
+}
+
+static void fft_plan_free(fft_plan_t* plan) {
+    free(plan->cos_table);
+    free(plan->sin_table);
+    free(plan->bitrev);
+}
+
+// In-place iterative radix-2 FFT of n contiguous complex values (split
+// re/im arrays). The inverse is unnormalized.
+static void fft_1d(const fft_plan_t* plan, float* re, float* im, int inverse) {
+    size_t n = plan->n;
+    for (size_t i = 0; i < n; i++) {
+        size_t j = plan->bitrev[i];
+        if (j > i) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        size_t half = len >> 1;
+        size_t step = n / len;
+        for (size_t start = 0; start < n; start += len) {
+            for (size_t k = 0; k < half; k++) {
+                float wr = plan->cos_table[k * step];
+                float wi = sign * plan->sin_table[k * step];
+                size_t a = start + k;
+                size_t b = a + half;
+                float xr = re[b] * wr - im[b] * wi;
+                float xi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - xr;
+                im[b] = im[a] - xi;
+                re[a] += xr;
+                im[a] += xi;
+            }
+        }
+    }
+}
+
+// 2D FFT over an fr x fc split-complex grid: rows, then columns via a
+// gathered scratch line
+static void fft_2d(const fft_plan_t* row_plan, const fft_plan_t* col_plan,
+                   float* re, float* im, float* line_re, float* line_im, int inverse) {
+    size_t fr = col_plan->n;
+    size_t fc = row_plan->n;
+    for (size_t r = 0; r < fr; r++) {
+        fft_1d(row_plan, re + r * fc, im + r * fc, inverse);
+    }
+    for (size_t c = 0; c < fc; c++) {
+        for (size_t r = 0; r < fr; r++) {
+            line_re[r] = re[r * fc + c];
+            line_im[r] = im[r * fc + c];
+        }
+        fft_1d(col_plan, line_re, line_im, inverse);
+        for (size_t r = 0; r < fr; r++) {
+            re[r * fc + c] = line_re[r];
+            im[r * fc + c] = line_im[r];
+        }
+    }
+}
+
+static size_t next_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+typedef struct {
+    const match_problem_t* m;
+    fft_plan_t row_plan, col_plan;
+    size_t fr, fc, grid, line;
+    const float* data_re;  // data spectrum, shared read-only by every chunk
+    const float* data_im;
+} fft_job_t;
+
+// Correlate pattern p (and p + 1 when present) against the data spectrum
+static void fft_pair(const fft_job_t* job, int p, float* work_re, float* work_im,
+                     float* line_re, float* line_im) {
+    const match_problem_t* m = job->m;
+    size_t fr = job->fr, fc = job->fc;
+    size_t plane = (size_t)m->rows * m->cols;
+    const float* data_re = job->data_re;
+    const float* data_im = job->data_im;
+
+    int pair = p + 1 < m->count;
+    const float* pa = m->patterns + (size_t)p * m->prows * m->pcols;
+    const float* pb = pair ? pa + (size_t)m->prows * m->pcols : NULL;
+
+    // Z = Pa + i Pb packs two real patterns into one complex transform
+    memset(work_re, 0, job->grid * sizeof(float));
+    memset(work_im, 0, job->grid * sizeof(float));
+    for (int i = 0; i < m->prows; i++) {
+        for (int j = 0; j < m->pcols; j++) {
+            work_re[(size_t)i * fc + j] = pa[i * m->pcols + j];
+            if (pb) work_im[(size_t)i * fc + j] = pb[i * m->pcols + j];
+        }
+    }
+    fft_2d(&job->row_plan, &job->col_plan, work_re, work_im, line_re, line_im, 0);
+
+    // Unpack the spectra A, B of Pa, Pb from Z(k) and Z(-k), then form
+    // R = conj(A) D + i conj(B) D so the inverse yields corr_a + i corr_b
+    for (size_t u = 0; u < fr; u++) {
+        size_t nu = (fr - u) & (fr - 1);
+        for (size_t v = 0; v < fc; v++) {
+            size_t nv = (fc - v) & (fc - 1);
+            size_t idx = u * fc + v;
+            size_t nidx = nu * fc + nv;
+            if (nidx < idx) continue;  // bins are processed in (k, -k) pairs
+
+            float zr = work_re[idx], zi = work_im[idx];
+            float zr_n = work_re[nidx], zi_n = work_im[nidx];
+
+            // A(k) = (Z(k) + conj(Z(-k))) / 2, B(k) = (Z(k) - conj(Z(-k))) / 2i
+            float ar = 0.5f * (zr + zr_n), ai = 0.5f * (zi - zi_n);
+            float br = 0.5f * (zi + zi_n), bi = -0.5f * (zr - zr_n);
+
+            float dr = data_re[idx], di = data_im[idx];
+            float dr_n = data_re[nidx], di_n = data_im[nidx];
+
+            // R(k) = conj(A(k)) D(k) + i conj(B(k)) D(k)
+            float car = ar * dr + ai * di, cai = ar * di - ai * dr;
+            float cbr = br * dr + bi * di, cbi = br * di - bi * dr;
+            // A(-k) = conj(A(k)), likewise for B
+            float car_n = ar * dr_n - ai * di_n, cai_n = ar * di_n + ai * dr_n;
+            float cbr_n = br * dr_n - bi * di_n, cbi_n = br * di_n + bi * dr_n;
+
+            work_re[idx] = car - cbi;
+            work_im[idx] = cai + cbr;
+            work_re[nidx] = car_n - cbi_n;
+            work_im[nidx] = cai_n + cbr_n;
+        }
+    }
+    fft_2d(&job->row_plan, &job->col_plan, work_re, work_im, line_re, line_im, 1);
+
+    float norm = 1.0f / (float)job->grid;
+    float* out_a = m->out + (size_t)p * plane;
+    float* out_b = pair ? out_a + plane : NULL;
+    for (int i = 0; i < m->rows; i++) {
+        for (int j = 0; j < m->cols; j++) {
+            out_a[(size_t)i * m->cols + j] = work_re[(size_t)i * fc + j] * norm;
+            if (out_b) out_b[(size_t)i * m->cols + j] = work_im[(size_t)i * fc + j] * norm;
+        }
+    }
+}
+
+// Units are pattern pairs; each chunk owns one work grid
+static void fft_range(int64_t begin, int64_t end, void* arg) {
+    const fft_job_t* job = arg;
+    const match_problem_t* m = job->m;
+    float* work = malloc((2 * job->grid + 2 * job->line) * sizeof(float));
+
+    for (int64_t q = begin; q < end; q++) {
+        int p = (int)(2 * q);
+        if (work) {
+            fft_pair(job, p, work, work + job->grid, work + 2 * job->grid,
+                     work + 2 * job->grid + job->line);
+            continue;
+        }
+        // No scratch for this chunk: the direct path needs none
+        for (int pp = p; pp < p + 2 && pp < m->count; pp++) {
+            for (int i = 0; i < m->rows; i++) {
+                direct_row(m, simd_kernels(), pp, i);
+            }
+        }
+    }
+    free(work);
+}
+
+static int match_fft(const match_problem_t* m) {
+    // Linear (non-wrapping) correlation needs rows + prows - 1 in each dim
+    fft_job_t job = {0};
+    job.m = m;
+    job.fr = next_pow2((size_t)m->rows + m->prows - 1);
+    job.fc = next_pow2((size_t)m->cols + m->pcols - 1);
+    job.grid = job.fr * job.fc;
+    job.line = job.fr > job.fc ? job.fr : job.fc;
+
+    float* buffer = malloc((2 * job.grid + 2 * job.line) * sizeof(float));
+    int ok = buffer != NULL &&
+             fft_plan_init(&job.row_plan, job.fc) == 0 &&
+             fft_plan_init(&job.col_plan, job.fr) == 0;
+    if (!ok) {
+        free(buffer);
+        fft_plan_free(&job.row_plan);
+        fft_plan_free(&job.col_plan);
+        return -1;
+    }
+
+    float* data_re = buffer;
+    float* data_im = data_re + job.grid;
+    float* line_re = data_im + job.grid;
+    float* line_im = line_re + job.line;
+
+    // Data spectrum, shared by every pattern in the batch
+    memset(data_re, 0, 2 * job.grid * sizeof(float));
+    for (int i = 0; i < m->rows; i++) {
+        memcpy(data_re + (size_t)i * job.fc, m->data + (size_t)i * m->cols,
+               (size_t)m->cols * sizeof(float));
+    }
+    fft_2d(&job.row_plan, &job.col_plan, data_re, data_im, line_re, line_im, 0);
+    job.data_re = data_re;
+    job.data_im = data_im;
+
+    int64_t pairs = ((int64_t)m->count + 1) / 2;
+    parallel_for(pairs, parallel_grain((int64_t)job.grid), fft_range, &job);
+
+    free(buffer);
+    fft_plan_free(&job.row_plan);
+    fft_plan_free(&job.col_plan);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Entry points
+
+static cognitive_match_backend_t choose_backend(const match_problem_t* m) {
+    int64_t prows = m->prows < m->rows ? m->prows : m->rows;
+    int64_t pcols = m->pcols < m->cols ? m->pcols : m->cols;
+    int64_t taps = prows * pcols;
+    if (taps <= MATCH_DIRECT_MAX_TAPS) return COGNITIVE_MATCH_DIRECT;
+    if (specialized_row(m, simd_kernels())) return COGNITIVE_MATCH_DIRECT;
+    if (taps <= MATCH_GEMM_MAX_TAPS) return COGNITIVE_MATCH_GEMM;
+    return COGNITIVE_MATCH_FFT;
+}
+
+static int run_match(const match_problem_t* m, cognitive_match_backend_t backend) {
+    if (backend == COGNITIVE_MATCH_AUTO) {
+        backend = choose_backend(m);
+    }
+    switch (backend) {
+    case COGNITIVE_MATCH_DIRECT:
+        match_direct(m);
+        return 0;
+    case COGNITIVE_MATCH_GEMM:
+        match_gemm(m);
+        return 0;
+    case COGNITIVE_MATCH_FFT:
+        if (match_fft(m) == 0) return 0;
+        break;
+    default:
+        return -1;
+    }
+    // FFT setup allocation failed: the direct path needs no scratch
+    match_direct(m);
+    return 0;
+}
+
+// Dense f32 copy of the first count planes of t (rows x cols each), or t's
+// own data when it is already dense f32. *owned is set when the caller
+// must free.
+static const float* dense_planes(const struct ggml_tensor* t, int64_t first_plane,
+                                 int64_t count, float** owned) {
+    int64_t rows = t->ne[0];
+    int64_t cols = t->ne[1];
+    *owned = NULL;
+    if (t->type == GGML_TYPE_F32 && ggml_is_contiguous(t)) {
+        return (const float*)t->data + first_plane * rows * cols;
+    }
+
+    const ggml_type_traits_t* traits = ggml_get_type_traits(t->type);
+    float* copy = malloc((size_t)(count * rows * cols) * sizeof(float));
+    if (!copy) return NULL;
+    for (int64_t r = 0; r < count * rows; r++) {
+        traits->to_f32(ggml_get_row(t, first_plane * rows + r), copy + r * cols, cols);
+    }
+    *owned = copy;
+    return copy;
+}
+
+struct ggml_tensor* cognitive_pattern_match_batch(
+    struct ggml_context* ctx,
+    const struct ggml_tensor* patterns,
+    const struct ggml_tensor* data,
+    cognitive_match_backend_t backend) {
+
+    if (!patterns || !data || !patterns->data || !data->data) return NULL;
+    if (data->ne[2] != 1 || data->ne[3] != 1 || patterns->ne[3] != 1) return NULL;
+
+    int count = patterns->ne[2];
+    struct ggml_tensor* result = ggml_new_tensor_3d(
+        ctx, GGML_TYPE_F32, data->ne[0], data->ne[1], count);
+    if (!result) return NULL;
+
+    float* owned_data;
+    float* owned_patterns;
+    match_problem_t m;
+    m.data = dense_planes(data, 0, 1, &owned_data);
+    m.patterns = dense_planes(patterns, 0, count, &owned_patterns);
+    m.rows = data->ne[0];
+    m.cols = data->ne[1];
+    m.prows = patterns->ne[0];
+    m.pcols = patterns->ne[1];
+    m.count = count;
+    m.out = (float*)result->data;
+
+    STATS_SPAN_BEGIN(span);
+    int status = (m.data && m.patterns) ? run_match(&m, backend) : -1;
+    STATS_SPAN_END(span, AGENT_ZERO_OP_PATTERN_MATCH,
+                   ggml_nbytes(data) + ggml_nbytes(patterns) + ggml_nbytes(result));
+    free(owned_data);
+    free(owned_patterns);
+    if (status != 0) {
+        ggml_free_tensor(result);
+        return NULL;
+    }
+    return result;
+}
+
+struct ggml_tensor* cognitive_pattern_match(
+    struct ggml_context* ctx,
+    struct ggml_tensor* pattern,
+    struct ggml_tensor* data) {
+
+    if (!pattern || !data || !pattern->data || !data->data) return NULL;
+
+    struct ggml_tensor* match_result = ggml_new_tensor(
+        ctx, GGML_TYPE_F32, GGML_MAX_DIMS, data->ne);
+    if (!match_result) return NULL;
+
+    // The 2D pattern is applied to every plane of a batched data tensor
+    float* owned_pattern;
+    match_problem_t m;
+    m.patterns = dense_planes(pattern, 0, 1, &owned_pattern);
+    m.rows = data->ne[0];
+    m.cols = data->ne[1];
+    m.prows = pattern->ne[0];
+    m.pcols = pattern->ne[1];
+    m.count = 1;
+
+    int64_t planes = (int64_t)data->ne[2] * data->ne[3];
+    int status = m.patterns ? 0 : -1;
+    STATS_SPAN_BEGIN(span);
+    for (int64_t p = 0; p < planes && status == 0; p++) {
+        float* owned_data;
+        m.data = dense_planes(data, p, 1, &owned_data);
+        m.out = (float*)match_result->data + p * m.rows * m.cols;
+        status = m.data ? run_match(&m, COGNITIVE_MATCH_AUTO) : -1;
+        free(owned_data);
+    }
+    free(owned_pattern);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_PATTERN_MATCH,
+                   ggml_nbytes(data) + ggml_nbytes(pattern) + ggml_nbytes(match_result));
+
+    if (status != 0) {
+        ggml_free_tensor(match_result);
+        return NULL;
+    }
+    return match_result;
+}
@@ -0,0 +1,270 @@
+// Agent-Zero Cognitive Pipeline
+// /src/agent-zero/pipeline.c
+//
+// Frames move through four stages: the caller snapshots the AtomSpace's
+// published activations in cognitive_pipeline_submit() (without blocking
+// its writers), and one thread each runs encode, compute and decode. Every
+// frame has its own slot (snapshot, input tensor, output tensor), depth
+// slots in all, so frame N + 1 encodes while N computes and N - 1 decodes.
+// Stages take frames strictly in submission order, which keeps the decoded
+// AtomSpace identical to running the same frames one after another;
+// throughput is set by the slowest stage. Stage progress is four counters
+// under one mutex.
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cognitive-internal.h"
+#include "atomspace-internal.h"
+
+#define PIPELINE_DEFAULT_DEPTH 3
+
+typedef struct {
+    float* snapshot;
+    size_t snapshot_size;
+    size_t snapshot_capacity;
+    struct ggml_tensor* input;
+    struct ggml_tensor* output;
+    int status;
+} pipeline_slot_t;
+
+typedef enum {
+    STAGE_ENCODE = 0,
+    STAGE_COMPUTE,
+    STAGE_DECODE,
+    STAGE_COUNT
+} pipeline_stage_t;
+
+struct cognitive_pipeline {
+    cognitive_pipeline_config_t config;
+    atomspace_delta_t* owned_delta;
+    size_t depth;
+    pipeline_slot_t* slots;
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    // Frames past each point: submitted >= encoded >= computed >= decoded
+    uint64_t submitted;
+    uint64_t encoded;
+    uint64_t computed;
+    uint64_t decoded;
+    uint64_t failures;
+    int shutdown;
+    int started;
+    pthread_t threads[STAGE_COUNT];
+};
+
+typedef struct {
+    cognitive_pipeline_t* p;
+    pipeline_stage_t stage;
+} stage_arg_t;
+
+static int default_compute(const struct ggml_tensor* input, struct ggml_tensor* output, void* user) {
+    const cognitive_kernel_t* kernel = user;
+    return cognitive_attention_matrix_into(output, input, kernel->attention_weight);
+}
+
+static void encode_slot(cognitive_pipeline_t* p, pipeline_slot_t* slot) {
+    // Streaming from the snapshot writes what encode_cognitive_state would
+    atomspace_tensor_stream_t stream;
+    if (atomspace_tensor_stream_init(&stream, slot->input, kernel_encode_factor(p->config.kernel)) != 0) {
+        slot->status = -1;
+    } else {
+        atomspace_tensor_stream_push(&stream, slot->snapshot, slot->snapshot_size);
+        atomspace_tensor_stream_finish(&stream);
+    }
+}
+
+static void compute_slot(cognitive_pipeline_t* p, pipeline_slot_t* slot) {
+    if (slot->status == 0 &&
+        p->config.compute(slot->input, slot->output, p->config.compute_user) != 0) {
+        slot->status = -1;
+    }
+}
+
+static void decode_slot(cognitive_pipeline_t* p, pipeline_slot_t* slot, uint64_t frame) {
+    atomspace_delta_t* delta = p->config.delta ? p->config.delta : p->owned_delta;
+    if (slot->status == 0 && p->config.sink &&
+        decode_cognitive_state_delta(slot->output, p->config.kernel, p->config.sink, delta) != 0) {
+        slot->status = -1;
+    }
+    if (p->config.done) {
+        p->config.done(frame, slot->status, slot->output, p->config.sink ? delta : NULL,
+                       p->config.done_user);
+    }
+}
+
+static void* stage_main(void* arg) {
+    cognitive_pipeline_t* p = ((stage_arg_t*)arg)->p;
+    pipeline_stage_t stage = ((stage_arg_t*)arg)->stage;
+    free(arg);
+    uint64_t* upstream = stage == STAGE_ENCODE ? &p->submitted
+                       : stage == STAGE_COMPUTE ? &p->encoded : &p->computed;
+    uint64_t* progress = stage == STAGE_ENCODE ? &p->encoded
+                       : stage == STAGE_COMPUTE ? &p->computed : &p->decoded;
+
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        // At shutdown a stage leaves once every submitted frame is past it
+        while (*progress == *upstream && !(p->shutdown && *progress == p->submitted)) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        if (*progress == p->submitted) break;
+        uint64_t frame = *progress;
+        pthread_mutex_unlock(&p->lock);
+
+        // The slot belongs to this stage until progress moves past it
+        pipeline_slot_t* slot = &p->slots[frame % p->depth];
+        if (stage == STAGE_ENCODE) {
+            encode_slot(p, slot);
+        } else if (stage == STAGE_COMPUTE) {
+            compute_slot(p, slot);
+        } else {
+            decode_slot(p, slot, frame);
+        }
+
+        pthread_mutex_lock(&p->lock);
+        if (stage == STAGE_DECODE && slot->status != 0) p->failures++;
+        (*progress)++;
+        pthread_cond_broadcast(&p->changed);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+cognitive_pipeline_t* create_cognitive_pipeline(const cognitive_pipeline_config_t* config) {
+    if (!config || !config->kernel || !config->kernel->tensor_field) return NULL;
+    const struct ggml_tensor* field = config->kernel->tensor_field;
+    if (config->depth == 1) return NULL;
+
+    cognitive_pipeline_t* p = calloc(1, sizeof(cognitive_pipeline_t));
+    if (!p) return NULL;
+    p->config = *config;
+    if (!p->config.compute) {
+        p->config.compute = default_compute;
+        p->config.compute_user = config->kernel;
+    }
+    p->depth = config->depth ? config->depth : PIPELINE_DEFAULT_DEPTH;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->changed, NULL);
+
+    int ok = (p->slots = calloc(p->depth, sizeof(pipeline_slot_t))) != NULL;
+    if (ok && config->sink && !config->delta) {
+        ok = (p->owned_delta = create_atomspace_delta()) != NULL;
+    }
+    for (size_t s = 0; ok && s < p->depth; s++) {
+        p->slots[s].input = ggml_new_tensor(NULL, field->type, GGML_MAX_DIMS, field->ne);
+        p->slots[s].output = ggml_new_tensor(NULL, GGML_TYPE_F32, GGML_MAX_DIMS, field->ne);
+        ok = p->slots[s].input && p->slots[s].output;
+    }
+    for (int t = 0; ok && t < STAGE_COUNT; t++) {
+        stage_arg_t* arg = malloc(sizeof(stage_arg_t));
+        ok = arg != NULL;
+        if (ok) {
+            arg->p = p;
+            arg->stage = (pipeline_stage_t)t;
+            ok = pthread_create(&p->threads[t], NULL, stage_main, arg) == 0;
+            if (ok) p->started = t + 1;
+            else free(arg);
+        }
+    }
+    if (!ok) {
+        destroy_cognitive_pipeline(p);
+        return NULL;
+    }
+    return p;
+}
+
+void destroy_cognitive_pipeline(cognitive_pipeline_t* p) {
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+    for (int t = 0; t < p->started; t++) {
+        pthread_join(p->threads[t], NULL);
+    }
+
+    for (size_t s = 0; p->slots && s < p->depth; s++) {
+        free(p->slots[s].snapshot);
+        ggml_free_tensor(p->slots[s].input);
+        ggml_free_tensor(p->slots[s].output);
+    }
+    free(p->slots);
+    destroy_atomspace_delta(p->owned_delta);
+    pthread_cond_destroy(&p->changed);
+    pthread_mutex_destroy(&p->lock);
+    free(p);
+}
+
+int64_t cognitive_pipeline_submit(cognitive_pipeline_t* p, const AtomSpace* as) {
+    if (!p || !as) return -1;
+
+    // Wait for a free slot
+    pthread_mutex_lock(&p->lock);
+    while (p->submitted - p->decoded >= p->depth) {
+        pthread_cond_wait(&p->changed, &p->lock);
+    }
+    uint64_t frame = p->submitted;
+    pthread_mutex_unlock(&p->lock);
+
+    // Only the submitting thread touches a free slot
+    pipeline_slot_t* slot = &p->slots[frame % p->depth];
+    const atomspace_view_t* view = atomspace_view_acquire(as);
+    size_t count = atomspace_view_count(view);
+    if (count > slot->snapshot_capacity) {
+        float* snapshot = realloc(slot->snapshot, count * sizeof(float));
+        if (!snapshot) {
+            atomspace_view_release();
+            return -1;
+        }
+        slot->snapshot = snapshot;
+        slot->snapshot_capacity = count;
+    }
+    if (count) memcpy(slot->snapshot, view->activation, count * sizeof(float));
+    atomspace_view_release();
+    slot->snapshot_size = count;
+    slot->status = 0;
+
+    pthread_mutex_lock(&p->lock);
+    p->submitted++;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+    return (int64_t)frame;
+}
+
+int cognitive_pipeline_poll(cognitive_pipeline_t* p, uint64_t frame) {
+    if (!p) return -1;
+    pthread_mutex_lock(&p->lock);
+    int result = frame >= p->submitted ? -1 : p->decoded > frame;
+    pthread_mutex_unlock(&p->lock);
+    return result;
+}
+
+int cognitive_pipeline_wait(cognitive_pipeline_t* p, uint64_t frame) {
+    if (!p) return -1;
+    pthread_mutex_lock(&p->lock);
+    int known = frame < p->submitted;
+    while (known && p->decoded <= frame) {
+        pthread_cond_wait(&p->changed, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return known ? 0 : -1;
+}
+
+void cognitive_pipeline_drain(cognitive_pipeline_t* p) {
+    if (!p) return;
+    pthread_mutex_lock(&p->lock);
+    while (p->decoded < p->submitted) {
+        pthread_cond_wait(&p->changed, &p->lock);
+    }
+    pthread_mutex_unlock(&p->lock);
+}
+
+uint64_t cognitive_pipeline_failures(cognitive_pipeline_t* p) {
+    if (!p) return 0;
+    pthread_mutex_lock(&p->lock);
+    uint64_t failures = p->failures;
+    pthread_mutex_unlock(&p->lock);
+    return failures;
+}
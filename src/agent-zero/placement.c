@@ -0,0 +1,344 @@
+// Agent-Zero NUMA Placement
+// /src/agent-zero/placement.c
+//
+// Large heap tensors (PLACEMENT_MIN_BYTES and up) and context arenas can be
+// placed by policy instead of on whichever node the allocating thread runs:
+// - interleave:  pages round-robin over the online nodes (mbind)
+// - partitioned: pool worker p is pinned to node p * nodes / threads (of
+//                the nodes with CPUs this process may use), and
+//                new tensors are zeroed through parallel_for with one chunk
+//                per participant, so each row block is first touched by the
+//                thread the pool's even split hands those rows to in later
+//                kernels. Arena offsets do not follow rows, so arenas are
+//                interleaved instead.
+// Any policy may add huge pages: MAP_HUGETLB when the system has them
+// reserved, otherwise a transparent huge page hint. Placed blocks are
+// anonymous mappings; a prefix ahead of each block records its mapping.
+// A few freed blocks stay mapped for reuse by the next allocation of the
+// same size and policy. Off Linux every policy leaves tensors on the heap.
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cognitive-internal.h"
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PLACEMENT_HAVE_NUMA 1
+#endif
+
+#define PLACEMENT_MAX_NODES 64              // one word of mbind node mask
+#define PLACEMENT_PREFIX GGML_MEM_ALIGN     // keeps the mapping length
+#define PLACEMENT_DEFAULT_HUGE_PAGE (2u << 20)
+#define PLACEMENT_MPOL_INTERLEAVE 3
+#define PLACEMENT_ARENA 0x200               // block kind bit for arenas
+#define PLACEMENT_CACHE_SLOTS 8
+#define PLACEMENT_CACHE_BYTES ((size_t)256 << 20)
+
+static atomic_int placement = AGENT_ZERO_PLACEMENT_FIRST_TOUCH;
+static pthread_once_t topology_once = PTHREAD_ONCE_INIT;
+static int node_count = 1;                  // online nodes
+static unsigned long node_mask;             // online nodes, for mbind
+static int worker_nodes = 1;                // nodes with usable CPUs
+static size_t huge_page_size = PLACEMENT_DEFAULT_HUGE_PAGE;
+#ifdef PLACEMENT_HAVE_NUMA
+static cpu_set_t node_cpus[PLACEMENT_MAX_NODES];  // limited to process_cpus
+static cpu_set_t process_cpus;                    // affinity at first use
+#endif
+
+static size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+// Parse a sysfs list ("0-3,8,10-11") into at most max ids; returns how many
+static int parse_list(const char* s, int* ids, int max) {
+    int n = 0;
+    while (*s && *s != '\n') {
+        char* end;
+        long lo = strtol(s, &end, 10), hi = lo;
+        if (end == s) break;
+        if (*end == '-') {
+            s = end + 1;
+            hi = strtol(s, &end, 10);
+            if (end == s) break;
+        }
+        for (long v = lo; v <= hi && n < max; v++) {
+            ids[n++] = (int)v;
+        }
+        s = *end == ',' ? end + 1 : end;
+    }
+    return n;
+}
+
+static int read_list(const char* path, int* ids, int max) {
+    char buf[4096];
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    return parse_list(buf, ids, max);
+}
+
+// "interleave", "partitioned" or "first-touch", each optionally "+huge"
+static int parse_placement(const char* name) {
+    int flags = 0;
+    size_t len = strlen(name);
+    if (len >= 5 && strcmp(name + len - 5, "+huge") == 0) {
+        flags = AGENT_ZERO_PLACEMENT_HUGE_PAGES;
+        len -= 5;
+    }
+    if (len == 10 && strncmp(name, "interleave", len) == 0) return AGENT_ZERO_PLACEMENT_INTERLEAVE | flags;
+    if (len == 11 && strncmp(name, "partitioned", len) == 0) return AGENT_ZERO_PLACEMENT_PARTITIONED | flags;
+    if (len == 11 && strncmp(name, "first-touch", len) == 0) return AGENT_ZERO_PLACEMENT_FIRST_TOUCH | flags;
+    return -1;
+}
+
+static void load_topology(void) {
+#ifdef PLACEMENT_HAVE_NUMA
+    if (sched_getaffinity(0, sizeof(process_cpus), &process_cpus) != 0) {
+        CPU_ZERO(&process_cpus);
+    }
+    int ids[PLACEMENT_MAX_NODES];
+    int nodes = read_list("/sys/devices/system/node/online", ids, PLACEMENT_MAX_NODES);
+    int online = 0, usable = 0;
+    for (int n = 0; n < nodes; n++) {
+        if (ids[n] < 0 || ids[n] >= PLACEMENT_MAX_NODES) continue;
+        node_mask |= 1ul << ids[n];
+        online++;
+        char path[64];
+        int cpus[CPU_SETSIZE];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", ids[n]);
+        int count = read_list(path, cpus, CPU_SETSIZE);
+        CPU_ZERO(&node_cpus[usable]);
+        for (int c = 0; c < count; c++) {
+            if (CPU_ISSET(cpus[c], &process_cpus)) CPU_SET(cpus[c], &node_cpus[usable]);
+        }
+        // Nodes without CPUs this process may use (memory-only or outside
+        // its cpuset) still take interleaved pages but no workers
+        if (CPU_COUNT(&node_cpus[usable])) usable++;
+    }
+    node_count = online > 0 ? online : 1;
+    worker_nodes = usable > 0 ? usable : 1;
+
+    FILE* f = fopen("/proc/meminfo", "r");
+    if (f) {
+        char line[128];
+        unsigned long kb;
+        while (fgets(line, sizeof(line), f)) {
+            if (sscanf(line, "Hugepagesize: %lu kB", &kb) == 1 && kb) {
+                huge_page_size = (size_t)kb << 10;
+                break;
+            }
+        }
+        fclose(f);
+    }
+#endif
+    const char* forced = getenv("AGENT_ZERO_PLACEMENT");
+    int parsed = forced ? parse_placement(forced) : -1;
+    if (parsed >= 0) atomic_store(&placement, parsed);
+}
+
+int agent_zero_set_placement(int value) {
+    int policy = value & ~AGENT_ZERO_PLACEMENT_HUGE_PAGES;
+    if (policy < AGENT_ZERO_PLACEMENT_FIRST_TOUCH || policy > AGENT_ZERO_PLACEMENT_PARTITIONED) return -1;
+    pthread_once(&topology_once, load_topology);
+    atomic_store(&placement, value);
+    return 0;
+}
+
+int agent_zero_get_placement(void) {
+    pthread_once(&topology_once, load_topology);
+    return atomic_load(&placement);
+}
+
+int agent_zero_numa_nodes(void) {
+    pthread_once(&topology_once, load_topology);
+    return node_count;
+}
+
+int placement_partitioned(void) {
+    return (agent_zero_get_placement() & ~AGENT_ZERO_PLACEMENT_HUGE_PAGES) == AGENT_ZERO_PLACEMENT_PARTITIONED;
+}
+
+#ifdef PLACEMENT_HAVE_NUMA
+static void interleave_pages(void* base, size_t length) {
+#ifdef SYS_mbind
+    if (node_count < 2) return;
+    unsigned long mask = node_mask;
+    // Best effort: a kernel without NUMA leaves first-touch placement
+    syscall(SYS_mbind, base, length, PLACEMENT_MPOL_INTERLEAVE, &mask,
+            (unsigned long)PLACEMENT_MAX_NODES + 1, 0u);
+#else
+    (void)base;
+    (void)length;
+#endif
+}
+#endif
+
+#ifdef PLACEMENT_HAVE_NUMA
+// Block prefix; kind is the placement value, plus PLACEMENT_ARENA
+typedef struct {
+    size_t length;
+    int kind;
+} placement_header_t;
+
+// Freed blocks kept mapped for the next allocation of the same kind and
+// length, so repeated tensors skip the page faults and keep their pages'
+// placement
+static placement_header_t* block_cache[PLACEMENT_CACHE_SLOTS];
+static size_t cached_bytes;
+static int cache_victim;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static placement_header_t* cache_take(int kind, size_t length) {
+    placement_header_t* found = NULL;
+    pthread_mutex_lock(&cache_lock);
+    for (int i = 0; i < PLACEMENT_CACHE_SLOTS && !found; i++) {
+        placement_header_t* h = block_cache[i];
+        // Huge-page mappings are rounded up past length
+        if (h && h->kind == kind && h->length >= length && h->length - length < huge_page_size) {
+            found = h;
+            block_cache[i] = NULL;
+            cached_bytes -= h->length;
+        }
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return found;
+}
+
+static placement_header_t* map_block(int kind, size_t length) {
+    int policy = kind & ~(AGENT_ZERO_PLACEMENT_HUGE_PAGES | PLACEMENT_ARENA);
+    int huge = kind & AGENT_ZERO_PLACEMENT_HUGE_PAGES;
+    void* base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge) {
+        size_t huge_length = align_up(length, huge_page_size);
+        base = mmap(NULL, huge_length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) length = huge_length;
+    }
+#endif
+    if (base == MAP_FAILED) {
+        base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+        if (huge) madvise(base, length, MADV_HUGEPAGE);
+#endif
+    }
+    if (policy == AGENT_ZERO_PLACEMENT_INTERLEAVE ||
+        (policy == AGENT_ZERO_PLACEMENT_PARTITIONED && (kind & PLACEMENT_ARENA))) {
+        interleave_pages(base, length);
+    }
+    placement_header_t* h = base;
+    h->length = length;
+    h->kind = kind;
+    return h;
+}
+#endif
+
+void* placement_alloc(size_t size, int arena) {
+    int value = agent_zero_get_placement();
+    int policy = value & ~AGENT_ZERO_PLACEMENT_HUGE_PAGES;
+    if (value == AGENT_ZERO_PLACEMENT_FIRST_TOUCH || size < PLACEMENT_MIN_BYTES) {
+        return NULL;
+    }
+#ifdef PLACEMENT_HAVE_NUMA
+    int kind = value | (arena ? PLACEMENT_ARENA : 0);
+    size_t length = align_up(size + PLACEMENT_PREFIX, (size_t)sysconf(_SC_PAGESIZE));
+    placement_header_t* h = cache_take(kind, length);
+    if (h) {
+        // Zero reused tensor blocks here unless placement_touch will
+        if (arena || policy != AGENT_ZERO_PLACEMENT_PARTITIONED) {
+            memset((char*)h + PLACEMENT_PREFIX, 0, size);
+        }
+    } else if (!(h = map_block(kind, length))) {
+        return NULL;
+    }
+    return (char*)h + PLACEMENT_PREFIX;
+#else
+    (void)arena;
+    (void)policy;
+    return NULL;
+#endif
+}
+
+void placement_free(void* ptr) {
+#ifdef PLACEMENT_HAVE_NUMA
+    if (!ptr) return;
+    placement_header_t* h = (placement_header_t*)((char*)ptr - PLACEMENT_PREFIX);
+    placement_header_t* unmap[PLACEMENT_CACHE_SLOTS + 1];
+    int n_unmap = 0;
+    pthread_mutex_lock(&cache_lock);
+    if (h->length > PLACEMENT_CACHE_BYTES) {
+        unmap[n_unmap++] = h;
+    } else {
+        // Evict round-robin (most likely blocks of an earlier policy or
+        // size) until the block fits both the slots and the byte budget
+        int slot = -1;
+        for (;;) {
+            for (int i = 0; i < PLACEMENT_CACHE_SLOTS && slot < 0; i++) {
+                if (!block_cache[i]) slot = i;
+            }
+            if (slot >= 0 && cached_bytes + h->length <= PLACEMENT_CACHE_BYTES) break;
+            placement_header_t* victim = block_cache[cache_victim];
+            if (victim) {
+                unmap[n_unmap++] = victim;
+                cached_bytes -= victim->length;
+                block_cache[cache_victim] = NULL;
+            }
+            cache_victim = (cache_victim + 1) % PLACEMENT_CACHE_SLOTS;
+        }
+        block_cache[slot] = h;
+        cached_bytes += h->length;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    for (int i = 0; i < n_unmap; i++) {
+        munmap(unmap[i], unmap[i]->length);
+    }
+#else
+    (void)ptr;
+#endif
+}
+
+typedef struct {
+    char* data;
+    size_t row_bytes;
+} touch_job_t;
+
+static void touch_range(int64_t begin, int64_t end, void* arg) {
+    const touch_job_t* job = arg;
+    memset(job->data + (size_t)begin * job->row_bytes, 0, (size_t)(end - begin) * job->row_bytes);
+}
+
+void placement_touch(void* data, size_t rows, size_t row_bytes) {
+    touch_job_t job = { data, row_bytes };
+    int64_t threads = agent_zero_get_num_threads();
+    parallel_for((int64_t)rows, ((int64_t)rows + threads - 1) / threads, touch_range, &job);
+}
+
+void placement_bind_worker(int self, int threads, int* bound) {
+#ifdef PLACEMENT_HAVE_NUMA
+    int node = -1;
+    if (placement_partitioned() && worker_nodes > 1 && threads > 0) {
+        node = (int)((int64_t)self * worker_nodes / threads);
+    }
+    if (node == *bound) return;
+    const cpu_set_t* cpus = node >= 0 ? &node_cpus[node] : &process_cpus;
+    if (CPU_COUNT(cpus) && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), cpus) == 0) {
+        *bound = node;
+    }
+#else
+    (void)self;
+    (void)threads;
+    (void)bound;
+#endif
+}
@@ -0,0 +1,308 @@
+// Agent-Zero Profiling
+// /src/agent-zero/profile.c
+//
+// Deterministic profiling behind agent_zero_profile_start(): the span
+// macros of stats.c hand every instrumented op here, which writes it to a
+// Chrome trace file (one JSON object, loadable by Perfetto, speedscope and
+// CogUtil::PerformanceProfiler.load_native_trace).
+//
+// Hardware counters come from one perf_event_open group per thread, opened
+// on the thread's first profiled op and counting user space only, so the
+// kernel's perf_event_paranoid default of 2 allows it. A counter the host
+// lacks (common in VMs) is left out of the group; a thread whose group
+// cannot be opened at all still gets timed events. Groups stay open until
+// their thread exits.
+//
+// Events are formatted on the calling thread and appended under one lock.
+// Allocations made while an op runs on the same thread are charged to it,
+// nested ops included.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "cognitive-internal.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+static const char* const counter_names[AGENT_ZERO_COUNTER_COUNT] = {
+    "cycles",
+    "instructions",
+    "llc_misses",
+    "branch_misses",
+};
+
+static const char* const alloc_sources[] = {
+    "arena",
+    "pool",
+    "placed",
+    "heap",
+    "context",
+};
+
+#ifndef AGENT_ZERO_NO_STATS
+
+_Atomic int profile_active;
+
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+static FILE* profile_file;
+static unsigned profile_flags;
+static int64_t profile_events;
+static long profile_pid;
+
+// Per-thread perf_event group; members[i] is the counter read into slot i
+// of the group's values
+typedef struct {
+    int opened;
+    int leader;
+    int fds[AGENT_ZERO_COUNTER_COUNT];
+    int members[AGENT_ZERO_COUNTER_COUNT];
+    int n_members;
+    long tid;
+} thread_profile_t;
+
+static _Thread_local thread_profile_t local_profile = { 0, -1, { -1, -1, -1, -1 }, { 0 }, 0, 0 };
+static _Thread_local uint64_t local_allocs;
+static _Thread_local uint64_t local_alloc_bytes;
+
+static pthread_key_t group_key;
+static pthread_once_t group_once = PTHREAD_ONCE_INIT;
+static int group_key_ok;
+
+static void close_group(void* p) {
+    thread_profile_t* t = p;
+    for (int i = 0; i < t->n_members; i++) {
+        close(t->fds[i]);
+    }
+    t->n_members = 0;
+    t->leader = -1;
+}
+
+static void make_group_key(void) {
+    group_key_ok = pthread_key_create(&group_key, close_group) == 0;
+}
+
+static long thread_id(void) {
+    if (!local_profile.tid) {
+#ifdef __linux__
+        local_profile.tid = (long)syscall(SYS_gettid);
+#else
+        local_profile.tid = (long)(uintptr_t)pthread_self();
+#endif
+    }
+    return local_profile.tid;
+}
+
+#ifdef __linux__
+static int open_counter(int counter, int group_fd) {
+    static const uint64_t configs[AGENT_ZERO_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,   // last level cache on the common PMUs
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[counter];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+#endif
+
+// Opens the calling thread's group once; members that fail are skipped
+static thread_profile_t* thread_group(void) {
+    thread_profile_t* t = &local_profile;
+    if (t->opened) return t;
+    t->opened = 1;
+#ifdef __linux__
+    pthread_once(&group_once, make_group_key);
+    if (!group_key_ok || pthread_setspecific(group_key, t) != 0) return t;
+    for (int c = 0; c < AGENT_ZERO_COUNTER_COUNT; c++) {
+        int fd = open_counter(c, t->leader);
+        if (fd < 0) continue;
+        if (t->leader < 0) t->leader = fd;
+        t->fds[t->n_members] = fd;
+        t->members[t->n_members++] = c;
+    }
+#endif
+    return t;
+}
+
+void profile_read_counters(uint64_t* counters) {
+    memset(counters, 0, AGENT_ZERO_COUNTER_COUNT * sizeof(uint64_t));
+    if (!(profile_flags & AGENT_ZERO_PROFILE_COUNTERS)) return;
+    thread_profile_t* t = thread_group();
+    if (t->leader < 0) return;
+    uint64_t values[1 + AGENT_ZERO_COUNTER_COUNT];
+    ssize_t got = read(t->leader, values, sizeof(values));
+    if (got < (ssize_t)sizeof(uint64_t) || values[0] != (uint64_t)t->n_members) return;
+    for (int i = 0; i < t->n_members; i++) {
+        counters[t->members[i]] = values[1 + i];
+    }
+}
+
+void profile_span_begin(stats_span_t* span) {
+    span->allocs = local_allocs;
+    span->alloc_bytes = local_alloc_bytes;
+    profile_read_counters(span->counters);
+}
+
+// Appends one formatted event; dropped once profiling has stopped
+static void write_event(const char* event) {
+    pthread_mutex_lock(&profile_lock);
+    if (profile_file) {
+        fputs(profile_events ? ",\n" : "\n", profile_file);
+        fputs(event, profile_file);
+        profile_events++;
+    }
+    pthread_mutex_unlock(&profile_lock);
+}
+
+// Microseconds with nanosecond digits, as the trace format expects
+static int format_us(char* out, size_t size, uint64_t ns) {
+    return snprintf(out, size, "%llu.%03u", (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+}
+
+void profile_span_end(int op, const stats_span_t* span, const uint64_t* counters,
+                      uint64_t end_ns, uint64_t bytes) {
+    char ts[32], dur[32], event[512];
+    format_us(ts, sizeof(ts), span->start_ns);
+    format_us(dur, sizeof(dur), end_ns - span->start_ns);
+    int n = snprintf(event, sizeof(event),
+                     "{\"name\":\"%s\",\"cat\":\"agent-zero\",\"ph\":\"X\",\"ts\":%s,\"dur\":%s,"
+                     "\"pid\":%ld,\"tid\":%ld,\"args\":{\"bytes\":%llu,\"allocs\":%llu,\"alloc_bytes\":%llu",
+                     agent_zero_op_name(op), ts, dur, profile_pid, thread_id(), (unsigned long long)bytes,
+                     (unsigned long long)(local_allocs - span->allocs),
+                     (unsigned long long)(local_alloc_bytes - span->alloc_bytes));
+    const thread_profile_t* t = &local_profile;
+    for (int i = 0; i < t->n_members && n < (int)sizeof(event); i++) {
+        int c = t->members[i];
+        n += snprintf(event + n, sizeof(event) - (size_t)n, ",\"%s\":%llu", counter_names[c],
+                      (unsigned long long)(counters[c] - span->counters[c]));
+    }
+    if (n < (int)sizeof(event)) snprintf(event + n, sizeof(event) - (size_t)n, "}}");
+    write_event(event);
+}
+
+void profile_alloc(int source, const void* ptr, uint64_t bytes) {
+    local_allocs++;
+    local_alloc_bytes += bytes;
+    if (!(profile_flags & AGENT_ZERO_PROFILE_ALLOCS)) return;
+    char ts[32], event[256];
+    format_us(ts, sizeof(ts), stats_clock_ns());
+    snprintf(event, sizeof(event),
+             "{\"name\":\"alloc\",\"cat\":\"agent-zero.alloc\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%s,"
+             "\"pid\":%ld,\"tid\":%ld,\"args\":{\"source\":\"%s\",\"ptr\":\"%p\",\"bytes\":%llu}}",
+             ts, profile_pid, thread_id(), alloc_sources[source], ptr, (unsigned long long)bytes);
+    write_event(event);
+}
+
+void profile_free(int source, const void* ptr) {
+    if (!(profile_flags & AGENT_ZERO_PROFILE_ALLOCS)) return;
+    char ts[32], event[256];
+    format_us(ts, sizeof(ts), stats_clock_ns());
+    snprintf(event, sizeof(event),
+             "{\"name\":\"free\",\"cat\":\"agent-zero.alloc\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%s,"
+             "\"pid\":%ld,\"tid\":%ld,\"args\":{\"source\":\"%s\",\"ptr\":\"%p\"}}",
+             ts, profile_pid, thread_id(), alloc_sources[source], ptr);
+    write_event(event);
+}
+
+int agent_zero_profile_start(const char* path, unsigned flags) {
+    if (!path) return -1;
+    pthread_mutex_lock(&profile_lock);
+    if (profile_file) {
+        pthread_mutex_unlock(&profile_lock);
+        return -1;
+    }
+    profile_file = fopen(path, "w");
+    if (!profile_file) {
+        pthread_mutex_unlock(&profile_lock);
+        return -1;
+    }
+    profile_flags = flags & AGENT_ZERO_PROFILE_ALL;
+    profile_events = 0;
+    profile_pid = (long)getpid();
+
+    fprintf(profile_file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"source\":\"agent-zero\","
+                          "\"clock\":\"CLOCK_MONOTONIC\",\"counters\":%d,\"allocs\":%d},\"traceEvents\":[",
+            !!(profile_flags & AGENT_ZERO_PROFILE_COUNTERS), !!(profile_flags & AGENT_ZERO_PROFILE_ALLOCS));
+    fprintf(profile_file, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"args\":{\"name\":\"agent-zero\"}}",
+            profile_pid);
+    profile_events = 1;
+    atomic_store_explicit(&profile_active, 1, memory_order_release);
+    pthread_mutex_unlock(&profile_lock);
+    return 0;
+}
+
+int64_t agent_zero_profile_stop(void) {
+    pthread_mutex_lock(&profile_lock);
+    if (!profile_file) {
+        pthread_mutex_unlock(&profile_lock);
+        return -1;
+    }
+    // Ops already inside a span finish and are dropped by write_event
+    atomic_store_explicit(&profile_active, 0, memory_order_relaxed);
+    fputs("\n]}\n", profile_file);
+    int failed = fclose(profile_file) != 0;
+    profile_file = NULL;
+    int64_t events = profile_events;
+    pthread_mutex_unlock(&profile_lock);
+    return failed ? -1 : events;
+}
+
+int agent_zero_profile_active(void) {
+    return atomic_load_explicit(&profile_active, memory_order_relaxed);
+}
+
+int agent_zero_profile_counters(void) {
+    int mask = 0;
+    thread_profile_t* t = thread_group();
+    for (int i = 0; i < t->n_members; i++) {
+        mask |= 1 << t->members[i];
+    }
+    return mask;
+}
+
+static void stop_at_exit(void) {
+    agent_zero_profile_stop();
+}
+
+__attribute__((constructor)) static void profile_from_environment(void) {
+    const char* path = getenv("AGENT_ZERO_PROFILE");
+    if (path && *path && agent_zero_profile_start(path, AGENT_ZERO_PROFILE_ALL) == 0) {
+        atexit(stop_at_exit);
+    }
+}
+
+#else
+
+int agent_zero_profile_start(const char* path, unsigned flags) {
+    (void)path;
+    (void)flags;
+    return -1;
+}
+
+int64_t agent_zero_profile_stop(void) {
+    return -1;
+}
+
+int agent_zero_profile_active(void) {
+    return 0;
+}
+
+int agent_zero_profile_counters(void) {
+    (void)counter_names;
+    (void)alloc_sources;
+    return 0;
+}
+
+#endif
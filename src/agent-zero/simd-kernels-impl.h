@@ -0,0 +1,469 @@
+// Agent-Zero SIMD kernel template
+// /src/agent-zero/simd-kernels-impl.h
+//
+// Included once per instruction set by simd-kernels.c. The includer
+// defines SIMD_W (lanes), SIMD_NAME(x) (symbol suffix), the VF/VI vector
+// types and the V* primitive macros below; every kernel is written once
+// in terms of those, and this file undefines them again at the end so the
+// next instantiation starts clean. Vector loops hand their remainder to
+// the scalar instantiation (SIMD_TAIL), which uses the same approximations.
+//
+// Required primitives:
+//   VLOAD(p) VSTORE(p,v) VSET1(x) VADD VSUB VMUL VDIV VMIN VMAX
+//   VFMA(a,b,c) = a*b+c        VSEL_LT(a,b,x,y) = a<b ? x : y
+//   VCVT_NEAREST(v) -> VI      VCVT_I2F(vi) -> VF
+//   VI_SET1 VI_AND VI_ADD VI_XOR VI_SLLI(v,n)   VAS_I(vf) VAS_F(vi)
+//   VMASK_GT(a,b) -> unsigned, bit k set when lane k of a > b
+//   VGATHER(base, idx) loads base[idx[0..W-1]] (idx: const uint32_t*)
+
+// Cody-Waite split of pi (sum is pi to ~2^-60)
+#define SIMD_PI_A 3.140625f
+#define SIMD_PI_B 0.0009670257568359375f
+#define SIMD_PI_C 6.2771141529083251953e-07f
+#define SIMD_PI_D 1.2154201256553420762e-10f
+
+// sin(x): reduce to r in [-pi/2, pi/2], odd minimax polynomial, sign from
+// the quadrant parity. Max error ~2 ulp for |x| < 1e5.
+static inline VF SIMD_NAME(v_sin)(VF x) {
+    VI qi = VCVT_NEAREST(VMUL(x, VSET1(0.318309886183790671538f)));
+    VF q = VCVT_I2F(qi);
+    VF r = VFMA(q, VSET1(-SIMD_PI_A), x);
+    r = VFMA(q, VSET1(-SIMD_PI_B), r);
+    r = VFMA(q, VSET1(-SIMD_PI_C), r);
+    r = VFMA(q, VSET1(-SIMD_PI_D), r);
+
+    VF s = VMUL(r, r);
+    VF u = VSET1(2.6083159809786593541503e-06f);
+    u = VFMA(u, s, VSET1(-0.0001981069071916863322258f));
+    u = VFMA(u, s, VSET1(0.00833307858556509017944336f));
+    u = VFMA(u, s, VSET1(-0.166666597127914428710938f));
+    u = VFMA(VMUL(u, s), r, r);
+
+    VI sign = VI_SLLI(VI_AND(qi, VI_SET1(1)), 31);
+    return VAS_F(VI_XOR(VAS_I(u), sign));
+}
+
+// exp(x) for x clamped to the finite float range (Cephes polynomial)
+static inline VF SIMD_NAME(v_exp)(VF x) {
+    x = VMIN(VMAX(x, VSET1(-87.3f)), VSET1(88.3f));
+    VI ni = VCVT_NEAREST(VMUL(x, VSET1(1.44269504088896341f)));
+    VF n = VCVT_I2F(ni);
+    VF r = VFMA(n, VSET1(-0.693359375f), x);
+    r = VFMA(n, VSET1(2.12194440e-4f), r);
+
+    VF p = VSET1(1.9875691500e-4f);
+    p = VFMA(p, r, VSET1(1.3981999507e-3f));
+    p = VFMA(p, r, VSET1(8.3334519073e-3f));
+    p = VFMA(p, r, VSET1(4.1665795894e-2f));
+    p = VFMA(p, r, VSET1(1.6666665459e-1f));
+    p = VFMA(p, r, VSET1(5.0000001201e-1f));
+    p = VFMA(VMUL(p, r), r, VADD(r, VSET1(1.0f)));
+
+    VF scale = VAS_F(VI_SLLI(VI_ADD(ni, VI_SET1(127)), 23));
+    return VMUL(p, scale);
+}
+
+// tanh(x): odd polynomial near zero (no cancellation), exp identity beyond
+static inline VF SIMD_NAME(v_tanh)(VF x) {
+    VI sign = VI_AND(VAS_I(x), VI_SET1(INT32_MIN));
+    VF ax = VAS_F(VI_AND(VAS_I(x), VI_SET1(INT32_MAX)));
+
+    VF z = VMUL(ax, ax);
+    VF p = VSET1(-5.70498872745e-3f);
+    p = VFMA(p, z, VSET1(2.06390887954e-2f));
+    p = VFMA(p, z, VSET1(-5.37397155531e-2f));
+    p = VFMA(p, z, VSET1(1.33314422036e-1f));
+    p = VFMA(p, z, VSET1(-3.33332819422e-1f));
+    VF small = VFMA(VMUL(p, z), ax, ax);
+
+    VF e = SIMD_NAME(v_exp)(VADD(ax, ax));
+    VF large = VSUB(VSET1(1.0f), VDIV(VSET1(2.0f), VADD(e, VSET1(1.0f))));
+
+    VF t = VSEL_LT(ax, VSET1(0.625f), small, large);
+    return VAS_F(VI_XOR(VAS_I(t), sign));
+}
+
+static inline VF SIMD_NAME(v_iota)(int64_t base) {
+#if SIMD_W > 1
+    return VADD(VSET1((float)base), VLOAD(simd_lane_offsets));
+#else
+    return (float)base;
+#endif
+}
+
+#if SIMD_W > 1
+#define SIMD_TAIL(call) do { if (i < n) { call; } } while (0)
+#else
+#define SIMD_TAIL(call) do { } while (0)
+#endif
+
+static void SIMD_NAME(mul)(float* dst, const float* a, const float* b, int64_t n) {
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, VMUL(VLOAD(a + i), VLOAD(b + i)));
+    }
+    SIMD_TAIL(scalar_mul(dst + i, a + i, b + i, n - i));
+}
+
+static void SIMD_NAME(add)(float* dst, const float* a, const float* b, int64_t n) {
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, VADD(VLOAD(a + i), VLOAD(b + i)));
+    }
+    SIMD_TAIL(scalar_add(dst + i, a + i, b + i, n - i));
+}
+
+static void SIMD_NAME(fmadd)(float* dst, const float* a, const float* b, const float* c, int64_t n) {
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, VFMA(VLOAD(a + i), VLOAD(b + i), VLOAD(c + i)));
+    }
+    SIMD_TAIL(scalar_fmadd(dst + i, a + i, b + i, c + i, n - i));
+}
+
+static void SIMD_NAME(scale)(float* dst, const float* a, float s, int64_t n) {
+    VF vs = VSET1(s);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, VMUL(VLOAD(a + i), vs));
+    }
+    SIMD_TAIL(scalar_scale(dst + i, a + i, s, n - i));
+}
+
+static void SIMD_NAME(tanh)(float* dst, const float* a, float s, int64_t n) {
+    VF vs = VSET1(s);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, SIMD_NAME(v_tanh)(VMUL(VLOAD(a + i), vs)));
+    }
+    SIMD_TAIL(scalar_tanh(dst + i, a + i, s, n - i));
+}
+
+static void SIMD_NAME(add_tanh)(float* dst, const float* a, const float* b, float s, int64_t n) {
+    VF vs = VSET1(s);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF sum = VADD(VLOAD(a + i), VLOAD(b + i));
+        VSTORE(dst + i, SIMD_NAME(v_tanh)(VMUL(sum, vs)));
+    }
+    SIMD_TAIL(scalar_add_tanh(dst + i, a + i, b + i, s, n - i));
+}
+
+static void SIMD_NAME(sin_mod)(float* dst, const float* a, float gain, float depth,
+                               float freq, int64_t base, int64_t n) {
+    VF vgain = VSET1(gain);
+    VF vdepth = VSET1(depth);
+    VF vfreq = VSET1(freq);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF wave = SIMD_NAME(v_sin)(VMUL(SIMD_NAME(v_iota)(base + i), vfreq));
+        VF m = VMUL(vgain, VFMA(vdepth, wave, VSET1(1.0f)));
+        VSTORE(dst + i, a ? VMUL(VLOAD(a + i), m) : m);
+    }
+    SIMD_TAIL(scalar_sin_mod(dst + i, a ? a + i : NULL, gain, depth, freq, base + i, n - i));
+}
+
+static void SIMD_NAME(mul_lincomb2)(float* dst, const float* a, const float* t1, const float* t2,
+                                    float c0, float c1, float c2, int64_t n) {
+    VF v0 = VSET1(c0);
+    VF v1 = VSET1(c1);
+    VF v2 = VSET1(c2);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF m = VFMA(v2, VLOAD(t2 + i), VFMA(v1, VLOAD(t1 + i), v0));
+        VSTORE(dst + i, a ? VMUL(VLOAD(a + i), m) : m);
+    }
+    SIMD_TAIL(scalar_mul_lincomb2(dst + i, a ? a + i : NULL, t1 + i, t2 + i, c0, c1, c2, n - i));
+}
+
+static void SIMD_NAME(axpy)(float* dst, const float* x, float s, int64_t n) {
+    VF vs = VSET1(s);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, VFMA(VLOAD(x + i), vs, VLOAD(dst + i)));
+    }
+    SIMD_TAIL(scalar_axpy(dst + i, x + i, s, n - i));
+}
+
+// C[m x n] += A[m x k] * B[k x n], row-major with leading dimensions.
+// Four rows of C stay in registers across the whole k loop, so each B
+// vector load feeds four FMAs.
+static void SIMD_NAME(sgemm)(float* c, int64_t ldc, const float* a, int64_t lda,
+                             const float* b, int64_t ldb, int64_t m, int64_t k, int64_t n) {
+    int64_t r = 0;
+    for (; r + 4 <= m; r += 4) {
+        float* c0 = c + (r + 0) * ldc;
+        float* c1 = c + (r + 1) * ldc;
+        float* c2 = c + (r + 2) * ldc;
+        float* c3 = c + (r + 3) * ldc;
+        const float* a0 = a + (r + 0) * lda;
+        const float* a1 = a + (r + 1) * lda;
+        const float* a2 = a + (r + 2) * lda;
+        const float* a3 = a + (r + 3) * lda;
+        int64_t i = 0;
+        for (; i + SIMD_W <= n; i += SIMD_W) {
+            VF acc0 = VLOAD(c0 + i);
+            VF acc1 = VLOAD(c1 + i);
+            VF acc2 = VLOAD(c2 + i);
+            VF acc3 = VLOAD(c3 + i);
+            for (int64_t p = 0; p < k; p++) {
+                VF bv = VLOAD(b + p * ldb + i);
+                acc0 = VFMA(VSET1(a0[p]), bv, acc0);
+                acc1 = VFMA(VSET1(a1[p]), bv, acc1);
+                acc2 = VFMA(VSET1(a2[p]), bv, acc2);
+                acc3 = VFMA(VSET1(a3[p]), bv, acc3);
+            }
+            VSTORE(c0 + i, acc0);
+            VSTORE(c1 + i, acc1);
+            VSTORE(c2 + i, acc2);
+            VSTORE(c3 + i, acc3);
+        }
+        SIMD_TAIL(scalar_sgemm(c + r * ldc + i, ldc, a + r * lda, lda, b + i, ldb, 4, k, n - i));
+    }
+    for (; r < m; r++) {
+        float* cr = c + r * ldc;
+        const float* ar = a + r * lda;
+        int64_t i = 0;
+        for (; i + SIMD_W <= n; i += SIMD_W) {
+            VF acc = VLOAD(cr + i);
+            for (int64_t p = 0; p < k; p++) {
+                acc = VFMA(VSET1(ar[p]), VLOAD(b + p * ldb + i), acc);
+            }
+            VSTORE(cr + i, acc);
+        }
+        SIMD_TAIL(scalar_sgemm(cr + i, ldc, ar, lda, b + i, ldb, 1, k, n - i));
+    }
+}
+
+static void SIMD_NAME(similarity)(float* dst, const float* a, float s, float c, float scale,
+                                  int64_t n) {
+    VF vs = VSET1(s);
+    VF vc = VSET1(c);
+    VF vscale = VSET1(scale);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF d = VSUB(VLOAD(a + i), vs);
+        VF ad = VAS_F(VI_AND(VAS_I(d), VI_SET1(INT32_MAX)));
+        VSTORE(dst + i, VMUL(VSUB(vc, ad), vscale));
+    }
+    SIMD_TAIL(scalar_similarity(dst + i, a + i, s, c, scale, n - i));
+}
+
+static void SIMD_NAME(sin)(float* dst, const float* a, int64_t n) {
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VSTORE(dst + i, SIMD_NAME(v_sin)(VLOAD(a + i)));
+    }
+    SIMD_TAIL(scalar_sin(dst + i, a + i, n - i));
+}
+
+// Compare-and-compress: one mask per vector, and set bits are peeled off
+// only where entries pass, so sparse inputs cost a compare per vector
+static int64_t SIMD_NAME(compress_gt)(uint32_t* idx, const float* a, float threshold,
+                                      uint32_t base, int64_t n) {
+    VF vt = VSET1(threshold);
+    int64_t count = 0;
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        unsigned mask = VMASK_GT(VLOAD(a + i), vt);
+        while (mask) {
+            idx[count++] = base + (uint32_t)i + (uint32_t)__builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    SIMD_TAIL(count += scalar_compress_gt(idx + count, a + i, threshold, base + (uint32_t)i, n - i));
+    return count;
+}
+
+// NaN entries compare false and count as zero
+static void SIMD_NAME(positive_stats)(float* sum, float* count, float* row, const float* a,
+                                      int64_t n) {
+    VF zero = VSET1(0.0f);
+    VF one = VSET1(1.0f);
+    VF row_sum = zero;
+    VF row_count = zero;
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF v = VLOAD(a + i);
+        VF p = VSEL_LT(zero, v, v, zero);
+        VF c = VSEL_LT(zero, v, one, zero);
+        VSTORE(sum + i, VADD(VLOAD(sum + i), p));
+        VSTORE(count + i, VADD(VLOAD(count + i), c));
+        row_sum = VADD(row_sum, p);
+        row_count = VADD(row_count, c);
+    }
+
+    float lanes_sum[SIMD_W], lanes_count[SIMD_W];
+    VSTORE(lanes_sum, row_sum);
+    VSTORE(lanes_count, row_count);
+    row[0] = 0.0f;
+    row[1] = 0.0f;
+    for (int l = 0; l < SIMD_W; l++) {
+        row[0] += lanes_sum[l];
+        row[1] += lanes_count[l];
+    }
+#if SIMD_W > 1
+    if (i < n) {
+        float tail[2];
+        scalar_positive_stats(sum + i, count + i, tail, a + i, n - i);
+        row[0] += tail[0];
+        row[1] += tail[1];
+    }
+#endif
+}
+
+static float SIMD_NAME(gather_dot)(const float* w, const uint32_t* idx, const float* x, int64_t n) {
+    VF acc = VSET1(0.0f);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        acc = VFMA(VLOAD(w + i), VGATHER(x, idx + i), acc);
+    }
+    float lanes[SIMD_W];
+    VSTORE(lanes, acc);
+    float sum = 0.0f;
+    for (int l = 0; l < SIMD_W; l++) {
+        sum += lanes[l];
+    }
+    SIMD_TAIL(sum += scalar_gather_dot(w + i, idx + i, x, n - i));
+    return sum;
+}
+
+static float SIMD_NAME(dot)(const float* a, const float* b, int64_t n) {
+    VF acc = VSET1(0.0f);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        acc = VFMA(VLOAD(a + i), VLOAD(b + i), acc);
+    }
+    float lanes[SIMD_W];
+    VSTORE(lanes, acc);
+    float sum = 0.0f;
+    for (int l = 0; l < SIMD_W; l++) {
+        sum += lanes[l];
+    }
+    SIMD_TAIL(sum += scalar_dot(a + i, b + i, n - i));
+    return sum;
+}
+
+static float SIMD_NAME(l2_sq)(const float* a, const float* b, int64_t n) {
+    VF acc = VSET1(0.0f);
+    int64_t i = 0;
+    for (; i + SIMD_W <= n; i += SIMD_W) {
+        VF d = VSUB(VLOAD(a + i), VLOAD(b + i));
+        acc = VFMA(d, d, acc);
+    }
+    float lanes[SIMD_W];
+    VSTORE(lanes, acc);
+    float sum = 0.0f;
+    for (int l = 0; l < SIMD_W; l++) {
+        sum += lanes[l];
+    }
+    SIMD_TAIL(sum += scalar_l2_sq(a + i, b + i, n - i));
+    return sum;
+}
+
+// Shape-specialized correlation. The body is written once over pr x pc
+// and forced inline into one wrapper per shape, so every tap loop has a
+// constant trip count and unrolls completely; the weights are broadcast
+// once per row.
+static inline __attribute__((always_inline)) void SIMD_NAME(correlate_body)(
+    float* out, const float* data, int64_t stride, const float* p, int64_t n,
+    const int pr, const int pc) {
+    VF w[SIMD_CORRELATE_MAX_SIDE * SIMD_CORRELATE_MAX_SIDE];
+    for (int t = 0; t < pr * pc; t++) {
+        w[t] = VSET1(p[t]);
+    }
+    // Four output vectors per step keep four FMA chains in flight
+    int64_t i = 0;
+    for (; i + 4 * SIMD_W + pc - 1 <= n; i += 4 * SIMD_W) {
+        VF acc[4];
+        for (int v = 0; v < 4; v++) {
+            acc[v] = VSET1(0.0f);
+        }
+        for (int pi = 0; pi < pr; pi++) {
+            const float* row = data + pi * stride + i;
+            for (int pj = 0; pj < pc; pj++) {
+                for (int v = 0; v < 4; v++) {
+                    acc[v] = VFMA(w[pi * pc + pj], VLOAD(row + pj + v * SIMD_W), acc[v]);
+                }
+            }
+        }
+        for (int v = 0; v < 4; v++) {
+            VSTORE(out + i + v * SIMD_W, acc[v]);
+        }
+    }
+    for (; i + SIMD_W + pc - 1 <= n; i += SIMD_W) {
+        VF acc = VSET1(0.0f);
+        for (int pi = 0; pi < pr; pi++) {
+            for (int pj = 0; pj < pc; pj++) {
+                acc = VFMA(w[pi * pc + pj], VLOAD(data + pi * stride + i + pj), acc);
+            }
+        }
+        VSTORE(out + i, acc);
+    }
+    // Columns whose taps run past the right edge (fewer than SIMD_W + pc - 1)
+    // run on a zero-padded copy of their window
+    if (i < n) {
+        int64_t rem = n - i;
+        float pad[SIMD_CORRELATE_MAX_SIDE][2 * SIMD_W + 2 * SIMD_CORRELATE_MAX_SIDE];
+        float tail[2 * SIMD_W + SIMD_CORRELATE_MAX_SIDE];
+        memset(pad, 0, sizeof(pad));
+        for (int pi = 0; pi < pr; pi++) {
+            memcpy(pad[pi], data + pi * stride + i, (size_t)rem * sizeof(float));
+        }
+        for (int64_t t = 0; t < rem; t += SIMD_W) {
+            VF acc = VSET1(0.0f);
+            for (int pi = 0; pi < pr; pi++) {
+                for (int pj = 0; pj < pc; pj++) {
+                    acc = VFMA(w[pi * pc + pj], VLOAD(pad[pi] + t + pj), acc);
+                }
+            }
+            VSTORE(tail + t, acc);
+        }
+        memcpy(out + i, tail, (size_t)rem * sizeof(float));
+    }
+}
+
+#define SIMD_CORRELATE_SHAPE(pr, pc)                                                       \
+    static void SIMD_NAME(correlate_##pr##x##pc)(float* out, const float* data,            \
+                                                 int64_t stride, const float* p, int64_t n) { \
+        SIMD_NAME(correlate_body)(out, data, stride, p, n, pr, pc);                        \
+    }
+SIMD_CORRELATE_SHAPE(3, 3)
+SIMD_CORRELATE_SHAPE(5, 5)
+SIMD_CORRELATE_SHAPE(7, 7)
+#undef SIMD_CORRELATE_SHAPE
+
+static const simd_correlate_shape_t SIMD_NAME(correlate_shapes)[SIMD_CORRELATE_SHAPE_COUNT] = {
+    { 3, 3, SIMD_NAME(correlate_3x3) },
+    { 5, 5, SIMD_NAME(correlate_5x5) },
+    { 7, 7, SIMD_NAME(correlate_7x7) },
+};
+
+#undef SIMD_TAIL
+
+#undef SIMD_W
+#undef SIMD_NAME
+#undef VF
+#undef VI
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VDIV
+#undef VMIN
+#undef VMAX
+#undef VFMA
+#undef VSEL_LT
+#undef VCVT_NEAREST
+#undef VCVT_I2F
+#undef VI_SET1
+#undef VI_AND
+#undef VI_ADD
+#undef VI_XOR
+#undef VI_SLLI
+#undef VAS_I
+#undef VAS_F
+#undef VMASK_GT
+#undef VGATHER
@@ -0,0 +1,361 @@
+// Agent-Zero Runtime-Dispatched SIMD Kernels
+// /src/agent-zero/simd-kernels.c
+//
+// One kernel template (simd-kernels-impl.h) is instantiated for each
+// instruction set this compiler can target; the best variant the running
+// CPU supports is picked on first use. Nothing outside a guarded target
+// region assumes more than the baseline ABI, so one build runs on pre-AVX
+// x86-64 hosts and on aarch64.
+//
+// Set AGENT_ZERO_SIMD=scalar|sse2|avx2|avx512|neon to force a variant.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <math.h>
+#include "cognitive-internal.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define SIMD_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(__clang__)
+#define SIMD_TARGET_AVX2 _Pragma("clang attribute push(__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define SIMD_TARGET_AVX512 _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx2,fma\"))), apply_to = function)")
+#define SIMD_TARGET_END _Pragma("clang attribute pop")
+#else
+#define SIMD_TARGET_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+#define SIMD_TARGET_AVX512 _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx2,fma\")")
+#define SIMD_TARGET_END _Pragma("GCC pop_options")
+#endif
+
+static const float simd_lane_offsets[16] __attribute__((aligned(64))) = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+};
+
+// ---------------------------------------------------------------------------
+// Scalar (portable; also handles every vector loop's remainder)
+
+static inline int32_t scalar_as_int(float v) {
+    int32_t i;
+    memcpy(&i, &v, sizeof(i));
+    return i;
+}
+
+static inline float scalar_as_float(int32_t i) {
+    float v;
+    memcpy(&v, &i, sizeof(v));
+    return v;
+}
+
+#define SIMD_W 1
+#define SIMD_NAME(x) scalar_##x
+#define VF float
+#define VI int32_t
+#define VLOAD(p) (*(p))
+#define VSTORE(p, v) (*(p) = (v))
+#define VSET1(x) (x)
+#define VADD(a, b) ((a) + (b))
+#define VSUB(a, b) ((a) - (b))
+#define VMUL(a, b) ((a) * (b))
+#define VDIV(a, b) ((a) / (b))
+#define VMIN(a, b) fminf(a, b)
+#define VMAX(a, b) fmaxf(a, b)
+#define VFMA(a, b, c) ((a) * (b) + (c))
+#define VSEL_LT(a, b, x, y) ((a) < (b) ? (x) : (y))
+#define VCVT_NEAREST(v) ((int32_t)lrintf(v))
+#define VCVT_I2F(v) ((float)(v))
+#define VI_SET1(x) ((int32_t)(x))
+#define VI_AND(a, b) ((a) & (b))
+#define VI_ADD(a, b) ((a) + (b))
+#define VI_XOR(a, b) ((a) ^ (b))
+#define VI_SLLI(v, n) ((int32_t)((uint32_t)(v) << (n)))
+#define VAS_I(v) scalar_as_int(v)
+#define VAS_F(v) scalar_as_float(v)
+#define VMASK_GT(a, b) ((unsigned)((a) > (b)))
+#define VGATHER(base, idx) ((base)[*(idx)])
+#include "simd-kernels-impl.h"
+
+#define SIMD_KERNEL_TABLE(isa) {   \
+    #isa,                          \
+    isa##_mul,                     \
+    isa##_add,                     \
+    isa##_fmadd,                   \
+    isa##_scale,                   \
+    isa##_tanh,                    \
+    isa##_add_tanh,                \
+    isa##_sin_mod,                 \
+    isa##_mul_lincomb2,            \
+    isa##_axpy,                    \
+    isa##_sgemm,                   \
+    isa##_similarity,              \
+    isa##_sin,                     \
+    isa##_compress_gt,             \
+    isa##_positive_stats,          \
+    isa##_gather_dot,              \
+    isa##_dot,                     \
+    isa##_l2_sq,                   \
+    isa##_correlate_shapes,        \
+}
+
+static const simd_kernels_t kernels_scalar = SIMD_KERNEL_TABLE(scalar);
+
+#ifdef SIMD_HAVE_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 (x86-64 baseline)
+
+static inline __m128 sse2_sel_lt(__m128 a, __m128 b, __m128 x, __m128 y) {
+    __m128 m = _mm_cmplt_ps(a, b);
+    return _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y));
+}
+
+#define SIMD_W 4
+#define SIMD_NAME(x) sse2_##x
+#define VF __m128
+#define VI __m128i
+#define VLOAD(p) _mm_loadu_ps(p)
+#define VSTORE(p, v) _mm_storeu_ps(p, v)
+#define VSET1(x) _mm_set1_ps(x)
+#define VADD(a, b) _mm_add_ps(a, b)
+#define VSUB(a, b) _mm_sub_ps(a, b)
+#define VMUL(a, b) _mm_mul_ps(a, b)
+#define VDIV(a, b) _mm_div_ps(a, b)
+#define VMIN(a, b) _mm_min_ps(a, b)
+#define VMAX(a, b) _mm_max_ps(a, b)
+#define VFMA(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+#define VSEL_LT(a, b, x, y) sse2_sel_lt(a, b, x, y)
+#define VCVT_NEAREST(v) _mm_cvtps_epi32(v)
+#define VCVT_I2F(v) _mm_cvtepi32_ps(v)
+#define VI_SET1(x) _mm_set1_epi32(x)
+#define VI_AND(a, b) _mm_and_si128(a, b)
+#define VI_ADD(a, b) _mm_add_epi32(a, b)
+#define VI_XOR(a, b) _mm_xor_si128(a, b)
+#define VI_SLLI(v, n) _mm_slli_epi32(v, n)
+#define VAS_I(v) _mm_castps_si128(v)
+#define VAS_F(v) _mm_castsi128_ps(v)
+#define VMASK_GT(a, b) ((unsigned)_mm_movemask_ps(_mm_cmpgt_ps(a, b)))
+#define VGATHER(base, idx) _mm_setr_ps((base)[(idx)[0]], (base)[(idx)[1]], (base)[(idx)[2]], (base)[(idx)[3]])
+#include "simd-kernels-impl.h"
+
+static const simd_kernels_t kernels_sse2 = SIMD_KERNEL_TABLE(sse2);
+
+// ---------------------------------------------------------------------------
+// AVX2 + FMA
+
+SIMD_TARGET_AVX2
+
+static inline __m256 avx2_sel_lt(__m256 a, __m256 b, __m256 x, __m256 y) {
+    return _mm256_blendv_ps(y, x, _mm256_cmp_ps(a, b, _CMP_LT_OQ));
+}
+
+#define SIMD_W 8
+#define SIMD_NAME(x) avx2_##x
+#define VF __m256
+#define VI __m256i
+#define VLOAD(p) _mm256_loadu_ps(p)
+#define VSTORE(p, v) _mm256_storeu_ps(p, v)
+#define VSET1(x) _mm256_set1_ps(x)
+#define VADD(a, b) _mm256_add_ps(a, b)
+#define VSUB(a, b) _mm256_sub_ps(a, b)
+#define VMUL(a, b) _mm256_mul_ps(a, b)
+#define VDIV(a, b) _mm256_div_ps(a, b)
+#define VMIN(a, b) _mm256_min_ps(a, b)
+#define VMAX(a, b) _mm256_max_ps(a, b)
+#define VFMA(a, b, c) _mm256_fmadd_ps(a, b, c)
+#define VSEL_LT(a, b, x, y) avx2_sel_lt(a, b, x, y)
+#define VCVT_NEAREST(v) _mm256_cvtps_epi32(v)
+#define VCVT_I2F(v) _mm256_cvtepi32_ps(v)
+#define VI_SET1(x) _mm256_set1_epi32(x)
+#define VI_AND(a, b) _mm256_and_si256(a, b)
+#define VI_ADD(a, b) _mm256_add_epi32(a, b)
+#define VI_XOR(a, b) _mm256_xor_si256(a, b)
+#define VI_SLLI(v, n) _mm256_slli_epi32(v, n)
+#define VAS_I(v) _mm256_castps_si256(v)
+#define VAS_F(v) _mm256_castsi256_ps(v)
+#define VMASK_GT(a, b) ((unsigned)_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)))
+#define VGATHER(base, idx) _mm256_i32gather_ps(base, _mm256_loadu_si256((const __m256i*)(idx)), 4)
+#include "simd-kernels-impl.h"
+
+SIMD_TARGET_END
+
+static const simd_kernels_t kernels_avx2 = SIMD_KERNEL_TABLE(avx2);
+
+// ---------------------------------------------------------------------------
+// AVX-512F
+
+SIMD_TARGET_AVX512
+
+static inline __m512 avx512_sel_lt(__m512 a, __m512 b, __m512 x, __m512 y) {
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ), y, x);
+}
+
+#define SIMD_W 16
+#define SIMD_NAME(x) avx512_##x
+#define VF __m512
+#define VI __m512i
+#define VLOAD(p) _mm512_loadu_ps(p)
+#define VSTORE(p, v) _mm512_storeu_ps(p, v)
+#define VSET1(x) _mm512_set1_ps(x)
+#define VADD(a, b) _mm512_add_ps(a, b)
+#define VSUB(a, b) _mm512_sub_ps(a, b)
+#define VMUL(a, b) _mm512_mul_ps(a, b)
+#define VDIV(a, b) _mm512_div_ps(a, b)
+#define VMIN(a, b) _mm512_min_ps(a, b)
+#define VMAX(a, b) _mm512_max_ps(a, b)
+#define VFMA(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define VSEL_LT(a, b, x, y) avx512_sel_lt(a, b, x, y)
+#define VCVT_NEAREST(v) _mm512_cvtps_epi32(v)
+#define VCVT_I2F(v) _mm512_cvtepi32_ps(v)
+#define VI_SET1(x) _mm512_set1_epi32(x)
+#define VI_AND(a, b) _mm512_and_si512(a, b)
+#define VI_ADD(a, b) _mm512_add_epi32(a, b)
+#define VI_XOR(a, b) _mm512_xor_si512(a, b)
+#define VI_SLLI(v, n) _mm512_slli_epi32(v, n)
+#define VAS_I(v) _mm512_castps_si512(v)
+#define VAS_F(v) _mm512_castsi512_ps(v)
+#define VMASK_GT(a, b) ((unsigned)_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ))
+#define VGATHER(base, idx) _mm512_i32gather_ps(_mm512_loadu_si512(idx), base, 4)
+#include "simd-kernels-impl.h"
+
+SIMD_TARGET_END
+
+static const simd_kernels_t kernels_avx512 = SIMD_KERNEL_TABLE(avx512);
+
+#endif // SIMD_HAVE_X86
+
+#ifdef SIMD_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// NEON (aarch64 baseline)
+
+static inline unsigned neon_mask_gt(float32x4_t a, float32x4_t b) {
+    static const uint32_t lane_bits[4] = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(vcgtq_f32(a, b), vld1q_u32(lane_bits)));
+}
+
+static inline float32x4_t neon_gather(const float* base, const uint32_t* idx) {
+    float lanes[4] = { base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]] };
+    return vld1q_f32(lanes);
+}
+
+#define SIMD_W 4
+#define SIMD_NAME(x) neon_##x
+#define VF float32x4_t
+#define VI int32x4_t
+#define VLOAD(p) vld1q_f32(p)
+#define VSTORE(p, v) vst1q_f32(p, v)
+#define VSET1(x) vdupq_n_f32(x)
+#define VADD(a, b) vaddq_f32(a, b)
+#define VSUB(a, b) vsubq_f32(a, b)
+#define VMUL(a, b) vmulq_f32(a, b)
+#define VDIV(a, b) vdivq_f32(a, b)
+#define VMIN(a, b) vminq_f32(a, b)
+#define VMAX(a, b) vmaxq_f32(a, b)
+#define VFMA(a, b, c) vfmaq_f32(c, a, b)
+#define VSEL_LT(a, b, x, y) vbslq_f32(vcltq_f32(a, b), x, y)
+#define VCVT_NEAREST(v) vcvtnq_s32_f32(v)
+#define VCVT_I2F(v) vcvtq_f32_s32(v)
+#define VI_SET1(x) vdupq_n_s32(x)
+#define VI_AND(a, b) vandq_s32(a, b)
+#define VI_ADD(a, b) vaddq_s32(a, b)
+#define VI_XOR(a, b) veorq_s32(a, b)
+#define VI_SLLI(v, n) vshlq_n_s32(v, n)
+#define VAS_I(v) vreinterpretq_s32_f32(v)
+#define VAS_F(v) vreinterpretq_f32_s32(v)
+#define VMASK_GT(a, b) neon_mask_gt(a, b)
+#define VGATHER(base, idx) neon_gather(base, idx)
+#include "simd-kernels-impl.h"
+
+static const simd_kernels_t kernels_neon = SIMD_KERNEL_TABLE(neon);
+
+#endif // SIMD_HAVE_NEON
+
+// ---------------------------------------------------------------------------
+// Dispatch
+
+static _Atomic(const simd_kernels_t*) active_kernels;
+
+static int backend_supported(const simd_kernels_t* k) {
+    if (k == &kernels_scalar) return 1;
+#ifdef SIMD_HAVE_X86
+    __builtin_cpu_init();
+    if (k == &kernels_sse2) return 1;
+    if (k == &kernels_avx2) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    if (k == &kernels_avx512) {
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+               __builtin_cpu_supports("fma");
+    }
+#endif
+#ifdef SIMD_HAVE_NEON
+    if (k == &kernels_neon) return 1;
+#endif
+    return 0;
+}
+
+// Candidates in order of preference
+static const simd_kernels_t* const all_kernels[] = {
+#ifdef SIMD_HAVE_X86
+    &kernels_avx512,
+    &kernels_avx2,
+    &kernels_sse2,
+#endif
+#ifdef SIMD_HAVE_NEON
+    &kernels_neon,
+#endif
+    &kernels_scalar,
+};
+
+static const simd_kernels_t* find_backend(const char* name) {
+    for (size_t i = 0; i < sizeof(all_kernels) / sizeof(all_kernels[0]); i++) {
+        if (strcmp(all_kernels[i]->name, name) == 0) {
+            return backend_supported(all_kernels[i]) ? all_kernels[i] : NULL;
+        }
+    }
+    return NULL;
+}
+
+static const simd_kernels_t* select_backend(void) {
+    const char* forced = getenv("AGENT_ZERO_SIMD");
+    if (forced) {
+        const simd_kernels_t* k = find_backend(forced);
+        if (k) return k;
+    }
+    for (size_t i = 0; i < sizeof(all_kernels) / sizeof(all_kernels[0]); i++) {
+        if (backend_supported(all_kernels[i])) {
+            return all_kernels[i];
+        }
+    }
+    return &kernels_scalar;
+}
+
+const simd_kernels_t* simd_kernels(void) {
+    const simd_kernels_t* k = atomic_load_explicit(&active_kernels, memory_order_acquire);
+    if (!k) {
+        // Racing initializers all pick the same table
+        k = select_backend();
+        atomic_store_explicit(&active_kernels, k, memory_order_release);
+    }
+    return k;
+}
+
+const char* agent_zero_simd_backend(void) {
+    return simd_kernels()->name;
+}
+
+int agent_zero_set_simd_backend(const char* name) {
+    if (!name) return -1;
+    const simd_kernels_t* k = find_backend(name);
+    if (!k) return -1;
+    atomic_store_explicit(&active_kernels, k, memory_order_release);
+    return 0;
+}
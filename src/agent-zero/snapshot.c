@@ -0,0 +1,469 @@
+// Agent-Zero Binary Snapshots
+// /src/agent-zero/snapshot.c
+//
+// File layout (little-endian, every section GGML_MEM_ALIGN aligned):
+//   header            magic, version, byte-order mark, section table offset
+//   section table     one snapshot_section_t per section
+//   sections          raw arrays: hypergraph weights and CSR incidence,
+//                     then one dense tensor per cognitive kernel
+//
+// The loader maps the file copy-on-write and points tensors and the
+// hypergraph view straight at the mapped sections, so opening a snapshot
+// costs validation only; pages are read in on first touch.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cognitive-internal.h"
+
+#define SNAPSHOT_MAGIC "AZSNAP\0\0"
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+enum {
+    SECTION_NODE_WEIGHTS = 1,  // f32 x node_count
+    SECTION_LINK_WEIGHTS,      // f32 x link_count
+    SECTION_EDGE_OFFSETS,      // u64 x (link_count + 1)
+    SECTION_EDGE_NODES,        // u32 x edge_offsets[link_count]
+    SECTION_NODE_OFFSETS,      // u64 x (node_count + 1), finalized graphs only
+    SECTION_NODE_EDGES,        // u32 x node_offsets[node_count]
+    SECTION_KERNEL,            // dense tensor of the given type and shape
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t section_table;      // offset of the section table
+    uint32_t section_count;
+    uint32_t alignment;
+    uint8_t reserved[24];
+} snapshot_header_t;
+
+typedef struct {
+    uint32_t kind;
+    int32_t type;                // element type of SECTION_KERNEL
+    int32_t ne[GGML_MAX_DIMS];   // SECTION_KERNEL shape
+    uint64_t offset;
+    uint64_t size;               // bytes
+    uint64_t count;              // array entries
+    float attention_weight;      // SECTION_KERNEL
+    int32_t meta_level;
+    uint8_t reserved[8];
+} snapshot_section_t;
+
+_Static_assert(sizeof(snapshot_header_t) == 64, "snapshot header layout");
+_Static_assert(sizeof(snapshot_section_t) == 64, "snapshot section layout");
+
+struct cognitive_snapshot {
+    void* base;
+    size_t size;
+    const snapshot_section_t* sections;
+    uint32_t section_count;
+    const snapshot_section_t** kernels;
+    size_t kernel_count;
+    hypergraph_t graph;          // arrays point into the mapping
+    int has_graph;
+};
+
+static int host_is_little_endian(void) {
+    uint32_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+static uint64_t align_offset(uint64_t offset) {
+    return (offset + GGML_MEM_ALIGN - 1) & ~(uint64_t)(GGML_MEM_ALIGN - 1);
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+
+typedef struct {
+    snapshot_section_t* sections;
+    uint32_t count;
+    uint64_t cursor;    // end of the last section
+} snapshot_plan_t;
+
+static snapshot_section_t* plan_section(snapshot_plan_t* plan, uint32_t kind,
+                                        uint64_t count, uint64_t size) {
+    snapshot_section_t* s = &plan->sections[plan->count++];
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->count = count;
+    s->size = size;
+    s->offset = align_offset(plan->cursor);
+    plan->cursor = s->offset + size;
+    return s;
+}
+
+static int write_padding(FILE* f, uint64_t* written, uint64_t offset) {
+    static const char zeros[GGML_MEM_ALIGN];
+    while (*written < offset) {
+        size_t n = offset - *written < sizeof(zeros) ? (size_t)(offset - *written) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, f) != n) return -1;
+        *written += n;
+    }
+    return 0;
+}
+
+static int write_bytes(FILE* f, uint64_t* written, const void* data, size_t size) {
+    if (size && fwrite(data, 1, size, f) != size) return -1;
+    *written += size;
+    return 0;
+}
+
+// size_t arrays are stored as u64 whatever the host's size_t
+static int write_u64_array(FILE* f, uint64_t* written, const size_t* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint64_t v = values[i];
+        if (write_bytes(f, written, &v, sizeof(v)) != 0) return -1;
+    }
+    return 0;
+}
+
+static int write_tensor_rows(FILE* f, uint64_t* written, const struct ggml_tensor* t) {
+    size_t row_size = ggml_row_size(t->type, t->ne[1]);
+    if (ggml_is_contiguous(t)) {
+        return write_bytes(f, written, t->data, row_size * (size_t)ggml_nrows(t));
+    }
+    for (int64_t r = 0; r < ggml_nrows(t); r++) {
+        if (write_bytes(f, written, ggml_get_row(t, r), row_size) != 0) return -1;
+    }
+    return 0;
+}
+
+static int write_snapshot(FILE* f, const hypergraph_t* hg,
+                          cognitive_kernel_t* const* kernels, size_t n_kernels) {
+    snapshot_plan_t plan = { NULL, 0, 0 };
+    plan.sections = malloc((6 + n_kernels) * sizeof(snapshot_section_t));
+    if (!plan.sections) return -1;
+
+    uint64_t table = align_offset(sizeof(snapshot_header_t));
+    uint32_t section_count = (uint32_t)n_kernels;
+    if (hg) section_count += hg->finalized ? 6 : 4;
+    plan.cursor = table + (uint64_t)section_count * sizeof(snapshot_section_t);
+
+    if (hg) {
+        size_t incidence = hg->edge_offsets[hg->link_count];
+        plan_section(&plan, SECTION_NODE_WEIGHTS, hg->node_count, hg->node_count * sizeof(float));
+        plan_section(&plan, SECTION_LINK_WEIGHTS, hg->link_count, hg->link_count * sizeof(float));
+        plan_section(&plan, SECTION_EDGE_OFFSETS, hg->link_count + 1, (hg->link_count + 1) * sizeof(uint64_t));
+        plan_section(&plan, SECTION_EDGE_NODES, incidence, incidence * sizeof(uint32_t));
+        if (hg->finalized) {
+            size_t memberships = hg->node_offsets[hg->node_count];
+            plan_section(&plan, SECTION_NODE_OFFSETS, hg->node_count + 1,
+                         (hg->node_count + 1) * sizeof(uint64_t));
+            plan_section(&plan, SECTION_NODE_EDGES, memberships, memberships * sizeof(uint32_t));
+        }
+    }
+    for (size_t k = 0; k < n_kernels; k++) {
+        const struct ggml_tensor* t = kernels[k]->tensor_field;
+        snapshot_section_t* s = plan_section(&plan, SECTION_KERNEL, (uint64_t)ggml_nelements(t),
+                                             ggml_row_size(t->type, t->ne[1]) * (size_t)ggml_nrows(t));
+        s->type = t->type;
+        memcpy(s->ne, t->ne, sizeof(s->ne));
+        s->attention_weight = kernels[k]->attention_weight;
+        s->meta_level = kernels[k]->meta_level;
+    }
+
+    snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = COGNITIVE_SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.file_size = plan.cursor;
+    header.section_table = table;
+    header.section_count = section_count;
+    header.alignment = GGML_MEM_ALIGN;
+
+    uint64_t written = 0;
+    int status = write_bytes(f, &written, &header, sizeof(header));
+    status = status || write_padding(f, &written, table);
+    status = status || write_bytes(f, &written, plan.sections, section_count * sizeof(snapshot_section_t));
+
+    uint32_t s = 0;
+    if (hg && !status) {
+        status = write_padding(f, &written, plan.sections[s++].offset) ||
+                 write_bytes(f, &written, hg->node_weights, hg->node_count * sizeof(float)) ||
+                 write_padding(f, &written, plan.sections[s++].offset) ||
+                 write_bytes(f, &written, hg->link_weights, hg->link_count * sizeof(float)) ||
+                 write_padding(f, &written, plan.sections[s++].offset) ||
+                 write_u64_array(f, &written, hg->edge_offsets, hg->link_count + 1) ||
+                 write_padding(f, &written, plan.sections[s++].offset) ||
+                 write_bytes(f, &written, hg->edge_nodes,
+                             hg->edge_offsets[hg->link_count] * sizeof(uint32_t));
+        if (hg->finalized && !status) {
+            status = write_padding(f, &written, plan.sections[s++].offset) ||
+                     write_u64_array(f, &written, hg->node_offsets, hg->node_count + 1) ||
+                     write_padding(f, &written, plan.sections[s++].offset) ||
+                     write_bytes(f, &written, hg->node_edges,
+                                 hg->node_offsets[hg->node_count] * sizeof(uint32_t));
+        }
+    }
+    for (size_t k = 0; k < n_kernels && !status; k++) {
+        status = write_padding(f, &written, plan.sections[s++].offset) ||
+                 write_tensor_rows(f, &written, kernels[k]->tensor_field);
+    }
+
+    free(plan.sections);
+    return status ? -1 : 0;
+}
+
+int cognitive_snapshot_save(const char* path, const hypergraph_t* hg,
+                            cognitive_kernel_t* const* kernels, size_t n_kernels) {
+    if (!path || (n_kernels && !kernels) || !host_is_little_endian()) return -1;
+    for (size_t k = 0; k < n_kernels; k++) {
+        if (!kernels[k] || !kernels[k]->tensor_field || !kernels[k]->tensor_field->data) return -1;
+    }
+
+    // Write beside the target and rename, so readers never map a torn file
+    size_t len = strlen(path);
+    char* tmp_path = malloc(len + 5);
+    if (!tmp_path) return -1;
+    memcpy(tmp_path, path, len);
+    memcpy(tmp_path + len, ".tmp", 5);
+
+    FILE* f = fopen(tmp_path, "wb");
+    int status = f ? write_snapshot(f, hg, kernels, n_kernels) : -1;
+    if (f && fclose(f) != 0) status = -1;
+    if (status == 0 && rename(tmp_path, path) != 0) status = -1;
+    if (status != 0) remove(tmp_path);
+    free(tmp_path);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Loader
+
+static const snapshot_section_t* find_section(const cognitive_snapshot_t* snap, uint32_t kind) {
+    for (uint32_t i = 0; i < snap->section_count; i++) {
+        if (snap->sections[i].kind == kind) return &snap->sections[i];
+    }
+    return NULL;
+}
+
+static void* section_data(const cognitive_snapshot_t* snap, const snapshot_section_t* s) {
+    return (char*)snap->base + s->offset;
+}
+
+// The section holds exactly count entries of elem bytes; bounded by
+// division first so a crafted count cannot wrap the product
+static int section_holds(const snapshot_section_t* s, uint64_t count, size_t elem) {
+    return count <= s->size / elem && s->size == count * elem;
+}
+
+// CSR offsets must start at 0, never decrease and end at the member count;
+// members must be valid ids
+static int valid_csr(const uint64_t* offsets, uint64_t rows, const uint32_t* members,
+                     uint64_t member_count, uint64_t id_limit) {
+    if (offsets[0] != 0 || offsets[rows] != member_count) return 0;
+    for (uint64_t i = 0; i < rows; i++) {
+        if (offsets[i + 1] < offsets[i]) return 0;
+    }
+    for (uint64_t i = 0; i < member_count; i++) {
+        if (members[i] >= id_limit) return 0;
+    }
+    return 1;
+}
+
+static int attach_hypergraph(cognitive_snapshot_t* snap) {
+    const snapshot_section_t* nodes = find_section(snap, SECTION_NODE_WEIGHTS);
+    const snapshot_section_t* links = find_section(snap, SECTION_LINK_WEIGHTS);
+    const snapshot_section_t* offsets = find_section(snap, SECTION_EDGE_OFFSETS);
+    const snapshot_section_t* members = find_section(snap, SECTION_EDGE_NODES);
+    const snapshot_section_t* node_offsets = find_section(snap, SECTION_NODE_OFFSETS);
+    const snapshot_section_t* node_edges = find_section(snap, SECTION_NODE_EDGES);
+    if (!nodes && !links && !offsets && !members) return 0;
+    if (!nodes || !links || !offsets || !members || !node_offsets != !node_edges) return -1;
+
+    // Mapped u64 offsets double as size_t arrays only where the two agree
+    if (sizeof(size_t) != sizeof(uint64_t)) return -1;
+    // links->count is bounded by its section before the + 1
+    if (!section_holds(nodes, nodes->count, sizeof(float)) ||
+        !section_holds(links, links->count, sizeof(float)) ||
+        offsets->count != links->count + 1 || !section_holds(offsets, offsets->count, sizeof(uint64_t)) ||
+        !section_holds(members, members->count, sizeof(uint32_t)) || nodes->count > UINT32_MAX) {
+        return -1;
+    }
+    if (!valid_csr(section_data(snap, offsets), links->count, section_data(snap, members),
+                   members->count, nodes->count)) {
+        return -1;
+    }
+
+    hypergraph_t* hg = &snap->graph;
+    hg->node_count = nodes->count;
+    hg->link_count = links->count;
+    hg->node_weights = section_data(snap, nodes);
+    hg->link_weights = section_data(snap, links);
+    hg->edge_offsets = section_data(snap, offsets);
+    hg->edge_nodes = section_data(snap, members);
+    hg->link_capacity = links->count;
+    hg->incidence_capacity = members->count;
+
+    if (node_offsets) {
+        if (node_offsets->count != nodes->count + 1 ||
+            !section_holds(node_offsets, node_offsets->count, sizeof(uint64_t)) ||
+            !section_holds(node_edges, node_edges->count, sizeof(uint32_t)) ||
+            !valid_csr(section_data(snap, node_offsets), nodes->count,
+                       section_data(snap, node_edges), node_edges->count, links->count)) {
+            return -1;
+        }
+        hg->node_offsets = section_data(snap, node_offsets);
+        hg->node_edges = section_data(snap, node_edges);
+        hg->finalized = 1;
+    }
+    snap->has_graph = 1;
+    return 0;
+}
+
+static int valid_kernel_section(const snapshot_section_t* s) {
+    if (!ggml_get_type_traits(s->type)) return 0;
+    for (int d = 0; d < GGML_MAX_DIMS; d++) {
+        if (s->ne[d] < 0) return 0;
+    }
+    if (s->ne[1] % ggml_blck_size(s->type) != 0) return 0;
+    // The product never exceeds the section size, so it cannot wrap
+    uint64_t bytes = ggml_row_size(s->type, s->ne[1]);
+    for (int d = 0; d < GGML_MAX_DIMS; d++) {
+        if (d == 1) continue;
+        if (s->ne[d] && bytes > s->size / (uint64_t)s->ne[d]) return 0;
+        bytes *= (uint64_t)s->ne[d];
+    }
+    return s->size == bytes;
+}
+
+static int validate_snapshot(cognitive_snapshot_t* snap) {
+    if (snap->size < sizeof(snapshot_header_t)) return -1;
+    const snapshot_header_t* header = snap->base;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != COGNITIVE_SNAPSHOT_VERSION ||
+        header->byte_order != SNAPSHOT_BYTE_ORDER ||
+        header->file_size != snap->size ||
+        header->alignment != GGML_MEM_ALIGN ||
+        header->section_table % GGML_MEM_ALIGN != 0 ||
+        header->section_table > snap->size ||
+        header->section_count > (snap->size - header->section_table) / sizeof(snapshot_section_t)) {
+        return -1;
+    }
+
+    snap->sections = (const snapshot_section_t*)((char*)snap->base + header->section_table);
+    snap->section_count = header->section_count;
+    for (uint32_t i = 0; i < snap->section_count; i++) {
+        const snapshot_section_t* s = &snap->sections[i];
+        if (s->offset % GGML_MEM_ALIGN != 0 || s->offset > snap->size ||
+            s->size > snap->size - s->offset) {
+            return -1;
+        }
+        if (s->kind == SECTION_KERNEL) {
+            if (!valid_kernel_section(s)) return -1;
+            snap->kernel_count++;
+        }
+    }
+
+    snap->kernels = malloc((snap->kernel_count ? snap->kernel_count : 1) * sizeof(*snap->kernels));
+    if (!snap->kernels) return -1;
+    size_t k = 0;
+    for (uint32_t i = 0; i < snap->section_count; i++) {
+        if (snap->sections[i].kind == SECTION_KERNEL) snap->kernels[k++] = &snap->sections[i];
+    }
+    return attach_hypergraph(snap);
+}
+
+cognitive_snapshot_t* cognitive_snapshot_open(const char* path) {
+    if (!path || !host_is_little_endian()) return NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // Private and writable: tensors may be modified in memory without
+    // touching the file
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    cognitive_snapshot_t* snap = calloc(1, sizeof(cognitive_snapshot_t));
+    if (!snap) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    snap->base = base;
+    snap->size = (size_t)st.st_size;
+    if (validate_snapshot(snap) != 0) {
+        cognitive_snapshot_close(snap);
+        return NULL;
+    }
+    return snap;
+}
+
+void cognitive_snapshot_close(cognitive_snapshot_t* snap) {
+    if (snap) {
+        munmap(snap->base, snap->size);
+        free(snap->kernels);
+        free(snap);
+    }
+}
+
+const hypergraph_t* cognitive_snapshot_hypergraph(const cognitive_snapshot_t* snap) {
+    return snap && snap->has_graph ? &snap->graph : NULL;
+}
+
+hypergraph_t* cognitive_snapshot_load_hypergraph(const cognitive_snapshot_t* snap) {
+    const hypergraph_t* view = cognitive_snapshot_hypergraph(snap);
+    if (!view) return NULL;
+
+    hypergraph_t* hg = create_hypergraph(view->node_count, view->link_count);
+    if (!hg) return NULL;
+    memcpy(hg->node_weights, view->node_weights, view->node_count * sizeof(float));
+    for (size_t e = 0; e < view->link_count; e++) {
+        size_t begin = view->edge_offsets[e];
+        if (hypergraph_add_edge(hg, view->edge_nodes + begin, view->edge_offsets[e + 1] - begin,
+                                view->link_weights[e]) < 0) {
+            destroy_hypergraph(hg);
+            return NULL;
+        }
+    }
+    if (view->finalized && hypergraph_finalize(hg) != 0) {
+        destroy_hypergraph(hg);
+        return NULL;
+    }
+    return hg;
+}
+
+size_t cognitive_snapshot_kernel_count(const cognitive_snapshot_t* snap) {
+    return snap ? snap->kernel_count : 0;
+}
+
+struct ggml_tensor* cognitive_snapshot_tensor(
+    struct ggml_context* ctx, const cognitive_snapshot_t* snap, size_t index) {
+    if (!snap || index >= snap->kernel_count) return NULL;
+    const snapshot_section_t* s = snap->kernels[index];
+    return ggml_tensor_wrap(ctx, s->type, GGML_MAX_DIMS, s->ne, section_data(snap, s));
+}
+
+cognitive_kernel_t* cognitive_snapshot_kernel(
+    struct ggml_context* ctx, const cognitive_snapshot_t* snap, size_t index) {
+    struct ggml_tensor* field = cognitive_snapshot_tensor(ctx, snap, index);
+    if (!field) return NULL;
+
+    cognitive_kernel_t* kernel = malloc(sizeof(cognitive_kernel_t));
+    if (!kernel) {
+        ggml_free_tensor(field);
+        return NULL;
+    }
+    kernel->tensor_field = field;
+    kernel->attention_weight = snap->kernels[index]->attention_weight;
+    kernel->meta_level = snap->kernels[index]->meta_level;
+    kernel->kernel_id = (size_t)kernel;
+    return kernel;
+}
@@ -0,0 +1,130 @@
+// Agent-Zero Instrumentation
+// /src/agent-zero/stats.c
+//
+// Process-wide counters behind agent_zero_get_stats(). Hot paths bump
+// them with one relaxed atomic add (STATS_ADD / STATS_SPAN_* in
+// cognitive-internal.h); readers may see a snapshot that is torn across
+// counters but never within one.
+
+#include <string.h>
+#include <time.h>
+#include "cognitive-internal.h"
+
+static const char* const op_names[AGENT_ZERO_OP_COUNT] = {
+    "attention",
+    "meta_transform",
+    "hypergraph_encoding",
+    "pattern_match",
+    "graph_compute",
+    "cast",
+    "encode",
+    "decode",
+    "attention_tensor",
+    "attention_matvec",
+    "similarity_hypergraph",
+    "hypergraph_to_sparse",
+    "attention_diffusion",
+    "ann_insert",
+    "ann_search",
+    "tensor_delta_encode",
+    "tensor_delta_decode",
+};
+
+const char* agent_zero_op_name(int op) {
+    return op >= 0 && op < AGENT_ZERO_OP_COUNT ? op_names[op] : NULL;
+}
+
+#ifndef AGENT_ZERO_NO_STATS
+
+_Atomic uint64_t stats_counters[STAT_COUNTER_COUNT];
+
+static _Atomic uint64_t op_calls[AGENT_ZERO_OP_COUNT];
+static _Atomic uint64_t op_nanoseconds[AGENT_ZERO_OP_COUNT];
+static _Atomic uint64_t op_bytes[AGENT_ZERO_OP_COUNT];
+
+static _Atomic(agent_zero_trace_fn) trace_hook;
+static _Atomic(void*) trace_user;
+
+uint64_t stats_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void stats_span_end(int op, const stats_span_t* span, uint64_t bytes) {
+    // Counters are read first so the bookkeeping below is not charged to the op
+    uint64_t counters[AGENT_ZERO_COUNTER_COUNT];
+    if (span->profiled) profile_read_counters(counters);
+    uint64_t end_ns = stats_clock_ns();
+    atomic_fetch_add_explicit(&op_calls[op], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&op_nanoseconds[op], end_ns - span->start_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&op_bytes[op], bytes, memory_order_relaxed);
+
+    agent_zero_trace_fn hook = atomic_load_explicit(&trace_hook, memory_order_acquire);
+    if (hook) {
+        agent_zero_trace_span_t trace = { op, op_names[op], span->start_ns, end_ns, bytes };
+        hook(&trace, atomic_load_explicit(&trace_user, memory_order_relaxed));
+    }
+    if (span->profiled) profile_span_end(op, span, counters, end_ns, bytes);
+}
+
+int agent_zero_stats_enabled(void) {
+    return 1;
+}
+
+void agent_zero_set_trace_hook(agent_zero_trace_fn hook, void* user) {
+    atomic_store_explicit(&trace_user, user, memory_order_relaxed);
+    atomic_store_explicit(&trace_hook, hook, memory_order_release);
+}
+
+void agent_zero_reset_stats(void) {
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+        atomic_store_explicit(&stats_counters[i], 0, memory_order_relaxed);
+    }
+    for (int op = 0; op < AGENT_ZERO_OP_COUNT; op++) {
+        atomic_store_explicit(&op_calls[op], 0, memory_order_relaxed);
+        atomic_store_explicit(&op_nanoseconds[op], 0, memory_order_relaxed);
+        atomic_store_explicit(&op_bytes[op], 0, memory_order_relaxed);
+    }
+}
+
+#else
+
+int agent_zero_stats_enabled(void) {
+    return 0;
+}
+
+void agent_zero_set_trace_hook(agent_zero_trace_fn hook, void* user) {
+    (void)hook;
+    (void)user;
+}
+
+void agent_zero_reset_stats(void) {
+}
+
+#endif
+
+void agent_zero_get_stats(agent_zero_stats_t* stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+
+#ifndef AGENT_ZERO_NO_STATS
+    for (int op = 0; op < AGENT_ZERO_OP_COUNT; op++) {
+        stats->op_calls[op] = atomic_load_explicit(&op_calls[op], memory_order_relaxed);
+        stats->op_nanoseconds[op] = atomic_load_explicit(&op_nanoseconds[op], memory_order_relaxed);
+        stats->op_bytes[op] = atomic_load_explicit(&op_bytes[op], memory_order_relaxed);
+    }
+    stats->tensor_allocs = atomic_load_explicit(&stats_counters[STAT_TENSOR_ALLOCS], memory_order_relaxed);
+    stats->tensor_bytes = atomic_load_explicit(&stats_counters[STAT_TENSOR_BYTES], memory_order_relaxed);
+    stats->arena_allocs = atomic_load_explicit(&stats_counters[STAT_ARENA_ALLOCS], memory_order_relaxed);
+    stats->pool_hits = atomic_load_explicit(&stats_counters[STAT_POOL_HITS], memory_order_relaxed);
+    stats->pool_misses = atomic_load_explicit(&stats_counters[STAT_POOL_MISSES], memory_order_relaxed);
+    stats->malloc_fallbacks = atomic_load_explicit(&stats_counters[STAT_MALLOC_FALLBACKS], memory_order_relaxed);
+    stats->placed_allocs = atomic_load_explicit(&stats_counters[STAT_PLACED_ALLOCS], memory_order_relaxed);
+#endif
+
+    size_t in_use, peak;
+    tensor_pool_usage(&in_use, &peak);
+    stats->pool_bytes_in_use = in_use;
+    stats->pool_peak_bytes = peak;
+}
@@ -0,0 +1,462 @@
+// Agent-Zero Tensor Deltas
+// /src/agent-zero/tensor-delta.c
+//
+// Message layout (little-endian):
+//   header    magic, version, encoding, flags, type and shape, quantization
+//             step, checksum of the base the delta applies to, body sizes
+//   body      optionally one zstd frame around the raw body
+//
+// The raw body walks the tensor's storage words (4 bytes for F32, 2 for the
+// 16-bit and block types) in blocks of DELTA_BLOCK_WORDS as runs of
+//   varint unchanged blocks, varint changed blocks, the changed blocks
+// with trailing unchanged blocks implied. In XOR mode a changed block holds,
+// for every byte plane of a word, a 64-bit mask of the words whose XOR with
+// the base has that byte nonzero followed by those bytes, so bits an update
+// leaves alone cost nothing. In quantized mode (F32 only) it holds a mask of
+// the changed words and one varint each: steps of the quantizer, zigzagged
+// and shifted left, or 1 followed by the raw word when no step count
+// reproduces the change (non-finite values, steps below the base's ulp).
+//
+// The encoder leaves base holding exactly what the decoder computes, so
+// peers stay bit-identical and quantization error never compounds. The
+// decoder validates the whole message before writing the target.
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cognitive-internal.h"
+#ifdef AGENT_ZERO_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define DELTA_MAGIC "AZTD"
+#define DELTA_BLOCK_WORDS 64
+#define DELTA_VARINT_MAX 10
+// Largest step count sent; anything further is sent as a raw word
+#define DELTA_MAX_STEPS 1073741824.0
+
+enum {
+    DELTA_XOR = 0,
+    DELTA_QUANTIZED = 1,
+};
+
+enum {
+    DELTA_FLAG_KEYFRAME = 0x1,   // applies to zeros; base_checksum unused
+    DELTA_FLAG_ZSTD = 0x2,       // body is one zstd frame of raw_size bytes
+};
+
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint8_t encoding;
+    uint8_t flags;
+    int32_t type;
+    int32_t ne[GGML_MAX_DIMS];
+    float step;                  // DELTA_QUANTIZED
+    uint64_t base_checksum;
+    uint64_t body_size;          // bytes after the header
+    uint64_t raw_size;           // body bytes before zstd framing
+    uint8_t reserved[8];
+} tensor_delta_header_t;
+
+_Static_assert(sizeof(tensor_delta_header_t) == 64, "tensor delta header layout");
+
+static int host_is_little_endian(void) {
+    uint32_t probe = 1;
+    uint8_t first;
+    memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+static size_t word_size(int type) {
+    return type == GGML_TYPE_F32 ? 4 : 2;
+}
+
+// Dense bytes of a tensor the format can carry, 0 otherwise
+static size_t delta_tensor_bytes(const struct ggml_tensor* t) {
+    if (!t || !t->data || !ggml_get_type_traits(t->type) || !ggml_is_contiguous(t)) return 0;
+    size_t bytes = ggml_nbytes(t);
+    return bytes % word_size(t->type) == 0 ? bytes : 0;
+}
+
+// Four independent multiply-xorshift lanes, so hashing runs near memory speed
+static uint64_t delta_checksum(const uint8_t* data, size_t size) {
+    const uint64_t prime = 0x9e3779b97f4a7c15ull;
+    uint64_t h[4] = { 0x243f6a8885a308d3ull, 0x13198a2e03707344ull,
+                      0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull };
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int l = 0; l < 4; l++) {
+            uint64_t v;
+            memcpy(&v, data + i + 8 * l, 8);
+            h[l] = (h[l] ^ v) * prime;
+            h[l] ^= h[l] >> 29;
+        }
+    }
+    uint64_t hash = size;
+    for (int l = 0; l < 4; l++) {
+        hash = (hash ^ h[l]) * prime;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * prime;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+static uint32_t load_word(const uint8_t* p, size_t w) {
+    if (w == 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return v;
+    }
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v;
+}
+
+static void store_word(uint8_t* p, size_t w, uint32_t v) {
+    if (w == 4) {
+        memcpy(p, &v, 4);
+    } else {
+        uint16_t h = (uint16_t)v;
+        memcpy(p, &h, 2);
+    }
+}
+
+static size_t put_varint(uint8_t* p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Bounded, canonical-length read; -1 on truncation or overlong encodings
+static int get_varint(const uint8_t* p, size_t size, size_t* pos, uint64_t* v) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= size) return -1;
+        uint8_t byte = p[(*pos)++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *v = value;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int get_mask(const uint8_t* p, size_t size, size_t* pos, size_t n, uint64_t* mask) {
+    if (size - *pos < 8) return -1;
+    memcpy(mask, p + *pos, 8);
+    *pos += 8;
+    // Bits past a short final block would address words outside the tensor
+    return n < 64 && (*mask >> n) ? -1 : 0;
+}
+
+// Bit pattern of fmaf(k, step, base), the value both peers compute
+static uint32_t quantized_word(uint32_t base_bits, int64_t k, float step) {
+    float base;
+    memcpy(&base, &base_bits, 4);
+    float r = fmaf((float)k, step, base);
+    uint32_t bits;
+    memcpy(&bits, &r, 4);
+    return bits;
+}
+
+// Encodes block words [0, n) of cur over base, moves base to the
+// decoder's result and returns the encoded size; 0 if the block is unchanged
+static size_t encode_xor_block(uint8_t* out, const uint8_t* cur, uint8_t* base, size_t n, size_t w) {
+    uint32_t x[DELTA_BLOCK_WORDS];
+    uint32_t any = 0;
+    for (size_t j = 0; j < n; j++) {
+        x[j] = load_word(cur + j * w, w) ^ load_word(base + j * w, w);
+        any |= x[j];
+    }
+    if (!any) return 0;
+
+    uint8_t* p = out;
+    for (size_t plane = 0; plane < w; plane++) {
+        unsigned shift = (unsigned)(8 * plane);
+        uint64_t mask = 0;
+        for (size_t j = 0; j < n; j++) {
+            if ((x[j] >> shift) & 0xff) mask |= (uint64_t)1 << j;
+        }
+        memcpy(p, &mask, 8);
+        p += 8;
+        for (size_t j = 0; j < n; j++) {
+            if ((x[j] >> shift) & 0xff) *p++ = (uint8_t)(x[j] >> shift);
+        }
+    }
+    memcpy(base, cur, n * w);
+    return (size_t)(p - out);
+}
+
+static size_t encode_quantized_block(uint8_t* out, const uint8_t* cur, uint8_t* base,
+                                     size_t n, float step) {
+    uint64_t code[DELTA_BLOCK_WORDS];
+    uint32_t next[DELTA_BLOCK_WORDS];
+    uint64_t mask = 0;
+    for (size_t j = 0; j < n; j++) {
+        uint32_t c = load_word(cur + 4 * j, 4);
+        uint32_t b = load_word(base + 4 * j, 4);
+        if (c == b) continue;
+        float cv, bv;
+        memcpy(&cv, &c, 4);
+        memcpy(&bv, &b, 4);
+        double steps = nearbyint(((double)cv - (double)bv) / step);
+        if (isfinite(cv) && isfinite(bv) && fabs(steps) <= DELTA_MAX_STEPS) {
+            if (steps == 0) continue;   // below step / 2: dropped
+            int64_t k = (int64_t)steps;
+            uint32_t r = quantized_word(b, k, step);
+            if (r != b) {
+                code[j] = (((uint64_t)k << 1) ^ (uint64_t)(k >> 63)) << 1;
+                next[j] = r;
+                mask |= (uint64_t)1 << j;
+                continue;
+            }
+        }
+        code[j] = 1;
+        next[j] = c;
+        mask |= (uint64_t)1 << j;
+    }
+    if (!mask) return 0;
+
+    uint8_t* p = out;
+    memcpy(p, &mask, 8);
+    p += 8;
+    for (size_t j = 0; j < n; j++) {
+        if (!(mask >> j & 1)) continue;
+        p += put_varint(p, code[j]);
+        if (code[j] == 1) {
+            memcpy(p, &next[j], 4);
+            p += 4;
+        }
+        store_word(base + 4 * j, 4, next[j]);
+    }
+    return (size_t)(p - out);
+}
+
+// Walks a raw body; with apply unset it only validates
+static int decode_body(const tensor_delta_header_t* h, const uint8_t* body, size_t size,
+                       uint8_t* target, size_t n_words, int apply) {
+    size_t w = word_size(h->type);
+    size_t n_blocks = (n_words + DELTA_BLOCK_WORDS - 1) / DELTA_BLOCK_WORDS;
+    size_t pos = 0;
+    size_t block = 0;
+    while (pos < size) {
+        uint64_t skip, changed;
+        if (get_varint(body, size, &pos, &skip) != 0) return -1;
+        if (get_varint(body, size, &pos, &changed) != 0) return -1;
+        if (changed == 0 || skip > n_blocks - block || changed > n_blocks - block - skip) return -1;
+        block += skip;
+        for (uint64_t c = 0; c < changed; c++, block++) {
+            size_t first = block * DELTA_BLOCK_WORDS;
+            size_t n = n_words - first < DELTA_BLOCK_WORDS ? n_words - first : DELTA_BLOCK_WORDS;
+            uint8_t* words = target + first * w;
+            if (h->encoding == DELTA_XOR) {
+                for (size_t plane = 0; plane < w; plane++) {
+                    uint64_t mask;
+                    if (get_mask(body, size, &pos, n, &mask) != 0) return -1;
+                    size_t count = (size_t)__builtin_popcountll(mask);
+                    if (size - pos < count) return -1;
+                    for (; apply && mask; mask &= mask - 1) {
+                        size_t j = (size_t)__builtin_ctzll(mask);
+                        uint32_t x = (uint32_t)body[pos++] << (8 * plane);
+                        store_word(words + j * w, w, load_word(words + j * w, w) ^ x);
+                    }
+                    if (!apply) pos += count;
+                }
+            } else {
+                uint64_t mask;
+                if (get_mask(body, size, &pos, n, &mask) != 0 || !mask) return -1;
+                for (; mask; mask &= mask - 1) {
+                    size_t j = (size_t)__builtin_ctzll(mask);
+                    uint64_t code;
+                    if (get_varint(body, size, &pos, &code) != 0) return -1;
+                    uint32_t r;
+                    if (code == 1) {
+                        if (size - pos < 4) return -1;
+                        memcpy(&r, body + pos, 4);
+                        pos += 4;
+                    } else {
+                        uint64_t z = code >> 1;
+                        if ((code & 1) || z == 0 || z > 2 * (uint64_t)DELTA_MAX_STEPS) return -1;
+                        int64_t k = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+                        r = apply ? quantized_word(load_word(words + 4 * j, 4), k, h->step) : 0;
+                    }
+                    if (apply) store_word(words + 4 * j, 4, r);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+size_t tensor_delta_bound(const struct ggml_tensor* t) {
+    size_t bytes = delta_tensor_bytes(t);
+    if (!bytes) return 0;
+    size_t n_blocks = (bytes / word_size(t->type) + DELTA_BLOCK_WORDS - 1) / DELTA_BLOCK_WORDS;
+    // Per block: two run varints plus the larger of an XOR block of 4-byte
+    // words and a quantized block of literals
+    return sizeof(tensor_delta_header_t) +
+           n_blocks * (2 * DELTA_VARINT_MAX + 8 + DELTA_BLOCK_WORDS * (DELTA_VARINT_MAX + 4));
+}
+
+int tensor_delta_zstd_available(void) {
+#ifdef AGENT_ZERO_HAVE_ZSTD
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int64_t tensor_delta_encode(const struct ggml_tensor* current, struct ggml_tensor* base,
+                            const tensor_delta_options_t* opts, void* out, size_t out_size) {
+    tensor_delta_options_t defaults = { 0.0f, 0, 0 };
+    if (!opts) opts = &defaults;
+    if (!host_is_little_endian() || !current || !base || !out) return -1;
+    size_t bytes = delta_tensor_bytes(current);
+    if (!bytes || current->type != base->type || delta_tensor_bytes(base) != bytes) return -1;
+    if (memcmp(current->ne, base->ne, sizeof(current->ne)) != 0) return -1;
+    int quantized = opts->step != 0.0f;
+    if (quantized && (current->type != GGML_TYPE_F32 || !(opts->step > 0.0f) || !isfinite(opts->step))) {
+        return -1;
+    }
+    if (out_size < tensor_delta_bound(current)) return -1;
+    STATS_SPAN_BEGIN(span);
+
+    tensor_delta_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DELTA_MAGIC, 4);
+    header.version = TENSOR_DELTA_VERSION;
+    header.encoding = quantized ? DELTA_QUANTIZED : DELTA_XOR;
+    header.type = current->type;
+    memcpy(header.ne, current->ne, sizeof(header.ne));
+    header.step = quantized ? opts->step : 0.0f;
+    if (opts->keyframe) {
+        header.flags |= DELTA_FLAG_KEYFRAME;
+        memset(base->data, 0, bytes);
+    } else {
+        header.base_checksum = delta_checksum(base->data, bytes);
+    }
+
+    size_t w = word_size(current->type);
+    size_t n_words = bytes / w;
+    size_t n_blocks = (n_words + DELTA_BLOCK_WORDS - 1) / DELTA_BLOCK_WORDS;
+    const uint8_t* cur = current->data;
+    uint8_t* ref = base->data;
+    uint8_t* body = (uint8_t*)out + sizeof(header);
+    uint8_t* p = body;
+
+    // Changed blocks are encoded past room for the run's two varints and
+    // slid down once the run's length is known
+    uint64_t skip = 0;
+    size_t b = 0;
+    while (b < n_blocks) {
+        uint8_t* bodies = p + 2 * DELTA_VARINT_MAX;
+        uint8_t* q = bodies;
+        uint64_t changed = 0;
+        uint64_t next_skip = 0;
+        for (; b < n_blocks; b++) {
+            size_t first = b * DELTA_BLOCK_WORDS;
+            size_t n = n_words - first < DELTA_BLOCK_WORDS ? n_words - first : DELTA_BLOCK_WORDS;
+            size_t len = quantized
+                ? encode_quantized_block(q, cur + first * w, ref + first * w, n, opts->step)
+                : encode_xor_block(q, cur + first * w, ref + first * w, n, w);
+            if (len) {
+                q += len;
+                changed++;
+            } else if (changed) {
+                b++;
+                next_skip = 1;
+                break;
+            } else {
+                skip++;
+            }
+        }
+        if (!changed) break;
+        p += put_varint(p, skip);
+        p += put_varint(p, changed);
+        memmove(p, bodies, (size_t)(q - bodies));
+        p += q - bodies;
+        skip = next_skip;
+    }
+    header.raw_size = (uint64_t)(p - body);
+    header.body_size = header.raw_size;
+
+#ifdef AGENT_ZERO_HAVE_ZSTD
+    if (opts->zstd_level > 0 && header.raw_size > 0) {
+        size_t capacity = ZSTD_compressBound((size_t)header.raw_size);
+        void* frame = malloc(capacity);
+        if (frame) {
+            size_t framed = ZSTD_compress(frame, capacity, body, (size_t)header.raw_size, opts->zstd_level);
+            if (!ZSTD_isError(framed) && framed < header.raw_size) {
+                memcpy(body, frame, framed);
+                header.body_size = framed;
+                header.flags |= DELTA_FLAG_ZSTD;
+            }
+            free(frame);
+        }
+    }
+#endif
+
+    memcpy(out, &header, sizeof(header));
+    int64_t written = (int64_t)(sizeof(header) + header.body_size);
+    STATS_SPAN_END(span, AGENT_ZERO_OP_DELTA_ENCODE, 2 * bytes + (size_t)written);
+    return written;
+}
+
+int tensor_delta_decode(struct ggml_tensor* target, const void* data, size_t size) {
+    if (!host_is_little_endian() || !data || size < sizeof(tensor_delta_header_t)) return -1;
+    tensor_delta_header_t h;
+    memcpy(&h, data, sizeof(h));
+    if (memcmp(h.magic, DELTA_MAGIC, 4) != 0 || h.version != TENSOR_DELTA_VERSION) return -1;
+    if (h.encoding > DELTA_QUANTIZED || (h.flags & ~(DELTA_FLAG_KEYFRAME | DELTA_FLAG_ZSTD))) return -1;
+    if (h.body_size != size - sizeof(h)) return -1;
+    size_t bytes = delta_tensor_bytes(target);
+    if (!bytes || h.type != target->type || memcmp(h.ne, target->ne, sizeof(h.ne)) != 0) return -1;
+    if (h.encoding == DELTA_QUANTIZED &&
+        (h.type != GGML_TYPE_F32 || !(h.step > 0.0f) || !isfinite(h.step))) {
+        return -1;
+    }
+    if (!(h.flags & DELTA_FLAG_KEYFRAME) && delta_checksum(target->data, bytes) != h.base_checksum) {
+        return -1;
+    }
+    STATS_SPAN_BEGIN(span);
+
+    const uint8_t* body = (const uint8_t*)data + sizeof(h);
+    uint8_t* raw = NULL;
+    if (h.flags & DELTA_FLAG_ZSTD) {
+#ifdef AGENT_ZERO_HAVE_ZSTD
+        // The body never outgrows the bound of its tensor
+        if (h.raw_size == 0 || h.raw_size > tensor_delta_bound(target)) return -1;
+        raw = malloc((size_t)h.raw_size);
+        if (!raw) return -1;
+        size_t n = ZSTD_decompress(raw, (size_t)h.raw_size, body, (size_t)h.body_size);
+        if (ZSTD_isError(n) || n != h.raw_size) {
+            free(raw);
+            return -1;
+        }
+        body = raw;
+#else
+        return -1;
+#endif
+    } else if (h.raw_size != h.body_size) {
+        return -1;
+    }
+
+    size_t n_words = bytes / word_size(h.type);
+    int result = decode_body(&h, body, (size_t)h.raw_size, target->data, n_words, 0);
+    if (result == 0) {
+        if (h.flags & DELTA_FLAG_KEYFRAME) memset(target->data, 0, bytes);
+        decode_body(&h, body, (size_t)h.raw_size, target->data, n_words, 1);
+    }
+    free(raw);
+    if (result == 0) STATS_SPAN_END(span, AGENT_ZERO_OP_DELTA_DECODE, bytes + size);
+    return result;
+}
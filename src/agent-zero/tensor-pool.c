@@ -0,0 +1,231 @@
+// Agent-Zero Tensor Memory Pool
+// /src/agent-zero/tensor-pool.c
+//
+// Size-classed block pool for heap tensors:
+// - Power-of-two size classes from 64B to 64KB, 64-byte aligned
+// - Slabs are carved lazily, only when a class actually runs dry
+// - Each thread keeps a private free list per class (no atomics on the
+//   fast path); overflow spills to a lock-free global depot that other
+//   threads drain in one exchange
+// - Thread exit flushes the private lists back to the depot
+//
+// The depot only supports "push chain" (CAS) and "take everything"
+// (exchange). Neither operation inspects a node another thread may be
+// popping concurrently, so the stack is immune to ABA without tagging.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "cognitive-internal.h"
+
+#define POOL_MIN_SHIFT 6                       // 64B
+#define POOL_MAX_SHIFT 16                      // 64KB
+#define POOL_CLASS_COUNT (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_SLAB_BYTES (256 * 1024)           // target slab size
+#define POOL_SLAB_MIN_BLOCKS 8
+#define POOL_CACHE_BYTES (512 * 1024)          // per-thread, per-class cap
+
+typedef struct PoolBlock {
+    struct PoolBlock* next;
+} PoolBlock;
+
+typedef struct PoolSlab {
+    struct PoolSlab* next;
+    void* memory;
+} PoolSlab;
+
+typedef struct {
+    _Atomic(PoolBlock*) depot[POOL_CLASS_COUNT];
+    _Atomic(PoolSlab*) slabs;
+    atomic_size_t total_allocated;
+    atomic_size_t peak_usage;
+} TensorMemoryPool;
+
+typedef struct {
+    PoolBlock* head[POOL_CLASS_COUNT];
+    size_t count[POOL_CLASS_COUNT];
+    int registered;
+} PoolThreadCache;
+
+static TensorMemoryPool tensor_pool;
+static _Thread_local PoolThreadCache thread_cache;
+
+static pthread_key_t cache_key;
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+static size_t class_block_size(int size_class) {
+    return (size_t)1 << (size_class + POOL_MIN_SHIFT);
+}
+
+static size_t class_cache_limit(int size_class) {
+    size_t limit = POOL_CACHE_BYTES / class_block_size(size_class);
+    return limit < POOL_SLAB_MIN_BLOCKS ? POOL_SLAB_MIN_BLOCKS : limit;
+}
+
+static int size_to_class(size_t size) {
+    int shift = POOL_MIN_SHIFT;
+    while (shift <= POOL_MAX_SHIFT && ((size_t)1 << shift) < size) {
+        shift++;
+    }
+    return shift <= POOL_MAX_SHIFT ? shift - POOL_MIN_SHIFT : -1;
+}
+
+// Push a pre-linked chain first..last onto a depot list
+static void depot_push(int size_class, PoolBlock* first, PoolBlock* last) {
+    PoolBlock* head = atomic_load_explicit(&tensor_pool.depot[size_class], memory_order_relaxed);
+    do {
+        last->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &tensor_pool.depot[size_class], &head, first,
+        memory_order_release, memory_order_relaxed));
+}
+
+static void flush_thread_cache(void* unused) {
+    (void)unused;
+    for (int c = 0; c < POOL_CLASS_COUNT; c++) {
+        PoolBlock* first = thread_cache.head[c];
+        if (!first) continue;
+
+        PoolBlock* last = first;
+        while (last->next) {
+            last = last->next;
+        }
+        depot_push(c, first, last);
+        thread_cache.head[c] = NULL;
+        thread_cache.count[c] = 0;
+    }
+}
+
+static void create_cache_key(void) {
+    pthread_key_create(&cache_key, flush_thread_cache);
+}
+
+// Arrange for flush_thread_cache to run when the calling thread exits
+static void register_thread_cache(void) {
+    pthread_once(&cache_key_once, create_cache_key);
+    pthread_setspecific(cache_key, &thread_cache);
+    thread_cache.registered = 1;
+}
+
+// Carve a fresh slab into the calling thread's cache
+static int grow_class(int size_class) {
+    size_t block_size = class_block_size(size_class);
+    size_t block_count = POOL_SLAB_BYTES / block_size;
+    if (block_count < POOL_SLAB_MIN_BLOCKS) {
+        block_count = POOL_SLAB_MIN_BLOCKS;
+    }
+
+    PoolSlab* slab = malloc(sizeof(PoolSlab));
+    if (!slab) return -1;
+    slab->memory = aligned_alloc(GGML_MEM_ALIGN, block_size * block_count);
+    if (!slab->memory) {
+        free(slab);
+        return -1;
+    }
+
+    // Slabs live for the process lifetime; blocks may sit in any thread's cache
+    slab->next = atomic_load_explicit(&tensor_pool.slabs, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &tensor_pool.slabs, &slab->next, slab,
+        memory_order_release, memory_order_relaxed)) {
+    }
+
+    char* base = (char*)slab->memory;
+    for (size_t i = 0; i < block_count; i++) {
+        PoolBlock* block = (PoolBlock*)(base + i * block_size);
+        block->next = thread_cache.head[size_class];
+        thread_cache.head[size_class] = block;
+    }
+    thread_cache.count[size_class] += block_count;
+    return 0;
+}
+
+static void account_allocation(size_t size) {
+    size_t total = atomic_fetch_add_explicit(
+        &tensor_pool.total_allocated, size, memory_order_relaxed) + size;
+    size_t peak = atomic_load_explicit(&tensor_pool.peak_usage, memory_order_relaxed);
+    while (total > peak && !atomic_compare_exchange_weak_explicit(
+        &tensor_pool.peak_usage, &peak, total,
+        memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void* tensor_pool_alloc(size_t size, int* size_class) {
+    int c = size_to_class(size);
+    *size_class = c;
+    if (c < 0) return NULL;  // Too large for the pool
+
+    if (!thread_cache.registered) {
+        register_thread_cache();
+    }
+
+    if (!thread_cache.head[c]) {
+        // Drain whatever other threads released, then fall back to a new slab
+        PoolBlock* chain = atomic_exchange_explicit(
+            &tensor_pool.depot[c], NULL, memory_order_acquire);
+        size_t n = 0;
+        for (PoolBlock* b = chain; b; b = b->next) {
+            n++;
+        }
+        thread_cache.head[c] = chain;
+        thread_cache.count[c] = n;
+
+        if (!chain) {
+            if (grow_class(c) != 0) {
+                *size_class = -1;
+                return NULL;
+            }
+            STATS_ADD(STAT_POOL_MISSES, 1);
+        } else {
+            STATS_ADD(STAT_POOL_HITS, 1);
+        }
+    } else {
+        STATS_ADD(STAT_POOL_HITS, 1);
+    }
+
+    PoolBlock* block = thread_cache.head[c];
+    thread_cache.head[c] = block->next;
+    thread_cache.count[c]--;
+
+    account_allocation(class_block_size(c));
+    return block;
+}
+
+void tensor_pool_free(void* ptr, int size_class) {
+    if (!ptr || size_class < 0 || size_class >= POOL_CLASS_COUNT) return;
+
+    if (!thread_cache.registered) {
+        register_thread_cache();
+    }
+
+    PoolBlock* block = ptr;
+    block->next = thread_cache.head[size_class];
+    thread_cache.head[size_class] = block;
+    thread_cache.count[size_class]++;
+    atomic_fetch_sub_explicit(&tensor_pool.total_allocated,
+                              class_block_size(size_class), memory_order_relaxed);
+
+    // Keep the private list bounded: spill half of it to the depot
+    size_t limit = class_cache_limit(size_class);
+    if (thread_cache.count[size_class] > limit) {
+        size_t keep = limit / 2;
+        PoolBlock* last = thread_cache.head[size_class];
+        for (size_t i = 1; i < thread_cache.count[size_class] - keep; i++) {
+            last = last->next;
+        }
+        PoolBlock* first = thread_cache.head[size_class];
+        thread_cache.head[size_class] = last->next;
+        thread_cache.count[size_class] = keep;
+        depot_push(size_class, first, last);
+    }
+}
+
+size_t tensor_pool_block_size(int size_class) {
+    return class_block_size(size_class);
+}
+
+void tensor_pool_usage(size_t* in_use, size_t* peak) {
+    *in_use = atomic_load_explicit(&tensor_pool.total_allocated, memory_order_relaxed);
+    *peak = atomic_load_explicit(&tensor_pool.peak_usage, memory_order_relaxed);
+}
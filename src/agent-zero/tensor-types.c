@@ -0,0 +1,222 @@
+// Agent-Zero Tensor Storage Types
+// /src/agent-zero/tensor-types.c
+//
+// f16 and bf16 halve a tensor, Q8_0 (32 int8 values sharing one fp16
+// scale, 34 bytes per block) cuts it to ~27%. Kernels stay f32: typed
+// operands are converted a tile at a time into cache-resident buffers, so
+// no f32 copy of a whole tensor is ever made.
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cognitive-internal.h"
+
+typedef struct {
+    uint16_t d;          // fp16 scale
+    int8_t qs[QK8_0];
+} block_q8_0;
+
+_Static_assert(sizeof(block_q8_0) == sizeof(uint16_t) + QK8_0, "block_q8_0 must be packed");
+
+static inline uint32_t float_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bits_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// Round to nearest even; overflow goes to inf, NaN stays a quiet NaN.
+// Subnormal halves are produced by letting the FPU align the mantissa.
+static inline uint16_t fp32_to_fp16(float value) {
+    const uint32_t f32_inf = 255u << 23;
+    const uint32_t f16_max = (127u + 16u) << 23;
+    const uint32_t denorm_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t f = float_bits(value);
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint16_t h;
+    if (f >= f16_max) {
+        h = f > f32_inf ? 0x7e00 : 0x7c00;
+    } else if (f < (113u << 23)) {
+        h = (uint16_t)(float_bits(bits_float(f) + bits_float(denorm_magic)) - denorm_magic);
+    } else {
+        uint32_t mant_odd = (f >> 13) & 1;
+        f += ((uint32_t)(15 - 127) << 23) + 0xfff + mant_odd;
+        h = (uint16_t)(f >> 13);
+    }
+    return h | (uint16_t)(sign >> 16);
+}
+
+static inline float fp16_to_fp32(uint16_t h) {
+    const uint32_t shifted_exp = 0x7c00u << 13;
+    uint32_t o = ((uint32_t)h & 0x7fffu) << 13;
+    uint32_t exp = o & shifted_exp;
+    o += (127u - 15u) << 23;
+    if (exp == shifted_exp) {
+        o += (128u - 16u) << 23;  // inf / NaN
+    } else if (exp == 0) {
+        o += 1u << 23;            // subnormal: renormalize
+        o = float_bits(bits_float(o) - bits_float(113u << 23));
+    }
+    return bits_float(o | ((uint32_t)h & 0x8000u) << 16);
+}
+
+static inline uint16_t fp32_to_bf16(float value) {
+    uint32_t u = float_bits(value);
+    if ((u & 0x7fffffffu) > 0x7f800000u) {
+        return (uint16_t)((u >> 16) | 0x40);  // quiet NaN
+    }
+    return (uint16_t)((u + 0x7fffu + ((u >> 16) & 1)) >> 16);
+}
+
+static inline float bf16_to_fp32(uint16_t h) {
+    return bits_float((uint32_t)h << 16);
+}
+
+void ggml_fp32_to_fp16_row(const float* x, uint16_t* y, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        y[i] = fp32_to_fp16(x[i]);
+    }
+}
+
+void ggml_fp16_to_fp32_row(const uint16_t* x, float* y, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        y[i] = fp16_to_fp32(x[i]);
+    }
+}
+
+void ggml_fp32_to_bf16_row(const float* x, uint16_t* y, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        y[i] = fp32_to_bf16(x[i]);
+    }
+}
+
+void ggml_bf16_to_fp32_row(const uint16_t* x, float* y, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+        y[i] = bf16_to_fp32(x[i]);
+    }
+}
+
+// Symmetric per-block scale: d = max|x| / 127, q = round(x / d)
+void quantize_row_q8_0(const float* x, void* y, int64_t n) {
+    block_q8_0* blocks = y;
+    for (int64_t b = 0; b < n / QK8_0; b++) {
+        const float* xb = x + b * QK8_0;
+        float amax = 0.0f;
+        for (int i = 0; i < QK8_0; i++) {
+            float v = fabsf(xb[i]);
+            if (v > amax) amax = v;
+        }
+        float d = amax / 127.0f;
+        float id = d > 0.0f ? 1.0f / d : 0.0f;
+        blocks[b].d = fp32_to_fp16(d);
+        for (int i = 0; i < QK8_0; i++) {
+            blocks[b].qs[i] = (int8_t)lrintf(xb[i] * id);
+        }
+    }
+}
+
+void dequantize_row_q8_0(const void* x, float* y, int64_t n) {
+    const block_q8_0* blocks = x;
+    for (int64_t b = 0; b < n / QK8_0; b++) {
+        float d = fp16_to_fp32(blocks[b].d);
+        for (int i = 0; i < QK8_0; i++) {
+            y[b * QK8_0 + i] = blocks[b].qs[i] * d;
+        }
+    }
+}
+
+static void f32_to_f32(const void* x, float* y, int64_t n) {
+    memcpy(y, x, (size_t)n * sizeof(float));
+}
+
+static void f32_from_f32(const float* x, void* y, int64_t n) {
+    memcpy(y, x, (size_t)n * sizeof(float));
+}
+
+static void f16_to_f32(const void* x, float* y, int64_t n) {
+    ggml_fp16_to_fp32_row(x, y, n);
+}
+
+static void f16_from_f32(const float* x, void* y, int64_t n) {
+    ggml_fp32_to_fp16_row(x, y, n);
+}
+
+static void bf16_to_f32(const void* x, float* y, int64_t n) {
+    ggml_bf16_to_fp32_row(x, y, n);
+}
+
+static void bf16_from_f32(const float* x, void* y, int64_t n) {
+    ggml_fp32_to_bf16_row(x, y, n);
+}
+
+static const ggml_type_traits_t type_traits[] = {
+    { "f32",  1,     sizeof(float),      f32_to_f32,          f32_from_f32 },
+    { "f16",  1,     sizeof(uint16_t),   f16_to_f32,          f16_from_f32 },
+    { "q8_0", QK8_0, sizeof(block_q8_0), dequantize_row_q8_0, quantize_row_q8_0 },
+    { "bf16", 1,     sizeof(uint16_t),   bf16_to_f32,         bf16_from_f32 },
+};
+
+const ggml_type_traits_t* ggml_get_type_traits(int type) {
+    switch (type) {
+    case GGML_TYPE_F32:  return &type_traits[0];
+    case GGML_TYPE_F16:  return &type_traits[1];
+    case GGML_TYPE_Q8_0: return &type_traits[2];
+    case GGML_TYPE_BF16: return &type_traits[3];
+    default:             return NULL;
+    }
+}
+
+const char* ggml_type_name(int type) {
+    const ggml_type_traits_t* traits = ggml_get_type_traits(type);
+    return traits ? traits->name : NULL;
+}
+
+int ggml_blck_size(int type) {
+    const ggml_type_traits_t* traits = ggml_get_type_traits(type);
+    return traits ? traits->blck_size : 0;
+}
+
+size_t ggml_type_size(int type) {
+    const ggml_type_traits_t* traits = ggml_get_type_traits(type);
+    return traits ? traits->type_size : 0;
+}
+
+size_t ggml_row_size(int type, int64_t n) {
+    const ggml_type_traits_t* traits = ggml_get_type_traits(type);
+    return traits ? (size_t)(n / traits->blck_size) * traits->type_size : 0;
+}
+
+struct ggml_tensor* ggml_cast(struct ggml_context* ctx, const struct ggml_tensor* tensor, int type) {
+    if (!tensor || !tensor->data) return NULL;
+    const ggml_type_traits_t* src = ggml_get_type_traits(tensor->type);
+    const ggml_type_traits_t* dst = ggml_get_type_traits(type);
+    if (!src || !dst) return NULL;
+
+    struct ggml_tensor* result = ggml_new_tensor(ctx, type, GGML_MAX_DIMS, tensor->ne);
+    if (!result) return NULL;
+
+    // Row by row through one f32 row buffer
+    int64_t row_len = tensor->ne[1];
+    int64_t nrows = ggml_nrows(tensor);
+    float* row = malloc((size_t)(row_len ? row_len : 1) * sizeof(float));
+    if (!row) {
+        ggml_free_tensor(result);
+        return NULL;
+    }
+    STATS_SPAN_BEGIN(span);
+    for (int64_t r = 0; r < nrows; r++) {
+        src->to_f32(ggml_get_row(tensor, r), row, row_len);
+        dst->from_f32(row, ggml_get_row(result, r), row_len);
+    }
+    STATS_SPAN_END(span, AGENT_ZERO_OP_CAST, ggml_nbytes(tensor) + ggml_nbytes(result));
+    free(row);
+    return result;
+}
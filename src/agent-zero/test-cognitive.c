@@ -1,7 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
 #include <assert.h>
-#include "cognitive.h"
+#include <pthread.h>
+#include <unistd.h>
+#include "cognitive-internal.h"
+#include "atomspace-internal.h"
+
+// assert() that is still evaluated under NDEBUG, so Release builds run
+// every call a check makes and fail the same way Debug builds do
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            abort(); \
+        } \
+    } while (0)
 
 int test_hypergraph_creation() {
     printf("Testing hypergraph creation...\n");
@@ -13,16 +29,470 @@ int test_hypergraph_creation() {
     }
     
     assert(hg->node_count == 10);
-    assert(hg->link_count == 20);
+    CHECK(hg->link_count == 0);
+    CHECK(hg->link_capacity >= 20);
     assert(hg->node_weights != NULL);
     assert(hg->link_weights != NULL);
-    assert(hg->adjacency_matrix != NULL);
+    CHECK(hg->edge_offsets != NULL && hg->edge_offsets[0] == 0);
     
     destroy_hypergraph(hg);
     printf("PASS: Hypergraph creation\n");
     return 1;
 }
 
+int test_sparse_hypergraph() {
+    printf("Testing sparse hypergraph...\n");
+    
+    // Far more nodes than a dense node_count^2 matrix could hold
+    const size_t nodes = 200000;
+    hypergraph_t* hg = create_hypergraph(nodes, 4);
+    CHECK(hg != NULL);
+    for (size_t v = 0; v < nodes; v++) {
+        hg->node_weights[v] = 1.0f + (float)(v % 7) * 0.25f;
+    }
+    
+    const uint32_t tri[3] = { 5, 9, 199999 };
+    const uint32_t pair[2] = { 9, 42 };
+    const uint32_t solo[1] = { 7 };
+    const uint32_t bad[2] = { 1, 200000 };
+    CHECK(hypergraph_add_edge(hg, tri, 3, 1.0f) == 0);
+    CHECK(hypergraph_add_edge(hg, pair, 2, 0.5f) == 1);
+    CHECK(hypergraph_add_edge(hg, solo, 1, 2.0f) == 2);
+    CHECK(hypergraph_add_edge(hg, bad, 2, 1.0f) == -1);
+    // Grow past the capacity hint
+    for (uint32_t v = 100; v < 140; v++) {
+        uint32_t e[2] = { v, v + 1 };
+        CHECK(hypergraph_add_edge(hg, e, 2, 1.0f) >= 0);
+    }
+    CHECK(hg->link_count == 43);
+    CHECK(hg->link_weights[1] == 0.5f);
+    
+    // Node -> edge incidence
+    CHECK(hypergraph_finalize(hg) == 0);
+    CHECK(hg->node_offsets[10] - hg->node_offsets[9] == 2);
+    CHECK(hg->node_edges[hg->node_offsets[9]] == 0);
+    CHECK(hg->node_edges[hg->node_offsets[9] + 1] == 1);
+    CHECK(hg->node_offsets[nodes] == hg->edge_offsets[hg->link_count]);
+    
+    // Clique expansion: triangle 6 + pair 2 + diagonal 1 + chain 80 entries
+    sparse_tensor_t* sp = encode_hypergraph_to_sparse(hg);
+    CHECK(sp != NULL);
+    CHECK(sp->rows == nodes && sp->nnz == 6 + 2 + 1 + 80);
+    CHECK(sp->row_ptr[10] - sp->row_ptr[9] == 3);  // 5, 42, 199999
+   CHECK(sp->col_idx[sp->row_ptr[9]] == 5 && sp->col_idx[sp->row_ptr[9] + 2] == 199999);
+    float w = (hg->node_weights[9] + hg->node_weights[42]) * 0.5f;
+    CHECK(sp->values[sp->row_ptr[9] + 1] == w);
+    
+    // Decoding yields one 2-node edge per symmetric pair
+    hypergraph_t* back = create_hypergraph(nodes, 0);
+    CHECK(back != NULL);
+    for (size_t v = 0; v < nodes; v++) {
+        back->node_weights[v] = 1.0f;
+    }
+    CHECK(decode_sparse_to_hypergraph(sp, back) == 0);
+    CHECK(back->link_count == 3 + 1 + 1 + 40);
+    
+    // The dense path agrees with the sparse one on a small graph
+    hypergraph_t* small = create_hypergraph(6, 2);
+    for (int v = 0; v < 6; v++) {
+        small->node_weights[v] = 1.0f + v;
+    }
+    const uint32_t quad[4] = { 0, 2, 3, 5 };
+    CHECK(hypergraph_add_edge(small, quad, 4, 1.0f) == 0);
+    struct ggml_tensor* dense = encode_hypergraph_to_tensor(NULL, small);
+    sparse_tensor_t* ssp = encode_hypergraph_to_sparse(small);
+    CHECK(dense && ssp && ssp->nnz == 12);
+    float* d = ggml_get_data_f32(dense);
+    int nonzero = 0;
+    for (int i = 0; i < 36; i++) {
+        nonzero += d[i] != 0.0f;
+    }
+    CHECK(nonzero == 12);
+    for (size_t r = 0; r < ssp->rows; r++) {
+        for (size_t k = ssp->row_ptr[r]; k < ssp->row_ptr[r + 1]; k++) {
+            CHECK(d[r * 6 + ssp->col_idx[k]] == ssp->values[k]);
+        }
+    }
+    CHECK(decode_tensor_to_hypergraph(dense, small) == 0);
+    CHECK(small->link_count == 6);
+    
+    ggml_free_tensor(dense);
+    destroy_sparse_tensor(ssp);
+    destroy_hypergraph(small);
+    destroy_hypergraph(back);
+    destroy_sparse_tensor(sp);
+    destroy_hypergraph(hg);
+    printf("PASS: Sparse hypergraph\n");
+    return 1;
+}
+
+int test_atomspace_similarity_join() {
+    printf("Testing AtomSpace similarity join...\n");
+    
+    AtomSpace* as = create_atomspace();
+    const int n = 900;
+    float means[900];
+    srand(7);
+    for (int i = 0; i < n; i++) {
+        // Coarse values force ties and exact-threshold gaps
+        means[i] = (float)(rand() % 200) / 100.0f - 0.5f;
+        CHECK(atomspace_add_atom(as, ATOM_TYPE_CONCEPT, "atom", means[i], 0.9) == i);
+    }
+    CHECK(atomspace_size(as) == (size_t)n);
+    
+    const float thresholds[] = { ATOMSPACE_SIMILARITY_THRESHOLD, 0.05f };
+    for (size_t t = 0; t < sizeof(thresholds) / sizeof(thresholds[0]); t++) {
+        size_t expected = 0;
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                expected += fabsf(means[i] - means[j]) < thresholds[t];
+            }
+        }
+        
+        hypergraph_t* serial = create_hypergraph_from_atomspace(as, thresholds[t], 1);
+        hypergraph_t* parallel = create_hypergraph_from_atomspace(as, thresholds[t], 4);
+        CHECK(serial && parallel);
+        CHECK(serial->link_count == expected && parallel->link_count == expected);
+        CHECK(memcmp(serial->edge_nodes, parallel->edge_nodes,
+                     2 * expected * sizeof(uint32_t)) == 0);
+        for (size_t e = 0; e < expected; e++) {
+            uint32_t i = serial->edge_nodes[2 * e];
+            uint32_t j = serial->edge_nodes[2 * e + 1];
+            CHECK(i < j && fabsf(means[i] - means[j]) < thresholds[t]);
+        }
+        destroy_hypergraph(serial);
+        destroy_hypergraph(parallel);
+    }
+    
+    // Dense and sparse tensors carry the same default-threshold adjacency
+    struct ggml_tensor* dense = create_hypergraph_tensor_from_atomspace(NULL, as);
+    sparse_tensor_t* sp = create_sparse_hypergraph_tensor_from_atomspace(
+        as, ATOMSPACE_SIMILARITY_THRESHOLD, 0);
+    CHECK(dense && sp);
+    float* d = ggml_get_data_f32(dense);
+    size_t nonzero = 0;
+    for (size_t i = 0; i < (size_t)n * n; i++) {
+        nonzero += d[i] != 0.0f;
+    }
+    for (size_t r = 0; r < sp->rows; r++) {
+        for (size_t k = sp->row_ptr[r]; k < sp->row_ptr[r + 1]; k++) {
+            CHECK(d[r * n + sp->col_idx[k]] == sp->values[k]);
+        }
+    }
+    // Pairs whose weights cancel are stored explicitly only in the sparse form
+    CHECK(nonzero <= sp->nnz);
+    
+    ggml_free_tensor(dense);
+    destroy_sparse_tensor(sp);
+    destroy_atomspace(as);
+    printf("PASS: AtomSpace similarity join\n");
+    return 1;
+}
+
+static void count_visit(uint32_t atom, void* user) {
+    (void)atom;
+    (*(size_t*)user)++;
+}
+
+int test_atomspace_index() {
+    printf("Testing indexed AtomSpace...\n");
+    
+    // Well past the old fixed capacity of 1000 atoms
+    AtomSpace* as = create_atomspace();
+    const int n = 5000;
+    static char names[5000][32];
+    for (int i = 0; i < n; i++) {
+        if (i % 10 == 0) {
+            snprintf(names[i], sizeof(names[i]), "agent-zero-%d", i % 7);
+        } else {
+            snprintf(names[i], sizeof(names[i]), "concept_%d", i);
+        }
+        int type = i % 3 == 0 ? ATOM_TYPE_LINK : ATOM_TYPE_CONCEPT;
+        CHECK(atomspace_add_atom(as, type, names[i], (i % 100) / 100.0, 0.9) == i);
+    }
+    CHECK(atomspace_size(as) == (size_t)n);
+    
+    const uint32_t* atoms;
+    size_t links = atomspace_atoms_by_type(as, ATOM_TYPE_LINK, &atoms);
+    CHECK(links == (size_t)(n + 2) / 3);
+    for (size_t k = 0; k < links; k++) {
+        CHECK(atoms[k] == 3 * k);
+    }
+    CHECK(atomspace_atoms_by_type(as, ATOM_TYPE_INHERITANCE, &atoms) == 0);
+    
+    // Interned names shared by many atoms
+    size_t named = atomspace_atoms_by_name(as, "agent-zero-3", &atoms);
+    CHECK(named > 0);
+    for (size_t k = 0; k < named; k++) {
+        CHECK(strcmp(names[atoms[k]], "agent-zero-3") == 0);
+    }
+    CHECK(atomspace_atoms_by_name(as, "concept_42", &atoms) == 1 && atoms[0] == 42);
+    CHECK(atomspace_atoms_by_name(as, "concept_40", &atoms) == 0);
+    
+    // Substring queries, trigram and short-pattern paths, against strstr
+    const char* patterns[] = { "zero", "concept_49", "t_1", "_4", "0", "", "missing" };
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+        size_t expected = 0;
+        for (int i = 0; i < n; i++) {
+            expected += strstr(names[i], patterns[p]) != NULL;
+        }
+        size_t visited = 0;
+        CHECK(atomspace_match_name(as, patterns[p], count_visit, &visited) == expected);
+        CHECK(visited == expected);
+    }
+    
+    // pattern_match_atomspace gives the same result as a full scan
+    struct ggml_tensor* result = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, n);
+    CHECK(pattern_match_atomspace(as, "_12", result) == 0);
+    float* r = ggml_get_data_f32(result);
+    for (int i = 0; i < n; i++) {
+        float ref = strstr(names[i], "_12") ? (float)((i % 100) / 100.0) : 0.0f;
+        CHECK(r[i] == ref);
+    }
+    
+    // Clearing keeps names interned but drops their atoms
+    atomspace_clear(as);
+    CHECK(atomspace_size(as) == 0);
+    CHECK(atomspace_atoms_by_name(as, "agent-zero-3", &atoms) == 0);
+    CHECK(atomspace_add_atom(as, ATOM_TYPE_CONCEPT, "agent-zero-3", 0.5, 0.5) == 0);
+    size_t visited = 0;
+    CHECK(atomspace_match_name(as, "zero", count_visit, &visited) == 1);
+    
+    ggml_free_tensor(result);
+    destroy_atomspace(as);
+    printf("PASS: Indexed AtomSpace\n");
+    return 1;
+}
+
+int test_atomspace_columns() {
+    printf("Testing column-wise AtomSpace storage...\n");
+    
+    AtomSpace* as = create_atomspace();
+    const int n = 3000;
+    for (int i = 0; i < n; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "node_%d", i % 500);
+        CHECK(atomspace_add_atom(as, ATOM_TYPE_CONCEPT, i % 4 ? name : NULL,
+                                 0.001 * i, 0.5) == i);
+    }
+    
+    // Columns hold every attribute contiguously; names live in one pool
+    for (int i = 0; i < n; i++) {
+        CHECK(as->mean[i] == 0.001 * i);
+        CHECK(as->activation[i] == (float)(0.001 * i));
+        CHECK(as->type[i] == ATOM_TYPE_CONCEPT);
+        const char* name = atomspace_atom_name(as, i);
+        if (i % 4) {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "node_%d", i % 500);
+            CHECK(name && strcmp(name, expected) == 0);
+        } else {
+            CHECK(name == NULL);
+        }
+    }
+    CHECK(as->name_count == 375);  // distinct names among the named atoms
+   
+   // The activation tensor wraps the column without copying
+   struct ggml_tensor* view = atomspace_activation_tensor(NULL, as);
+    CHECK(view && ggml_get_data_f32(view) == atomspace_activations(as));
+    CHECK(ggml_get_ne(view, 0) == n && ggml_is_contiguous(view));
+    
+    // The copying conversion agrees and pads with the default activation
+    struct ggml_tensor* dense = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, n + 10);
+    atomspace_to_tensor(as, dense);
+    float* d = ggml_get_data_f32(dense);
+    CHECK(memcmp(d, ggml_get_data_f32(view), n * sizeof(float)) == 0);
+    CHECK(d[n] == 0.1f && d[n + 9] == 0.1f);
+    
+    ggml_free_tensor(view);  // leaves the column alone
+    CHECK(atomspace_activations(as)[n - 1] == (float)(0.001 * (n - 1)));
+    ggml_free_tensor(dense);
+    destroy_atomspace(as);
+    printf("PASS: Column-wise AtomSpace storage\n");
+    return 1;
+}
+
+// Live atoms of as must be exactly the concept_<i> atoms a full decode of
+// values would create, with the same means
+static int same_as_full_decode(const AtomSpace* as, const float* values, int n) {
+    size_t expected = 0;
+    for (int i = 0; i < n; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "concept_%d", i);
+        const uint32_t* atoms;
+        size_t found = atomspace_atoms_by_name(as, name, &atoms);
+        if (values[i] > 0.01f) {
+            if (found != 1 || as->activation[atoms[0]] != values[i]) return 0;
+            expected++;
+        } else if (found != 0) {
+            return 0;
+        }
+    }
+    const uint32_t* concepts;
+    return atomspace_size(as) == expected &&
+           atomspace_atoms_by_type(as, ATOM_TYPE_CONCEPT, &concepts) == expected;
+}
+
+int test_atomspace_delta() {
+    printf("Testing delta tensor_to_atomspace...\n");
+    
+    const int n = 2000;
+    struct ggml_tensor* t = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, n);
+    float* v = ggml_get_data_f32(t);
+    for (int i = 0; i < n; i++) {
+        v[i] = (i % 3 == 0) ? 0.0f : 0.5f + (float)(i % 17) * 0.01f;
+    }
+    
+    AtomSpace* as = create_atomspace();
+    atomspace_delta_t* delta = create_atomspace_delta();
+    CHECK(tensor_to_atomspace_delta(t, as, delta) == 0);
+    CHECK(delta->created_count == (size_t)(n - (n + 2) / 3));
+    CHECK(delta->updated_count == 0 && delta->retired_count == 0);
+    CHECK(same_as_full_decode(as, v, n));
+    
+    const uint32_t* atoms;
+    CHECK(atomspace_atoms_by_name(as, "concept_1", &atoms) == 1);
+    uint32_t handle1 = atoms[0];
+    
+    // Steady state: nothing changes, nothing is reported
+    size_t handles = as->count;
+    CHECK(tensor_to_atomspace_delta(t, as, delta) == 0);
+    CHECK(delta->created_count == 0 && delta->updated_count == 0 && delta->retired_count == 0);
+    
+    // Element 1 falls below the threshold, 3 rises above it, 2 moves
+    v[1] = 0.0f;
+    v[3] = 0.9f;
+    v[2] = 0.25f;
+    CHECK(tensor_to_atomspace_delta(t, as, delta) == 0);
+    CHECK(delta->retired_count == 1 && delta->retired[0] == handle1);
+    CHECK(delta->created_count == 1 && delta->updated_count == 1);
+    CHECK(as->count == handles + 1);
+    CHECK(same_as_full_decode(as, v, n));
+    
+    // Revival restores the atom's original handle
+    v[1] = 0.75f;
+    CHECK(tensor_to_atomspace_delta(t, as, delta) == 0);
+    CHECK(delta->created_count == 1 && delta->created[0] == handle1);
+    CHECK(as->count == handles + 1);
+    CHECK(same_as_full_decode(as, v, n));
+    
+    // The delta decoder adopts atoms created by a full decode
+    AtomSpace* full = create_atomspace();
+    tensor_to_atomspace(t, full);
+    CHECK(tensor_to_atomspace_delta(t, full, delta) == 0);
+    CHECK(delta->created_count == 0 && delta->updated_count == 0);
+    v[4] = 0.0f;
+    CHECK(tensor_to_atomspace_delta(t, full, delta) == 0);
+    CHECK(delta->retired_count == 1);
+    CHECK(same_as_full_decode(full, v, n));
+    
+    // Kernel-scaled decode matches decode_cognitive_state
+    int shape[] = {8, 8};
+    cognitive_kernel_t* kernel = create_cognitive_kernel(NULL, shape, 2, 0.5f);
+    AtomSpace* scaled = create_atomspace();
+    AtomSpace* reference = create_atomspace();
+    CHECK(decode_cognitive_state_delta(t, kernel, scaled, delta) == 0);
+    CHECK(decode_cognitive_state(t, kernel, reference) == 0);
+    CHECK(atomspace_size(scaled) == atomspace_size(reference));
+    for (size_t k = 0; k < delta->created_count; k++) {
+        uint32_t h = delta->created[k];
+        const char* name = atomspace_atom_name(scaled, h);
+        CHECK(atomspace_atoms_by_name(reference, name, &atoms) == 1);
+        CHECK(reference->activation[atoms[0]] == scaled->activation[h]);
+    }
+    
+    destroy_cognitive_kernel(kernel);
+    destroy_atomspace(scaled);
+    destroy_atomspace(reference);
+    destroy_atomspace(full);
+    destroy_atomspace_delta(delta);
+    destroy_atomspace(as);
+    ggml_free_tensor(t);
+    printf("PASS: Delta tensor_to_atomspace\n");
+    return 1;
+}
+
+int test_batched_encode() {
+    printf("Testing batched cognitive state encode...\n");
+    
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 10000; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, (i % 89) / 89.0, 0.8);
+    }
+    
+    // Outputs shorter and longer than the AtomSpace, across block edges
+    enum { KERNELS = 5 };
+    const int rows[KERNELS] = { 10, 100, 111, 3, 150 };
+    const int cols = 97;
+    int shape[] = {4, 4};
+    cognitive_kernel_t* kernels[KERNELS];
+    struct ggml_tensor* batch[KERNELS];
+    struct ggml_tensor* single[KERNELS];
+    for (int k = 0; k < KERNELS; k++) {
+        kernels[k] = create_cognitive_kernel(NULL, shape, 2, 0.3f + 0.1f * k);
+        kernels[k]->meta_level = k;
+        batch[k] = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows[k], cols);
+        single[k] = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows[k], cols);
+        CHECK(encode_cognitive_state(as, kernels[k], single[k]) == 0);
+    }
+    CHECK(encode_cognitive_state_batch(as, kernels, KERNELS, batch) == 0);
+    
+    // Reference: the unbatched conversion + scale
+    for (int k = 0; k < KERNELS; k++) {
+        int n = rows[k] * cols;
+        struct ggml_tensor* ref = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, n);
+        atomspace_to_tensor(as, ref);
+        float factor = kernels[k]->attention_weight * (1.0f + kernels[k]->meta_level * 0.1f);
+        float* r = ggml_get_data_f32(ref);
+        float* b = ggml_get_data_f32(batch[k]);
+        float* s = ggml_get_data_f32(single[k]);
+        for (int i = 0; i < n; i++) {
+            CHECK(b[i] == r[i] * factor && s[i] == b[i]);
+        }
+        ggml_free_tensor(ref);
+    }
+    
+    // Stacked output: plane k matches a same-shaped batch output
+    struct ggml_tensor* stacked = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 111, cols, KERNELS);
+    CHECK(encode_cognitive_state_stacked(as, kernels, KERNELS, stacked) == 0);
+    struct ggml_tensor* plane = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 111, cols);
+    for (int k = 0; k < KERNELS; k++) {
+        CHECK(encode_cognitive_state(as, kernels[k], plane) == 0);
+        CHECK(memcmp(ggml_get_data_f32(stacked) + (size_t)k * 111 * cols,
+                     ggml_get_data_f32(plane), 111 * cols * sizeof(float)) == 0);
+    }
+    CHECK(encode_cognitive_state_stacked(as, kernels, KERNELS - 1, stacked) == -1);
+    
+    // Batched decode matches one-at-a-time delta decodes
+    AtomSpace* spaces[KERNELS];
+    atomspace_delta_t* deltas[KERNELS];
+    for (int k = 0; k < KERNELS; k++) {
+        spaces[k] = create_atomspace();
+        deltas[k] = create_atomspace_delta();
+    }
+    CHECK(decode_cognitive_state_batch((const struct ggml_tensor* const*)batch, kernels,
+                                       KERNELS, spaces, deltas) == 0);
+    for (int k = 0; k < KERNELS; k++) {
+        AtomSpace* ref = create_atomspace();
+        CHECK(decode_cognitive_state(batch[k], kernels[k], ref) == 0);
+        CHECK(atomspace_size(spaces[k]) == atomspace_size(ref));
+        destroy_atomspace(ref);
+        destroy_atomspace(spaces[k]);
+        destroy_atomspace_delta(deltas[k]);
+    }
+    
+    for (int k = 0; k < KERNELS; k++) {
+        ggml_free_tensor(batch[k]);
+        ggml_free_tensor(single[k]);
+        destroy_cognitive_kernel(kernels[k]);
+    }
+    ggml_free_tensor(plane);
+    ggml_free_tensor(stacked);
+    destroy_atomspace(as);
+    printf("PASS: Batched cognitive state encode\n");
+    return 1;
+}
+
 int test_cognitive_kernel_creation() {
     printf("Testing cognitive kernel creation...\n");
     
@@ -47,6 +517,2160 @@ int test_cognitive_kernel_creation() {
     return 1;
 }
 
+int test_context_arena() {
+    printf("Testing context arena allocation...\n");
+    
+    struct ggml_context* ctx = ggml_context_create(1024 * 1024);
+    if (!ctx) {
+        printf("FAIL: Context creation failed\n");
+        return 0;
+    }
+    CHECK(ggml_context_used(ctx) == 0);
+    
+    int shape[] = {32, 16};
+    cognitive_kernel_t* kernel = create_cognitive_kernel(ctx, shape, 2, 0.5f);
+    CHECK(kernel != NULL);
+    CHECK(kernel->tensor_field->flags & GGML_TENSOR_FLAG_CTX);
+    CHECK(((uintptr_t)kernel->tensor_field % GGML_HEADER_ALIGN) == 0);
+    CHECK(((uintptr_t)kernel->tensor_field->data % GGML_MEM_ALIGN) == 0);
+    
+    float* field = (float*)kernel->tensor_field->data;
+    for (int i = 0; i < 32 * 16; i++) {
+        field[i] = 1.0f;
+    }
+    
+    struct ggml_tensor* result = cognitive_attention_matrix(ctx, kernel->tensor_field, 0.5f);
+    CHECK(result != NULL);
+    CHECK(((float*)result->data)[0] == 0.5f);
+    // Kernel field and result only: the weighting is never materialized
+    size_t used = ggml_context_used(ctx);
+    CHECK(used >= 2 * 32 * 16 * sizeof(float));
+    CHECK(used <= 2 * (32 * 16 * sizeof(float) + ggml_tensor_overhead()));
+    
+    // Budget exhaustion returns NULL instead of touching memory past the arena
+    struct ggml_context* small = ggml_context_create(256);
+    CHECK(create_cognitive_kernel(small, shape, 2, 0.5f) == NULL);
+    ggml_context_free(small);
+    
+    destroy_cognitive_kernel(kernel);
+    ggml_context_reset(ctx);
+    CHECK(ggml_context_used(ctx) == 0);
+    
+    ggml_context_free(ctx);
+    printf("PASS: Context arena allocation\n");
+    return 1;
+}
+
+static void* pool_worker(void* arg) {
+    int* failures = arg;
+    for (int round = 0; round < 2000; round++) {
+        // Mix of sizes spanning several size classes and the heap fallback
+        int rows = 1 + (round % 7) * 13;
+        struct ggml_tensor* a = ggml_new_tensor_2d(NULL, 0, rows, 16);
+        struct ggml_tensor* b = ggml_new_tensor_2d(NULL, 0, rows * 40, 32);
+        if (!a || !b || ((float*)a->data)[rows * 16 - 1] != 0.0f) {
+            (*failures)++;
+        } else {
+            ((float*)a->data)[0] = (float)round;
+        }
+        ggml_free_tensor(a);
+        ggml_free_tensor(b);
+    }
+    return NULL;
+}
+
+int test_tensor_pool() {
+    printf("Testing tensor pool recycling...\n");
+    
+    // A released block is handed straight back to the same thread
+    struct ggml_tensor* first = ggml_new_tensor_2d(NULL, 0, 8, 8);
+    CHECK(first != NULL);
+    CHECK(first->flags & GGML_TENSOR_FLAG_POOL);
+    CHECK(((uintptr_t)first->data % GGML_MEM_ALIGN) == 0);
+    ggml_free_tensor(first);
+    struct ggml_tensor* second = ggml_new_tensor_2d(NULL, 0, 8, 8);
+    CHECK(second == first);
+    ggml_free_tensor(second);
+    
+    // Far more live-then-freed tensors than the old fixed 1024-block pool
+    for (int i = 0; i < 5000; i++) {
+        struct ggml_tensor* t = ggml_new_tensor_2d(NULL, 0, 16, 16);
+        CHECK(t != NULL && (t->flags & GGML_TENSOR_FLAG_POOL));
+        ggml_free_tensor(t);
+    }
+    
+    // Oversized tensors bypass the pool
+    struct ggml_tensor* large = ggml_new_tensor_2d(NULL, 0, 512, 512);
+    CHECK(large != NULL && !(large->flags & GGML_TENSOR_FLAG_POOL));
+    ggml_free_tensor(large);
+    
+    pthread_t threads[4];
+    int failures[4] = {0};
+    for (int i = 0; i < 4; i++) {
+        pthread_create(&threads[i], NULL, pool_worker, &failures[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        if (failures[i]) {
+            printf("FAIL: Pool worker %d saw %d bad allocations\n", i, failures[i]);
+            return 0;
+        }
+    }
+    
+    printf("PASS: Tensor pool recycling\n");
+    return 1;
+}
+
+int test_tensor_views() {
+    printf("Testing N-D tensors and views...\n");
+    
+    struct ggml_context* ctx = ggml_context_create(1024 * 1024);
+    CHECK(ctx != NULL);
+    
+    // Dense strides: ne[1] innermost, then ne[0], ne[2]
+    struct ggml_tensor* batch = ggml_new_tensor_3d(ctx, GGML_TYPE_F32, 6, 8, 3);
+    CHECK(batch != NULL);
+    CHECK(ggml_nelements(batch) == 6 * 8 * 3);
+    CHECK(ggml_get_nb(batch, 1) == sizeof(float));
+    CHECK(ggml_get_nb(batch, 0) == 8 * sizeof(float));
+    CHECK(ggml_get_nb(batch, 2) == 6 * 8 * sizeof(float));
+    CHECK(ggml_is_contiguous(batch));
+    
+    float* data = ggml_get_data_f32(batch);
+    for (int i = 0; i < 6 * 8 * 3; i++) {
+        data[i] = (float)i;
+    }
+    
+    // 3x4 sub-block of plane 1 starting at row 2, column 3, shares the buffer
+    size_t offset = 1 * ggml_get_nb(batch, 2) + 2 * ggml_get_nb(batch, 0) + 3 * sizeof(float);
+    struct ggml_tensor* block = ggml_view_2d(ctx, batch, 3, 4, ggml_get_nb(batch, 0), offset);
+    CHECK(block != NULL);
+    CHECK(!ggml_is_contiguous(block));
+    CHECK(ggml_get_data_f32(block) == data + 48 + 16 + 3);
+    CHECK(ggml_view_2d(ctx, batch, 3, 4, ggml_get_nb(batch, 0), 1 << 20) == NULL);
+    
+    // Ops read strided views and write dense results
+    struct ggml_tensor* meta = meta_cognitive_transform(ctx, block, 0);
+    CHECK(meta != NULL && ggml_is_contiguous(meta));
+    float* meta_data = ggml_get_data_f32(meta);
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 4; c++) {
+            CHECK(meta_data[r * 4 + c] == data[48 + (2 + r) * 8 + 3 + c]);
+        }
+    }
+    
+    // Batched op over the third dimension matches the per-plane result
+    struct ggml_tensor* scaled = cognitive_attention_matrix(ctx, batch, 1.0f);
+    CHECK(scaled != NULL && ggml_get_ne(scaled, 2) == 3);
+    for (int p = 0; p < 3; p++) {
+        struct ggml_tensor* plane_view = ggml_view_3d(ctx, batch, 6, 8, 1,
+            ggml_get_nb(batch, 0), ggml_get_nb(batch, 2), p * ggml_get_nb(batch, 2));
+        struct ggml_tensor* single = cognitive_attention_matrix(ctx, plane_view, 1.0f);
+        CHECK(single != NULL);
+        CHECK(memcmp(ggml_get_data_f32(single), ggml_get_data_f32(scaled) + p * 6 * 8,
+                     6 * 8 * sizeof(float)) == 0);
+    }
+    
+    // The first plane viewed as a 3D tensor of depth 1 is contiguous
+    struct ggml_tensor* plane = ggml_view_3d(ctx, batch, 6, 8, 1,
+        ggml_get_nb(batch, 0), ggml_get_nb(batch, 2), 0);
+    CHECK(plane != NULL && ggml_is_contiguous(plane));
+    
+    // Heap views only borrow data
+    struct ggml_tensor* heap = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 4, 4);
+    struct ggml_tensor* row = ggml_view_2d(NULL, heap, 1, 4, ggml_get_nb(heap, 0), ggml_get_nb(heap, 0));
+    CHECK(row != NULL && ggml_get_data_f32(row) == ggml_get_data_f32(heap) + 4);
+    ggml_free_tensor(row);
+    ggml_free_tensor(heap);
+    
+    ggml_context_free(ctx);
+    printf("PASS: N-D tensors and views\n");
+    return 1;
+}
+
+int test_simd_dispatch() {
+    printf("Testing SIMD kernel dispatch...\n");
+    
+    const char* original = agent_zero_simd_backend();
+    const char* backends[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+    CHECK(agent_zero_set_simd_backend("no-such-isa") == -1);
+    
+    enum { N = 1003 };  // odd length exercises the vector remainder
+    struct ggml_tensor* nodes = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 17, 59);
+    struct ggml_tensor* links = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 17, 59);
+    CHECK(ggml_nelements(nodes) == N);
+    float* nd = ggml_get_data_f32(nodes);
+    float* ld = ggml_get_data_f32(links);
+    for (int i = 0; i < N; i++) {
+        nd[i] = (float)(i % 97) * 0.13f - 6.0f;
+        ld[i] = (float)(i % 13) * 0.05f;
+    }
+    
+    int tested = 0;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (agent_zero_set_simd_backend(backends[b]) != 0) continue;
+        CHECK(strcmp(agent_zero_simd_backend(), backends[b]) == 0);
+        tested++;
+        
+        struct ggml_tensor* enc = hypergraph_encoding(NULL, nodes, links);
+        struct ggml_tensor* att = cognitive_attention_matrix(NULL, nodes, 0.7f);
+        struct ggml_tensor* meta = meta_cognitive_transform(NULL, nodes, 3);
+        CHECK(enc && att && meta);
+        
+        float* e = ggml_get_data_f32(enc);
+        float* a = ggml_get_data_f32(att);
+        float* m = ggml_get_data_f32(meta);
+        for (int i = 0; i < N; i++) {
+            float ref_e = tanhf((nd[i] + ld[i]) * 0.5f);
+            float ref_a = nd[i] * 0.7f * (1.0f + 0.1f * sinf(i * 0.1f));
+            float ref_m = nd[i] * 1.6f * (1.0f + 0.1f * sinf(i * 3 * 0.01f));
+            if (fabsf(e[i] - ref_e) > 1e-5f || fabsf(a[i] - ref_a) > 1e-4f ||
+                fabsf(m[i] - ref_m) > 1e-4f) {
+                printf("FAIL: %s kernel mismatch at %d\n", backends[b], i);
+                return 0;
+            }
+        }
+        
+        ggml_free_tensor(enc);
+        ggml_free_tensor(att);
+        ggml_free_tensor(meta);
+    }
+    CHECK(tested >= 1);
+    
+    ggml_free_tensor(nodes);
+    ggml_free_tensor(links);
+    agent_zero_set_simd_backend(original);
+    printf("PASS: SIMD kernel dispatch (%d backends, default %s)\n", tested, original);
+    return 1;
+}
+
+int test_fused_attention() {
+    printf("Testing fused attention matrix...\n");
+    
+    // Long enough to span several modulation blocks
+    struct ggml_tensor* input = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 50, 97);
+    float* in = ggml_get_data_f32(input);
+    int n = 50 * 97;
+    for (int i = 0; i < n; i++) {
+        in[i] = 0.25f + (float)(i % 11) * 0.1f;
+    }
+    
+    struct ggml_tensor* out = cognitive_attention_matrix(NULL, input, 0.6f);
+    CHECK(out != NULL);
+    float* o = ggml_get_data_f32(out);
+    for (int i = 0; i < n; i++) {
+        float ref = in[i] * 0.6f * (1.0f + 0.1f * sinf(i * 0.1f));
+        CHECK(fabsf(o[i] - ref) < 1e-4f);
+    }
+    
+    // In place over the input gives the same result without allocating
+    CHECK(cognitive_attention_matrix_into(input, input, 0.6f) == 0);
+    for (int i = 0; i < n; i++) {
+        CHECK(in[i] == o[i]);
+    }
+    
+    // Strided view into a dense output
+    struct ggml_tensor* view = ggml_view_2d(NULL, out, 3, 5, ggml_get_nb(out, 0), 7 * sizeof(float));
+    struct ggml_tensor* small = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 3, 5);
+    CHECK(cognitive_attention_matrix_into(small, view, 1.0f) == 0);
+    CHECK(cognitive_attention_matrix_into(small, input, 1.0f) == -1);
+    
+    ggml_free_tensor(small);
+    ggml_free_tensor(view);
+    ggml_free_tensor(out);
+    ggml_free_tensor(input);
+    printf("PASS: Fused attention matrix\n");
+    return 1;
+}
+
+static float naive_match(const float* data, int rows, int cols,
+                         const float* pattern, int prows, int pcols, int i, int j) {
+    float sum = 0.0f;
+    for (int pi = 0; pi < prows && i + pi < rows; pi++) {
+        for (int pj = 0; pj < pcols && j + pj < cols; pj++) {
+            sum += pattern[pi * pcols + pj] * data[(i + pi) * cols + j + pj];
+        }
+    }
+    return sum;
+}
+
+int test_pattern_match_engine() {
+    printf("Testing pattern match engine...\n");
+    
+    // Non-square data; pattern sizes chosen to land on each AUTO backend
+    const int rows = 37, cols = 53, count = 5;
+    const int sizes[][2] = { {3, 4}, {11, 9}, {21, 25}, {40, 60} };
+    const cognitive_match_backend_t backends[] = {
+        COGNITIVE_MATCH_AUTO, COGNITIVE_MATCH_DIRECT, COGNITIVE_MATCH_GEMM, COGNITIVE_MATCH_FFT
+    };
+    
+    struct ggml_tensor* data = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+    float* d = ggml_get_data_f32(data);
+    for (int i = 0; i < rows * cols; i++) {
+        d[i] = (float)((i * 37) % 101) / 101.0f - 0.5f;
+    }
+    
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int prows = sizes[s][0], pcols = sizes[s][1];
+        struct ggml_tensor* patterns = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, prows, pcols, count);
+        float* p = ggml_get_data_f32(patterns);
+        for (int i = 0; i < prows * pcols * count; i++) {
+            p[i] = (float)((i * 13) % 29) / 29.0f - 0.4f;
+        }
+        
+        for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+            struct ggml_tensor* result = cognitive_pattern_match_batch(NULL, patterns, data, backends[b]);
+            CHECK(result != NULL);
+            CHECK(ggml_get_ne(result, 0) == rows && ggml_get_ne(result, 1) == cols &&
+                  ggml_get_ne(result, 2) == count);
+            float* r = ggml_get_data_f32(result);
+            for (int k = 0; k < count; k++) {
+                const float* pk = p + k * prows * pcols;
+                for (int i = 0; i < rows; i++) {
+                    for (int j = 0; j < cols; j++) {
+                        float ref = naive_match(d, rows, cols, pk, prows, pcols, i, j);
+                        float got = r[(k * rows + i) * cols + j];
+                        if (fabsf(got - ref) > 1e-3f * (1.0f + fabsf(ref))) {
+                            printf("FAIL: backend %d, pattern %dx%d[%d] at (%d,%d): %f vs %f\n",
+                                   (int)backends[b], prows, pcols, k, i, j, got, ref);
+                            return 0;
+                        }
+                    }
+                }
+            }
+            ggml_free_tensor(result);
+        }
+        
+        // Single-pattern entry point agrees with plane 0 of the batch
+        struct ggml_tensor* first = ggml_view_2d(NULL, patterns, prows, pcols,
+                                                 ggml_get_nb(patterns, 0), 0);
+        struct ggml_tensor* single = cognitive_pattern_match(NULL, first, data);
+        CHECK(single != NULL);
+        float* r = ggml_get_data_f32(single);
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                float ref = naive_match(d, rows, cols, p, prows, pcols, i, j);
+                CHECK(fabsf(r[i * cols + j] - ref) <= 1e-3f * (1.0f + fabsf(ref)));
+            }
+        }
+        ggml_free_tensor(single);
+        ggml_free_tensor(first);
+        ggml_free_tensor(patterns);
+    }
+    
+    ggml_free_tensor(data);
+    printf("PASS: Pattern match engine\n");
+    return 1;
+}
+
+// Every threaded op, computed into fresh tensors
+enum { POOL_OPS = 8 };
+static void run_pool_ops(struct ggml_tensor* const* in, AtomSpace* as,
+                         struct ggml_tensor* out[POOL_OPS]) {
+    out[0] = cognitive_attention_matrix(NULL, in[0], 0.7f);
+    out[1] = cognitive_attention_matrix(NULL, in[1], 0.7f);  // strided view
+    out[2] = meta_cognitive_transform(NULL, in[0], 3);
+    out[3] = hypergraph_encoding(NULL, in[0], in[2]);
+    out[4] = cognitive_pattern_match_batch(NULL, in[3], in[5], COGNITIVE_MATCH_DIRECT);
+    out[5] = cognitive_pattern_match_batch(NULL, in[4], in[5], COGNITIVE_MATCH_GEMM);
+    out[6] = cognitive_pattern_match_batch(NULL, in[4], in[5], COGNITIVE_MATCH_FFT);
+    out[7] = create_attention_tensor(NULL, as, 0.8f);
+}
+
+int test_thread_pool() {
+    printf("Testing work-stealing thread pool...\n");
+    
+    CHECK(agent_zero_set_num_threads(-1) == -1);
+    CHECK(agent_zero_set_num_threads(3) == 0);
+    CHECK(agent_zero_get_num_threads() == 3);
+    agent_zero_set_grain_size(0);
+    CHECK(agent_zero_get_grain_size() > 0);
+    
+    struct ggml_tensor* in[6];
+    in[0] = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 300, 257, 3);
+    struct ggml_tensor* parent = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 700, 300);
+    in[1] = ggml_view_2d(NULL, parent, 350, 257, 2 * parent->nb[0], 7 * sizeof(float));
+    in[2] = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 300, 257, 3);
+    in[3] = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 2, 3, 5);
+    in[4] = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 9, 11, 7);
+    in[5] = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 150, 140);
+    struct ggml_tensor* filled[] = { in[0], parent, in[2], in[3], in[4], in[5] };
+    for (int t = 0; t < 6; t++) {
+        float* d = ggml_get_data_f32(filled[t]);
+        for (int64_t i = 0; i < ggml_nelements(filled[t]); i++) {
+            d[i] = (float)((i * 37 + t * 11) % 101) / 50.0f - 1.0f;
+        }
+    }
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 500; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, (i % 67) / 67.0, 0.9);
+    }
+    
+    // Serial reference, then small grains so every op splits into many
+    // chunks that the workers steal from each other
+    struct ggml_tensor* serial[POOL_OPS];
+    struct ggml_tensor* threaded[POOL_OPS];
+    CHECK(agent_zero_set_num_threads(1) == 0);
+    run_pool_ops(in, as, serial);
+    CHECK(agent_zero_set_num_threads(4) == 0);
+    agent_zero_set_grain_size(3000);
+    for (int round = 0; round < 3; round++) {
+        run_pool_ops(in, as, threaded);
+        for (int op = 0; op < POOL_OPS; op++) {
+            CHECK(serial[op] && threaded[op]);
+            CHECK(ggml_same_shape(serial[op], threaded[op]));
+            CHECK(memcmp(serial[op]->data, threaded[op]->data,
+                         (size_t)ggml_nelements(serial[op]) * sizeof(float)) == 0);
+            ggml_free_tensor(threaded[op]);
+        }
+    }
+    
+    for (int op = 0; op < POOL_OPS; op++) {
+        ggml_free_tensor(serial[op]);
+    }
+    for (int t = 0; t < 6; t++) {
+        ggml_free_tensor(in[t]);
+    }
+    ggml_free_tensor(parent);
+    destroy_atomspace(as);
+    agent_zero_set_grain_size(0);
+    agent_zero_set_num_threads(0);
+    printf("PASS: Work-stealing thread pool\n");
+    return 1;
+}
+
+int test_cognitive_graph() {
+    printf("Testing fused cognitive graph...\n");
+    
+    struct ggml_tensor* nodes = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 70, 333, 2);
+    struct ggml_tensor* links = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, 70, 333, 2);
+    int64_t n = ggml_nelements(nodes);
+    for (int64_t i = 0; i < n; i++) {
+        ggml_get_data_f32(nodes)[i] = (float)(i % 53) / 26.0f - 1.0f;
+        ggml_get_data_f32(links)[i] = (float)(i % 31) / 31.0f;
+    }
+    
+    // hypergraph_encoding -> attention -> meta transform, one output
+    cognitive_graph_t* graph = create_cognitive_graph();
+    int x = cognitive_graph_input(graph, nodes);
+    int y = cognitive_graph_input(graph, links);
+    int encoded = cognitive_graph_hypergraph_encoding(graph, x, y);
+    int attended = cognitive_graph_attention(graph, encoded, 0.6f);
+    int meta = cognitive_graph_meta_transform(graph, attended, 2);
+    CHECK(x == 0 && y == 1 && meta == 4);
+    CHECK(cognitive_graph_attention(graph, 9, 0.5f) == -1);
+    struct ggml_tensor* small = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 4, 4);
+    CHECK(cognitive_graph_input(graph, small) == -1);
+    CHECK(cognitive_graph_set_output(graph, meta, small) == -1);
+    
+    struct ggml_tensor* fused = cognitive_graph_new_output(NULL, graph, meta);
+    CHECK(fused && cognitive_graph_compute(graph) == 0);
+    
+    struct ggml_tensor* e1 = hypergraph_encoding(NULL, nodes, links);
+    struct ggml_tensor* e2 = cognitive_attention_matrix(NULL, e1, 0.6f);
+    struct ggml_tensor* e3 = meta_cognitive_transform(NULL, e2, 2);
+    CHECK(memcmp(fused->data, e3->data, (size_t)n * sizeof(float)) == 0);
+    
+    // A second output on an intermediate node; recompute after the inputs change
+    struct ggml_tensor* mid = cognitive_graph_new_output(NULL, graph, attended);
+    ggml_get_data_f32(nodes)[5] = 0.25f;
+    CHECK(cognitive_graph_compute(graph) == 0);
+    ggml_free_tensor(e1);
+    ggml_free_tensor(e2);
+    ggml_free_tensor(e3);
+    e1 = hypergraph_encoding(NULL, nodes, links);
+    e2 = cognitive_attention_matrix(NULL, e1, 0.6f);
+    e3 = meta_cognitive_transform(NULL, e2, 2);
+    CHECK(memcmp(mid->data, e2->data, (size_t)n * sizeof(float)) == 0);
+    CHECK(memcmp(fused->data, e3->data, (size_t)n * sizeof(float)) == 0);
+    
+    // Strided input, evaluated row by row
+    struct ggml_tensor* parent = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 140, 400);
+    for (int64_t i = 0; i < ggml_nelements(parent); i++) {
+        ggml_get_data_f32(parent)[i] = (float)(i % 17) / 17.0f;
+    }
+    struct ggml_tensor* view = ggml_view_2d(NULL, parent, 70, 333, 2 * parent->nb[0], 0);
+    cognitive_graph_reset(graph);
+    int v = cognitive_graph_input(graph, view);
+    int chain = cognitive_graph_meta_transform(graph, cognitive_graph_attention(graph, v, 0.9f), 1);
+    struct ggml_tensor* strided = cognitive_graph_new_output(NULL, graph, chain);
+    CHECK(cognitive_graph_compute(graph) == 0);
+    struct ggml_tensor* s1 = cognitive_attention_matrix(NULL, view, 0.9f);
+    struct ggml_tensor* s2 = meta_cognitive_transform(NULL, s1, 1);
+    for (int64_t i = 0; i < ggml_nelements(s2); i++) {
+        CHECK(fabsf(ggml_get_data_f32(strided)[i] - ggml_get_data_f32(s2)[i]) < 1e-5f);
+    }
+    
+    struct ggml_tensor* owned[] = { nodes, links, small, fused, mid, e1, e2, e3,
+                                    view, parent, strided, s1, s2 };
+    for (size_t i = 0; i < sizeof(owned) / sizeof(owned[0]); i++) {
+        ggml_free_tensor(owned[i]);
+    }
+    destroy_cognitive_graph(graph);
+    printf("PASS: Fused cognitive graph\n");
+    return 1;
+}
+
+int test_packed_attention() {
+    printf("Testing packed attention and matvec...\n");
+    
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 1500; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, ((i * 7919) % 1000) / 1000.0, 0.8);
+    }
+    size_t n = attention_tensor_size(as);
+    CHECK(n == 1500);
+    
+    // Dense matrix against the defining formula
+    struct ggml_tensor* dense = create_attention_tensor(NULL, as, 0.6f);
+    const float* act = atomspace_activations(as);
+    const float* d = ggml_get_data_f32(dense);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            float expected = i == j ? 0.6f : (1.0f - fabsf(act[i] - act[j])) * 0.6f * 0.5f;
+            CHECK(d[i * n + j] == expected);
+        }
+    }
+    
+    // Packed triangle: half the storage, same entries
+    packed_attention_t* packed = create_packed_attention(as, 0.6f);
+    CHECK(packed && packed->n == n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            CHECK(packed_attention_get(packed, i, j) == d[i * n + j]);
+        }
+    }
+    
+    // Matrix-free product against the dense one
+    float* x = malloc(n * sizeof(float));
+    float* y = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (float)((i * 31) % 17) / 17.0f - 0.4f;
+    }
+    CHECK(attention_matvec(as, 0.6f, x, y) == 0);
+    for (size_t i = 0; i < n; i++) {
+        double ref = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            ref += (double)d[i * n + j] * x[j];
+        }
+        CHECK(fabs(ref - y[i]) < 1e-3);
+    }
+    
+    // Empty AtomSpace: 64 x 64 weight * identity
+    AtomSpace* empty = create_atomspace();
+    CHECK(attention_tensor_size(empty) == 64);
+    packed_attention_t* identity = create_packed_attention(empty, 0.5f);
+    CHECK(packed_attention_get(identity, 3, 3) == 0.5f && packed_attention_get(identity, 3, 9) == 0.0f);
+    CHECK(attention_matvec(empty, 0.5f, x, y) == 0 && y[10] == 0.5f * x[10]);
+    
+    free(x);
+    free(y);
+    destroy_packed_attention(identity);
+    destroy_packed_attention(packed);
+    ggml_free_tensor(dense);
+    destroy_atomspace(empty);
+    destroy_atomspace(as);
+    printf("PASS: Packed attention and matvec\n");
+    return 1;
+}
+
+static int same_data(const struct ggml_tensor* a, const struct ggml_tensor* b) {
+    return a->type == b->type && ggml_same_shape(a, b) &&
+           memcmp(a->data, b->data, ggml_row_size(a->type, a->ne[1]) * (size_t)ggml_nrows(a)) == 0;
+}
+
+int test_tensor_types() {
+    printf("Testing f16/bf16/q8_0 tensor types...\n");
+    
+    // Scalar conversions, including rounding and the special values
+    float edge[] = { 1.0f, -2.5f, 65504.0f, 70000.0f, 5.9604645e-8f, 1e-9f, 0.1f, NAN };
+    uint16_t half[8];
+    float back[8];
+    ggml_fp32_to_fp16_row(edge, half, 8);
+    ggml_fp16_to_fp32_row(half, back, 8);
+    CHECK(half[0] == 0x3c00 && half[1] == 0xc100 && half[2] == 0x7bff && half[3] == 0x7c00);
+    CHECK(half[4] == 0x0001 && half[5] == 0x0000 && half[6] == 0x2e66 && isnan(back[7]));
+    CHECK(back[4] == 5.9604645e-8f && isinf(back[3]));
+    ggml_fp32_to_bf16_row(edge, half, 8);
+    ggml_bf16_to_fp32_row(half, back, 8);
+    CHECK(half[0] == 0x3f80 && back[1] == -2.5f && half[6] == 0x3dcd && isnan(back[7]));
+    
+    // Storage sizes and block constraints
+    CHECK(ggml_type_size(GGML_TYPE_F16) == 2 && ggml_blck_size(GGML_TYPE_Q8_0) == QK8_0);
+    CHECK(ggml_row_size(GGML_TYPE_Q8_0, 64) == 68 && ggml_type_size(77) == 0);
+    CHECK(strcmp(ggml_type_name(GGML_TYPE_BF16), "bf16") == 0);
+    CHECK(ggml_new_tensor_2d(NULL, GGML_TYPE_Q8_0, 4, 33) == NULL);
+    CHECK(ggml_new_tensor_2d(NULL, 77, 4, 4) == NULL);
+    
+    int rows = 40, cols = 2048 + 64;
+    struct ggml_tensor* field = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+    float* f = ggml_get_data_f32(field);
+    for (int i = 0; i < rows * cols; i++) {
+        f[i] = (float)((i * 7717) % 1000) / 1000.0f;
+    }
+    
+    const int types[] = { GGML_TYPE_F16, GGML_TYPE_BF16, GGML_TYPE_Q8_0 };
+    const float tolerance[] = { 1e-3f, 4e-3f, 8e-3f };
+    for (int t = 0; t < 3; t++) {
+        struct ggml_tensor* typed = ggml_cast(NULL, field, types[t]);
+        CHECK(typed && typed->type == types[t] && ggml_get_data_f32(typed) == NULL);
+        CHECK(typed->nb[0] == ggml_row_size(types[t], cols) && ggml_is_contiguous(typed));
+        struct ggml_tensor* restored = ggml_cast(NULL, typed, GGML_TYPE_F32);
+        for (int i = 0; i < rows * cols; i++) {
+            CHECK(fabsf(ggml_get_data_f32(restored)[i] - f[i]) <= tolerance[t]);
+        }
+        
+        // Ops read typed data in place and store their result in its type,
+        // matching the f32 op on the decoded values
+        struct ggml_tensor* out = cognitive_attention_matrix(NULL, typed, 0.7f);
+        struct ggml_tensor* ref32 = cognitive_attention_matrix(NULL, restored, 0.7f);
+        struct ggml_tensor* ref = ggml_cast(NULL, ref32, types[t]);
+        CHECK(out->type == types[t] && same_data(out, ref));
+        struct ggml_tensor* enc = hypergraph_encoding(NULL, typed, field);
+        struct ggml_tensor* enc32 = hypergraph_encoding(NULL, restored, field);
+        struct ggml_tensor* enc_ref = ggml_cast(NULL, enc32, types[t]);
+        CHECK(same_data(enc, enc_ref));
+        
+        struct ggml_tensor* owned[] = { typed, restored, out, ref32, ref, enc, enc32, enc_ref };
+        for (size_t i = 0; i < sizeof(owned) / sizeof(owned[0]); i++) {
+            ggml_free_tensor(owned[i]);
+        }
+    }
+    
+    // Typed attention matrices and kernel fields through the bridge
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 96; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, (i % 13) / 13.0, 0.8);
+    }
+    struct ggml_tensor* dense = create_attention_tensor(NULL, as, 0.8f);
+    for (int t = 0; t < 3; t++) {
+        struct ggml_tensor* typed = create_attention_tensor_typed(NULL, as, 0.8f, types[t]);
+        struct ggml_tensor* ref = ggml_cast(NULL, dense, types[t]);
+        CHECK(typed && same_data(typed, ref));
+        ggml_free_tensor(typed);
+        ggml_free_tensor(ref);
+    }
+    
+    int shape[] = { 8, 64 };
+    cognitive_kernel_t* kernel = create_cognitive_kernel_typed(NULL, shape, 2, 0.5f, GGML_TYPE_F16);
+    CHECK(kernel && kernel->tensor_field->type == GGML_TYPE_F16);
+    struct ggml_tensor* encoded32 = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 8, 64);
+    CHECK(encode_cognitive_state(as, kernel, encoded32) == 0);
+    CHECK(encode_cognitive_state(as, kernel, kernel->tensor_field) == 0);
+    struct ggml_tensor* expected = ggml_cast(NULL, encoded32, GGML_TYPE_F16);
+    CHECK(same_data(kernel->tensor_field, expected));
+    
+    AtomSpace* from_typed = create_atomspace();
+    AtomSpace* from_f32 = create_atomspace();
+    struct ggml_tensor* decoded32 = ggml_cast(NULL, kernel->tensor_field, GGML_TYPE_F32);
+    CHECK(decode_cognitive_state(kernel->tensor_field, kernel, from_typed) == 0);
+    CHECK(decode_cognitive_state(decoded32, kernel, from_f32) == 0);
+    CHECK(atomspace_size(from_typed) == atomspace_size(from_f32) && atomspace_size(from_f32) > 0);
+    
+    ggml_free_tensor(decoded32);
+    ggml_free_tensor(expected);
+    ggml_free_tensor(encoded32);
+    ggml_free_tensor(dense);
+    ggml_free_tensor(field);
+    destroy_cognitive_kernel(kernel);
+    destroy_atomspace(from_typed);
+    destroy_atomspace(from_f32);
+    destroy_atomspace(as);
+    printf("PASS: f16/bf16/q8_0 tensor types\n");
+    return 1;
+}
+
+// Snapshot file layout as far as the crafted-file tests need it: the
+// header's section table offset and count, and per 64-byte section its
+// kind, shape, size and count
+#define SNAPSHOT_TEST_LINK_WEIGHTS 2
+#define SNAPSHOT_TEST_EDGE_OFFSETS 3
+#define SNAPSHOT_TEST_KERNEL 7
+
+// Rewrites size and count ({ kind, size, count } rows) of every section of
+// a kind, and the shape of kernels when ne is given
+static int patch_snapshot_sections(const char* path, uint64_t (*patches)[3], int n_patches,
+                                   const int32_t* ne) {
+    FILE* f = fopen(path, "r+b");
+    if (!f) return -1;
+    uint64_t table = 0;
+    uint32_t count = 0;
+    int status = fseek(f, 24, SEEK_SET) != 0 || fread(&table, 8, 1, f) != 1 || fread(&count, 4, 1, f) != 1;
+    for (uint32_t i = 0; !status && i < count; i++) {
+        long section = (long)(table + 64 * i);
+        uint32_t kind;
+        status = fseek(f, section, SEEK_SET) != 0 || fread(&kind, 4, 1, f) != 1;
+        for (int p = 0; !status && p < n_patches; p++) {
+            if (patches[p][0] != kind) continue;
+            status = fseek(f, section + 32, SEEK_SET) != 0 || fwrite(&patches[p][1], 8, 2, f) != 2;
+            if (!status && ne && kind == SNAPSHOT_TEST_KERNEL) {
+                status = fseek(f, section + 8, SEEK_SET) != 0 || fwrite(ne, 4, GGML_MAX_DIMS, f) != GGML_MAX_DIMS;
+            }
+        }
+    }
+    return fclose(f) != 0 || status ? -1 : 0;
+}
+
+int test_snapshot() {
+    printf("Testing binary snapshots...\n");
+    
+    hypergraph_t* hg = create_hypergraph(50, 8);
+    for (size_t i = 0; i < hg->node_count; i++) {
+        hg->node_weights[i] = (float)i / 50.0f;
+    }
+    for (uint32_t e = 0; e < 30; e++) {
+        uint32_t members[] = { e, e + 7, (e * 3 + 11) % 50 };
+        CHECK(hypergraph_add_edge(hg, members, members[2] == e || members[2] == e + 7 ? 2 : 3,
+                                  0.1f * (float)(e % 10)) >= 0);
+    }
+    CHECK(hypergraph_finalize(hg) == 0);
+    
+    int shape[] = { 4, 96 };
+    cognitive_kernel_t* kernels[2];
+    kernels[0] = create_cognitive_kernel(NULL, shape, 2, 0.3f);
+    kernels[1] = create_cognitive_kernel_typed(NULL, shape, 2, 0.9f, GGML_TYPE_F16);
+    kernels[1]->meta_level = 2;
+    float field[4 * 96];
+    for (int i = 0; i < 4 * 96; i++) {
+        field[i] = sinf((float)i * 0.05f);
+    }
+    memcpy(kernels[0]->tensor_field->data, field, sizeof(field));
+    ggml_fp32_to_fp16_row(field, kernels[1]->tensor_field->data, 4 * 96);
+    
+    const char* path = "/tmp/agent-zero-test.azsnap";
+    CHECK(cognitive_snapshot_save(path, hg, kernels, 2) == 0);
+    cognitive_snapshot_t* snap = cognitive_snapshot_open(path);
+    CHECK(snap && cognitive_snapshot_kernel_count(snap) == 2);
+    
+    // The view aliases the mapped arrays and matches the source graph
+    const hypergraph_t* view = cognitive_snapshot_hypergraph(snap);
+    CHECK(view && view->node_count == 50 && view->link_count == 30 && view->finalized);
+    CHECK(memcmp(view->node_weights, hg->node_weights, 50 * sizeof(float)) == 0);
+    CHECK(memcmp(view->link_weights, hg->link_weights, 30 * sizeof(float)) == 0);
+    CHECK(memcmp(view->edge_offsets, hg->edge_offsets, 31 * sizeof(size_t)) == 0);
+    CHECK(memcmp(view->edge_nodes, hg->edge_nodes, hg->edge_offsets[30] * sizeof(uint32_t)) == 0);
+    CHECK(memcmp(view->node_edges, hg->node_edges, hg->node_offsets[50] * sizeof(uint32_t)) == 0);
+    CHECK((uintptr_t)view->edge_nodes % GGML_MEM_ALIGN == 0);
+    
+    hypergraph_t* copy = cognitive_snapshot_load_hypergraph(snap);
+    CHECK(copy && copy->link_count == 30 && copy->finalized);
+    CHECK(memcmp(copy->edge_nodes, hg->edge_nodes, hg->edge_offsets[30] * sizeof(uint32_t)) == 0);
+    sparse_tensor_t* from_view = encode_hypergraph_to_sparse(view);
+    sparse_tensor_t* from_source = encode_hypergraph_to_sparse(hg);
+    CHECK(from_view->nnz == from_source->nnz &&
+          memcmp(from_view->values, from_source->values, from_view->nnz * sizeof(float)) == 0);
+    
+    // Kernels come back bit for bit, wrapping the mapping without a copy
+    for (size_t k = 0; k < 2; k++) {
+        cognitive_kernel_t* loaded = cognitive_snapshot_kernel(NULL, snap, k);
+        CHECK(loaded && loaded->attention_weight == kernels[k]->attention_weight);
+        CHECK(loaded->meta_level == kernels[k]->meta_level);
+        CHECK(same_data(loaded->tensor_field, kernels[k]->tensor_field));
+        CHECK(loaded->tensor_field->flags & GGML_TENSOR_FLAG_VIEW);
+        CHECK((uintptr_t)loaded->tensor_field->data % GGML_MEM_ALIGN == 0);
+        destroy_cognitive_kernel(loaded);
+    }
+    CHECK(cognitive_snapshot_kernel(NULL, snap, 2) == NULL);
+    
+    // Copy-on-write: writes through a mapped tensor do not reach the file
+    struct ggml_tensor* mapped = cognitive_snapshot_tensor(NULL, snap, 0);
+    ggml_get_data_f32(mapped)[0] = 42.0f;
+    ggml_free_tensor(mapped);
+    cognitive_snapshot_close(snap);
+    snap = cognitive_snapshot_open(path);
+    mapped = cognitive_snapshot_tensor(NULL, snap, 0);
+    CHECK(ggml_get_data_f32(mapped)[0] == field[0]);
+    ggml_free_tensor(mapped);
+    cognitive_snapshot_close(snap);
+    
+    // Kernels only, no hypergraph
+    CHECK(cognitive_snapshot_save(path, NULL, kernels, 1) == 0);
+    snap = cognitive_snapshot_open(path);
+    CHECK(snap && cognitive_snapshot_hypergraph(snap) == NULL && cognitive_snapshot_kernel_count(snap) == 1);
+    CHECK(cognitive_snapshot_load_hypergraph(snap) == NULL);
+    cognitive_snapshot_close(snap);
+    
+    // Corrupt, truncated and missing files are rejected
+    CHECK(cognitive_snapshot_save(path, hg, kernels, 2) == 0);
+    FILE* f = fopen(path, "r+b");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 8, SEEK_SET);
+    fputc(99, f);  // version
+    fclose(f);
+    CHECK(cognitive_snapshot_open(path) == NULL);
+    CHECK(cognitive_snapshot_save(path, hg, kernels, 2) == 0);
+    CHECK(truncate(path, size - 16) == 0);
+    CHECK(cognitive_snapshot_open(path) == NULL);
+    
+    // Counts whose byte sizes wrap: a link count of 2^62 over empty link
+    // weights and 8 bytes of offsets, and a kernel of 2^64 bytes in an
+    // empty section
+    uint64_t huge = (uint64_t)1 << 62;
+    uint64_t wrapped[][3] = {
+        { SNAPSHOT_TEST_LINK_WEIGHTS, 0, huge },
+        { SNAPSHOT_TEST_EDGE_OFFSETS, 8, huge + 1 },
+    };
+    CHECK(cognitive_snapshot_save(path, hg, kernels, 2) == 0);
+    CHECK(patch_snapshot_sections(path, wrapped, 2, NULL) == 0);
+    CHECK(cognitive_snapshot_open(path) == NULL);
+    int32_t wrapped_shape[GGML_MAX_DIMS] = { 1 << 30, 1, 1 << 30, 4 };
+    uint64_t empty_kernel[][3] = { { SNAPSHOT_TEST_KERNEL, 0, 0 } };
+    CHECK(cognitive_snapshot_save(path, NULL, kernels, 1) == 0);
+    CHECK(patch_snapshot_sections(path, empty_kernel, 1, wrapped_shape) == 0);
+    CHECK(cognitive_snapshot_open(path) == NULL);
+    remove(path);
+    CHECK(cognitive_snapshot_open(path) == NULL);
+    CHECK(cognitive_snapshot_save(NULL, hg, kernels, 2) == -1);
+    
+    destroy_sparse_tensor(from_view);
+    destroy_sparse_tensor(from_source);
+    destroy_hypergraph(copy);
+    destroy_hypergraph(hg);
+    destroy_cognitive_kernel(kernels[0]);
+    destroy_cognitive_kernel(kernels[1]);
+    printf("PASS: Binary snapshots\n");
+    return 1;
+}
+
+int test_streaming_encode() {
+    printf("Testing streaming AtomSpace encode...\n");
+    
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 5000; i++) {
+        atomspace_add_atom(as, i % 3 == 0 ? ATOM_TYPE_LINK : ATOM_TYPE_CONCEPT, NULL,
+                           (double)((i * 37) % 101) / 101.0, 0.9);
+    }
+    
+    // Typed cursors walk the type index in chunks, in index order
+    const uint32_t* links;
+    size_t link_count = atomspace_atoms_by_type(as, ATOM_TYPE_LINK, &links);
+    atomspace_cursor_t cursor;
+    atomspace_cursor_init(&cursor, as, ATOM_TYPE_LINK);
+    uint32_t handles[300];
+    float chunk[777];
+    size_t seen = 0, n;
+    while ((n = atomspace_cursor_next(&cursor, handles, NULL, 300)) > 0) {
+        CHECK(memcmp(handles, links + seen, n * sizeof(uint32_t)) == 0);
+        seen += n;
+    }
+    CHECK(seen == link_count && link_count == 1667);
+    atomspace_cursor_init(&cursor, as, 99);
+    CHECK(atomspace_cursor_next(&cursor, handles, chunk, 300) == 0);
+    
+    // Chunked pushes from a cursor match the one-shot encode bit for bit,
+    // padding included, for every storage type
+    const int types[] = { GGML_TYPE_F32, GGML_TYPE_F16, GGML_TYPE_BF16, GGML_TYPE_Q8_0 };
+    for (int t = 0; t < 4; t++) {
+        struct ggml_tensor* expected = ggml_new_tensor_2d(NULL, types[t], 8, 1024);
+        struct ggml_tensor* streamed = ggml_new_tensor_2d(NULL, types[t], 8, 1024);
+        atomspace_to_tensor(as, expected);
+        
+        atomspace_tensor_stream_t* stream = malloc(sizeof(atomspace_tensor_stream_t));
+        CHECK(atomspace_tensor_stream_init(stream, streamed, 1.0f) == 0);
+        atomspace_cursor_init(&cursor, as, -1);
+        while ((n = atomspace_cursor_next(&cursor, NULL, chunk, 777)) > 0) {
+            CHECK(atomspace_tensor_stream_push(stream, chunk, n) == n);
+        }
+        atomspace_tensor_stream_finish(stream);
+        CHECK(same_data(expected, streamed));
+        
+        free(stream);
+        ggml_free_tensor(expected);
+        ggml_free_tensor(streamed);
+    }
+    
+    // A kernel scale reproduces encode_cognitive_state; pushes stop at the
+    // tensor's end
+    int shape[] = { 4, 1024 };
+    cognitive_kernel_t* kernel = create_cognitive_kernel(NULL, shape, 2, 0.6f);
+    kernel->meta_level = 2;
+    struct ggml_tensor* encoded = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 4, 1024);
+    CHECK(encode_cognitive_state(as, kernel, encoded) == 0);
+    atomspace_tensor_stream_t stream;
+    CHECK(atomspace_tensor_stream_init(&stream, kernel->tensor_field, 0.6f * (1.0f + 2 * 0.1f)) == 0);
+    CHECK(atomspace_tensor_stream_push(&stream, atomspace_activations(as), 5000) == 4096);
+    CHECK(atomspace_tensor_stream_push(&stream, chunk, 10) == 0);
+    atomspace_tensor_stream_finish(&stream);
+    CHECK(same_data(encoded, kernel->tensor_field));
+    
+    struct ggml_tensor* view = ggml_view_2d(NULL, encoded, 4, 512, encoded->nb[0], 0);
+    CHECK(atomspace_tensor_stream_init(&stream, view, 1.0f) == -1);
+    CHECK(atomspace_tensor_stream_init(&stream, NULL, 1.0f) == -1);
+    
+    ggml_free_tensor(view);
+    ggml_free_tensor(encoded);
+    destroy_cognitive_kernel(kernel);
+    destroy_atomspace(as);
+    printf("PASS: Streaming AtomSpace encode\n");
+    return 1;
+}
+
+typedef struct {
+    int spans[AGENT_ZERO_OP_COUNT];
+    int ordered;
+} trace_log_t;
+
+static void count_span(const agent_zero_trace_span_t* span, void* user) {
+    trace_log_t* log = user;
+    log->spans[span->op]++;
+    if (span->end_ns < span->start_ns || strcmp(span->name, agent_zero_op_name(span->op)) != 0) {
+        log->ordered = 0;
+    }
+}
+
+int test_stats_and_trace() {
+    printf("Testing instrumentation counters and trace hooks...\n");
+    
+    CHECK(strcmp(agent_zero_op_name(AGENT_ZERO_OP_ATTENTION), "attention") == 0);
+    CHECK(agent_zero_op_name(AGENT_ZERO_OP_COUNT) == NULL && agent_zero_op_name(-1) == NULL);
+    
+    agent_zero_stats_t stats;
+    if (!agent_zero_stats_enabled()) {
+        // Compiled out: everything but the pool gauges reads zero
+        agent_zero_get_stats(&stats);
+        CHECK(stats.op_calls[AGENT_ZERO_OP_ATTENTION] == 0 && stats.tensor_allocs == 0);
+        printf("PASS: Instrumentation counters (compiled out)\n");
+        return 1;
+    }
+    
+    agent_zero_reset_stats();
+    agent_zero_get_stats(&stats);
+    for (int op = 0; op < AGENT_ZERO_OP_COUNT; op++) {
+        CHECK(stats.op_calls[op] == 0 && stats.op_bytes[op] == 0);
+    }
+    CHECK(stats.tensor_allocs == 0 && stats.pool_hits == 0);
+    
+    // Each op call is one span; bytes cover what it read and wrote
+    struct ggml_tensor* input = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 64);
+    struct ggml_tensor* out = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 64);
+    for (int i = 0; i < 3; i++) {
+        CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    }
+    struct ggml_tensor* meta = meta_cognitive_transform(NULL, input, 2);
+    struct ggml_tensor* half = ggml_cast(NULL, input, GGML_TYPE_F16);
+    agent_zero_get_stats(&stats);
+    CHECK(stats.op_calls[AGENT_ZERO_OP_ATTENTION] == 3);
+    CHECK(stats.op_bytes[AGENT_ZERO_OP_ATTENTION] == 3 * 2 * 16 * 64 * sizeof(float));
+    CHECK(stats.op_calls[AGENT_ZERO_OP_META_TRANSFORM] == 1);
+    CHECK(stats.op_calls[AGENT_ZERO_OP_CAST] == 1);
+    CHECK(stats.op_bytes[AGENT_ZERO_OP_CAST] == 16 * 64 * (sizeof(float) + sizeof(uint16_t)));
+    CHECK(stats.tensor_allocs == 4);
+    CHECK(stats.tensor_bytes == 3 * 16 * 64 * sizeof(float) + 16 * 64 * sizeof(uint16_t));
+    CHECK(stats.pool_hits + stats.pool_misses == 4 && stats.malloc_fallbacks == 0);
+    CHECK(stats.pool_bytes_in_use > 0 && stats.pool_peak_bytes >= stats.pool_bytes_in_use);
+    
+    // A freed block is handed straight back by the thread cache
+    ggml_free_tensor(half);
+    uint64_t hits = stats.pool_hits;
+    half = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, 16, 64);
+    agent_zero_get_stats(&stats);
+    CHECK(stats.pool_hits == hits + 1);
+    
+    // Blocks past the largest size class fall back to malloc; arena
+    // tensors are counted separately
+    struct ggml_tensor* big = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 256, 256);
+    struct ggml_context* ctx = ggml_context_create(64 * 1024);
+    struct ggml_tensor* arena = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 1000);
+    agent_zero_get_stats(&stats);
+    CHECK(big && arena);
+    CHECK(stats.malloc_fallbacks == 1 && stats.arena_allocs == 1);
+    
+    // The hook sees every span until it is removed
+    trace_log_t log = { { 0 }, 1 };
+    agent_zero_set_trace_hook(count_span, &log);
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 100; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, (double)i / 100.0, 0.9);
+    }
+    atomspace_to_tensor(as, out);
+    hypergraph_t* hg = create_hypergraph_from_atomspace(as, 0.05f, 1);
+    sparse_tensor_t* sp = encode_hypergraph_to_sparse(hg);
+    CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    agent_zero_set_trace_hook(NULL, NULL);
+    CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    CHECK(log.ordered);
+    CHECK(log.spans[AGENT_ZERO_OP_ENCODE] == 1);
+    CHECK(log.spans[AGENT_ZERO_OP_SIMILARITY_HYPERGRAPH] == 1);
+    CHECK(log.spans[AGENT_ZERO_OP_HYPERGRAPH_TO_SPARSE] == 1);
+    CHECK(log.spans[AGENT_ZERO_OP_ATTENTION] == 1);
+    agent_zero_get_stats(&stats);
+    CHECK(stats.op_calls[AGENT_ZERO_OP_ATTENTION] == 5);
+    
+    // Reset clears counters but leaves the pool gauges alone
+    agent_zero_reset_stats();
+    agent_zero_get_stats(&stats);
+    CHECK(stats.op_calls[AGENT_ZERO_OP_ATTENTION] == 0 && stats.op_nanoseconds[AGENT_ZERO_OP_ATTENTION] == 0);
+    CHECK(stats.tensor_allocs == 0 && stats.pool_bytes_in_use > 0);
+    
+    destroy_sparse_tensor(sp);
+    destroy_hypergraph(hg);
+    destroy_atomspace(as);
+    ggml_context_free(ctx);
+    ggml_free_tensor(big);
+    ggml_free_tensor(half);
+    ggml_free_tensor(meta);
+    ggml_free_tensor(out);
+    ggml_free_tensor(input);
+    printf("PASS: Instrumentation counters and trace hooks\n");
+    return 1;
+}
+
+int test_threshold_decode() {
+    printf("Testing threshold decode of dense fields...\n");
+    
+    // A mostly symmetric field with negatives, zeros and a NaN; 203 is
+    // odd so every vector remainder path runs
+    enum { N = 203 };
+    struct ggml_tensor* field = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, N, N);
+    float* f = ggml_get_data_f32(field);
+    srand(11);
+    for (int i = 0; i < N; i++) {
+        for (int j = i; j < N; j++) {
+            float v = (float)(rand() % 1000) / 1000.0f - 0.3f;
+            if (rand() % 3 == 0) v = 0.0f;
+            f[i * N + j] = v;
+            f[j * N + i] = rand() % 10 == 0 ? 0.9f - v : v;
+        }
+    }
+    f[5 * N + 7] = NAN;
+    
+    // Reference: edges in row-major order, node weights by definition
+    const float threshold = 0.55f;
+    double node_sum[N] = { 0 }, node_count[N] = { 0 };
+    size_t expected_edges = 0, expected_nnz = 0;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            float v = f[i * N + j];
+            if (v > threshold) {
+                expected_nnz++;
+                expected_edges += j >= i || !(f[j * N + i] > threshold);
+            }
+            if (v > 0.0f) {
+                node_sum[i] += v;
+                node_sum[j] += v;
+                node_count[i] += 1;
+                node_count[j] += 1;
+            }
+        }
+    }
+    
+    const char* original = agent_zero_simd_backend();
+    int original_threads = agent_zero_get_num_threads();
+    const char* backends[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+    float reference[N];
+    int have_reference = 0;
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (agent_zero_set_simd_backend(backends[b]) != 0) continue;
+        for (int threads = 1; threads <= 4; threads += 3) {
+            agent_zero_set_num_threads(threads);
+            hypergraph_t* hg = create_hypergraph(N, 16);
+            for (int v = 0; v < N; v++) {
+                hg->node_weights[v] = 0.25f;
+            }
+            sparse_tensor_t* entries;
+            CHECK(decode_tensor_to_hypergraph_threshold(field, hg, threshold, &entries) == 0);
+            CHECK(hg->link_count == expected_edges);
+            CHECK(entries && entries->nnz == expected_nnz);
+            
+            // Kept entries are exact copies in CSR order
+            for (size_t r = 0; r < entries->rows; r++) {
+                for (size_t k = entries->row_ptr[r]; k < entries->row_ptr[r + 1]; k++) {
+                    CHECK(k == entries->row_ptr[r] || entries->col_idx[k] > entries->col_idx[k - 1]);
+                    CHECK(f[r * N + entries->col_idx[k]] == entries->values[k]);
+                    CHECK(entries->values[k] > threshold);
+                }
+            }
+            
+            // Symmetric pairs yield one edge, stored low node first
+            for (size_t e = 0; e < hg->link_count; e++) {
+                size_t arity = hg->edge_offsets[e + 1] - hg->edge_offsets[e];
+                const uint32_t* nodes = hg->edge_nodes + hg->edge_offsets[e];
+                CHECK(arity == 1 || (arity == 2 && nodes[0] < nodes[1]));
+            }
+            
+            for (int v = 0; v < N; v++) {
+                double expected = (0.25 + node_sum[v]) / (1.0 + node_count[v]);
+                CHECK(fabs(hg->node_weights[v] - expected) < 1e-4);
+            }
+            // Bit-identical at any thread count for a given backend
+            if (threads == 1) {
+                memcpy(reference, hg->node_weights, sizeof(reference));
+                have_reference = 1;
+            } else {
+                CHECK(memcmp(reference, hg->node_weights, sizeof(reference)) == 0);
+            }
+            
+            destroy_sparse_tensor(entries);
+            destroy_hypergraph(hg);
+        }
+    }
+    CHECK(have_reference);
+    agent_zero_set_simd_backend(original);
+    agent_zero_set_num_threads(original_threads);
+    
+    // The plain decode keeps 0.5; rectangular fields compress row by row
+    hypergraph_t* hg = create_hypergraph(N, 16);
+    CHECK(decode_tensor_to_hypergraph(field, hg) == 0);
+    sparse_tensor_t* half = tensor_to_sparse_threshold(field, 0.5f);
+    CHECK(half && half->rows == N && half->cols == N);
+    size_t above = 0;
+    for (int i = 0; i < N * N; i++) {
+        above += f[i] > 0.5f;
+    }
+    CHECK(half->nnz == above && hg->link_count < above);
+    
+    struct ggml_tensor* wide = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, 3, 100);
+    float ones[300];
+    for (int i = 0; i < 300; i++) {
+        ones[i] = i % 7 == 0 ? 1.0f : 0.0f;
+    }
+    ggml_get_type_traits(GGML_TYPE_F16)->from_f32(ones, wide->data, 300);
+    sparse_tensor_t* sp = tensor_to_sparse_threshold(wide, 0.5f);
+    CHECK(sp && sp->rows == 3 && sp->cols == 100 && sp->nnz == 43);
+    CHECK(sp->col_idx[0] == 0 && sp->col_idx[sp->row_ptr[1]] == 5);
+    
+    destroy_sparse_tensor(sp);
+    destroy_sparse_tensor(half);
+    ggml_free_tensor(wide);
+    destroy_hypergraph(hg);
+    ggml_free_tensor(field);
+    printf("PASS: Threshold decode of dense fields\n");
+    return 1;
+}
+
+static void count_release(void* data, void* user) {
+    (void)data;
+    (*(int*)user)++;
+}
+
+int test_zero_copy_buffers() {
+    printf("Testing zero-copy tensor buffers...\n");
+    
+    // Caller-owned input and output run through a kernel in place
+    enum { ROWS = 6, COLS = 10, PITCH = 12 };
+    float* in_buf = malloc(ROWS * COLS * sizeof(float));
+    float out_buf[ROWS * COLS];
+    for (int i = 0; i < ROWS * COLS; i++) {
+        in_buf[i] = 0.1f * (float)(i % 17);
+    }
+    int ne[2] = { ROWS, COLS };
+    int released = 0;
+    struct ggml_tensor* in = ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, NULL,
+                                                         in_buf, count_release, &released);
+    struct ggml_tensor* out = ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, NULL,
+                                                          out_buf, NULL, NULL);
+    CHECK(in && out && ggml_is_contiguous(in));
+    CHECK(ggml_get_data_f32(in) == in_buf);
+    CHECK(cognitive_attention_matrix_into(out, in, 0.7f) == 0);
+    
+    struct ggml_tensor* owned = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, ROWS, COLS);
+    memcpy(ggml_get_data_f32(owned), in_buf, sizeof(out_buf));
+    struct ggml_tensor* expected = cognitive_attention_matrix(NULL, owned, 0.7f);
+    CHECK(memcmp(ggml_get_data_f32(expected), out_buf, sizeof(out_buf)) == 0);
+    
+    // Borrowing hands back the same memory with its element count
+    int64_t n;
+    CHECK(ggml_borrow_f32(out, &n) == out_buf && n == ROWS * COLS);
+    CHECK(ggml_borrow_f32(expected, &n) == ggml_get_data_f32(expected) && n == ROWS * COLS);
+    
+    // Row-pitched buffers wrap as strided tensors and compute like views
+    float pitched[ROWS * PITCH];
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < PITCH; c++) {
+            pitched[r * PITCH + c] = c < COLS ? in_buf[r * COLS + c] : -1.0f;
+        }
+    }
+    size_t nb[2] = { PITCH * sizeof(float), sizeof(float) };
+    struct ggml_tensor* strided = ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, nb,
+                                                              pitched, NULL, NULL);
+    CHECK(strided && !ggml_is_contiguous(strided) && ggml_get_nb(strided, 0) == nb[0]);
+    CHECK(ggml_borrow_f32(strided, &n) == NULL && n == 0);
+    struct ggml_tensor* meta = meta_cognitive_transform(NULL, strided, 2);
+    struct ggml_tensor* meta_ref = meta_cognitive_transform(NULL, owned, 2);
+    CHECK(meta && meta_ref && ggml_is_contiguous(meta));
+    for (int i = 0; i < ROWS * COLS; i++) {
+        CHECK(fabsf(ggml_get_data_f32(meta)[i] - ggml_get_data_f32(meta_ref)[i]) < 1e-5f);
+    }
+    
+    // Release runs once, when the header is freed
+    ggml_free_tensor(in);
+    CHECK(released == 1);
+    free(in_buf);
+    
+    // Invalid layouts and arena-owned releasing headers are refused
+    size_t overlap[2] = { (COLS - 1) * sizeof(float), sizeof(float) };
+    size_t bad_inner[2] = { PITCH * sizeof(float), 2 * sizeof(float) };
+    CHECK(!ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, overlap, pitched, NULL, NULL));
+    CHECK(!ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, bad_inner, pitched, NULL, NULL));
+    CHECK(!ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, NULL,
+                                       (char*)pitched + 1, NULL, NULL));
+    CHECK(!ggml_new_tensor_from_buffer(NULL, GGML_TYPE_F32, 2, ne, NULL, NULL, NULL, NULL));
+    struct ggml_context* ctx = ggml_context_create(4096);
+    CHECK(!ggml_new_tensor_from_buffer(ctx, GGML_TYPE_F32, 2, ne, NULL,
+                                       pitched, count_release, &released));
+    struct ggml_tensor* arena = ggml_new_tensor_from_buffer(ctx, GGML_TYPE_F16, 2, ne, NULL,
+                                                            pitched, NULL, NULL);
+    CHECK(arena && ggml_borrow_f32(arena, NULL) == NULL);
+    ggml_context_free(ctx);
+    CHECK(released == 1);
+    
+    ggml_free_tensor(meta);
+    ggml_free_tensor(meta_ref);
+    ggml_free_tensor(strided);
+    ggml_free_tensor(expected);
+    ggml_free_tensor(owned);
+    ggml_free_tensor(out);
+    printf("PASS: Zero-copy tensor buffers\n");
+    return 1;
+}
+
+int test_attention_diffusion() {
+    printf("Testing attention diffusion...\n");
+    
+    // Random hyperedges of arity 1-5 with repeated pairs; the last node is
+    // isolated and keeps its STI
+    enum { N = 301, EDGES = 400 };
+    hypergraph_t* hg = create_hypergraph(N, EDGES);
+    static double adjacency[N][N];
+    memset(adjacency, 0, sizeof(adjacency));
+    srand(23);
+    for (int e = 0; e < EDGES; e++) {
+        uint32_t nodes[5];
+        size_t arity = 1 + (size_t)(rand() % 5);
+        for (size_t a = 0; a < arity; a++) {
+            int fresh;
+            do {
+                nodes[a] = (uint32_t)(rand() % (N - 1));
+                fresh = 1;
+                for (size_t b = 0; b < a; b++) fresh &= nodes[b] != nodes[a];
+            } while (!fresh);
+        }
+        float weight = 0.1f + (float)(rand() % 100) / 50.0f;
+        CHECK(hypergraph_add_edge(hg, nodes, arity, weight) == e);
+        for (size_t a = 0; a < arity; a++) {
+            for (size_t b = 0; b < arity; b++) {
+                if (a != b) adjacency[nodes[a]][nodes[b]] += weight / (double)(arity - 1);
+            }
+        }
+    }
+    
+    const float spread = 0.2f, threshold = 2.0f;
+    float sti[N], result[N];
+    double degree[N] = { 0 }, total = 0.0;
+    for (int i = 0; i < N; i++) {
+        sti[i] = (float)(rand() % 1100) / 100.0f - 1.0f;
+        total += sti[i];
+        for (int j = 0; j < N; j++) degree[i] += adjacency[i][j];
+    }
+    
+    // Reference step in double precision
+    double expected[N];
+    for (int i = 0; i < N; i++) {
+        double out = degree[i] > 0.0 && sti[i] > threshold ? spread * sti[i] : 0.0;
+        expected[i] = sti[i] - out;
+        for (int j = 0; j < N; j++) {
+            if (adjacency[i][j] > 0.0 && sti[j] > threshold) {
+                expected[i] += spread * sti[j] * adjacency[i][j] / degree[j];
+            }
+        }
+    }
+    
+    const char* original = agent_zero_simd_backend();
+    int original_threads = agent_zero_get_num_threads();
+    const char* backends[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (agent_zero_set_simd_backend(backends[b]) != 0) continue;
+        float reference[N];
+        for (int threads = 1; threads <= 4; threads += 3) {
+            agent_zero_set_num_threads(threads);
+            attention_diffusion_t* d = create_attention_diffusion(hg, spread, threshold);
+            CHECK(d && attention_diffusion_size(d) == N);
+            CHECK(attention_diffusion_compute(d, sti, result) == 0);
+            double sum = 0.0;
+            for (int i = 0; i < N; i++) {
+                CHECK(fabs(result[i] - expected[i]) < 1e-4 * (1.0 + fabs(expected[i])));
+                sum += result[i];
+            }
+            CHECK(fabs(sum - total) < 1e-3 * fabs(total));
+            CHECK(result[N - 1] == sti[N - 1]);
+            
+            // Bit-identical at any thread count for a given backend
+            if (threads == 1) {
+                memcpy(reference, result, sizeof(reference));
+            } else {
+                CHECK(memcmp(reference, result, sizeof(reference)) == 0);
+            }
+            
+            // A few atoms cross the threshold: the incremental step touches
+            // them and their neighbours and matches a full recompute
+            float moved[N];
+            memcpy(moved, sti, sizeof(moved));
+            uint32_t changed[4] = { 3, 150, 3, N - 1 };
+            moved[3] = sti[3] > threshold ? 0.5f : 9.0f;
+            moved[150] += 4.0f;
+            moved[N - 1] = 7.0f;
+            size_t frontier = 0;
+            for (int i = 0; i < N; i++) {
+                frontier += i == 3 || i == 150 || i == N - 1 ||
+                            adjacency[3][i] > 0.0 || adjacency[150][i] > 0.0;
+            }
+            CHECK(attention_diffusion_update(d, moved, changed, 4, result) == (int64_t)frontier);
+            float full[N];
+            attention_diffusion_t* fresh = create_attention_diffusion(hg, spread, threshold);
+            CHECK(attention_diffusion_compute(fresh, moved, full) == 0);
+            CHECK(memcmp(full, result, sizeof(full)) == 0);
+            CHECK(attention_diffusion_update(d, moved, NULL, 0, result) == 0);
+            
+            // In place, and an unprimed update runs a full step
+            memcpy(full, moved, sizeof(full));
+            CHECK(attention_diffusion_compute(fresh, full, full) == 0);
+            CHECK(memcmp(full, result, sizeof(full)) == 0);
+            destroy_attention_diffusion(fresh);
+            fresh = create_attention_diffusion(hg, spread, threshold);
+            CHECK(attention_diffusion_update(fresh, moved, changed, 1, full) == N);
+            CHECK(memcmp(full, result, sizeof(full)) == 0);
+            
+            uint32_t bad = N;
+            CHECK(attention_diffusion_update(d, moved, &bad, 1, result) == -1);
+            CHECK(attention_diffusion_update(d, moved, changed, 1, moved) == -1);
+            CHECK(memcmp(full, result, sizeof(full)) == 0);
+            destroy_attention_diffusion(fresh);
+            destroy_attention_diffusion(d);
+        }
+    }
+    agent_zero_set_simd_backend(original);
+    agent_zero_set_num_threads(original_threads);
+    
+    // A moved threshold takes effect on the next update, which recomputes
+    // every row against it
+    attention_diffusion_t* d = create_attention_diffusion(hg, spread, threshold);
+    attention_diffusion_t* fresh = create_attention_diffusion(hg, spread, 0.0f);
+    float full[N];
+    CHECK(attention_diffusion_compute(d, sti, result) == 0);
+    CHECK(attention_diffusion_set_threshold(d, 0.0f) == 0);
+    CHECK(attention_diffusion_update(d, sti, NULL, 0, result) == N);
+    CHECK(attention_diffusion_compute(fresh, sti, full) == 0);
+    CHECK(memcmp(full, result, sizeof(full)) == 0);
+    CHECK(attention_diffusion_set_threshold(NULL, 0.0f) == -1);
+    destroy_attention_diffusion(fresh);
+    destroy_attention_diffusion(d);
+    
+    CHECK(!create_attention_diffusion(hg, 1.5f, threshold));
+    CHECK(!create_attention_diffusion(NULL, spread, threshold));
+    destroy_hypergraph(hg);
+    
+    // A zero-weight edge leaves atom 2 with no degree: it neither spreads
+    // nor receives, and its column must not turn into 0 / 0
+    hypergraph_t* chain = create_hypergraph(3, 3);
+    uint32_t first[2] = { 0, 1 }, second[2] = { 1, 2 };
+    CHECK(hypergraph_add_edge(chain, first, 2, 1.0f) == 0);
+    CHECK(hypergraph_add_edge(chain, second, 2, 0.0f) == 1);
+    attention_diffusion_t* zero = create_attention_diffusion(chain, 0.5f, 0.0f);
+    float chain_sti[3] = { 5.0f, 1.0f, 2.0f }, chain_result[3];
+    CHECK(zero && attention_diffusion_compute(zero, chain_sti, chain_result) == 0);
+    CHECK(chain_result[0] == 3.0f && chain_result[1] == 3.0f && chain_result[2] == 2.0f);
+    destroy_attention_diffusion(zero);
+    uint32_t third[2] = { 0, 2 };
+    CHECK(hypergraph_add_edge(chain, third, 2, -1.0f) == 2);
+    CHECK(!create_attention_diffusion(chain, 0.5f, 0.0f));
+    destroy_hypergraph(chain);
+    printf("PASS: Attention diffusion\n");
+    return 1;
+}
+
+int test_ann_index() {
+    printf("Testing approximate nearest neighbour index...\n");
+    
+    // Clustered rows: 40 centres with spread-out members; 21 is odd so the
+    // SIMD distance tails run
+    enum { N = 2000, DIM = 21, QUERIES = 50, K = 10 };
+    static float data[N * DIM];
+    float centres[40 * DIM];
+    srand(31);
+    for (int i = 0; i < 40 * DIM; i++) {
+        centres[i] = (float)(rand() % 2000) / 100.0f;
+    }
+    for (int i = 0; i < N; i++) {
+        for (int d = 0; d < DIM; d++) {
+            data[i * DIM + d] = centres[(i % 40) * DIM + d] + (float)(rand() % 400) / 100.0f;
+        }
+    }
+    
+    ann_index_t* index = create_ann_index(DIM, ANN_L2, 0, 0, 7);
+    CHECK(index && ann_index_size(index) == 0 && ann_index_dim(index) == DIM);
+    uint32_t ids[QUERIES * K];
+    float distances[QUERIES * K];
+    CHECK(ann_index_search(index, data, K, 0, ids, distances) == 0);
+    CHECK(ids[0] == UINT32_MAX && isinf(distances[K - 1]));
+    for (int i = 0; i < N / 2; i++) {
+        CHECK(ann_index_add(index, data + i * DIM) == i);
+    }
+    
+    // The second half arrives as an F16 tensor; stored rows are the f16
+    // round trip, so queries use those values too
+    struct ggml_tensor* rows = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, N / 2, DIM);
+    ggml_get_type_traits(GGML_TYPE_F16)->from_f32(data + N / 2 * DIM, rows->data, N / 2 * DIM);
+    ggml_get_type_traits(GGML_TYPE_F16)->to_f32(rows->data, data + N / 2 * DIM, N / 2 * DIM);
+    CHECK(ann_index_add_rows(index, rows) == N / 2 && ann_index_size(index) == N);
+    
+    // Recall against brute force; every stored row finds itself first
+    struct ggml_tensor* queries = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, QUERIES, DIM);
+    float* q = ggml_get_data_f32(queries);
+    for (int i = 0; i < QUERIES * DIM; i++) {
+        q[i] = data[(i / DIM * 37) * DIM + i % DIM] + (float)(rand() % 100) / 100.0f - 0.5f;
+    }
+    size_t hits = 0;
+    for (int i = 0; i < QUERIES; i++) {
+        float exact[N];
+        for (int j = 0; j < N; j++) {
+            float sum = 0.0f;
+            for (int d = 0; d < DIM; d++) {
+                float diff = q[i * DIM + d] - data[j * DIM + d];
+                sum += diff * diff;
+            }
+            exact[j] = sum;
+        }
+        CHECK(ann_index_search(index, q + i * DIM, K, 64, ids, distances) == K);
+        float kth = INFINITY;
+        for (int r = 0; r < K; r++) {
+            // k-th smallest exact distance by selection
+            float best = INFINITY;
+            int best_j = -1;
+            for (int j = 0; j < N; j++) {
+                if (exact[j] < best) { best = exact[j]; best_j = j; }
+            }
+            exact[best_j] = INFINITY;
+            kth = best;
+            CHECK(r == 0 || distances[r] >= distances[r - 1]);
+        }
+        for (int r = 0; r < K; r++) {
+            hits += distances[r] <= kth * (1.0f + 1e-5f);
+        }
+        
+        uint32_t self;
+        float self_distance;
+        CHECK(ann_index_search(index, data + (i * 41 % N) * DIM, 1, 0, &self, &self_distance) == 1);
+        CHECK(self_distance == 0.0f);
+    }
+    CHECK(hits >= (size_t)(0.95 * QUERIES * K));
+    
+    // Batched queries match single ones at any thread count
+    int original_threads = agent_zero_get_num_threads();
+    for (int threads = 1; threads <= 4; threads += 3) {
+        agent_zero_set_num_threads(threads);
+        uint32_t batch_ids[QUERIES * K];
+        float batch_distances[QUERIES * K];
+        CHECK(ann_index_search_batch(index, queries, K, 64, batch_ids, batch_distances) == 0);
+        for (int i = 0; i < QUERIES; i++) {
+            ann_index_search(index, q + i * DIM, K, 64, ids, distances);
+            CHECK(memcmp(ids, batch_ids + i * K, K * sizeof(uint32_t)) == 0);
+            CHECK(memcmp(distances, batch_distances + i * K, K * sizeof(float)) == 0);
+        }
+    }
+    agent_zero_set_num_threads(original_threads);
+    
+    // Asking for more than the index holds pads the tail
+    ann_index_t* tiny = create_ann_index(DIM, ANN_COSINE, 4, 8, 1);
+    float scaled[DIM];
+    for (int d = 0; d < DIM; d++) scaled[d] = 3.0f * data[d];
+    CHECK(ann_index_add(tiny, data) == 0 && ann_index_add(tiny, data + DIM) == 1);
+    CHECK(ann_index_search(tiny, scaled, 4, 0, ids, distances) == 2);
+    CHECK(ids[0] == 0 && fabsf(distances[0]) < 1e-5f && ids[2] == UINT32_MAX);
+    CHECK(!create_ann_index(0, ANN_L2, 0, 0, 0) && !create_ann_index(DIM, ANN_L2, 1000, 0, 0));
+    CHECK(ann_index_add_rows(tiny, queries) == 2);
+    struct ggml_tensor* wrong = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 2, DIM + 1);
+    CHECK(ann_index_add_rows(tiny, wrong) == -1);
+    CHECK(ann_index_search_batch(tiny, wrong, 1, 0, ids, NULL) == -1);
+    
+    // Similar atoms through the bridge: rows of the encoded similarity
+    // hypergraph, plus rows past the AtomSpace that must be skipped
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 40; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, (double)(i % 10) / 10.0, 0.9);
+    }
+    hypergraph_t* hg = create_hypergraph_from_atomspace(as, 0.15f, 1);
+    struct ggml_tensor* encoded = encode_hypergraph_to_tensor(NULL, hg);
+    ann_index_t* atoms_index = create_ann_index(40, ANN_L2, 0, 0, 3);
+    CHECK(ann_index_add_rows(atoms_index, encoded) == 0);
+    const float* row3 = ggml_get_data_f32(encoded) + 3 * 40;
+    for (int i = 0; i < 5; i++) ann_index_add(atoms_index, row3);
+    uint32_t similar[8];
+    float similar_distances[8];
+    CHECK(pattern_match_atomspace_similar(as, atoms_index, row3, 4, 0, similar, similar_distances) == 4);
+    // The copies of row 3 tie with atom 3 and are fetched past
+    CHECK(similar[0] == 3 && similar_distances[0] == 0.0f);
+    for (int r = 1; r < 4; r++) {
+        CHECK(similar[r] < 40 && similar_distances[r] >= similar_distances[r - 1]);
+    }
+    
+    destroy_ann_index(atoms_index);
+    ggml_free_tensor(encoded);
+    destroy_hypergraph(hg);
+    destroy_atomspace(as);
+    ggml_free_tensor(wrong);
+    destroy_ann_index(tiny);
+    ggml_free_tensor(queries);
+    ggml_free_tensor(rows);
+    destroy_ann_index(index);
+    printf("PASS: Approximate nearest neighbour index\n");
+    return 1;
+}
+
+typedef struct {
+    _Atomic int gate;        // compute blocks while 0
+    int fail_frame;
+    int calls;
+    uint64_t frames[16];
+    float outputs[16][256];
+    int statuses[16];
+} pipeline_probe_t;
+
+static int gated_compute(const struct ggml_tensor* input, struct ggml_tensor* output, void* user) {
+    pipeline_probe_t* probe = user;
+    while (!atomic_load(&probe->gate)) {
+        usleep(100);
+    }
+    if (probe->calls++ == probe->fail_frame) return -1;
+    return cognitive_attention_matrix_into(output, input, 0.6f);
+}
+
+static void record_frame(uint64_t frame, int status, const struct ggml_tensor* output,
+                         const atomspace_delta_t* delta, void* user) {
+    pipeline_probe_t* probe = user;
+    CHECK(delta != NULL);
+    probe->frames[frame] = frame;
+    probe->statuses[frame] = status;
+    memcpy(probe->outputs[frame], ggml_get_data_f32(output), sizeof(probe->outputs[frame]));
+}
+
+int test_cognitive_pipeline() {
+    printf("Testing cognitive pipeline...\n");
+    
+    enum { FRAMES = 12 };
+    int shape[] = { 16, 16 };
+    cognitive_kernel_t* kernel = create_cognitive_kernel(NULL, shape, 2, 0.6f);
+    AtomSpace* source = create_atomspace();
+    AtomSpace* sink = create_atomspace();
+    AtomSpace* reference = create_atomspace();
+    atomspace_delta_t* reference_delta = create_atomspace_delta();
+    for (int i = 0; i < 100; i++) {
+        atomspace_add_atom(source, ATOM_TYPE_CONCEPT, NULL, (double)(i % 17) / 17.0, 0.9);
+    }
+    
+    pipeline_probe_t* probe = calloc(1, sizeof(pipeline_probe_t));
+    probe->fail_frame = 5;
+    cognitive_pipeline_config_t config = {
+        kernel, gated_compute, probe, sink, NULL, record_frame, probe, 3
+    };
+    cognitive_pipeline_t* p = create_cognitive_pipeline(&config);
+    CHECK(p && cognitive_pipeline_poll(p, 0) == -1 && cognitive_pipeline_wait(p, 0) == -1);
+    
+    // With compute held, submits return straight away until all three
+    // slots are taken; the source keeps changing meanwhile
+    struct ggml_tensor* encoded = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 16);
+    struct ggml_tensor* computed = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 16);
+    float expected[FRAMES][256];
+    for (int f = 0; f < FRAMES; f++) {
+        if (f == 3) {
+            CHECK(cognitive_pipeline_poll(p, 0) == 0);
+            atomic_store(&probe->gate, 1);
+        }
+        CHECK(cognitive_pipeline_submit(p, source) == f);
+        
+        encode_cognitive_state(source, kernel, encoded);
+        cognitive_attention_matrix_into(computed, encoded, 0.6f);
+        memcpy(expected[f], ggml_get_data_f32(computed), sizeof(expected[f]));
+        if (f != probe->fail_frame) {
+            CHECK(decode_cognitive_state_delta(computed, kernel, reference, reference_delta) == 0);
+        }
+        for (int i = 0; i < 7; i++) {
+            atomspace_add_atom(source, ATOM_TYPE_CONCEPT, NULL, (double)((f * 7 + i) % 11) / 11.0, 0.8);
+        }
+    }
+    CHECK(cognitive_pipeline_wait(p, 4) == 0 && cognitive_pipeline_poll(p, 4) == 1);
+    cognitive_pipeline_drain(p);
+    CHECK(cognitive_pipeline_poll(p, FRAMES - 1) == 1);
+    CHECK(cognitive_pipeline_failures(p) == 1);
+    
+    // Same results, in order, as running the frames back to back
+    for (int f = 0; f < FRAMES; f++) {
+        CHECK(probe->frames[f] == (uint64_t)f);
+        CHECK(probe->statuses[f] == (f == probe->fail_frame ? -1 : 0));
+        if (f != probe->fail_frame) {
+            CHECK(memcmp(probe->outputs[f], expected[f], sizeof(expected[f])) == 0);
+        }
+    }
+    CHECK(atomspace_size(sink) == atomspace_size(reference));
+    CHECK(memcmp(atomspace_activations(sink), atomspace_activations(reference),
+                 atomspace_size(sink) * sizeof(float)) == 0);
+    
+    // Frames still queued at destroy are completed first
+    probe->fail_frame = -1;
+    int64_t last = -1;
+    for (int f = 0; f < 4; f++) {
+        last = cognitive_pipeline_submit(p, source);
+    }
+    CHECK(last == FRAMES + 3);
+    destroy_cognitive_pipeline(p);
+    CHECK(probe->frames[15] == 15 && probe->statuses[15] == 0);
+    
+    // Default compute, no sink or callback
+    cognitive_pipeline_config_t plain = { kernel, NULL, NULL, NULL, NULL, NULL, NULL, 0 };
+    p = create_cognitive_pipeline(&plain);
+    CHECK(p && cognitive_pipeline_submit(p, source) == 0 && cognitive_pipeline_wait(p, 0) == 0);
+    CHECK(cognitive_pipeline_failures(p) == 0);
+    destroy_cognitive_pipeline(p);
+    plain.depth = 1;
+    CHECK(!create_cognitive_pipeline(&plain));
+    
+    ggml_free_tensor(computed);
+    ggml_free_tensor(encoded);
+    free(probe);
+    destroy_atomspace_delta(reference_delta);
+    destroy_atomspace(reference);
+    destroy_atomspace(sink);
+    destroy_atomspace(source);
+    destroy_cognitive_kernel(kernel);
+    printf("PASS: Cognitive pipeline\n");
+    return 1;
+}
+
+// Shared by the concurrent AtomSpace writers and readers. Every activation
+// a writer stores lies in [0.5, 0.9]; retired atoms read 0 and padding 0.1.
+typedef struct {
+    AtomSpace* as;
+    _Atomic int done;
+    _Atomic int failures;
+    _Atomic int reads;
+} concurrent_atomspace_t;
+
+static int activation_in_domain(float v) {
+    return v == 0.0f || v == 0.1f || (v >= 0.5f - 1e-6f && v <= 0.9f + 1e-6f);
+}
+
+static float writer_value(int k) {
+    return 0.5f + (float)(k % 5) * 0.1f;
+}
+
+static void* atomspace_decode_writer(void* arg) {
+    concurrent_atomspace_t* shared = arg;
+    float values[1500];
+    struct ggml_tensor* decoded = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, 100);
+    for (int i = 0; i < 100; i++) {
+        ggml_get_data_f32(decoded)[i] = writer_value(i);
+    }
+    atomspace_delta_t* delta = create_atomspace_delta();
+    for (int round = 0; round < 40; round++) {
+        // The first batch grows the columns past their initial capacity
+        size_t n = round == 0 ? 1500 : 200;
+        for (size_t i = 0; i < n; i++) {
+            values[i] = (i + round) % 3 == 0 ? 0.0f : writer_value((int)i + round);
+        }
+        if (atomspace_apply_activations(shared->as, values, n, 1.0f, 0.01f, delta) != 0) {
+            atomic_fetch_add(&shared->failures, 1);
+        }
+        if (round % 3 == 2) tensor_to_atomspace(decoded, shared->as);
+    }
+    destroy_atomspace_delta(delta);
+    ggml_free_tensor(decoded);
+    return NULL;
+}
+
+static void* atomspace_add_writer(void* arg) {
+    concurrent_atomspace_t* shared = arg;
+    for (int i = 0; i < 2000; i++) {
+        if (atomspace_add_atom(shared->as, ATOM_TYPE_LINK, NULL, writer_value(i), 0.5) < 0) {
+            atomic_fetch_add(&shared->failures, 1);
+        }
+    }
+    return NULL;
+}
+
+static void* atomspace_tensor_reader(void* arg) {
+    concurrent_atomspace_t* shared = arg;
+    struct ggml_tensor* encoded = ggml_new_tensor_1d(NULL, GGML_TYPE_F32, 4096);
+    do {
+        atomspace_to_tensor(shared->as, encoded);
+        for (int i = 0; i < 4096; i++) {
+            if (!activation_in_domain(ggml_get_data_f32(encoded)[i])) {
+                atomic_fetch_add(&shared->failures, 1);
+                break;
+            }
+        }
+        atomic_fetch_add(&shared->reads, 1);
+    } while (!atomic_load(&shared->done));
+    ggml_free_tensor(encoded);
+    return NULL;
+}
+
+static void* atomspace_attention_reader(void* arg) {
+    concurrent_atomspace_t* shared = arg;
+    const float weight = 0.8f;
+    do {
+        struct ggml_tensor* attention = create_attention_tensor(NULL, shared->as, weight);
+        size_t n = (size_t)attention->ne[0];
+        const float* data = ggml_get_data_f32(attention);
+        for (size_t i = 0; i < n * n; i++) {
+            float v = data[i];
+            int ok = i % (n + 1) == 0 ? v == weight : v >= 0.0f && v <= 0.5f * weight + 1e-6f;
+            if (!ok) {
+                atomic_fetch_add(&shared->failures, 1);
+                break;
+            }
+        }
+        ggml_free_tensor(attention);
+
+        // Inside a read section the column does not move or change
+        atomspace_read_begin(shared->as);
+        struct ggml_tensor* column = atomspace_activation_tensor(NULL, shared->as);
+        if (column) {
+            size_t count = (size_t)column->ne[0];
+            float* copy = malloc(count * sizeof(float));
+            memcpy(copy, ggml_get_data_f32(column), count * sizeof(float));
+            usleep(50);
+            if (memcmp(copy, ggml_get_data_f32(column), count * sizeof(float)) != 0) {
+                atomic_fetch_add(&shared->failures, 1);
+            }
+            free(copy);
+            ggml_free_tensor(column);
+        }
+        atomspace_read_end(shared->as);
+        atomic_fetch_add(&shared->reads, 1);
+    } while (!atomic_load(&shared->done));
+    return NULL;
+}
+
+int test_concurrent_atomspace() {
+    printf("Testing concurrent AtomSpace readers and writers...\n");
+    
+    concurrent_atomspace_t shared = { create_atomspace(), 0, 0, 0 };
+    CHECK(shared.as != NULL);
+    
+    pthread_t writers[2], readers[2];
+    pthread_create(&readers[0], NULL, atomspace_tensor_reader, &shared);
+    pthread_create(&readers[1], NULL, atomspace_attention_reader, &shared);
+    pthread_create(&writers[0], NULL, atomspace_decode_writer, &shared);
+    pthread_create(&writers[1], NULL, atomspace_add_writer, &shared);
+    for (int i = 0; i < 2; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    atomic_store(&shared.done, 1);
+    for (int i = 0; i < 2; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    if (atomic_load(&shared.failures)) {
+        printf("FAIL: %d inconsistent reads or failed writes\n", atomic_load(&shared.failures));
+        return 0;
+    }
+    CHECK(atomic_load(&shared.reads) >= 2);
+    
+    // Writers serialized: the columns agree with the liveness count and the
+    // published view matches the writer's
+    size_t live = 0;
+    for (size_t i = 0; i < shared.as->count; i++) {
+        live += shared.as->live[i];
+        CHECK(shared.as->live[i] ? shared.as->activation[i] >= 0.5f : shared.as->activation[i] == 0.0f);
+    }
+    CHECK(live == atomspace_size(shared.as));
+    CHECK(atomic_load(&shared.as->published) == shared.as->view);
+    
+    // Nested read sections on one thread
+    atomspace_read_begin(shared.as);
+    atomspace_read_begin(shared.as);
+    const float* column = atomspace_activations(shared.as);
+    atomspace_read_end(shared.as);
+    CHECK(column[0] == shared.as->activation[0]);
+    atomspace_read_end(shared.as);
+    
+    destroy_atomspace(shared.as);
+    printf("PASS: Concurrent AtomSpace readers and writers\n");
+    return 1;
+}
+
+int test_specialized_pattern_shapes() {
+    printf("Testing shape-specialized pattern kernels...\n");
+    
+    // Unrolled 3x3/5x5/7x7 rows on square fields, odd widths that end in the
+    // padded edge path, and a plane too short for 7x7 (generic fallback)
+    const int planes[][2] = { {64, 64}, {128, 128}, {19, 45}, {9, 3}, {6, 70} };
+    const int sides[] = { 3, 5, 7 };
+    const cognitive_match_backend_t modes[] = { COGNITIVE_MATCH_AUTO, COGNITIVE_MATCH_DIRECT };
+    const char* original = agent_zero_simd_backend();
+    const char* backends[] = {"scalar", "sse2", "avx2", "avx512", "neon"};
+    
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (agent_zero_set_simd_backend(backends[b]) != 0) continue;
+        for (size_t pl = 0; pl < sizeof(planes) / sizeof(planes[0]); pl++) {
+            int rows = planes[pl][0], cols = planes[pl][1];
+            struct ggml_tensor* data = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+            float* d = ggml_get_data_f32(data);
+            for (int i = 0; i < rows * cols; i++) {
+                d[i] = (float)((i * 53) % 97) / 97.0f - 0.5f;
+            }
+            for (size_t s = 0; s < sizeof(sides) / sizeof(sides[0]); s++) {
+                int side = sides[s], count = 3;
+                struct ggml_tensor* patterns = ggml_new_tensor_3d(NULL, GGML_TYPE_F32, side, side, count);
+                float* p = ggml_get_data_f32(patterns);
+                for (int i = 0; i < side * side * count; i++) {
+                    p[i] = (float)((i * 17) % 31) / 31.0f - 0.45f;
+                }
+                for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+                    struct ggml_tensor* result = cognitive_pattern_match_batch(NULL, patterns, data, modes[m]);
+                    CHECK(result != NULL);
+                    float* r = ggml_get_data_f32(result);
+                    for (int k = 0; k < count; k++) {
+                        for (int i = 0; i < rows; i++) {
+                            for (int j = 0; j < cols; j++) {
+                                float ref = naive_match(d, rows, cols, p + k * side * side, side, side, i, j);
+                                float got = r[(k * rows + i) * cols + j];
+                                if (fabsf(got - ref) > 1e-3f * (1.0f + fabsf(ref))) {
+                                    printf("FAIL: %s %dx%d on %dx%d[%d] at (%d,%d): %f vs %f\n",
+                                           backends[b], side, side, rows, cols, k, i, j, got, ref);
+                                    agent_zero_set_simd_backend(original);
+                                    return 0;
+                                }
+                            }
+                        }
+                    }
+                    ggml_free_tensor(result);
+                }
+                ggml_free_tensor(patterns);
+            }
+            ggml_free_tensor(data);
+        }
+    }
+    
+    agent_zero_set_simd_backend(original);
+    printf("PASS: Shape-specialized pattern kernels\n");
+    return 1;
+}
+
+int test_memory_placement() {
+    printf("Testing NUMA memory placement...\n");
+    
+    // AGENT_ZERO_PLACEMENT may set the starting policy
+    int original = agent_zero_get_placement();
+    CHECK(agent_zero_numa_nodes() >= 1);
+    CHECK(agent_zero_set_placement(7) == -1);
+    CHECK(agent_zero_get_placement() == original);
+    CHECK(agent_zero_set_placement(AGENT_ZERO_PLACEMENT_FIRST_TOUCH) == 0);
+    
+    // 600 x 600 f32 attention is past the 1 MiB placement threshold
+    AtomSpace* as = create_atomspace();
+    for (int i = 0; i < 600; i++) {
+        atomspace_add_atom(as, ATOM_TYPE_CONCEPT, NULL, ((i * 4111) % 997) / 997.0, 0.8);
+    }
+    int original_threads = agent_zero_get_num_threads();
+    agent_zero_set_num_threads(4);
+    struct ggml_tensor* reference = create_attention_tensor(NULL, as, 0.7f);
+    CHECK(reference != NULL && !(reference->flags & GGML_TENSOR_FLAG_PLACED));
+    size_t bytes = (size_t)600 * 600 * sizeof(float);
+    
+    const int policies[] = {
+        AGENT_ZERO_PLACEMENT_INTERLEAVE,
+        AGENT_ZERO_PLACEMENT_PARTITIONED,
+        AGENT_ZERO_PLACEMENT_PARTITIONED | AGENT_ZERO_PLACEMENT_HUGE_PAGES,
+        AGENT_ZERO_PLACEMENT_FIRST_TOUCH | AGENT_ZERO_PLACEMENT_HUGE_PAGES,
+    };
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+        CHECK(agent_zero_set_placement(policies[p]) == 0);
+        CHECK(agent_zero_get_placement() == policies[p]);
+        
+        // Placed, aligned, and the same result as the heap tensor
+        struct ggml_tensor* attention = create_attention_tensor(NULL, as, 0.7f);
+        CHECK(attention != NULL && (attention->flags & GGML_TENSOR_FLAG_PLACED));
+        CHECK((uintptr_t)attention->data % GGML_MEM_ALIGN == 0);
+        CHECK(memcmp(attention->data, reference->data, bytes) == 0);
+        ggml_free_tensor(attention);
+        
+        // New placed tensors read as zero, also when they reuse a freed
+        // block, and are counted apart from heap fallbacks; small ones
+        // stay in the pool
+        agent_zero_reset_stats();
+        for (int round = 0; round < 2; round++) {
+            struct ggml_tensor* big = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 1024, 300);
+            CHECK(big && (big->flags & GGML_TENSOR_FLAG_PLACED));
+            float* b = ggml_get_data_f32(big);
+            for (int i = 0; i < 1024 * 300; i++) {
+                CHECK(b[i] == 0.0f);
+                b[i] = 1.0f;
+            }
+            ggml_free_tensor(big);
+        }
+        if (agent_zero_stats_enabled()) {
+            agent_zero_stats_t stats;
+            agent_zero_get_stats(&stats);
+            CHECK(stats.placed_allocs == 2 && stats.malloc_fallbacks == 0);
+        }
+        struct ggml_tensor* small = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 16);
+        CHECK(small && (small->flags & GGML_TENSOR_FLAG_POOL));
+        ggml_free_tensor(small);
+        
+        // Arenas are placed as a whole
+        struct ggml_context* ctx = ggml_context_create(4 << 20);
+        CHECK(ctx && ctx->placed);
+        struct ggml_tensor* in_ctx = create_attention_tensor(ctx, as, 0.7f);
+        CHECK(in_ctx != NULL && memcmp(in_ctx->data, reference->data, bytes) == 0);
+        ggml_context_free(ctx);
+    }
+    
+    // The default policy is back to plain heap memory
+    CHECK(agent_zero_set_placement(AGENT_ZERO_PLACEMENT_FIRST_TOUCH) == 0);
+    struct ggml_tensor* heap = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 1024, 300);
+    CHECK(heap && !(heap->flags & GGML_TENSOR_FLAG_PLACED));
+    ggml_free_tensor(heap);
+    struct ggml_context* ctx = ggml_context_create(4 << 20);
+    CHECK(ctx && !ctx->placed);
+    ggml_context_free(ctx);
+    
+    agent_zero_set_placement(original);
+    agent_zero_set_num_threads(original_threads);
+    ggml_free_tensor(reference);
+    destroy_atomspace(as);
+    printf("PASS: NUMA memory placement\n");
+    return 1;
+}
+
+int test_tensor_delta() {
+    printf("Testing tensor delta messages...\n");
+    
+    // A 257 x 301 field (the last block is short) that a few updates touch
+    const int rows = 257, cols = 301, n = rows * cols;
+    size_t raw = (size_t)n * sizeof(float);
+    struct ggml_tensor* current = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+    struct ggml_tensor* base = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+    struct ggml_tensor* peer = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, rows, cols);
+    CHECK(current && base && peer);
+    float* c = ggml_get_data_f32(current);
+    for (int i = 0; i < n; i++) {
+        c[i] = ((i * 7919) % 1009) / 1009.0f;
+    }
+    size_t bound = tensor_delta_bound(current);
+    CHECK(bound > raw);
+    uint8_t* msg = malloc(bound);
+    uint8_t* saved = malloc(raw);
+    CHECK(msg && saved);
+    
+    // Keyframe onto a peer holding garbage
+    tensor_delta_options_t key = { 0.0f, 1, 0 };
+    memset(peer->data, 0x5a, raw);
+    int64_t size = tensor_delta_encode(current, base, &key, msg, bound);
+    CHECK(size > 0 && (size_t)size <= bound);
+    CHECK(tensor_delta_decode(peer, msg, (size_t)size) == 0);
+    CHECK(memcmp(peer->data, c, raw) == 0 && memcmp(base->data, c, raw) == 0);
+    
+    // Nothing changed: header only
+    size = tensor_delta_encode(current, base, NULL, msg, bound);
+    CHECK(size == 64 && tensor_delta_decode(peer, msg, (size_t)size) == 0);
+    CHECK(tensor_delta_encode(current, base, NULL, msg, bound - 1) == -1);
+    
+    // A mostly stable update: three rows rewritten, a hundred scattered cells
+    for (int round = 0; round < 4; round++) {
+        for (int r = 0; r < 3; r++) {
+            int row = (round * 61 + r * 83) % rows;
+            for (int j = 0; j < cols; j++) c[row * cols + j] *= 0.9f;
+        }
+        for (int k = 0; k < 100; k++) {
+            c[(k * 104729 + round * 13) % n] += 0.25f;
+        }
+        size = tensor_delta_encode(current, base, NULL, msg, bound);
+        CHECK(size > 64 && (size_t)size * 10 < raw);
+        CHECK(tensor_delta_decode(peer, msg, (size_t)size) == 0);
+        CHECK(memcmp(peer->data, c, raw) == 0 && memcmp(base->data, c, raw) == 0);
+        
+        // Replaying the same message fails: the peer no longer holds its base
+        memcpy(saved, peer->data, raw);
+        CHECK(tensor_delta_decode(peer, msg, (size_t)size) == -1);
+        CHECK(memcmp(peer->data, saved, raw) == 0);
+    }
+    
+    // Truncated and corrupt messages leave the target untouched
+    c[5] = -3.0f;
+    c[n - 1] = 42.0f;
+    size = tensor_delta_encode(current, base, NULL, msg, bound);
+    memcpy(saved, peer->data, raw);
+    for (int64_t cut = 0; cut < size; cut += 7) {
+        CHECK(tensor_delta_decode(peer, msg, (size_t)cut) == -1);
+    }
+    for (int64_t at = 0; at < size; at++) {
+        msg[at] ^= 0x80;
+        if (tensor_delta_decode(peer, msg, (size_t)size) != 0) {
+            CHECK(memcmp(peer->data, saved, raw) == 0);
+        } else {
+            // A flip inside a payload byte still decodes; undo it
+            memcpy(peer->data, saved, raw);
+        }
+        msg[at] ^= 0x80;
+    }
+    CHECK(tensor_delta_decode(peer, msg, (size_t)size) == 0);
+    CHECK(memcmp(peer->data, c, raw) == 0);
+    struct ggml_tensor* other = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, cols, rows);
+    CHECK(other && tensor_delta_decode(other, msg, (size_t)size) == -1);
+    ggml_free_tensor(other);
+    
+    // Quantized: small drifts are held back until they reach step / 2,
+    // and both sides stay bit-identical to each other
+    const float step = 1.0f / 1024;
+    tensor_delta_options_t quantized = { step, 0, 0 };
+    for (int round = 0; round < 6; round++) {
+        for (int i = 0; i < n; i += 97) c[i] += step * 0.3f;
+        for (int i = 1; i < n; i += 1031) c[i] -= 0.5f;
+        if (round == 3) {
+            c[2] = INFINITY;
+            c[3] = NAN;
+        }
+        if (round == 4) c[2] = 1.0f;
+        size = tensor_delta_encode(current, base, &quantized, msg, bound);
+        CHECK(size > 0 && (size_t)size * 10 < raw);
+        CHECK(tensor_delta_decode(peer, msg, (size_t)size) == 0);
+        CHECK(memcmp(peer->data, base->data, raw) == 0);
+        const float* p = ggml_get_data_f32(peer);
+        for (int i = 0; i < n; i++) {
+            if (isnan(c[i])) {
+                CHECK(isnan(p[i]));
+            } else if (isinf(c[i])) {
+                CHECK(p[i] == c[i]);
+            } else {
+                CHECK(fabsf(p[i] - c[i]) <= step * 0.5f + 1e-6f);
+            }
+        }
+    }
+    tensor_delta_options_t bad_step = { -1.0f, 0, 0 };
+    CHECK(tensor_delta_encode(current, base, &bad_step, msg, bound) == -1);
+    
+    // 16-bit storage words, optionally zstd-framed
+    struct ggml_tensor* h_cur = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, 64, 96);
+    struct ggml_tensor* h_base = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, 64, 96);
+    struct ggml_tensor* h_peer = ggml_new_tensor_2d(NULL, GGML_TYPE_F16, 64, 96);
+    CHECK(h_cur && h_base && h_peer);
+    ggml_fp32_to_fp16_row(c, h_cur->data, 64 * 96);
+    size_t h_bound = tensor_delta_bound(h_cur);
+    uint8_t* h_msg = malloc(h_bound);
+    CHECK(h_msg);
+    tensor_delta_options_t unframed = { 0.0f, 1, 0 };
+    int64_t unframed_size = tensor_delta_encode(h_cur, h_base, &unframed, h_msg, h_bound);
+    tensor_delta_options_t framed = { 0.0f, 1, 3 };
+    size = tensor_delta_encode(h_cur, h_base, &framed, h_msg, h_bound);
+    CHECK(size > 0 && size <= unframed_size);
+    CHECK(tensor_delta_zstd_available() ? size < unframed_size : size == unframed_size);
+    CHECK(tensor_delta_decode(h_peer, h_msg, (size_t)size) == 0);
+    CHECK(memcmp(h_peer->data, h_cur->data, 64 * 96 * 2) == 0);
+    ((uint16_t*)h_cur->data)[100] ^= 0x1;
+    size = tensor_delta_encode(h_cur, h_base, &framed, h_msg, h_bound);
+    CHECK(size > 64 && tensor_delta_decode(h_peer, h_msg, (size_t)size) == 0);
+    CHECK(memcmp(h_peer->data, h_cur->data, 64 * 96 * 2) == 0);
+    tensor_delta_options_t f16_quantized = { step, 0, 0 };
+    CHECK(tensor_delta_encode(h_cur, h_base, &f16_quantized, h_msg, h_bound) == -1);
+    
+    free(h_msg);
+    ggml_free_tensor(h_cur);
+    ggml_free_tensor(h_base);
+    ggml_free_tensor(h_peer);
+    free(saved);
+    free(msg);
+    ggml_free_tensor(current);
+    ggml_free_tensor(base);
+    ggml_free_tensor(peer);
+    printf("PASS: Tensor delta messages\n");
+    return 1;
+}
+
+static int count_occurrences(const char* text, const char* needle) {
+    int count = 0;
+    for (const char* p = strstr(text, needle); p; p = strstr(p + 1, needle)) {
+        count++;
+    }
+    return count;
+}
+
+int test_profiling() {
+    printf("Testing profiling traces...\n");
+    
+    const char* path = "/tmp/agent-zero-test-profile.json";
+    if (!agent_zero_stats_enabled()) {
+        CHECK(agent_zero_profile_start(path, AGENT_ZERO_PROFILE_ALL) == -1);
+        printf("PASS: Profiling traces (compiled out)\n");
+        return 1;
+    }
+    CHECK(!agent_zero_profile_active() && agent_zero_profile_stop() == -1);
+    CHECK(agent_zero_profile_start("/nonexistent-dir/profile.json", AGENT_ZERO_PROFILE_ALL) == -1);
+    
+    struct ggml_tensor* input = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 64);
+    struct ggml_tensor* out = ggml_new_tensor_2d(NULL, GGML_TYPE_F32, 16, 64);
+    CHECK(input && out);
+    
+    CHECK(agent_zero_profile_start(path, AGENT_ZERO_PROFILE_ALL) == 0);
+    CHECK(agent_zero_profile_active());
+    CHECK(agent_zero_profile_start(path, AGENT_ZERO_PROFILE_ALL) == -1);
+    int counters = agent_zero_profile_counters();
+    
+    // Two ops in place, one that allocates its result inside its span, a
+    // freed tensor and an arena with one tensor
+    CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    struct ggml_tensor* encoded = hypergraph_encoding(NULL, input, input);
+    CHECK(encoded);
+    ggml_free_tensor(encoded);
+    struct ggml_context* ctx = ggml_context_create(64 * 1024);
+    CHECK(ggml_new_tensor_1d(ctx, GGML_TYPE_F32, 100));
+    ggml_context_free(ctx);
+    
+    int64_t events = agent_zero_profile_stop();
+    CHECK(!agent_zero_profile_active() && agent_zero_profile_stop() == -1);
+    // Stopped: nothing more is written
+    CHECK(cognitive_attention_matrix_into(out, input, 0.5f) == 0);
+    
+    FILE* f = fopen(path, "r");
+    CHECK(f);
+    char* text = calloc(1, 64 * 1024);
+    CHECK(text);
+    size_t len = fread(text, 1, 64 * 1024 - 1, f);
+    fclose(f);
+    CHECK(len > 0 && len < 64 * 1024 - 1);
+    CHECK(strncmp(text, "{\"displayTimeUnit\"", 18) == 0);
+    CHECK(strcmp(text + len - 4, "\n]}\n") == 0);
+    
+    // Process name, three op spans, tensor alloc + free, context alloc,
+    // arena tensor, context free
+    CHECK(events == 1 + 3 + 2 + 3);
+    CHECK(count_occurrences(text, "\"ph\":\"X\"") == 3);
+    CHECK(count_occurrences(text, "\"name\":\"attention\"") == 2);
+    CHECK(count_occurrences(text, "\"name\":\"hypergraph_encoding\"") == 1);
+    CHECK(count_occurrences(text, "\"name\":\"alloc\"") == 3);
+    CHECK(count_occurrences(text, "\"name\":\"free\"") == 2);
+    CHECK(count_occurrences(text, "\"source\":\"context\"") == 2);
+    CHECK(count_occurrences(text, "\"source\":\"arena\"") == 1);
+    // The transform's result is charged to it
+    const char* span = strstr(text, "\"name\":\"hypergraph_encoding\"");
+    CHECK(span && strstr(span, "\"allocs\":1,\"alloc_bytes\":4096"));
+    CHECK(count_occurrences(text, "\"allocs\":0,") == 2);
+    // Counters appear on every span when this host grants them
+    int expected = counters ? 3 : 0;
+    CHECK(count_occurrences(text, "\"cycles\":") == ((counters & 1) ? expected : 0));
+    CHECK(count_occurrences(text, "\"branch_misses\":") == ((counters & 8) ? expected : 0));
+    
+    // Without flags spans carry neither counters nor allocation events
+    CHECK(agent_zero_profile_start(path, 0) == 0);
+    encoded = hypergraph_encoding(NULL, input, input);
+    ggml_free_tensor(encoded);
+    CHECK(agent_zero_profile_stop() == 2);
+    f = fopen(path, "r");
+    CHECK(f);
+    len = fread(text, 1, 64 * 1024 - 1, f);
+    text[len] = '\0';
+    fclose(f);
+    CHECK(count_occurrences(text, "\"ph\":\"X\"") == 1 && !strstr(text, "\"cycles\""));
+    CHECK(strstr(text, "\"allocs\":1,\"alloc_bytes\":4096") && !strstr(text, "\"name\":\"alloc\""));
+    
+    remove(path);
+    free(text);
+    ggml_free_tensor(out);
+    ggml_free_tensor(input);
+    printf("PASS: Profiling traces (counters 0x%x)\n", counters);
+    return 1;
+}
+
 int test_tensor_operations() {
     printf("Testing tensor operations...\n");
     
@@ -61,10 +2685,39 @@ int main() {
     printf("Running Agent-Zero C component tests...\n\n");
     
     int passed = 0;
-    int total = 3;
+    int total = 32;
     
     passed += test_hypergraph_creation();
+    passed += test_sparse_hypergraph();
+    passed += test_atomspace_similarity_join();
+    passed += test_atomspace_index();
+    passed += test_atomspace_columns();
+    passed += test_atomspace_delta();
+    passed += test_batched_encode();
     passed += test_cognitive_kernel_creation();
+    passed += test_context_arena();
+    passed += test_tensor_pool();
+    passed += test_tensor_views();
+    passed += test_simd_dispatch();
+    passed += test_fused_attention();
+    passed += test_pattern_match_engine();
+    passed += test_thread_pool();
+    passed += test_cognitive_graph();
+    passed += test_packed_attention();
+    passed += test_tensor_types();
+    passed += test_snapshot();
+    passed += test_streaming_encode();
+    passed += test_stats_and_trace();
+    passed += test_threshold_decode();
+    passed += test_zero_copy_buffers();
+    passed += test_attention_diffusion();
+    passed += test_ann_index();
+    passed += test_cognitive_pipeline();
+    passed += test_concurrent_atomspace();
+    passed += test_specialized_pattern_shapes();
+    passed += test_memory_placement();
+    passed += test_tensor_delta();
+    passed += test_profiling();
     passed += test_tensor_operations();
     
     printf("\nTest Results: %d/%d passed\n", passed, total);
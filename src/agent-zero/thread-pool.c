@@ -0,0 +1,290 @@
+// Agent-Zero Work-Stealing Thread Pool
+// /src/agent-zero/thread-pool.c
+//
+// parallel_for() splits [0, n) into grain-sized chunks and deals them out
+// as contiguous chunk ranges, one per participant (the caller plus the
+// worker threads). A participant pops chunks from the front of its own
+// range; once empty it scans the others round-robin, starting after
+// itself, and steals the back half of the first non-empty one. Each
+// range is one packed 64-bit word (front << 32 | back), so pops and
+// steals are single CASes and need no locks.
+//
+// Chunk boundaries depend only on n and the grain, never on the thread
+// count or on who runs a chunk, so kernels that compute each element
+// independently of their chunk give bit-identical results at any size.
+//
+// Nested calls, and calls made while another thread holds the pool, run
+// inline on the calling thread. Under the PARTITIONED placement policy
+// each worker pins itself to its NUMA node before joining a job.
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "cognitive-internal.h"
+
+#define POOL_MAX_THREADS 256
+#define POOL_DEFAULT_GRAIN 16384  // elements per task
+
+typedef struct {
+    _Atomic uint64_t range;  // front << 32 | back, chunk indices
+    char pad[64 - sizeof(uint64_t)];
+} chunk_queue_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_mutex_t job_lock;  // held by the thread running parallel_for
+
+    pthread_t* threads;
+    int n_workers;             // threads started, excluding callers
+    int target_threads;        // participants per job, 0 until configured
+    int shutdown;
+
+    // Current job, published under lock
+    uint64_t generation;
+    int job_open;
+    int active;                // workers inside the current job
+    parallel_range_fn fn;
+    void* params;
+    int64_t n;
+    int64_t grain;
+    int participants;
+    chunk_queue_t queues[POOL_MAX_THREADS];
+    atomic_int_fast64_t completed;
+} thread_pool_t;
+
+static thread_pool_t pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .job_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static atomic_int_fast64_t grain_size = POOL_DEFAULT_GRAIN;
+static _Thread_local int in_parallel;
+
+static uint64_t pack_range(uint32_t front, uint32_t back) {
+    return ((uint64_t)front << 32) | back;
+}
+
+// Take the front chunk of queue q; -1 when empty
+static int64_t pop_front(chunk_queue_t* q) {
+    uint64_t range = atomic_load_explicit(&q->range, memory_order_acquire);
+    for (;;) {
+        uint32_t front = (uint32_t)(range >> 32);
+        uint32_t back = (uint32_t)range;
+        if (front >= back) return -1;
+        if (atomic_compare_exchange_weak_explicit(&q->range, &range, pack_range(front + 1, back),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            return front;
+        }
+    }
+}
+
+// Move the back half of a victim's range into the thief's (empty) queue
+static int steal_half(chunk_queue_t* victim, chunk_queue_t* thief) {
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+    for (;;) {
+        uint32_t front = (uint32_t)(range >> 32);
+        uint32_t back = (uint32_t)range;
+        if (front >= back) return 0;
+        uint32_t mid = front + (back - front) / 2;
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &range, pack_range(front, mid),
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            atomic_store_explicit(&thief->range, pack_range(mid, back), memory_order_release);
+            return 1;
+        }
+    }
+}
+
+static void run_chunk(int64_t chunk) {
+    int64_t begin = chunk * pool.grain;
+    int64_t end = begin + pool.grain < pool.n ? begin + pool.grain : pool.n;
+    pool.fn(begin, end, pool.params);
+    atomic_fetch_add_explicit(&pool.completed, 1, memory_order_acq_rel);
+}
+
+// Drain our own queue, then steal until every queue is empty
+static void participate(int self) {
+    chunk_queue_t* own = &pool.queues[self];
+    for (;;) {
+        int64_t chunk;
+        while ((chunk = pop_front(own)) >= 0) {
+            run_chunk(chunk);
+        }
+
+        int stolen = 0;
+        for (int i = 1; i < pool.participants && !stolen; i++) {
+            int victim = (self + i) % pool.participants;
+            stolen = steal_half(&pool.queues[victim], own);
+        }
+        if (!stolen) return;
+    }
+}
+
+static void* worker_main(void* arg) {
+    int self = (int)(intptr_t)arg;
+    uint64_t seen = 0;
+    int node = -1;
+    in_parallel = 1;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        while (pool.generation == seen && !pool.shutdown) {
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        }
+        if (pool.shutdown) break;
+        seen = pool.generation;
+        if (!pool.job_open || self >= pool.participants) continue;
+
+        pool.active++;
+        int threads = pool.target_threads;
+        pthread_mutex_unlock(&pool.lock);
+        placement_bind_worker(self, threads, &node);
+        participate(self);
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.active == 0) {
+            pthread_cond_signal(&pool.done);
+        }
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+static int default_thread_count(void) {
+    const char* forced = getenv("AGENT_ZERO_NUM_THREADS");
+    if (forced && atoi(forced) > 0) return atoi(forced);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+static int clamp_threads(int n_threads) {
+    if (n_threads <= 0) n_threads = default_thread_count();
+    return n_threads > POOL_MAX_THREADS ? POOL_MAX_THREADS : n_threads;
+}
+
+static void stop_workers(void) {
+    pthread_mutex_lock(&pool.lock);
+    pool.shutdown = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for (int i = 0; i < pool.n_workers; i++) {
+        pthread_join(pool.threads[i], NULL);
+    }
+    free(pool.threads);
+    pool.threads = NULL;
+    pool.n_workers = 0;
+    pool.shutdown = 0;
+}
+
+// Start workers up to target_threads - 1; keeps what it could start
+static void start_workers(void) {
+    int wanted = pool.target_threads - 1;
+    if (pool.n_workers >= wanted) return;
+    pthread_t* threads = realloc(pool.threads, (size_t)wanted * sizeof(pthread_t));
+    if (!threads) return;
+    pool.threads = threads;
+    while (pool.n_workers < wanted) {
+        if (pthread_create(&pool.threads[pool.n_workers], NULL, worker_main,
+                           (void*)(intptr_t)(pool.n_workers + 1)) != 0) {
+            break;
+        }
+        pool.n_workers++;
+    }
+}
+
+int agent_zero_set_num_threads(int n_threads) {
+    if (n_threads < 0) return -1;
+    pthread_mutex_lock(&pool.job_lock);
+    int target = clamp_threads(n_threads);
+    if (target < pool.n_workers + 1) {
+        stop_workers();
+    }
+    pool.target_threads = target;
+    pthread_mutex_unlock(&pool.job_lock);
+    return 0;
+}
+
+int agent_zero_get_num_threads(void) {
+    pthread_mutex_lock(&pool.job_lock);
+    if (!pool.target_threads) pool.target_threads = clamp_threads(0);
+    int n = pool.target_threads;
+    pthread_mutex_unlock(&pool.job_lock);
+    return n;
+}
+
+void agent_zero_set_grain_size(int64_t elements) {
+    atomic_store_explicit(&grain_size, elements > 0 ? elements : POOL_DEFAULT_GRAIN,
+                          memory_order_relaxed);
+}
+
+int64_t agent_zero_get_grain_size(void) {
+    return atomic_load_explicit(&grain_size, memory_order_relaxed);
+}
+
+int64_t parallel_grain(int64_t unit_cost) {
+    int64_t grain = agent_zero_get_grain_size();
+    if (unit_cost < 1) unit_cost = 1;
+    return grain / unit_cost > 0 ? grain / unit_cost : 1;
+}
+
+void parallel_for(int64_t n, int64_t grain, parallel_range_fn fn, void* params) {
+    if (n <= 0) return;
+    if (grain < 1) grain = 1;
+
+    int64_t chunks = (n + grain - 1) / grain;
+    if (chunks <= 1 || chunks > UINT32_MAX || in_parallel ||
+        pthread_mutex_trylock(&pool.job_lock) != 0) {
+        fn(0, n, params);
+        return;
+    }
+
+    if (!pool.target_threads) pool.target_threads = clamp_threads(0);
+    start_workers();
+    int participants = pool.n_workers + 1;
+    if ((int64_t)participants > chunks) participants = (int)chunks;
+    if (participants <= 1) {
+        pthread_mutex_unlock(&pool.job_lock);
+        fn(0, n, params);
+        return;
+    }
+
+    // Publish the job with an even split of chunk ranges
+    pthread_mutex_lock(&pool.lock);
+    pool.fn = fn;
+    pool.params = params;
+    pool.n = n;
+    pool.grain = grain;
+    pool.participants = participants;
+    for (int p = 0; p < participants; p++) {
+        uint32_t front = (uint32_t)(chunks * p / participants);
+        uint32_t back = (uint32_t)(chunks * (p + 1) / participants);
+        atomic_store_explicit(&pool.queues[p].range, pack_range(front, back), memory_order_relaxed);
+    }
+    atomic_store_explicit(&pool.completed, 0, memory_order_relaxed);
+    pool.job_open = 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_parallel = 1;
+    participate(0);
+    in_parallel = 0;
+
+    // Wait for chunks still running elsewhere, then for every worker to
+    // leave the job before its state is reused
+    while (atomic_load_explicit(&pool.completed, memory_order_acquire) < chunks) {
+        sched_yield();
+    }
+    pthread_mutex_lock(&pool.lock);
+    pool.job_open = 0;
+    while (pool.active > 0) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.job_lock);
+}